@@ -35,8 +35,10 @@
 #include "CBroker.hpp"
 #include "CConnectionManager.hpp"
 #include "CDispatcher.hpp"
+#include "CEventLog.hpp"
 #include "CListener.hpp"
 #include "CLogger.hpp"
+#include "CLogWriter.hpp"
 #include "CGlobalConfiguration.hpp"
 #include "CGlobalPeerList.hpp"
 
@@ -45,9 +47,12 @@
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/thread/thread.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <map>
+#include <sstream>
 
 /// General FREEDM Namespace
 namespace freedm {
@@ -74,12 +79,20 @@ CBroker& CBroker::Instance()
 /// Private constructor for the singleton Broker instance
 ///////////////////////////////////////////////////////////////////////////////
 CBroker::CBroker()
-    : m_phasetimer(m_ioService)
+    : m_netstrand(m_ioService)
+    , m_threads(1)
+    , m_busy(false)
+    , m_phasetasks(0)
+    , m_roundlength(0)
+    , m_reloadphases(false)
+    , m_phase(0)
+    , m_phasecount(0)
+    , m_phasetimer(m_ioService)
     , m_synchronizer()
-    , m_signals(m_ioService, SIGINT, SIGTERM)
+    , m_signals(m_ioService, SIGINT, SIGTERM, SIGHUP)
     , m_stopping(false)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     m_synchronizer = boost::make_shared<CClockSynchronizer>(boost::ref(m_ioService));
 }
@@ -94,9 +107,9 @@ CBroker::CBroker()
 ///////////////////////////////////////////////////////////////////////////////
 CBroker::~CBroker()
 {
-    for(TimersMap::iterator it=m_timers.begin(); it!=m_timers.end(); it++)
+    for(TimerTable::iterator it=m_timers.begin(); it!=m_timers.end(); it++)
     {
-        delete it->second;
+        delete it->timer;
     }
 }
 
@@ -108,10 +121,13 @@ CBroker::~CBroker()
 ///       it doesn't exit immediately).
 /// @post The ioservice has stopped.
 /// @ErrorHandling Could raise arbitrary exceptions from anywhere in the DGI.
+/// @limitations When more than one broker thread is configured, the extra
+///     threads only service network handlers and timers concurrently with
+///     the modules; module tasks are still run one at a time.
 ///////////////////////////////////////////////////////////////////////////////
 void CBroker::Run()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     // Open the acceptor with the option to reuse the address (i.e. SO_REUSEADDR).
     boost::asio::ip::udp::resolver resolver(m_ioService);
@@ -136,11 +152,49 @@ void CBroker::Run()
     CDispatcher::Instance().RegisterReadHandler(m_synchronizer, "clk");
     m_synchronizer->Run();
 
+    m_threads = CGlobalConfiguration::Instance().GetBrokerThreads();
+    if(m_threads == 0)
+    {
+        m_threads = 1;
+    }
+    FREEDM_LOG_STATUS(Logger) << "Running the broker on " << m_threads << " thread(s)"
+                  << std::endl;
+
     // The io_service::run() call will block until all asynchronous operations
     // have finished. While the server is running, there is always at least one
     // asynchronous operation outstanding: the asynchronous accept call waiting
     // for new incoming connections.
+    boost::thread_group pool;
+    for(unsigned int i = 1; i < m_threads; i++)
+    {
+        pool.create_thread(boost::bind(&CBroker::RunThread, this));
+    }
     m_ioService.run();
+    pool.join_all();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::RunThread
+/// @description Runs the ioservice on one of the additional broker threads.
+/// @pre Called from a thread started by CBroker::Run.
+/// @post The ioservice has stopped.
+/// @ErrorHandling An exception that escapes a handler is logged and the
+///     broker is asked to stop, the same as an exception in the main thread.
+///////////////////////////////////////////////////////////////////////////////
+void CBroker::RunThread()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    try
+    {
+        m_ioService.run();
+    }
+    catch (std::exception & e)
+    {
+        FREEDM_LOG_FATAL(Logger) << "Exception caught in broker thread: " << e.what()
+                     << std::endl;
+        Stop();
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -150,10 +204,35 @@ void CBroker::Run()
 ///////////////////////////////////////////////////////////////////////////////
 boost::asio::io_service& CBroker::GetIOService()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     return m_ioService;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::GetNetworkStrand
+/// @description Returns the strand used for the listener, the protocol
+///     timers, the clock synchronizer and the phase timer. Handlers wrapped
+///     by this strand never run concurrently with each other, so the
+///     connection state needs no further locking.
+/// @return The strand which serializes the network handlers.
+///////////////////////////////////////////////////////////////////////////////
+boost::asio::io_service::strand& CBroker::GetNetworkStrand()
+{
+    return m_netstrand;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::IsMultithreaded
+/// @description Checks if the ioservice is being run by a thread pool. In that
+///     case module tasks run on their own strands and must hand network
+///     operations to the network strand.
+/// @return true if the broker runs on more than one thread.
+///////////////////////////////////////////////////////////////////////////////
+bool CBroker::IsMultithreaded() const
+{
+    return m_threads > 1;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// @fn CBroker::Stop
 /// @description  Registers a stop command into the io_service's job queue.
@@ -166,7 +245,7 @@ boost::asio::io_service& CBroker::GetIOService()
 ///////////////////////////////////////////////////////////////////////////////
 void CBroker::Stop(unsigned int signum)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     // FIXME add code here to stop lb, gm, and sc
     // (IAgent should get a virtual Stop function)
@@ -177,14 +256,16 @@ void CBroker::Stop(unsigned int signum)
     }
 
     /* Run agents' previously-posted handlers before shutting down. */
-    m_ioService.post(boost::bind(&CBroker::HandleStop, this, signum));
+    m_netstrand.post(boost::bind(&CBroker::HandleStop, this, signum));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 /// @fn CBroker::HandleSignal
-/// @description Handle signals that terminate the program.
+/// @description Handle signals that terminate the program, and SIGHUP, which
+///     reloads the configuration.
 /// @pre None
-/// @post The broker is scheduled to be stopped.
+/// @post The broker is scheduled to be stopped, or on SIGHUP the reload is
+///     scheduled and the broker waits for the next signal.
 ///////////////////////////////////////////////////////////////////////////////
 void CBroker::HandleSignal(const boost::system::error_code& error, int signum)
 {
@@ -194,7 +275,12 @@ void CBroker::HandleSignal(const boost::system::error_code& error, int signum)
     //
     // E.g. our logger is synchronized, so using it here could cause deadlock.
     // An unsynchronized iostream could be corrupted, so don't do that either.
-    if(!error)
+    if(!error && signum == SIGHUP)
+    {
+        m_netstrand.post(boost::bind(&CBroker::HandleReload, this));
+        m_signals.async_wait(boost::bind(&CBroker::HandleSignal, this, _1, _2));
+    }
+    else if(!error)
     {
         // If we get a signal twice, use the default handler to stop right away.
         m_signals.remove(signum);
@@ -215,11 +301,11 @@ void CBroker::HandleSignal(const boost::system::error_code& error, int signum)
 ///////////////////////////////////////////////////////////////////////////////
 void CBroker::HandleStop(unsigned int signum)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if (signum > 0)
     {
-        Logger.Fatal<<"Caught signal "<<signum<<". Shutting Down..."<<std::endl;
+        FREEDM_LOG_FATAL(Logger)<<"Caught signal "<<signum<<". Shutting Down..."<<std::endl;
         // If we get another signal at this point, really stop right away
         m_signals.clear();
     }
@@ -238,10 +324,61 @@ void CBroker::HandleStop(unsigned int signum)
 
     if (signum > 0)
     {
+        // The signal ends the process, so write out the buffered log first.
+        CLogWriter::instance().Stop();
+        CEventLog::Instance().Close();
         raise(signum);
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::SetReloadHandler
+/// @description Sets the task that rereads the configuration files when the
+///     DGI receives SIGHUP.
+/// @pre None
+/// @post The handler is called on each SIGHUP.
+/// @param h the task that reloads the configuration. A file that cannot be
+///     loaded should keep its old settings and be reported by the handler.
+///////////////////////////////////////////////////////////////////////////////
+void CBroker::SetReloadHandler(ReloadHandler h)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    m_reloadhandler = h;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::HandleReload
+/// @description Runs the reload handler, then marks the phase durations to be
+///     reread. They are applied at the start of the next round rather than
+///     mid-round, so no phase is cut short or stretched by the change.
+/// @pre Called on the network strand, after SIGHUP.
+/// @post The configuration is reloaded, or an error is logged and the old
+///     settings are kept. Either way the phase table is rebuilt from the
+///     current timings at the start of the next round.
+///////////////////////////////////////////////////////////////////////////////
+void CBroker::HandleReload()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    if(!m_reloadhandler)
+    {
+        FREEDM_LOG_WARN(Logger)<<"Caught SIGHUP, but there is nothing to reload"<<std::endl;
+        return;
+    }
+
+    try
+    {
+        m_reloadhandler();
+    }
+    catch(std::exception & e)
+    {
+        FREEDM_LOG_ERROR(Logger)<<"Failed to reload the configuration: "<<e.what()<<std::endl;
+    }
+
+    boost::mutex::scoped_lock schlock(m_schmutex);
+    m_reloadphases = true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// @fn CBroker::RegisterModule
 /// @description Places the module in to the list of schedulable phases. The
@@ -255,12 +392,18 @@ void CBroker::HandleStop(unsigned int signum)
 ///////////////////////////////////////////////////////////////////////////////
 void CBroker::RegisterModule(CBroker::ModuleIdent m, boost::posix_time::time_duration phase)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     boost::mutex::scoped_lock schlock(m_schmutex);
     boost::system::error_code err;
     if(!IsModuleRegistered(m))
     {
-        m_modules.push_back(PhaseTuple(m,phase));
+        SPhase p;
+        p.module = InternModule(m);
+        p.duration = phase;
+        p.timing = CTimings::TIMING_PARAMETER_COUNT;
+        m_moduletable[p.module].scheduled = true;
+        m_modules.push_back(p);
+        RebuildPhaseTable();
         if(m_modules.size() == 1)
         {
             schlock.unlock();
@@ -270,6 +413,32 @@ void CBroker::RegisterModule(CBroker::ModuleIdent m, boost::posix_time::time_dur
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::RegisterModule
+/// @description Places the module in to the list of schedulable phases, with
+///   a duration read from the timings. When the timings are reloaded, the
+///   phase takes the new duration at the start of the next round.
+/// @pre The timings have been loaded.
+/// @post The module is registered with a phase duration specified by the
+///   timing parameter.
+/// @param m the identifier for the module.
+/// @param phase the timing parameter for the duration of the phase.
+///////////////////////////////////////////////////////////////////////////////
+void CBroker::RegisterModule(CBroker::ModuleIdent m, CTimings::TimingParameter phase)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    RegisterModule(m, CTimings::GetDuration(phase));
+
+    boost::mutex::scoped_lock schlock(m_schmutex);
+    BOOST_FOREACH(SPhase & p, m_modules)
+    {
+        if(m_moduletable[p.module].ident == m)
+        {
+            p.timing = phase;
+        }
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// @fn CBroker::IsModuleRegistered
 /// @description Checks to see if a module is registered with the scheduler.
@@ -280,16 +449,139 @@ void CBroker::RegisterModule(CBroker::ModuleIdent m, boost::posix_time::time_dur
 ///////////////////////////////////////////////////////////////////////////////
 bool CBroker::IsModuleRegistered(ModuleIdent m)
 {
-    bool exists = false;
-    for(unsigned int i=0; i < m_modules.size(); i++)
+    ModuleIndexMap::const_iterator it = m_moduleindex.find(m);
+    return it != m_moduleindex.end() && m_moduletable[it->second].scheduled;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::IsModuleRegistered
+/// @description Checks to see if a module is registered with the scheduler.
+///     Identical to the ModuleIdent overload, without the lookup of the
+///     module's identifier.
+/// @pre m was returned by GetModuleIndex.
+/// @post None
+/// @param m the index of the module.
+/// @return true if the module is registered with the broker.
+///////////////////////////////////////////////////////////////////////////////
+bool CBroker::IsModuleRegistered(ModuleIndex m)
+{
+    boost::mutex::scoped_lock schlock(m_schmutex);
+    return m < m_moduletable.size() && m_moduletable[m].scheduled;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::GetModuleIndex
+/// @description Returns the index the scheduler uses for a module. Callers
+///     that schedule many tasks for the same module can keep the index and
+///     use the ModuleIndex overload of Schedule to skip the lookup.
+/// @pre None
+/// @post If the module was not known, it is added to the module table.
+/// @param m the identifier for the module.
+/// @return The index of the module in the scheduler's tables.
+///////////////////////////////////////////////////////////////////////////////
+CBroker::ModuleIndex CBroker::GetModuleIndex(ModuleIdent m)
+{
+    boost::mutex::scoped_lock schlock(m_schmutex);
+    return InternModule(m);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::InternModule
+/// @description Looks up the index of a module, adding a new entry to the
+///     module table the first time an identifier is seen. Modules can allocate
+///     timers before they register a phase, so this is not tied to
+///     RegisterModule.
+/// @pre m_schmutex is held by the caller.
+/// @post The module has an entry in the module table.
+/// @param m the identifier for the module.
+/// @return The index of the module in the scheduler's tables.
+///////////////////////////////////////////////////////////////////////////////
+CBroker::ModuleIndex CBroker::InternModule(const ModuleIdent& m)
+{
+    ModuleIndexMap::iterator it = m_moduleindex.find(m);
+    if(it != m_moduleindex.end())
     {
-        if(m_modules[i].first == m)
-        {
-            exists = true;
-            break;
-        }
+        return it->second;
+    }
+    ModuleIndex index = m_moduletable.size();
+    m_moduletable.push_back(SModule());
+    m_moduletable[index].ident = m;
+    m_moduletable[index].scheduled = false;
+    m_moduletable[index].strand =
+        boost::make_shared<boost::asio::io_service::strand>(boost::ref(m_ioService));
+    m_moduletable[index].jitter.assign(PHASE_JITTER_BUCKETS, 0);
+    m_moduletable[index].cost = InternCostClass(m + "/default");
+    m_moduletable[index].executed = 0;
+    m_moduletable[index].deferred = 0;
+    m_moduleindex.insert(ModuleIndexMap::value_type(m, index));
+    return index;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::GetCostClass
+/// @description Returns the cost class for a named kind of task run by a
+///     module. The broker learns how long tasks of each class take and uses
+///     the estimate to avoid starting a task that would overrun the phase.
+/// @pre None
+/// @post If the class was not known, it is added to the cost table.
+/// @param m the identifier for the module that runs the tasks.
+/// @param name the name of the kind of task, unique within the module.
+/// @return The cost class to pass to Schedule.
+///////////////////////////////////////////////////////////////////////////////
+CBroker::CostClass CBroker::GetCostClass(ModuleIdent m, std::string name)
+{
+    boost::mutex::scoped_lock schlock(m_schmutex);
+    return InternCostClass(m + "/" + name);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::InternCostClass
+/// @description Looks up a cost class by its key, adding an unlearned entry
+///     to the cost table the first time the key is seen.
+/// @pre m_schmutex is held by the caller.
+/// @post The key has an entry in the cost table.
+/// @param key the module-qualified name of the class.
+/// @return The index of the class in the cost table.
+///////////////////////////////////////////////////////////////////////////////
+CBroker::CostClass CBroker::InternCostClass(const std::string& key)
+{
+    CostIndexMap::iterator it = m_costindex.find(key);
+    if(it != m_costindex.end())
+    {
+        return it->second;
     }
-    return exists;
+    CostClass index = m_costs.size();
+    SCostEstimate cost;
+    cost.estimate = 0;
+    cost.learned = false;
+    m_costs.push_back(cost);
+    m_costindex.insert(CostIndexMap::value_type(key, index));
+    return index;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::Enqueue
+/// @description Appends a task to a module's ready queue. The queue is a ring
+///     buffer that only grows when it is full, so once it has reached its
+///     working size enqueueing does not allocate.
+/// @pre m_schmutex is held by the caller.
+/// @post The task is at the back of the module's ready queue.
+/// @param m the index of the module.
+/// @param x the task to append.
+/// @param c the cost class of the task.
+///////////////////////////////////////////////////////////////////////////////
+void CBroker::Enqueue(ModuleIndex m, const BoundScheduleable& x, CostClass c)
+{
+    ReadyQueue& queue = m_moduletable[m].ready;
+    if(queue.full())
+    {
+        queue.set_capacity(queue.capacity() > 0 ? 2 * queue.capacity() : 16);
+    }
+    SReadyTask task;
+    task.task = x;
+    task.cost = c;
+    task.deferred = false;
+    queue.push_back(task);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -303,17 +595,19 @@ bool CBroker::IsModuleRegistered(ModuleIdent m)
 ///////////////////////////////////////////////////////////////////////////////
 CBroker::TimerHandle CBroker::AllocateTimer(CBroker::ModuleIdent module)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     boost::mutex::scoped_lock schlock(m_schmutex);
-    CBroker::TimerHandle myhandle;
-    boost::asio::deadline_timer* t = new boost::asio::deadline_timer(m_ioService);
-    myhandle = m_handlercounter;
-    m_handlercounter++;
-    m_allocs.insert(CBroker::TimerAlloc::value_type(myhandle,module));
-    m_timers.insert(CBroker::TimersMap::value_type(myhandle,t));
-    m_nexttime.insert(CBroker::NextTimeMap::value_type(myhandle,false));
-    m_ntexpired.insert(CBroker::NextTimeMap::value_type(myhandle,false));
+    CBroker::TimerHandle myhandle = m_timers.size();
+    STimerSlot slot;
+    slot.module = InternModule(module);
+    slot.timer = new boost::asio::deadline_timer(m_ioService);
+    slot.nexttime = false;
+    slot.ntexpired = false;
+    slot.cost = InternCostClass(module + "/timer" +
+        boost::lexical_cast<std::string>(myhandle));
+    m_timers.push_back(slot);
+    m_moduletable[slot.module].timers.push_back(myhandle);
     return myhandle;
 }
 
@@ -341,7 +635,7 @@ CBroker::TimerHandle CBroker::AllocateTimer(CBroker::ModuleIdent module)
 int CBroker::Schedule(CBroker::TimerHandle h,
     boost::posix_time::time_duration wait, CBroker::Scheduleable x)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     {
         boost::unique_lock<boost::mutex> lock(m_stoppingMutex);
         if (m_stopping)
@@ -352,19 +646,20 @@ int CBroker::Schedule(CBroker::TimerHandle h,
 
     boost::mutex::scoped_lock schlock(m_schmutex);
     CBroker::Scheduleable s;
+    STimerSlot& slot = m_timers[h];
     if(wait.is_not_a_date_time())
     {
         wait = boost::posix_time::time_duration(boost::posix_time::pos_infin);
-        m_nexttime[h] = true;
+        slot.nexttime = true;
     }
     else
     {
-        m_nexttime[h] = false;
+        slot.nexttime = false;
     }
-    m_timers[h]->expires_from_now(wait);
+    slot.timer->expires_from_now(wait);
     s = boost::bind(&CBroker::ScheduledTask,this,x,h,boost::asio::placeholders::error);
-    Logger.Debug<<"Scheduled task for timer "<<h<<std::endl;
-    m_timers[h]->async_wait(s);
+    FREEDM_LOG_DEBUG(Logger)<<"Scheduled task for timer "<<h<<std::endl;
+    slot.timer->async_wait(s);
 
     return 0;
 }
@@ -388,7 +683,56 @@ int CBroker::Schedule(CBroker::TimerHandle h,
 ///////////////////////////////////////////////////////////////////////////////
 int CBroker::Schedule(ModuleIdent m, BoundScheduleable x, bool start_worker)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    return Schedule(GetModuleIndex(m), x, start_worker);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::Schedule
+/// @description Given a module index and a task, put that task into that
+///		module's job queue. Identical to the ModuleIdent overload, without the
+///		lookup of the module's identifier.
+/// @pre m was returned by GetModuleIndex.
+/// @post The task is placed in the work queue for the module m. If the
+///     start_worker parameter is set to true, the module's worker will be
+///     activated if it isn't already.
+/// @param m The index of the module the schedulable should be run as.
+/// @param x The method that will be run. A functor that expects no parameters
+///		and returns void. Created via boost::bind()
+/// @param start_worker tells the worker to begin processing again, if it is
+///     currently idle.
+/// @return 0 on success, -1 if rejected because the Broker is stopping.
+///////////////////////////////////////////////////////////////////////////////
+int CBroker::Schedule(ModuleIndex m, BoundScheduleable x, bool start_worker)
+{
+    CostClass c;
+    {
+        boost::mutex::scoped_lock schlock(m_schmutex);
+        c = m_moduletable[m].cost;
+    }
+    return Schedule(m, c, x, start_worker);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::Schedule
+/// @description Given a module index, a cost class and a task, put that task
+///		into that module's job queue. The runtime of the task is estimated
+///		from earlier tasks of the same class; the worker will not start the
+///		task late in a phase if the estimate says it would overrun it.
+/// @pre m was returned by GetModuleIndex and c by GetCostClass.
+/// @post The task is placed in the work queue for the module m. If the
+///     start_worker parameter is set to true, the module's worker will be
+///     activated if it isn't already.
+/// @param m The index of the module the schedulable should be run as.
+/// @param c The cost class the task belongs to.
+/// @param x The method that will be run. A functor that expects no parameters
+///		and returns void. Created via boost::bind()
+/// @param start_worker tells the worker to begin processing again, if it is
+///     currently idle.
+/// @return 0 on success, -1 if rejected because the Broker is stopping.
+///////////////////////////////////////////////////////////////////////////////
+int CBroker::Schedule(ModuleIndex m, CostClass c, BoundScheduleable x, bool start_worker)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     {
         boost::unique_lock<boost::mutex> lock(m_stoppingMutex);
         if (m_stopping)
@@ -398,15 +742,18 @@ int CBroker::Schedule(ModuleIdent m, BoundScheduleable x, bool start_worker)
     }
 
     boost::mutex::scoped_lock schlock(m_schmutex);
-    m_ready[m].push_back(x);
+    Enqueue(m, x, c);
     if(!m_busy && start_worker)
     {
+        // Claim the worker while locked so only one caller can start it.
+        m_busy = true;
         schlock.unlock();
         Worker();
         schlock.lock();
     }
-    Logger.Debug<<"Module "<<m<<" now has queue size: "<<m_ready[m].size()<<std::endl;
-    Logger.Debug<<"Scheduled task (NODELAY) for "<<m<<std::endl;
+    FREEDM_LOG_DEBUG(Logger)<<"Module "<<m_moduletable[m].ident<<" now has queue size: "
+                <<m_moduletable[m].ready.size()<<std::endl;
+    FREEDM_LOG_DEBUG(Logger)<<"Scheduled task (NODELAY) for "<<m_moduletable[m].ident<<std::endl;
     return 0;
 }
 
@@ -422,7 +769,7 @@ int CBroker::Schedule(ModuleIdent m, BoundScheduleable x, bool start_worker)
 ///////////////////////////////////////////////////////////////////////////////
 void CBroker::ChangePhase(const boost::system::error_code & /*err*/)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     if(m_modules.size() == 0)
     {
         m_phase=0;
@@ -432,47 +779,39 @@ void CBroker::ChangePhase(const boost::system::error_code & /*err*/)
     // Past this point assume there is at least one module.
     boost::mutex::scoped_lock schlock(m_schmutex);
     m_phase++;
+    m_phasecount.fetch_add(1, boost::memory_order_relaxed);
     // Get the time without millisec and with millisec then see how many millsec we
     // are into this second.
     // Generate a clock beacon
     boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
-    boost::posix_time::time_duration time = now.time_of_day();
-    time += CGlobalConfiguration::Instance().GetClockSkew();
+    boost::posix_time::time_duration skew = CGlobalConfiguration::Instance().GetClockSkew();
+    boost::posix_time::time_duration time = now.time_of_day() + skew;
 
     if(m_phase >= m_modules.size())
     {
         m_phase = 0;
     }
-    unsigned int round = 0;
-    for(unsigned int i=0; i < m_modules.size(); i++)
+    // Switch to reloaded phase durations between rounds.
+    if(m_phase == 0 && m_reloadphases)
     {
-        round += m_modules[i].second.total_milliseconds();
+        ReloadPhaseTable();
     }
-    assert(round > 0);
+    assert(m_roundlength > 0);
     unsigned int millisecs = time.total_milliseconds();
-    unsigned int intoround = (millisecs % round);
-    unsigned int cphase = 0;
-    unsigned int tmp = m_modules[0].second.total_milliseconds();
-    // Pre: Assume it should be the first phase.
-    // Step: Consider how long the phase would be if it ran in its entirety. If
-    //  completing that phase would go beyod the amount of time in the
-    //  round so far (considering all the time that would be used by other phases up
-    //  to that point) then that phase is the current one.
-    // Post: CPhase should be the current phase and tmp should be
-    while(cphase < m_modules.size() && tmp < intoround)
-    {
-        cphase++;
-        tmp += m_modules[cphase].second.total_milliseconds();
-    }
-    unsigned int remaining = tmp-intoround;
-    unsigned int sched_duration = m_modules[m_phase].second.total_milliseconds();
+    unsigned int intoround = (millisecs % m_roundlength);
+    // The current phase is the first one which ends at or after the time we
+    // are into the round.
+    unsigned int cphase = std::lower_bound(m_phaseoffsets.begin(),
+        m_phaseoffsets.end(), intoround) - m_phaseoffsets.begin();
+    unsigned int remaining = m_phaseoffsets[cphase]-intoround;
+    unsigned int sched_duration = m_modules[m_phase].duration.total_milliseconds();
     // How we want to do this is that every so of tone we want to figure out
     // what phase it should be and then schedule that phase?
     // As an aside, you could tune alignment duration down to 0 so that every
     // phase is specifically assigned to a time slice.
     if(now-m_last_alignment > boost::posix_time::milliseconds(ALIGNMENT_DURATION))
     {
-        Logger.Notice<<"Aligned phase to "<<cphase<<" (was "<<m_phase<<") for "
+        FREEDM_LOG_NOTICE(Logger)<<"Aligned phase to "<<cphase<<" (was "<<m_phase<<") for "
                    <<remaining<<" ms"<<std::endl;
 
 
@@ -482,40 +821,60 @@ void CBroker::ChangePhase(const boost::system::error_code & /*err*/)
     }
     if(m_modules.size() > 0)
     {
-        Logger.Notice<<"Phase: "<<m_modules[m_phase].first<<" for "<<sched_duration<<"ms "<<"offset "<<CGlobalConfiguration::Instance().GetClockSkew()<<std::endl;
+        FREEDM_LOG_NOTICE(Logger)<<"Phase: "<<m_moduletable[m_modules[m_phase].module].ident<<" for "<<sched_duration<<"ms "<<"offset "<<skew<<std::endl;
     }
     if(m_phase != oldphase)
     {
+        // How far into the round the phase should have started.
+        unsigned int start = m_phaseoffsets[m_phase] -
+            m_modules[m_phase].duration.total_milliseconds();
+        unsigned int late = (intoround + m_roundlength - start) % m_roundlength;
+        // A phase that starts early shows up as nearly a whole round late.
+        if(late > m_roundlength / 2)
+        {
+            late = 0;
+        }
+        RecordPhaseJitter(m_modules[m_phase].module, late);
+        CEventLog::Instance().PhaseChange(m_moduletable[m_modules[m_phase].module].ident,
+            m_phasecount.load(boost::memory_order_relaxed), late, sched_duration);
+        if(m_phase == 0)
+        {
+            LogRoundStatistics();
+            CDispatcher::Instance().LogQueueStatistics();
+        }
         CConnectionManager::Instance().ChangePhase((m_phase==0));
-        ModuleIdent oldident = m_modules[oldphase].first;
-        Logger.Notice<<"Changed Phase: expiring next time timers for "<<oldident<<std::endl;
+        SModule& oldmodule = m_moduletable[m_modules[oldphase].module];
+        FREEDM_LOG_NOTICE(Logger)<<"Changed Phase: expiring next time timers for "<<oldmodule.ident<<std::endl;
         // Look through the timers for the module and see if any of them are
         // set for next time:
-        BOOST_FOREACH(CBroker::TimerAlloc::value_type t, m_allocs)
+        BOOST_FOREACH(TimerHandle t, oldmodule.timers)
         {
-            Logger.Debug<<"Examine timer "<<t.first<<" for module "<<t.second<<" expire nexttime: "
-                        <<m_nexttime[t.first]<<std::endl;
-            if(t.second == oldident && m_nexttime[t.first] == true)
+            STimerSlot& slot = m_timers[t];
+            FREEDM_LOG_DEBUG(Logger)<<"Examine timer "<<t<<" for module "<<oldmodule.ident<<" expire nexttime: "
+                        <<slot.nexttime<<std::endl;
+            if(slot.nexttime == true)
             {
-                Logger.Notice<<"Scheduling task for next time timer: "<<t.first<<std::endl;
-                m_timers[t.first]->cancel();
-                m_nexttime[t.first] = false;
-                m_ntexpired[t.first] = true;
+                FREEDM_LOG_NOTICE(Logger)<<"Scheduling task for next time timer: "<<t<<std::endl;
+                slot.timer->cancel();
+                slot.nexttime = false;
+                slot.ntexpired = true;
             }
         }
     }
     //If the worker isn't going, start him again when you change phases.
     boost::posix_time::time_duration r = boost::posix_time::milliseconds(sched_duration);
     m_phaseends = now + r;
+    m_phasetasks = 0;
     if(!m_busy)
     {
+        m_busy = true;
         schlock.unlock();
         Worker();
         schlock.lock();
     }
     m_phasetimer.expires_from_now(r);
-    m_phasetimer.async_wait(boost::bind(&CBroker::ChangePhase,this,
-        boost::asio::placeholders::error));
+    m_phasetimer.async_wait(m_netstrand.wrap(boost::bind(&CBroker::ChangePhase,
+        this, boost::asio::placeholders::error)));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -532,9 +891,188 @@ void CBroker::ChangePhase(const boost::system::error_code & /*err*/)
 ///////////////////////////////////////////////////////////////////////////////
 boost::posix_time::time_duration CBroker::TimeRemaining()
 {
+    boost::mutex::scoped_lock schlock(m_schmutex);
     return m_phaseends - boost::posix_time::microsec_clock::universal_time();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::GetPhaseCount
+/// @description Returns the number of phases which have started since the
+///     broker began to run. Modules use it to tell when a phase has ended.
+///     The count is atomic so the module tasks which build messages do not
+///     wait on the scheduler lock.
+/// @pre None
+/// @post None
+/// @return The number of phase changes.
+///////////////////////////////////////////////////////////////////////////////
+unsigned long CBroker::GetPhaseCount()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    return m_phasecount.load(boost::memory_order_relaxed);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::GetPhaseJitter
+/// @description Returns how late the phases of a module have started, as a
+///     histogram. Bucket i counts the phase starts which were less than
+///     PHASE_JITTER_BOUNDS[i] milliseconds late (and no less than the bound of
+///     the previous bucket); the last bucket counts everything later.
+/// @pre None
+/// @post None
+/// @param m the identifier for the module.
+/// @return The histogram, or an empty vector if the module is not known.
+///////////////////////////////////////////////////////////////////////////////
+std::vector<unsigned int> CBroker::GetPhaseJitter(ModuleIdent m)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    boost::mutex::scoped_lock schlock(m_schmutex);
+    ModuleIndexMap::const_iterator it = m_moduleindex.find(m);
+    if(it == m_moduleindex.end())
+    {
+        return std::vector<unsigned int>();
+    }
+    return m_moduletable[it->second].jitter;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::RebuildPhaseTable
+/// @description Computes the round length and the offset into the round at
+///     which each phase ends, so ChangePhase does not need to walk the module
+///     list to align the schedule.
+/// @pre m_schmutex is held by the caller.
+/// @post m_phaseoffsets and m_roundlength match m_modules.
+///////////////////////////////////////////////////////////////////////////////
+void CBroker::RebuildPhaseTable()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    m_roundlength = 0;
+    m_phaseoffsets.clear();
+    for(unsigned int i=0; i < m_modules.size(); i++)
+    {
+        m_roundlength += m_modules[i].duration.total_milliseconds();
+        m_phaseoffsets.push_back(m_roundlength);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::ReloadPhaseTable
+/// @description Rereads the duration of each phase registered with a timing
+///     parameter and rebuilds the phase table. The round is aligned to the
+///     synchronized clock, so once every DGI has reloaded the same timings
+///     their rounds line up again; reload them all within one round to keep
+///     the switch clean.
+/// @pre m_schmutex is held by the caller, and a round is about to start.
+/// @post The phases have the durations of the current timings. A timing
+///     that would make the round empty is ignored.
+///////////////////////////////////////////////////////////////////////////////
+void CBroker::ReloadPhaseTable()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    ModuleVector modules = m_modules;
+    unsigned int roundlength = 0;
+
+    m_reloadphases = false;
+    BOOST_FOREACH(SPhase & p, modules)
+    {
+        if(p.timing != CTimings::TIMING_PARAMETER_COUNT)
+        {
+            p.duration = CTimings::GetDuration(p.timing);
+        }
+        roundlength += p.duration.total_milliseconds();
+    }
+    if(roundlength == 0)
+    {
+        FREEDM_LOG_ERROR(Logger)<<"Reloaded phase times sum to 0 ms, keeping the old phases"<<std::endl;
+        return;
+    }
+
+    for(unsigned int i=0; i < modules.size(); i++)
+    {
+        if(modules[i].duration != m_modules[i].duration)
+        {
+            FREEDM_LOG_STATUS(Logger)<<"Phase "<<m_moduletable[modules[i].module].ident
+                <<" changed from "<<m_modules[i].duration.total_milliseconds()<<" ms to "
+                <<modules[i].duration.total_milliseconds()<<" ms"<<std::endl;
+        }
+    }
+    m_modules.swap(modules);
+    RebuildPhaseTable();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::RecordPhaseJitter
+/// @description Adds the start of a phase to the owning module's jitter
+///     histogram.
+/// @pre m_schmutex is held by the caller.
+/// @post The bucket for the lateness is incremented.
+/// @param m the index of the module whose phase started.
+/// @param late how many milliseconds late the phase started.
+///////////////////////////////////////////////////////////////////////////////
+void CBroker::RecordPhaseJitter(ModuleIndex m, unsigned int late)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    const unsigned int * bucket = std::upper_bound(PHASE_JITTER_BOUNDS,
+        PHASE_JITTER_BOUNDS + PHASE_JITTER_BUCKETS - 1, late);
+    m_moduletable[m].jitter[bucket - PHASE_JITTER_BOUNDS]++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::GetTaskCounts
+/// @description Returns how many of a module's tasks the worker has run, and
+///     how many times a task was held back to a later phase because its
+///     estimated runtime exceeded the time left in the phase.
+/// @pre None
+/// @post None
+/// @param m the identifier for the module.
+/// @param executed set to the number of tasks run for the module.
+/// @param deferred set to the number of tasks deferred for the module.
+///////////////////////////////////////////////////////////////////////////////
+void CBroker::GetTaskCounts(ModuleIdent m, unsigned long& executed, unsigned long& deferred)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    boost::mutex::scoped_lock schlock(m_schmutex);
+    executed = 0;
+    deferred = 0;
+    ModuleIndexMap::const_iterator it = m_moduleindex.find(m);
+    if(it != m_moduleindex.end())
+    {
+        executed = m_moduletable[it->second].executed;
+        deferred = m_moduletable[it->second].deferred;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::LogRoundStatistics
+/// @description Writes the jitter histogram and the executed and deferred
+///     task counts of each scheduled module to the log.
+/// @pre m_schmutex is held by the caller.
+/// @post None
+///////////////////////////////////////////////////////////////////////////////
+void CBroker::LogRoundStatistics()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    BOOST_FOREACH(const SPhase & p, m_modules)
+    {
+        const SModule & module = m_moduletable[p.module];
+        std::stringstream ss;
+        for(unsigned int i=0; i < PHASE_JITTER_BUCKETS; i++)
+        {
+            if(i < PHASE_JITTER_BUCKETS - 1)
+            {
+                ss<<" <"<<PHASE_JITTER_BOUNDS[i]<<"ms:"<<module.jitter[i];
+            }
+            else
+            {
+                ss<<" >="<<PHASE_JITTER_BOUNDS[i-1]<<"ms:"<<module.jitter[i];
+            }
+        }
+        FREEDM_LOG_INFO(Logger)<<"Phase jitter for "<<module.ident<<ss.str()<<std::endl;
+        FREEDM_LOG_INFO(Logger)<<"Tasks for "<<module.ident<<": executed "<<module.executed
+                   <<" deferred "<<module.deferred<<std::endl;
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// @fn CBroker::ScheduledTask
 /// @description When a timer for a task expires, this function is called to
@@ -545,26 +1083,29 @@ boost::posix_time::time_duration CBroker::TimeRemaining()
 void CBroker::ScheduledTask(CBroker::Scheduleable x, CBroker::TimerHandle handle,
     const boost::system::error_code &err)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     boost::mutex::scoped_lock schlock(m_schmutex);
-    ModuleIdent module = m_allocs[handle];
+    STimerSlot& slot = m_timers[handle];
+    const ModuleIdent& module = m_moduletable[slot.module].ident;
     boost::system::error_code serr;
-    if(m_ntexpired[handle])
+    if(slot.ntexpired)
     {
-        m_ntexpired[handle] = false;
+        slot.ntexpired = false;
     }
     else
     {
         serr = err;
     }
-    Logger.Debug<<"Handle finished: "<<handle<<" For module "<<module<<std::endl;
+    FREEDM_LOG_DEBUG(Logger)<<"Handle finished: "<<handle<<" For module "<<module<<std::endl;
     // First, prepare another bind, which uses the given error
     CBroker::BoundScheduleable y = boost::bind(x,serr);
     // Put it into the ready queue
-    m_ready[module].push_back(y);
-    Logger.Debug<<"Module "<<module<<" now has queue size: "<<m_ready[module].size()<<std::endl;
+    Enqueue(slot.module, y, slot.cost);
+    FREEDM_LOG_DEBUG(Logger)<<"Module "<<module<<" now has queue size: "
+                <<m_moduletable[slot.module].ready.size()<<std::endl;
     if(!m_busy)
     {
+        m_busy = true;
         schlock.unlock();
         Worker();
     }
@@ -573,33 +1114,67 @@ void CBroker::ScheduledTask(CBroker::Scheduleable x, CBroker::TimerHandle handle
 ///////////////////////////////////////////////////////////////////////////////
 /// @fn CBroker::Worker
 /// @description The worker determines the active module and execute the first
-///		task in that module's queue, before rescheduling itself.
-/// @pre None
+///		task in that module's queue, before rescheduling itself. When the
+///		broker runs on a thread pool, the task is handed to the module's
+///		strand instead and the worker resumes once the task completes. A task
+///		whose learned runtime exceeds the time left in the phase stays at the
+///		head of the queue until the module's next phase, unless it would be
+///		the first task of the phase.
+/// @pre The caller has set m_busy to claim the worker.
 /// @post If there are tasks in the module's queue, the first task in the queue
 ///		will be run, and the work will schedule itself to run again through the
-///		ioservice. If there are no tasks in the queue, the worker will stop.
+///		ioservice. If there are no tasks in the queue, or the first task was
+///		deferred, the worker will stop.
 ///////////////////////////////////////////////////////////////////////////////
 void CBroker::Worker()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     boost::mutex::scoped_lock schlock(m_schmutex);
     if(m_phase >= m_modules.size())
     {
         m_busy = false;
         return;
     }
-    ModuleIdent active = m_modules[m_phase].first;
-    if(m_ready[active].size() > 0)
+    SModule& active = m_moduletable[m_modules[m_phase].module];
+    if(!active.ready.empty())
     {
-        Logger.Debug<<"Performing Job"<<std::endl;
+        SReadyTask& head = active.ready.front();
+        const SCostEstimate& cost = m_costs[head.cost];
+        boost::posix_time::time_duration remaining =
+            m_phaseends - boost::posix_time::microsec_clock::universal_time();
+        // Always run the first task of a phase so a task that is longer than
+        // the whole phase cannot starve the module.
+        if(m_phasetasks > 0 && cost.learned &&
+            boost::posix_time::microseconds(cost.estimate) > remaining)
+        {
+            FREEDM_LOG_DEBUG(Logger)<<"Deferring task for "<<active.ident<<": estimated "
+                        <<cost.estimate<<"us with "<<remaining<<" left"<<std::endl;
+            if(!head.deferred)
+            {
+                head.deferred = true;
+                active.deferred++;
+            }
+            m_busy = false;
+            return;
+        }
+        FREEDM_LOG_DEBUG(Logger)<<"Performing Job"<<std::endl;
         // Mark that the worker has something to do
         m_busy = true;
+        m_phasetasks++;
+        active.executed++;
         // Extract the first item from the work queue:
-        CBroker::BoundScheduleable x = m_ready[active].front();
-        m_ready[active].pop_front();
+        CBroker::BoundScheduleable x = head.task;
+        CostClass c = head.cost;
+        active.ready.pop_front();
+        if(IsMultithreaded())
+        {
+            // RunTask reschedules the worker when the task is complete.
+            active.strand->post(boost::bind(&CBroker::RunTask, this, x, c));
+            return;
+        }
         // Execute the task.
         schlock.unlock();
-        x();
+        ExecuteTask(x, c);
         schlock.lock();
     }
     else
@@ -611,6 +1186,54 @@ void CBroker::Worker()
     m_ioService.post(boost::bind(&CBroker::Worker, this));
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::RunTask
+/// @description Runs a module task on the module's strand when the broker is
+///     multithreaded. The network handlers keep running on the other threads
+///     while the task executes.
+/// @pre The worker has been claimed and x was removed from the ready queue.
+/// @post The task has been run and the worker is scheduled to run again.
+/// @param x The task to execute.
+/// @param c The cost class of the task.
+///////////////////////////////////////////////////////////////////////////////
+void CBroker::RunTask(BoundScheduleable x, CostClass c)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    ExecuteTask(x, c);
+    m_ioService.post(boost::bind(&CBroker::Worker, this));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @fn CBroker::ExecuteTask
+/// @description Runs a task and folds its runtime into the moving average
+///     kept for its cost class. The average weights the newest sample by 1/8.
+/// @pre m_schmutex is not held by the caller.
+/// @post The task has been run and the estimate for c is updated.
+/// @param x The task to execute.
+/// @param c The cost class of the task.
+///////////////////////////////////////////////////////////////////////////////
+void CBroker::ExecuteTask(const BoundScheduleable& x, CostClass c)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    x();
+    boost::posix_time::time_duration runtime =
+        boost::posix_time::microsec_clock::universal_time() - start;
+    unsigned int sample = runtime.is_negative() ? 0 : runtime.total_microseconds();
+
+    boost::mutex::scoped_lock schlock(m_schmutex);
+    SCostEstimate& cost = m_costs[c];
+    if(cost.learned)
+    {
+        cost.estimate = (7 * static_cast<unsigned long>(cost.estimate) + sample) / 8;
+    }
+    else
+    {
+        cost.estimate = sample;
+        cost.learned = true;
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// @fn CBroker::GetClockSynchronizer
 /// @description Returns a reference to the ClockSynchronizer object.
@@ -34,14 +34,19 @@
 #define FREEDM_BROKER_HPP
 
 #include "CClockSynchronizer.hpp"
+#include "CTimings.hpp"
 
-#include <list>
+#include <map>
 #include <string>
+#include <vector>
 
 #include <boost/asio.hpp>
 #include <boost/asio/deadline_timer.hpp>
+#include <boost/atomic.hpp>
+#include <boost/circular_buffer.hpp>
 #include <boost/function.hpp>
 #include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/thread/shared_mutex.hpp>
 
 namespace freedm {
@@ -53,21 +58,104 @@ class CDispatcher;
 /// How often the scheduler should verify the schedule is being followed
 const unsigned int ALIGNMENT_DURATION = 250;
 
+/// Number of buckets in the phase jitter histogram
+const unsigned int PHASE_JITTER_BUCKETS = 8;
+
+/// Upper bounds (ms, exclusive) of the phase jitter buckets; the last bucket is unbounded
+const unsigned int PHASE_JITTER_BOUNDS[PHASE_JITTER_BUCKETS-1] = { 1, 2, 5, 10, 25, 50, 100 };
+
 /// Scheduler for the DGI modules
 class CBroker : private boost::noncopyable
 {
 public:
     typedef boost::function<void (boost::system::error_code)> Scheduleable;
     typedef boost::function<void ()> BoundScheduleable;
+    typedef boost::function<void ()> ReloadHandler;
     typedef std::string ModuleIdent;
-    typedef std::pair<ModuleIdent, boost::posix_time::time_duration> PhaseTuple;
-    typedef std::vector< PhaseTuple > ModuleVector;
+    typedef unsigned int ModuleIndex;
     typedef unsigned int PhaseMarker;
     typedef unsigned int TimerHandle;
-    typedef std::map<TimerHandle, ModuleIdent> TimerAlloc;
-    typedef std::map<TimerHandle, boost::asio::deadline_timer* > TimersMap;
-    typedef std::map<TimerHandle, bool > NextTimeMap;
-    typedef std::map<ModuleIdent, std::list< BoundScheduleable > > ReadyMap;
+    typedef unsigned int CostClass;
+
+    /// A task waiting in a module's ready queue
+    struct SReadyTask
+    {
+        /// The task to run
+        BoundScheduleable task;
+        /// The class of tasks whose past runtimes estimate this task's cost
+        CostClass cost;
+        /// True once the task has been deferred to a later phase
+        bool deferred;
+    };
+
+    /// The learned runtime of a class of tasks
+    struct SCostEstimate
+    {
+        /// Moving average of the runtime in microseconds
+        unsigned int estimate;
+        /// True once at least one task of the class has run
+        bool learned;
+    };
+
+    typedef boost::circular_buffer< SReadyTask > ReadyQueue;
+    typedef boost::shared_ptr<boost::asio::io_service::strand> StrandPtr;
+    typedef std::map<ModuleIdent, ModuleIndex> ModuleIndexMap;
+    typedef std::map<std::string, CostClass> CostIndexMap;
+
+    /// A phase of the round and the module that owns it
+    struct SPhase
+    {
+        /// The module that is active during the phase
+        ModuleIndex module;
+        /// The duration of the phase
+        boost::posix_time::time_duration duration;
+        /// The timing parameter the duration is read from, or
+        /// TIMING_PARAMETER_COUNT if the duration is fixed
+        CTimings::TimingParameter timing;
+    };
+
+    /// The scheduler state kept for each module
+    struct SModule
+    {
+        /// The identifier the module was registered with
+        ModuleIdent ident;
+        /// True if the module owns a phase
+        bool scheduled;
+        /// Jobs that are ready to run as soon as the module's phase comes up
+        ReadyQueue ready;
+        /// The timers allocated to the module
+        std::vector<TimerHandle> timers;
+        /// The strand which serializes the tasks of the module
+        StrandPtr strand;
+        /// Histogram of how late the module's phases started
+        std::vector<unsigned int> jitter;
+        /// The cost class of tasks scheduled without one
+        CostClass cost;
+        /// The number of tasks the worker has run for the module
+        unsigned long executed;
+        /// The number of tasks deferred because they would overrun the phase
+        unsigned long deferred;
+    };
+
+    /// The scheduler state kept for each allocated timer
+    struct STimerSlot
+    {
+        /// The module that owns the timer
+        ModuleIndex module;
+        /// The timer object
+        boost::asio::deadline_timer* timer;
+        /// If the timer is set to expire for the next round.
+        bool nexttime;
+        /// If the timer has been cancelled or triggered by end of round
+        bool ntexpired;
+        /// The cost class of the tasks scheduled on the timer
+        CostClass cost;
+    };
+
+    typedef std::vector< SPhase > ModuleVector;
+    typedef std::vector< SModule > ModuleTable;
+    typedef std::vector< STimerSlot > TimerTable;
+    typedef std::vector< SCostEstimate > CostTable;
 
     /// Get the singleton instance of this class
     static CBroker& Instance();
@@ -81,6 +169,12 @@ public:
     /// Return a reference to the boost::ioservice
     boost::asio::io_service& GetIOService();
 
+    /// Return the strand that serializes the network handlers
+    boost::asio::io_service::strand& GetNetworkStrand();
+
+    /// Returns true if the ioservice is run by more than one thread
+    bool IsMultithreaded() const;
+
     /// Requests that the Broker stops execution to exit the DGI.
     void Stop(unsigned int signum = 0);
 
@@ -96,18 +190,48 @@ public:
     /// Schedule a task to be run as soon as the module is active.
     int Schedule(ModuleIdent m, BoundScheduleable x, bool start_worker=true);
 
+    /// Schedule a task to be run as soon as the module is active.
+    int Schedule(ModuleIndex m, BoundScheduleable x, bool start_worker=true);
+
+    /// Schedule a task whose cost is estimated from a class of similar tasks.
+    int Schedule(ModuleIndex m, CostClass c, BoundScheduleable x, bool start_worker=true);
+
     /// Allocate a timer to a specified module.
     TimerHandle AllocateTimer(ModuleIdent module);
 
+    /// Returns the scheduler's index for a module identifier.
+    ModuleIndex GetModuleIndex(ModuleIdent m);
+
+    /// Returns the cost class used to estimate the runtime of similar tasks.
+    CostClass GetCostClass(ModuleIdent m, std::string name);
+
     /// Registers a module for the scheduler
     void RegisterModule(ModuleIdent m, boost::posix_time::time_duration phase);
 
+    /// Registers a module whose phase follows a timing parameter
+    void RegisterModule(ModuleIdent m, CTimings::TimingParameter phase);
+
+    /// Sets the task that reloads the configuration files on SIGHUP
+    void SetReloadHandler(ReloadHandler h);
+
     /// Checks to see if a module is registered with the scheduler
     bool IsModuleRegistered(ModuleIdent m);
 
+    /// Checks to see if a module is registered with the scheduler
+    bool IsModuleRegistered(ModuleIndex m);
+
     /// Returns how much time the current module has left in its phase
     boost::posix_time::time_duration TimeRemaining();
 
+    /// Returns how many phases have started since the broker ran
+    unsigned long GetPhaseCount();
+
+    /// Returns the phase jitter histogram for a module
+    std::vector<unsigned int> GetPhaseJitter(ModuleIdent m);
+
+    /// Returns how many tasks of a module were executed and deferred
+    void GetTaskCounts(ModuleIdent m, unsigned long& executed, unsigned long& deferred);
+
     /// Returns the synchronizer
     CClockSynchronizer& GetClockSynchronizer();
 
@@ -118,6 +242,15 @@ private:
     /// The io_service used to perform asynchronous operations.
     boost::asio::io_service m_ioService;
 
+    /// Serializes the listener, the protocol timers and the synchronizer.
+    boost::asio::io_service::strand m_netstrand;
+
+    /// The number of threads running the ioservice.
+    unsigned int m_threads;
+
+    /// Runs the ioservice on one of the pool threads.
+    void RunThread();
+
     ///An task that will advance the Broker's active module to the next module.
     void ChangePhase(const boost::system::error_code &err);
 
@@ -127,41 +260,86 @@ private:
     ///Executes tasks from the active module's task queue.
     void Worker();
 
+    ///Executes a single task on its module's strand, then resumes the worker.
+    void RunTask(BoundScheduleable x, CostClass c);
+
+    ///Runs a task and updates the runtime estimate of its class.
+    void ExecuteTask(const BoundScheduleable& x, CostClass c);
+
+    ///Finds or creates a cost class, requires m_schmutex.
+    CostClass InternCostClass(const std::string& key);
+
+    ///Reloads the configuration and marks the phase table to be rebuilt.
+    void HandleReload();
+
+    ///Finds or creates the index for a module, requires m_schmutex.
+    ModuleIndex InternModule(const ModuleIdent& m);
+
+    ///Appends a task to a module's ready queue, requires m_schmutex.
+    void Enqueue(ModuleIndex m, const BoundScheduleable& x, CostClass c);
+
+    ///Recomputes the round length and phase offsets, requires m_schmutex.
+    void RebuildPhaseTable();
+
+    ///Rereads the phase durations from the timings, requires m_schmutex.
+    void ReloadPhaseTable();
+
+    ///Adds a phase start to a module's jitter histogram, requires m_schmutex.
+    void RecordPhaseJitter(ModuleIndex m, unsigned int late);
+
+    ///Writes the jitter histograms and task counts to the log, requires m_schmutex.
+    void LogRoundStatistics();
+
     ///True while the worker is actively running tasks.
     bool m_busy;
 
+    ///The number of tasks the worker has started in the current phase.
+    unsigned int m_phasetasks;
+
     ///The last time the phases were aligned
     boost::posix_time::ptime m_last_alignment;
 
     ///List of modules for the scheduler
     ModuleVector m_modules;
 
+    ///Offset (ms) from the start of the round at which each phase ends.
+    std::vector<unsigned int> m_phaseoffsets;
+
+    ///The length of a round in milliseconds.
+    unsigned int m_roundlength;
+
+    ///True if the phase durations are reread at the start of the next round.
+    bool m_reloadphases;
+
+    ///The task that reloads the configuration files.
+    ReloadHandler m_reloadhandler;
+
     ///The active module in the scheduler.
     PhaseMarker m_phase;
 
+    ///The number of phases started since the broker ran, read without m_schmutex.
+    boost::atomic<unsigned long> m_phasecount;
+
     ///Computed ptime for when the current phase ends
     boost::posix_time::ptime m_phaseends;
 
     ///Timer for the phases
     boost::asio::deadline_timer m_phasetimer;
 
-    ///The current counter for the time handlers
-    TimerHandle m_handlercounter;
-
-    ///Timer allocations for modules.
-    TimerAlloc m_allocs;
+    ///Module identifiers to their index in the module table.
+    ModuleIndexMap m_moduleindex;
 
-    ///A relation between the timer handles and the actual timer objects.
-    TimersMap m_timers;
+    ///Scheduler state for every module, indexed by ModuleIndex.
+    ModuleTable m_moduletable;
 
-    ///Maps handle to bool: if a timer handle is set to expire for the next round.
-    NextTimeMap m_nexttime;
+    ///Scheduler state for every timer, indexed by TimerHandle.
+    TimerTable m_timers;
 
-    ///Maps if a specific timer has been cancelled or triggered by end of round
-    NextTimeMap m_ntexpired;
+    ///Cost class names to their index in the cost table.
+    CostIndexMap m_costindex;
 
-    ///A map of jobs that are ready to run as soon as their phase comes up
-    ReadyMap m_ready;
+    ///Runtime estimates for every cost class, indexed by CostClass.
+    CostTable m_costs;
 
     ///Lock for the scheduler.
     boost::mutex m_schmutex;
@@ -25,8 +25,10 @@
 #include "CConnectionManager.hpp"
 #include "CGlobalConfiguration.hpp"
 #include "CGlobalPeerList.hpp"
+#include "CListener.hpp"
 #include "CLogger.hpp"
 #include "CPeerNode.hpp"
+#include "Messages.hpp"
 #include "messages/ModuleMessage.pb.h"
 
 #include <memory>
@@ -61,7 +63,7 @@ const int QUERY_INTERVAL = 10000;
 CClockSynchronizer::CClockSynchronizer(boost::asio::io_service& ios)
     : m_exchangetimer(ios)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     MapIndex ii(GetUUID(),GetUUID());
     m_offsets[ii] = boost::posix_time::milliseconds(0);
     SetWeight(ii, 1.0);
@@ -83,10 +85,11 @@ CClockSynchronizer::CClockSynchronizer(boost::asio::io_service& ios)
 ///////////////////////////////////////////////////////////////////////////////
 void CClockSynchronizer::Run()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     m_exchangetimer.expires_from_now(boost::posix_time::milliseconds(QUERY_INTERVAL));
-    m_exchangetimer.async_wait(boost::bind(&CClockSynchronizer::Exchange,this,
-        boost::asio::placeholders::error));
+    m_exchangetimer.async_wait(CBroker::Instance().GetNetworkStrand().wrap(
+        boost::bind(&CClockSynchronizer::Exchange, this,
+            boost::asio::placeholders::error)));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -98,7 +101,7 @@ void CClockSynchronizer::Run()
 ///////////////////////////////////////////////////////////////////////////////
 void CClockSynchronizer::Stop()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     m_exchangetimer.cancel();
 }
 
@@ -112,11 +115,11 @@ void CClockSynchronizer::Stop()
 void CClockSynchronizer::HandleIncomingMessage(
     boost::shared_ptr<const ModuleMessage> msg, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if (!msg->has_clock_synchronizer_message())
     {
-        Logger.Warn << "Dropped message of unexpected type:\n" << msg->DebugString();
+        FREEDM_LOG_WARN(Logger) << "Dropped message of unexpected type:\n" << msg->DebugString();
         return;
     }
 
@@ -131,7 +134,7 @@ void CClockSynchronizer::HandleIncomingMessage(
     }
     else
     {
-        Logger.Warn << "Dropped clk message of unexpected type:\n" << msg->DebugString();
+        FREEDM_LOG_WARN(Logger) << "Dropped clk message of unexpected type:\n" << msg->DebugString();
     }
 }
 
@@ -146,10 +149,10 @@ void CClockSynchronizer::HandleIncomingMessage(
 ///////////////////////////////////////////////////////////////////////////////
 void CClockSynchronizer::HandleExchange(const ExchangeMessage& msg, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     // Respond to the query ID
-    peer.Send(CreateExchangeResponse(msg.query()));
+    peer.Send(ShareMessage(CreateExchangeResponse(msg.query(), !msg.binary_timestamps())));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -164,15 +167,22 @@ void CClockSynchronizer::HandleExchange(const ExchangeMessage& msg, CPeerNode pe
 ///////////////////////////////////////////////////////////////////////////////
 void CClockSynchronizer::HandleExchangeResponse(const ExchangeResponseMessage& msg, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     std::string sender = peer.GetUUID();
     MapIndex ij(GetUUID(),sender);
     boost::posix_time::ptime challenge;
     boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
-    boost::posix_time::ptime response =
-        boost::posix_time::time_from_string(msg.unsynchronized_sendtime());
+    boost::posix_time::ptime response;
+    if(msg.has_unsynchronized_sendtime_us())
+    {
+        response = MicrosecondsToTime(msg.unsynchronized_sendtime_us());
+    }
+    else
+    {
+        response = boost::posix_time::time_from_string(msg.unsynchronized_sendtime());
+    }
     unsigned int k = msg.response();
-    Logger.Debug<<__FILE__<<":"<<__LINE__<<std::endl;
+    FREEDM_LOG_DEBUG(Logger)<<__FILE__<<":"<<__LINE__<<std::endl;
     if(m_queries.find(ij) == m_queries.end() || m_queries[ij].first != k)
         return;
     challenge = m_queries[ij].second;
@@ -231,7 +241,7 @@ void CClockSynchronizer::HandleExchangeResponse(const ExchangeResponseMessage& m
         }
     }
     double lag = (TDToDouble(sumlag))/rlist.size();
-    Logger.Notice<<"Computed lag ("<<sender<<"): "<<lag<<std::endl;
+    FREEDM_LOG_NOTICE(Logger)<<"Computed lag ("<<sender<<"): "<<lag<<std::endl;
     double dxbar = TDToDouble(sumx)/rlist.size();
     double dybar = TDToDouble(sumy)/rlist.size();
     boost::posix_time::time_duration xbar = DoubleToTD(dxbar);
@@ -300,14 +310,15 @@ void CClockSynchronizer::HandleExchangeResponse(const ExchangeResponseMessage& m
 ///////////////////////////////////////////////////////////////////////////////
 void CClockSynchronizer::Exchange(const boost::system::error_code& err)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     if(err)
         return;
     // Loop through the peers and send them beacons
     std::deque< CPeerNode > tmplist;
     std::deque< CPeerNode > tmplist2;
     bool flop = false;
-    BOOST_FOREACH(CPeerNode peer, CGlobalPeerList::instance().PeerList() | boost::adaptors::map_values)
+    boost::shared_ptr<const CGlobalPeerList::PeerSet> peers = CGlobalPeerList::instance().PeerList();
+    BOOST_FOREACH(CPeerNode peer, *peers | boost::adaptors::map_values)
     {
         if(peer.GetUUID() == GetUUID())
            flop = true;
@@ -319,17 +330,24 @@ void CClockSynchronizer::Exchange(const boost::system::error_code& err)
     // put elements from list b into list a
     tmplist.insert(tmplist.end(),tmplist2.begin(),tmplist2.end());
     // This should do a circular shift of the queries, which SHOULD help with traffic if I have postulated correctly.
+    // With multicast, one query reaches every peer and the shift doesn't matter.
+    // Every peer gets the same query, so it is built and shared once.
+    boost::shared_ptr<const ModuleMessage> query =
+        ShareMessage(CreateExchangeMessage(m_kcounter));
+    bool multicast = CListener::Instance().Broadcast(*query);
     BOOST_FOREACH(CPeerNode peer, tmplist)
     {
-        peer.Send(CreateExchangeMessage(m_kcounter));
+        if(!multicast)
+            peer.Send(query);
         MapIndex ij(GetUUID(),peer.GetUUID());
         m_queries[ij] = QueryRecord(m_kcounter, boost::posix_time::microsec_clock::universal_time());
     }
     m_kcounter++;
     // Run this every so often
     m_exchangetimer.expires_from_now(boost::posix_time::milliseconds(QUERY_INTERVAL));
-    m_exchangetimer.async_wait(boost::bind(&CClockSynchronizer::Exchange,this,
-        boost::asio::placeholders::error));
+    m_exchangetimer.async_wait(CBroker::Instance().GetNetworkStrand().wrap(
+        boost::bind(&CClockSynchronizer::Exchange, this,
+            boost::asio::placeholders::error)));
     //make sure the self referential entries stay sane.
     MapIndex ii(GetUUID(),GetUUID());
     m_offsets[ii] = boost::posix_time::milliseconds(0);
@@ -351,7 +369,7 @@ void CClockSynchronizer::Exchange(const boost::system::error_code& err)
         tmp1 /= tmp2;
         tmp3 /= tmp2;
         m_myoffset = DoubleToTD(tmp1);
-        Logger.Notice<<"Adjusting Skew to "<<m_myoffset<<std::endl;
+        FREEDM_LOG_NOTICE(Logger)<<"Adjusting Skew to "<<m_myoffset<<std::endl;
         CGlobalConfiguration::Instance().SetClockSkew(m_myoffset);
         m_myskew = tmp3;
     }
@@ -377,15 +395,17 @@ void CClockSynchronizer::Exchange(const boost::system::error_code& err)
 /// @post None
 /// @param k A sequence number to use for this request, which is a monotonically
 ///		increasing value for each receiver 
-/// @return A prepared exchange message.
+/// @return A prepared exchange message, built in the module's message pool.
 ///////////////////////////////////////////////////////////////////////////////
-ModuleMessage CClockSynchronizer::CreateExchangeMessage(unsigned int k)
+const ModuleMessage& CClockSynchronizer::CreateExchangeMessage(unsigned int k)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    ClockSynchronizerMessage csm;
-    ExchangeMessage* em = csm.mutable_exchange_message();
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    ModuleMessage& mm = NewMessage("clk");
+    ExchangeMessage* em =
+        mm.mutable_clock_synchronizer_message()->mutable_exchange_message();
     em->set_query(k);
-    return PrepareForSending(csm);
+    em->set_binary_timestamps(true);
+    return mm;
 }
 
 
@@ -398,16 +418,19 @@ ModuleMessage CClockSynchronizer::CreateExchangeMessage(unsigned int k)
 /// @post None
 /// @param k A sequence number to use for this request, which is a monotonically
 ///		increasing value for each receiver 
-/// @return A prepared response message.
+/// @param legacy Also embed the clock reading as text, for older peers.
+/// @return A prepared response message, built in the module's message pool.
 ///////////////////////////////////////////////////////////////////////////////
-ModuleMessage CClockSynchronizer::CreateExchangeResponse(unsigned int k)
+const ModuleMessage& CClockSynchronizer::CreateExchangeResponse(unsigned int k, bool legacy)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    ClockSynchronizerMessage csm;
-    ExchangeResponseMessage* erm = csm.mutable_exchange_response_message();
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    ModuleMessage& mm = NewMessage("clk");
+    ExchangeResponseMessage* erm =
+        mm.mutable_clock_synchronizer_message()->mutable_exchange_response_message();
+    boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
     erm->set_response(k);
-    erm->set_unsynchronized_sendtime(boost::posix_time::to_simple_string(
-        boost::posix_time::microsec_clock::universal_time()));
+    erm->set_unsynchronized_sendtime_us(TimeToMicroseconds(now));
+    erm->set_unsynchronized_sendtime(legacy ? boost::posix_time::to_simple_string(now) : "");
     for(OffsetMap::iterator oit=m_offsets.begin(); oit != m_offsets.end(); oit++)
     {
         ExchangeResponseMessage::TableEntry* te = erm->add_table_entry();
@@ -417,7 +440,7 @@ ModuleMessage CClockSynchronizer::CreateExchangeResponse(unsigned int k)
         te->set_skew(m_skews[oit->first]);
         te->set_weight(GetWeight(oit->first));
     }
-    return PrepareForSending(csm);
+    return mm;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -430,7 +453,7 @@ ModuleMessage CClockSynchronizer::CreateExchangeResponse(unsigned int k)
 ///////////////////////////////////////////////////////////////////////////////
 boost::posix_time::ptime CClockSynchronizer::GetSynchronizedTime() const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
     return now + CGlobalConfiguration::Instance().GetClockSkew();
 }
@@ -445,7 +468,7 @@ boost::posix_time::ptime CClockSynchronizer::GetSynchronizedTime() const
 ///////////////////////////////////////////////////////////////////////////////
 double CClockSynchronizer::GetWeight(MapIndex i) const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     WeightMap::const_iterator it = m_weights.find(i);
     boost::posix_time::ptime set;
     if(i == MapIndex(GetUUID(),GetUUID()))
@@ -466,7 +489,7 @@ double CClockSynchronizer::GetWeight(MapIndex i) const
 ///////////////////////////////////////////////////////////////////////////////
 void CClockSynchronizer::SetWeight(MapIndex i, double w)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     DecayingWeight weight(w, boost::posix_time::microsec_clock::universal_time());
     m_weights[i] = weight;
     m_lastresponse[i] = m_kcounter;
@@ -483,7 +506,7 @@ void CClockSynchronizer::SetWeight(MapIndex i, double w)
 ///////////////////////////////////////////////////////////////////////////////
 double CClockSynchronizer::TDToDouble(boost::posix_time::time_duration td)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     double x = td.total_seconds() + (td.fractional_seconds()*1.0)/1000000;
     return x;
 }
@@ -499,7 +522,7 @@ double CClockSynchronizer::TDToDouble(boost::posix_time::time_duration td)
 ///////////////////////////////////////////////////////////////////////////////
 boost::posix_time::time_duration CClockSynchronizer::DoubleToTD(double td)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     double seconds, tmp, fractional;
     tmp = modf(td, &seconds);
     tmp *= 1000000; // Shift out to the microseconds
@@ -507,23 +530,5 @@ boost::posix_time::time_duration CClockSynchronizer::DoubleToTD(double td)
     return boost::posix_time::seconds(seconds) + boost::posix_time::microseconds(fractional);
 }
 
-///////////////////////////////////////////////////////////////////////////////
-/// CClockSynchronizer::PrepareForSending
-/// @description Wraps a ClockSynchronizerMessage in a ModuleMessage.
-/// @param message the message to prepare. If any required field is unset,
-///     an exception will be thrown.
-/// @pre None
-/// @post None
-/// @return a ModuleMessage containing a copy of the ClockSynchronizerMessage
-///////////////////////////////////////////////////////////////////////////////
-ModuleMessage CClockSynchronizer::PrepareForSending(const ClockSynchronizerMessage& message)
-{
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    ModuleMessage mm;
-    mm.mutable_clock_synchronizer_message()->CopyFrom(message);
-    mm.set_recipient_module("clk");
-    return mm;
-}
-
 }
 }
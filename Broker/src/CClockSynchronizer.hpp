@@ -85,11 +85,9 @@ private:
     void Exchange(const boost::system::error_code& err );
 
     /// Generate the exchange message
-    ModuleMessage CreateExchangeMessage(unsigned int k);
+    const ModuleMessage& CreateExchangeMessage(unsigned int k);
     /// Generate the exchange response message
-    ModuleMessage CreateExchangeResponse(unsigned int k);
-    /// Wraps a clock synchronizer message in a ModuleMessage
-    static ModuleMessage PrepareForSending(const ClockSynchronizerMessage& message);
+    const ModuleMessage& CreateExchangeResponse(unsigned int k, bool legacy);
 
     /// Relative offsets
     OffsetMap m_offsets;
@@ -53,8 +53,9 @@ CLocalLogger Logger(__FILE__);
 ///////////////////////////////////////////////////////////////////////////////
 CConnection::CConnection(std::string uuid, boost::asio::ip::udp::endpoint endpoint)
   : m_protocol(boost::make_shared<CProtocolSR>(uuid,endpoint))   // FIXME hardcoded protocol
+  , m_local(uuid == CGlobalConfiguration::Instance().GetUUID())
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -73,7 +74,7 @@ CConnection::~CConnection()
 ///////////////////////////////////////////////////////////////////////////////
 void CConnection::Stop()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     m_protocol->Stop();
 }
 
@@ -105,19 +106,18 @@ void CConnection::ChangePhase(bool newround)
 /// CConnection::Send
 /// @description Passes a message to the protocol to deliver it to the intended
 ///		recipient. If the intended recipient is this process, the delivery
-///		is done directly without the protocol.
+///		is done directly without the protocol, on a copy of the message.
 /// @pre None.
 /// @post The message is scheduled to be delivered.
 /// @param msg The message to write to the channel.
 ///////////////////////////////////////////////////////////////////////////////
 void CConnection::Send(const ModuleMessage& msg)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
-    // If the UUID of the recipient (The value stored by GetUUID of this
-    // object) is the same as the this node's uuid, place the message directly
-    // into the received Queue.
-    if(m_protocol->GetUUID() == CGlobalConfiguration::Instance().GetUUID())
+    // If the recipient is this node, place the message directly into the
+    // received Queue. The caller keeps its message, so the queue gets a copy.
+    if(m_local)
     {
         boost::shared_ptr<ModuleMessage> copy = boost::make_shared<ModuleMessage>();
         copy->CopyFrom(msg);
@@ -129,6 +129,41 @@ void CConnection::Send(const ModuleMessage& msg)
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// CConnection::Send
+/// @description Passes a shared message to the protocol to deliver it to the
+///		intended recipient. If the intended recipient is this process, the
+///		dispatcher is handed the message itself rather than a copy.
+/// @pre The message is not modified once it has been sent.
+/// @post The message is scheduled to be delivered.
+/// @param msg The message to write to the channel.
+///////////////////////////////////////////////////////////////////////////////
+void CConnection::Send(boost::shared_ptr<const ModuleMessage> msg)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    if(m_local)
+    {
+        CDispatcher::Instance().HandleRequest(msg, m_protocol->GetUUID());
+    }
+    else
+    {
+        m_protocol->Send(*msg);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CConnection::IsLocal
+/// @description Checks whether the peer of this connection is this process.
+/// @pre None
+/// @post None
+/// @return True if messages on this connection are delivered locally.
+///////////////////////////////////////////////////////////////////////////////
+bool CConnection::IsLocal() const
+{
+    return m_local;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// CConnection::ReceiveACK
 /// @description Handler for recieving acknowledgments from the peer.
@@ -138,7 +173,7 @@ void CConnection::Send(const ModuleMessage& msg)
 ///////////////////////////////////////////////////////////////////////////////
 void CConnection::ReceiveACK(const ProtocolMessage& msg)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     m_protocol->ReceiveACK(msg);
 }
 
@@ -151,7 +186,7 @@ void CConnection::ReceiveACK(const ProtocolMessage& msg)
 ///////////////////////////////////////////////////////////////////////////////
 bool CConnection::Receive(const ProtocolMessage& msg)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if(m_protocol->Receive(msg))
     {
@@ -162,6 +197,20 @@ bool CConnection::Receive(const ProtocolMessage& msg)
     return false;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// CConnection::Refuse
+/// @description Reports to the peer that a message it sent was accepted but
+///     not delivered, because its module's inbound queue was full.
+/// @pre msg was accepted by Receive.
+/// @post Calls the protocol's Refuse method.
+/// @param msg The refused message.
+///////////////////////////////////////////////////////////////////////////////
+void CConnection::Refuse(const ProtocolMessage& msg)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    m_protocol->Refuse(msg);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// CConnection::OnReceive
 /// @description Handles performing some action after processing a received
@@ -183,7 +232,7 @@ void CConnection::OnReceive()
 ///////////////////////////////////////////////////////////////////////////////
 std::string CConnection::GetUUID() const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     return m_protocol->GetUUID();
 }
@@ -198,7 +247,7 @@ std::string CConnection::GetUUID() const
 ///////////////////////////////////////////////////////////////////////////////
 void CConnection::SetReliability(int r)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     return m_protocol->SetReliability(r);
 }
@@ -212,10 +261,114 @@ void CConnection::SetReliability(int r)
 ///////////////////////////////////////////////////////////////////////////////
 int CConnection::GetReliability() const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     return m_protocol->GetReliability();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// CConnection::SetBinaryTimestamps
+/// @description Records whether the peer advertised that it reads the binary
+///     timestamps, so the text forms can be left out of outgoing messages.
+/// @pre None
+/// @post The protocol only writes text timestamps if v is false.
+/// @param v true if the last window from the peer advertised the capability
+///////////////////////////////////////////////////////////////////////////////
+void CConnection::SetBinaryTimestamps(bool v)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    m_protocol->SetBinaryTimestamps(v);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CConnection::SetSelectiveAck
+/// @description Records whether the peer advertised that it reads cumulative
+///     and selective ACKs, so its messages can be acknowledged once per window
+///     and held when they arrive out of order.
+/// @pre None
+/// @post The protocol only holds out of order messages if v is true.
+/// @param v true if the last window from the peer advertised the capability
+///////////////////////////////////////////////////////////////////////////////
+void CConnection::SetSelectiveAck(bool v)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    m_protocol->SetSelectiveAck(v);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CConnection::NextInOrder
+/// @description Takes the message the protocol held because it arrived ahead
+///     of a lost one, once everything before it has been accepted.
+/// @pre None
+/// @post The returned message is accepted by the protocol.
+/// @return the next message in order, or null if it hasn't arrived
+///////////////////////////////////////////////////////////////////////////////
+boost::shared_ptr<const ProtocolMessage> CConnection::NextInOrder()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    return m_protocol->NextInOrder();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CConnection::SetEndpoint
+/// @description Gives the protocol the address of the peer once its hostname
+///     is resolved, so the messages queued for the peer can be written.
+/// @pre None
+/// @post The protocol writes to endpoint.
+/// @param endpoint the resolved address of the peer
+///////////////////////////////////////////////////////////////////////////////
+void CConnection::SetEndpoint(boost::asio::ip::udp::endpoint endpoint)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    m_protocol->SetEndpoint(endpoint);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CConnection::IsResolved
+/// @description Checks whether the address of the peer is known.
+/// @pre None
+/// @post None
+/// @return true if the protocol has an endpoint to write to
+///////////////////////////////////////////////////////////////////////////////
+bool CConnection::IsResolved() const
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    return m_protocol->IsResolved();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CConnection::Flush
+/// @description Writes the messages the protocol has staged since the last
+///     flush without waiting for the end of the current handler.
+/// @pre Called through the network strand.
+/// @post The protocol's Flush method has been called.
+///////////////////////////////////////////////////////////////////////////////
+void CConnection::Flush()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    m_protocol->Flush();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CConnection::GetStats
+/// @description Get the round trip time estimate, retransmission counts and
+///     acknowledged bytes of the connection.
+/// @pre None
+/// @post None
+/// @return the link statistics of the protocol
+///////////////////////////////////////////////////////////////////////////////
+SLinkStats CConnection::GetStats() const
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    return m_protocol->GetStats();
+}
+
     } // namespace broker
 } // namespace freedm
@@ -76,12 +76,21 @@ public:
     /// Puts a message into the channel.
     void Send(const ModuleMessage& msg);
 
+    /// Puts a shared message into the channel, without copying it if local.
+    void Send(boost::shared_ptr<const ModuleMessage> msg);
+
+    /// Returns true if the peer of this connection is this process.
+    bool IsLocal() const;
+
     /// Handles acknowledgement messages from the peer.
     void ReceiveACK(const ProtocolMessage& msg);
 
     /// Handles messages from the peer.
     bool Receive(const ProtocolMessage& msg);
 
+    /// Tells the peer an accepted message could not be queued.
+    void Refuse(const ProtocolMessage& msg);
+
     /// Performs an action based on receiving a Protocol Message Window.
     void OnReceive();
     
@@ -96,10 +105,34 @@ public:
     
     /// Get the connection reliability for DCUSTOMNETWORK
     int GetReliability() const;
+
+    /// Record whether the peer reads the binary timestamps
+    void SetBinaryTimestamps(bool v);
+
+    /// Record whether the peer reads cumulative and selective ACKs
+    void SetSelectiveAck(bool v);
+
+    /// Get the next held message that is now in order, if any
+    boost::shared_ptr<const ProtocolMessage> NextInOrder();
+
+    /// Set the destination once the peer's hostname is resolved
+    void SetEndpoint(boost::asio::ip::udp::endpoint endpoint);
+
+    /// Returns true once the destination is known
+    bool IsResolved() const;
+
+    /// Write the messages the protocol has staged
+    void Flush();
+
+    /// Get the link statistics of the protocol
+    SLinkStats GetStats() const;
 private:
 
     /// The network protocol to use for sending/receiving messages
     boost::shared_ptr<IProtocol> m_protocol;
+
+    /// True if the peer is this process, so messages skip the protocol
+    bool m_local;
 };
 
 typedef boost::shared_ptr<CConnection> ConnectionPtr;
@@ -34,6 +34,7 @@
 #include <algorithm>
 
 #include <boost/bind.hpp>
+#include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/property_tree/ptree.hpp>
@@ -50,6 +51,10 @@ CLocalLogger Logger(__FILE__);
 
 }
 
+// Defined here as well, since the boost::posix_time::seconds constructor
+// takes its argument by reference.
+const unsigned int CConnectionManager::RESOLVE_TTL;
+
 ///////////////////////////////////////////////////////////////////////////////
 /// CConnectionManager::CConnectionManager
 /// @description: Initializes the connection manager object
@@ -57,8 +62,14 @@ CLocalLogger Logger(__FILE__);
 /// @post Connection manager is ready for use
 ///////////////////////////////////////////////////////////////////////////////
 CConnectionManager::CConnectionManager()
+    : m_resolvecount(0)
+    , m_peerids(new peeridmap)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    for(unsigned int i = 0; i < CONNECTION_SHARDS; i++)
+    {
+        m_shards[i].table.reset(new connectiontable);
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -80,20 +91,198 @@ CConnectionManager& CConnectionManager::Instance()
 /// @param uuid The uuid of the node the connection is to.
 /// @param c The connection object that manages the channel to uuid
 /// @pre The connection is initialized.
-/// @post The connection has been inserted into the connection map.
+/// @post The connection has been inserted into the connection map, unless
+///     a running connection to uuid already is.
 ///////////////////////////////////////////////////////////////////////////////
 void CConnectionManager::PutConnection(std::string uuid, ConnectionPtr c)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    InsertConnection(InternPeer(uuid), c);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CConnectionManager::InternPeer
+/// @description Finds the small integer that identifies a peer in the
+///     connection table. Peers are never forgotten, so an identifier can be
+///     kept for as long as the peer is referred to. Only peers in the host
+///     list are given an identifier, so the table does not grow with every
+///     uuid seen on the network.
+/// @pre None
+/// @post If the peer is new, a copy of the identifier map which includes it
+///     replaces the current one. Throws if the peer is not in the host list.
+/// @param uuid The uuid of the peer.
+/// @return The identifier of the peer.
+///////////////////////////////////////////////////////////////////////////////
+CConnectionManager::PeerId CConnectionManager::InternPeer(const std::string& uuid)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    PeerId id = FindPeer(uuid);
+    if(id != NO_PEER)
     {
-        boost::lock_guard< boost::mutex > scopedLock_( m_Mutex );
-        m_connections.insert(connectionmap::value_type(uuid,c));
+        return id;
+    }
+
+    boost::lock_guard< boost::mutex > scopedLock_( m_Mutex );
+    if(m_hosts.count(uuid) == 0)
+    {
+        throw std::runtime_error("Couldn't find peer in hostlist: "+uuid);
+    }
+    // Another thread may have added the peer before the lock was taken.
+    boost::shared_ptr<const peeridmap> ids = m_peerids;
+    peeridmap::const_iterator it = ids->find(uuid);
+    if(it != ids->end())
+    {
+        return it->second;
+    }
+    boost::shared_ptr<peeridmap> updated(new peeridmap(*ids));
+    id = ids->size();
+    updated->insert(peeridmap::value_type(uuid, id));
+    boost::atomic_store(&m_peerids, boost::shared_ptr<const peeridmap>(updated));
+    return id;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CConnectionManager::FindPeer
+/// @description Looks up the identifier of a peer in a snapshot of the
+///     identifier map, without taking a lock or assigning an identifier.
+/// @pre None
+/// @post None
+/// @param uuid The uuid of the peer.
+/// @return The identifier of the peer, or NO_PEER if it has none.
+///////////////////////////////////////////////////////////////////////////////
+CConnectionManager::PeerId CConnectionManager::FindPeer(const std::string& uuid)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    boost::shared_ptr<const peeridmap> ids = boost::atomic_load(&m_peerids);
+    peeridmap::const_iterator it = ids->find(uuid);
+    if(it != ids->end())
+    {
+        return it->second;
     }
+    return NO_PEER;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CConnectionManager::GetConnection
+/// @description Reads the connection registered for a peer. This takes a
+///     snapshot of the peer's shard rather than a lock, so it may be called
+///     from any thread.
+/// @pre None
+/// @post None
+/// @param id The identifier returned by InternPeer, or NO_PEER.
+/// @return The registered connection, which may be stopped, or null.
+///////////////////////////////////////////////////////////////////////////////
+ConnectionPtr CConnectionManager::GetConnection(PeerId id)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    if(id == NO_PEER)
+    {
+        return ConnectionPtr();
+    }
+    boost::shared_ptr<const connectiontable> table =
+        boost::atomic_load(&m_shards[id % CONNECTION_SHARDS].table);
+    unsigned int slot = id / CONNECTION_SHARDS;
+    if(slot < table->size())
+    {
+        return (*table)[slot];
+    }
+    return ConnectionPtr();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CConnectionManager::InsertConnection
+/// @description Publishes a connection in the peer's shard of the connection
+///     table. If two threads create a connection to the same peer, the first
+///     to register it wins and the other is handed the registered one.
+/// @pre None
+/// @post c is registered for the peer, unless a running connection was.
+/// @param id The identifier of the peer.
+/// @param c The connection to the peer.
+/// @return The connection registered for the peer.
+///////////////////////////////////////////////////////////////////////////////
+ConnectionPtr CConnectionManager::InsertConnection(PeerId id, ConnectionPtr c)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    SShard& shard = m_shards[id % CONNECTION_SHARDS];
+    unsigned int slot = id / CONNECTION_SHARDS;
+
+    boost::lock_guard< boost::mutex > scopedLock_( shard.mutex );
+    if(slot < shard.table->size())
+    {
+        ConnectionPtr current = (*shard.table)[slot];
+        if(current && !current->GetStopped())
+        {
+            return current;
+        }
+    }
+    boost::shared_ptr<connectiontable> updated(new connectiontable(*shard.table));
+    if(slot >= updated->size())
+    {
+        updated->resize(slot + 1);
+    }
+    (*updated)[slot] = c;
+    boost::atomic_store(&shard.table, boost::shared_ptr<const connectiontable>(updated));
+    return c;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CConnectionManager::RemoveConnection
+/// @description Removes a connection from the connection table.
+/// @pre None
+/// @post If c is registered for its peer, the peer has no connection.
+/// @param c The connection to remove.
+///////////////////////////////////////////////////////////////////////////////
+void CConnectionManager::RemoveConnection(ConnectionPtr c)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    PeerId id = FindPeer(c->GetUUID());
+    if(id == NO_PEER)
+    {
+        return;
+    }
+    SShard& shard = m_shards[id % CONNECTION_SHARDS];
+    unsigned int slot = id / CONNECTION_SHARDS;
+
+    boost::lock_guard< boost::mutex > scopedLock_( shard.mutex );
+    if(slot < shard.table->size() && (*shard.table)[slot] == c)
+    {
+        boost::shared_ptr<connectiontable> updated(new connectiontable(*shard.table));
+        (*updated)[slot].reset();
+        boost::atomic_store(&shard.table, boost::shared_ptr<const connectiontable>(updated));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CConnectionManager::GetConnections
+/// @description Collects the registered connections from every shard.
+/// @pre None
+/// @post None
+/// @return The connections registered when each shard was read.
+///////////////////////////////////////////////////////////////////////////////
+std::vector<ConnectionPtr> CConnectionManager::GetConnections()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    std::vector<ConnectionPtr> connections;
+    for(unsigned int i = 0; i < CONNECTION_SHARDS; i++)
+    {
+        boost::shared_ptr<const connectiontable> table =
+            boost::atomic_load(&m_shards[i].table);
+        BOOST_FOREACH(const ConnectionPtr& c, *table)
+        {
+            if(c)
+            {
+                connections.push_back(c);
+            }
+        }
+    }
+    return connections;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 /// CConnectionManager::PutHost
-/// @description Registers a peer with the connection manager.
+/// @description Registers a peer with the connection manager and starts
+///     resolving its hostname, so the first message to the peer doesn't have
+///     to wait for it.
 /// @pre None
 /// @post The hostname is registered with the uuid to hostname map.
 /// @param u The peer's UUID
@@ -102,16 +291,17 @@ void CConnectionManager::PutConnection(std::string uuid, ConnectionPtr c)
 ///////////////////////////////////////////////////////////////////////////////
 void CConnectionManager::PutHost(std::string u, std::string host, std::string port)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    SRemoteHost x;
+    x.hostname = host;
+    x.port = port;
     {
         boost::lock_guard< boost::mutex > scopedLock_( m_Mutex );
         if(m_hosts.count(u) != 0)
             return;
-        SRemoteHost x;
-        x.hostname = host;
-        x.port = port;
         m_hosts.insert(std::pair<std::string, SRemoteHost>(u, x));
     }
+    Resolve(x);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -124,7 +314,7 @@ void CConnectionManager::PutHost(std::string u, std::string host, std::string po
 ///////////////////////////////////////////////////////////////////////////////
 void CConnectionManager::PutHost(std::string u, SRemoteHost host)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     {
         boost::lock_guard< boost::mutex > scopedLock_( m_Mutex );
         if(m_hosts.count(u) != 0)
@@ -133,6 +323,23 @@ void CConnectionManager::PutHost(std::string u, SRemoteHost host)
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// CConnectionManager::HasHost
+/// @description Checks whether a peer is in the host list. Unlike GetHost,
+///     this holds the lock, so it may be called while other threads add
+///     hosts.
+/// @pre None
+/// @post None
+/// @param uuid The uuid of the peer.
+/// @return True if the peer has a registered hostname.
+///////////////////////////////////////////////////////////////////////////////
+bool CConnectionManager::HasHost(const std::string& uuid)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    boost::lock_guard< boost::mutex > scopedLock_( m_Mutex );
+    return m_hosts.count(uuid) != 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// CConnectionManager::Stop
 /// @description Stops a connection.
@@ -142,11 +349,8 @@ void CConnectionManager::PutHost(std::string u, SRemoteHost host)
 ///////////////////////////////////////////////////////////////////////////////
 void CConnectionManager::Stop(ConnectionPtr c)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    if(m_connections.right.count(c))
-    {
-        m_connections.right.erase(c);
-    }
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    RemoveConnection(c);
     c->Stop();
 }
 
@@ -155,19 +359,18 @@ void CConnectionManager::Stop(ConnectionPtr c)
 /// @description Stops all the connections registered with the connection
 ///		manager.
 /// @pre None
-/// @post The forward and reverse connection maps are empty, and all
+/// @post The connection table is empty, and all
 ///        connections that were contained within them are stopped.
 ///////////////////////////////////////////////////////////////////////////////
 void CConnectionManager::StopAll()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    while(m_connections.size() > 0)
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    BOOST_FOREACH(ConnectionPtr c, GetConnections())
     {
-      Stop((*m_connections.left.begin()).second); //Side effect of stop should make this map smaller
+        Stop(c);
     }
-    m_connections.clear();
     CListener::Instance().Stop();
-    Logger.Debug << "All Connections Closed" << std::endl;
+    FREEDM_LOG_DEBUG(Logger) << "All Connections Closed" << std::endl;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -180,45 +383,190 @@ void CConnectionManager::StopAll()
 ///        connections table and be started. If the connection is not
 ///        constructed there is no change to the connection table.
 ///		   Throws an exception of the connection couldn't be constructed.
+///        If the peer's hostname isn't in the resolve cache, the connection
+///        is created without an endpoint and holds its messages until the
+///        hostname is resolved in the background.
 /// @return A pointer to the connection
 ///////////////////////////////////////////////////////////////////////////////
 ConnectionPtr CConnectionManager::GetConnectionByUUID(std::string uuid)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     // See if there is a connection in the open connections already
     if(HasConnection(uuid))
-        return m_connections.left.at(uuid);
+        return GetConnection(FindPeer(uuid));
 
-    Logger.Info << "Making Fresh Connection to " << uuid << std::endl;
+    FREEDM_LOG_INFO(Logger) << "Making Fresh Connection to " << uuid << std::endl;
 
     // Find the requested host from the list of known hosts
-    std::map<std::string, SRemoteHost>::iterator mapIt;
-    mapIt = m_hosts.find(uuid);
-    if(mapIt == m_hosts.end())
+    SRemoteHost host;
     {
-        throw std::runtime_error("Couldn't find peer in hostlist: "+uuid);
+        boost::lock_guard< boost::mutex > scopedLock_( m_Mutex );
+        std::map<std::string, SRemoteHost>::iterator mapIt;
+        mapIt = m_hosts.find(uuid);
+        if(mapIt == m_hosts.end())
+        {
+            throw std::runtime_error("Couldn't find peer in hostlist: "+uuid);
+        }
+        host = mapIt->second;
     }
-    std::string s = mapIt->second.hostname;
-    std::string port = boost::lexical_cast<std::string>(mapIt->second.port);
 
 
     // Initiate the UDP connection
-    Logger.Debug<<"Computing remote endpoint"<<std::endl;
-    boost::asio::ip::udp::resolver resolver(CBroker::Instance().GetIOService());
-    boost::asio::ip::udp::resolver::query query(s, port);
+    FREEDM_LOG_DEBUG(Logger)<<"Computing remote endpoint"<<std::endl;
     boost::asio::ip::udp::endpoint endpoint;
-    try
+    if(!FindEndpoint(host, endpoint))
     {
-        endpoint = *resolver.resolve(query);
+        // Never block the scheduler on the resolver; the connection waits.
+        FREEDM_LOG_INFO(Logger)<<"Resolving "<<host.hostname<<":"<<host.port<<" for "<<uuid<<std::endl;
+        ConnectionPtr c = CreateConnection(uuid, endpoint);
+        Resolve(host);
+        return c;
     }
-    catch (boost::system::system_error& e)
+    FREEDM_LOG_INFO(Logger)<<"Resolved: "<<endpoint<<std::endl;
+    return CreateConnection(uuid,endpoint);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CConnectionManager::FindEndpoint
+/// @description Looks up the endpoint of a host in the resolve cache.
+/// @pre None
+/// @post None
+/// @param host The hostname and port to look up.
+/// @param endpoint Set to the endpoint of the host if it is cached.
+/// @return True if the host was resolved less than RESOLVE_TTL seconds ago.
+///////////////////////////////////////////////////////////////////////////////
+bool CConnectionManager::FindEndpoint(const SRemoteHost& host,
+                                      boost::asio::ip::udp::endpoint& endpoint)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    boost::lock_guard< boost::mutex > scopedLock_( m_Mutex );
+    resolvedmap::iterator it = m_resolved.find(host);
+    if(it == m_resolved.end() || it->second.expires.is_not_a_date_time() ||
+        it->second.expires < boost::posix_time::microsec_clock::universal_time())
     {
-        //Pass Couldn't resolve endpoint, let the protocol handle the bad connection
-        //Exception thrown if no endpoints found.
+        return false;
     }
-    Logger.Info<<"Resolved: "<<endpoint<<std::endl;
-    return CreateConnection(uuid,endpoint);
+    endpoint = it->second.endpoint;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CConnectionManager::Resolve
+/// @description Starts an asynchronous resolution of a host, unless the cache
+///     entry for it is fresh or a resolution is already in progress.
+/// @pre None
+/// @post HandleResolve will be called on the network strand.
+/// @param host The hostname and port to resolve.
+///////////////////////////////////////////////////////////////////////////////
+void CConnectionManager::Resolve(const SRemoteHost& host)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+    {
+        boost::lock_guard< boost::mutex > scopedLock_( m_Mutex );
+        SResolvedHost& entry = m_resolved[host];
+        if(entry.pending || (!entry.expires.is_not_a_date_time() && now < entry.expires))
+        {
+            return;
+        }
+        entry.pending = true;
+    }
+    boost::shared_ptr<boost::asio::ip::udp::resolver> resolver(
+        new boost::asio::ip::udp::resolver(CBroker::Instance().GetIOService()));
+    boost::asio::ip::udp::resolver::query query(host.hostname, host.port);
+    resolver->async_resolve(query, CBroker::Instance().GetNetworkStrand().wrap(
+        boost::bind(&CConnectionManager::HandleResolve, this, host, resolver, now,
+            boost::asio::placeholders::error, boost::asio::placeholders::iterator)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CConnectionManager::HandleResolve
+/// @description Completes a resolution started by Resolve. The endpoint is
+///     cached for RESOLVE_TTL seconds and given to the connections to the
+///     host that were created before it was known. If the host could not be
+///     resolved, those connections are stopped, as they would have been when
+///     their first write failed.
+/// @pre Called on the network strand.
+/// @post The waiting connections have an endpoint or are stopped.
+/// @param host The resolved hostname and port.
+/// @param resolver The resolver, kept alive until the handler runs.
+/// @param started When the resolution started.
+/// @param err The result of the resolution.
+/// @param it The resolved endpoints.
+///////////////////////////////////////////////////////////////////////////////
+void CConnectionManager::HandleResolve(SRemoteHost host,
+    boost::shared_ptr<boost::asio::ip::udp::resolver> /*resolver*/,
+    boost::posix_time::ptime started,
+    const boost::system::error_code& err,
+    boost::asio::ip::udp::resolver::iterator it)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+    bool resolved = !err && it != boost::asio::ip::udp::resolver::iterator();
+    boost::asio::ip::udp::endpoint endpoint;
+    std::vector<std::string> waiting;
+    {
+        boost::lock_guard< boost::mutex > scopedLock_( m_Mutex );
+        m_resolvetime += now - started;
+        m_resolvecount++;
+        SResolvedHost& entry = m_resolved[host];
+        entry.pending = false;
+        if(resolved)
+        {
+            endpoint = *it;
+            entry.endpoint = endpoint;
+            entry.expires = now + boost::posix_time::seconds(RESOLVE_TTL);
+        }
+        for(hostnamemap::iterator hit = m_hosts.begin(); hit != m_hosts.end(); hit++)
+        {
+            if(hit->second == host)
+            {
+                waiting.push_back(hit->first);
+            }
+        }
+    }
+    if(resolved)
+    {
+        FREEDM_LOG_INFO(Logger)<<"Resolved "<<host.hostname<<":"<<host.port<<" to "<<endpoint
+                   <<" in "<<(now - started)<<std::endl;
+    }
+    else
+    {
+        FREEDM_LOG_WARN(Logger)<<"Couldn't resolve "<<host.hostname<<":"<<host.port<<": "
+                   <<err.message()<<std::endl;
+    }
+    BOOST_FOREACH(const std::string& uuid, waiting)
+    {
+        ConnectionPtr c = GetConnection(FindPeer(uuid));
+        if(c && !c->IsResolved())
+        {
+            if(resolved)
+            {
+                c->SetEndpoint(endpoint);
+            }
+            else
+            {
+                Stop(c);
+            }
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CConnectionManager::GetResolveTime
+/// @description Reports how long the background hostname resolutions took.
+/// @pre None
+/// @post None
+/// @param count Set to the number of resolutions that completed.
+/// @return The total time spent resolving hostnames.
+///////////////////////////////////////////////////////////////////////////////
+boost::posix_time::time_duration CConnectionManager::GetResolveTime(unsigned int& count)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    boost::lock_guard< boost::mutex > scopedLock_( m_Mutex );
+    count = m_resolvecount;
+    return m_resolvetime;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -233,9 +581,10 @@ ConnectionPtr CConnectionManager::GetConnectionByUUID(std::string uuid)
 //////////////////////////////////////////////////////////////////////////////
 bool CConnectionManager::HasConnection(std::string uuid)
 {
-    if(m_connections.left.count(uuid))
+    ConnectionPtr c = GetConnection(FindPeer(uuid));
+    if(c)
     {
-        if(!m_connections.left.at(uuid)->GetStopped())
+        if(!c->GetStopped())
         {
             #ifdef CUSTOMNETWORK
             LoadNetworkConfig();
@@ -244,10 +593,10 @@ bool CConnectionManager::HasConnection(std::string uuid)
         }
         else
         {
-            Logger.Warn <<"Connection to " << uuid << " has gone stale " << std::endl;
+            FREEDM_LOG_WARN(Logger) <<"Connection to " << uuid << " has gone stale " << std::endl;
             //The socket is not marked as open anymore, we
             //should stop it.
-            Stop(m_connections.left.at(uuid));
+            Stop(c);
         }
     }
     return false;
@@ -261,18 +610,20 @@ bool CConnectionManager::HasConnection(std::string uuid)
 /// @param endpoint The network destination for the messages sent to this peer.
 /// @pre endpoint is a valid endpoint
 /// @post A new CConnection is created and bound to and endpoint. The resulting
-///		CConnection is inserted into the connection manager's map.
+///		CConnection is inserted into the connection manager's map. If another
+///     thread registered a connection first, that one is returned instead.
 ///////////////////////////////////////////////////////////////////////////////
 ConnectionPtr CConnectionManager::CreateConnection(std::string uuid, boost::asio::ip::udp::endpoint endpoint)
 {
     if(HasConnection(uuid))
-        return m_connections.left.at(uuid);
-    Logger.Warn<<"EP = "<<endpoint<<std::endl;
+        return GetConnection(FindPeer(uuid));
+    PeerId id = InternPeer(uuid);
+    FREEDM_LOG_WARN(Logger)<<"EP = "<<endpoint<<std::endl;
     // Create a new CConnection object for this host
-    Logger.Debug<<"Constructing CConnection"<<std::endl;
+    FREEDM_LOG_DEBUG(Logger)<<"Constructing CConnection"<<std::endl;
     ConnectionPtr c = boost::make_shared<CConnection>(uuid, endpoint);
     // Add to the connection list
-    PutConnection(uuid,c);
+    c = InsertConnection(id, c);
 #ifdef CUSTOMNETWORK
     LoadNetworkConfig();
 #endif
@@ -288,9 +639,9 @@ ConnectionPtr CConnectionManager::CreateConnection(std::string uuid, boost::asio
 ///////////////////////////////////////////////////////////////////////////////
 void CConnectionManager::ChangePhase(bool newround)
 {
-    for(connectionmap::left_iterator it = m_connections.left.begin(); it != m_connections.left.end(); it++)
+    BOOST_FOREACH(ConnectionPtr c, GetConnections())
     {
-        it->second->ChangePhase(newround);
+        c->ChangePhase(newround);
     }
 }
 
@@ -303,16 +654,17 @@ void CConnectionManager::ChangePhase(bool newround)
 ///////////////////////////////////////////////////////////////////////////////
 void CConnectionManager::LoadNetworkConfig()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     boost::property_tree::ptree pt;
     boost::property_tree::read_xml("network.xml",pt);
     BOOST_FOREACH(boost::property_tree::ptree::value_type & child, pt.get_child("network.outgoing"))
     {
         std::string uuid = child.second.get<std::string>("<xmlattr>.uuid");
         int reliability = child.second.get<int>("reliability");
-        if(m_connections.left.count(uuid) != 0)
+        ConnectionPtr c = GetConnection(FindPeer(uuid));
+        if(c)
         {
-            m_connections.left.at(uuid)->SetReliability(reliability);
+            c->SetReliability(reliability);
         }
     }
 }
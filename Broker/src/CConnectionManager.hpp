@@ -30,8 +30,9 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
-#include <boost/bimap.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/mutex.hpp>
@@ -53,13 +54,22 @@ public:
     /// Typedef for the map which handles uuid to hostname
     typedef std::map<std::string, SRemoteHost> hostnamemap;
 
-    /// Typedef for the map which handles uuid to connection
-    typedef boost::bimap<std::string, ConnectionPtr> connectionmap;
+    /// The interned identifier of a peer
+    typedef unsigned int PeerId;
+
+    /// The identifier FindPeer returns for a peer that has none
+    static const PeerId NO_PEER = static_cast<PeerId>(-1);
+
+    /// Typedef for the map which interns the peer uuids
+    typedef std::map<std::string, PeerId> peeridmap;
+
+    /// Typedef for one shard of the connection table, indexed by PeerId / CONNECTION_SHARDS
+    typedef std::vector<ConnectionPtr> connectiontable;
 
     /// Access the singleton instance of the connection manager
     static CConnectionManager& Instance();
 
-    /// Place a host/port and uuid into the host / uuid map.
+    /// Place a host/port and uuid into the host / uuid map and resolve it.
     void PutHost(std::string u, std::string host, std::string port);
 
     /// Place a host/port and uuid into the host / uuid map.
@@ -86,6 +96,15 @@ public:
     /// Returns true if this map is currently tracking a connection to this peer.
     bool HasConnection(std::string uuid);
 
+    /// Returns the interned identifier of a known host, assigning one if needed.
+    PeerId InternPeer(const std::string& uuid);
+
+    /// Returns the interned identifier of a peer, or NO_PEER, without assigning one.
+    PeerId FindPeer(const std::string& uuid);
+
+    /// Fetch the registered connection to a peer without creating one
+    ConnectionPtr GetConnection(PeerId id);
+
     /// An iterator to the beginning of the hostname map.
     hostnamemap::iterator GetHostsBegin() { return m_hosts.begin(); };
 
@@ -95,24 +114,79 @@ public:
     /// An iterator to the specified hostname.
     hostnamemap::iterator GetHost(std::string uuid) { return m_hosts.find(uuid); };
 
-    /// Iterator to the beginning of the connection map.
-    connectionmap::iterator GetConnectionsBegin() { return m_connections.begin(); };
+    /// Returns true if the peer is in the host list.
+    bool HasHost(const std::string& uuid);
 
-    /// Iterator to the end of the connections map.
-    connectionmap::iterator GetConnectionsEnd() { return m_connections.end(); };
+    /// Returns the time spent resolving hostnames and the number resolved.
+    boost::posix_time::time_duration GetResolveTime(unsigned int& count);
 
     // Transient Network Simulation
     /// Load a network configuration & apply it.
     void LoadNetworkConfig();
 
 private:
+    /// The number of independently locked parts of the connection table
+    static const unsigned int CONNECTION_SHARDS = 8;
+
+    /// How long (s) a resolved endpoint is used before it is resolved again
+    static const unsigned int RESOLVE_TTL = 300;
+
+    /// The cached resolution of a remote host
+    struct SResolvedHost
+    {
+        SResolvedHost() : pending(false) { }
+        /// The resolved endpoint
+        boost::asio::ip::udp::endpoint endpoint;
+        /// When the endpoint should be resolved again; not-a-date-time if never resolved
+        boost::posix_time::ptime expires;
+        /// True while a resolution is in progress
+        bool pending;
+    };
+
+    /// Typedef for the cache of resolved hosts
+    typedef std::map<SRemoteHost, SResolvedHost> resolvedmap;
+
+    /// A part of the connection table. Readers take a snapshot of the table
+    /// without locking; writers copy it under the mutex and publish the copy.
+    struct SShard
+    {
+        /// The current table, replaced rather than modified
+        boost::shared_ptr<const connectiontable> table;
+        /// Serializes the writers of the shard
+        boost::mutex mutex;
+    };
+
     /// Private constructor for the singleton instance
     CConnectionManager();
+    /// Registers c for a peer unless a running connection already is
+    ConnectionPtr InsertConnection(PeerId id, ConnectionPtr c);
+    /// Unregisters c if it is the connection registered for its peer
+    void RemoveConnection(ConnectionPtr c);
+    /// Returns every registered connection
+    std::vector<ConnectionPtr> GetConnections();
+    /// Looks up an unexpired endpoint for a host in the cache
+    bool FindEndpoint(const SRemoteHost& host, boost::asio::ip::udp::endpoint& endpoint);
+    /// Starts resolving a host in the background, unless it already is
+    void Resolve(const SRemoteHost& host);
+    /// Caches a resolved host and passes it to the connections waiting on it
+    void HandleResolve(SRemoteHost host,
+        boost::shared_ptr<boost::asio::ip::udp::resolver> resolver,
+        boost::posix_time::ptime started,
+        const boost::system::error_code& err,
+        boost::asio::ip::udp::resolver::iterator it);
     /// Mapping from uuid to host.
     hostnamemap m_hosts;
-    /// Forward map (UUID->Connection)
-    connectionmap m_connections;
-    /// Mutex for protecting the handler maps above
+    /// Resolved hosts, by hostname and port.
+    resolvedmap m_resolved;
+    /// Total time spent resolving hosts.
+    boost::posix_time::time_duration m_resolvetime;
+    /// The number of resolutions that completed.
+    unsigned int m_resolvecount;
+    /// Interned peer identifiers, replaced rather than modified
+    boost::shared_ptr<const peeridmap> m_peerids;
+    /// The connection table, sharded by PeerId
+    SShard m_shards[CONNECTION_SHARDS];
+    /// Mutex for protecting the host map, the resolve cache and the peer identifiers
     boost::mutex m_Mutex;
 };
 
@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CDatagramBatch.cpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Sends or receives several datagrams with one system call
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CDatagramBatch.hpp"
+
+#ifdef BATCHED_UDP
+
+#include <cstring>
+
+namespace freedm {
+
+namespace broker {
+
+///////////////////////////////////////////////////////////////////////////////
+/// CDatagramBatch
+/// @description Constructor for an empty batch.
+/// @pre None
+/// @post The batch holds no datagrams.
+///////////////////////////////////////////////////////////////////////////////
+CDatagramBatch::CDatagramBatch()
+    : m_count(0)
+{
+    //Pass
+}
+///////////////////////////////////////////////////////////////////////////////
+/// Add
+/// @description Points the next header of the batch at a datagram to send.
+///  The datagram is not copied.
+/// @pre data and to stay valid until the batch is sent or cleared.
+/// @post If the batch was not full, the datagram is the last one in it.
+/// @param data the contents of the datagram.
+/// @param length the size of the datagram.
+/// @param to the endpoint to send the datagram to.
+/// @return False if the batch already holds BATCH_SIZE datagrams.
+///////////////////////////////////////////////////////////////////////////////
+bool CDatagramBatch::Add(const char* data, std::size_t length,
+    const boost::asio::ip::udp::endpoint& to)
+{
+    if(m_count == BATCH_SIZE)
+    {
+        return false;
+    }
+    // sendmmsg does not write to the datagrams, though iovec is not const.
+    m_iovecs[m_count].iov_base = const_cast<char*>(data);
+    m_iovecs[m_count].iov_len = length;
+    std::memset(&m_msgs[m_count], 0, sizeof(mmsghdr));
+    m_msgs[m_count].msg_hdr.msg_iov = &m_iovecs[m_count];
+    m_msgs[m_count].msg_hdr.msg_iovlen = 1;
+    m_msgs[m_count].msg_hdr.msg_name = const_cast<sockaddr*>(to.data());
+    m_msgs[m_count].msg_hdr.msg_namelen = to.size();
+    m_count++;
+    return true;
+}
+///////////////////////////////////////////////////////////////////////////////
+/// Send
+/// @description Sends the datagrams of the batch, in order, with sendmmsg.
+/// @pre The batch is not empty.
+/// @post The datagrams the kernel took are sent. The batch is unchanged.
+/// @param socket the native handle of the socket to send on.
+/// @return The number of datagrams sent from the front of the batch, or -1
+///  with errno set if the first one could not be sent.
+///////////////////////////////////////////////////////////////////////////////
+int CDatagramBatch::Send(int socket)
+{
+    return ::sendmmsg(socket, m_msgs, m_count, 0);
+}
+///////////////////////////////////////////////////////////////////////////////
+/// Receive
+/// @description Reads up to BATCH_SIZE datagrams with one recvmmsg call,
+///  without waiting for any. Datagram i is read into the buffer at offset
+///  i * size.
+/// @pre buffer holds BATCH_SIZE * size bytes.
+/// @post GetLength and GetSender describe the datagrams read.
+/// @param socket the native handle of the socket to read from.
+/// @param buffer where to read the datagrams into.
+/// @param size the most bytes read of each datagram.
+/// @return The number of datagrams read, or -1 with errno set if none were
+///  waiting or the read failed.
+///////////////////////////////////////////////////////////////////////////////
+int CDatagramBatch::Receive(int socket, char* buffer, std::size_t size)
+{
+    for(unsigned int i = 0; i < BATCH_SIZE; i++)
+    {
+        m_iovecs[i].iov_base = buffer + i * size;
+        m_iovecs[i].iov_len = size;
+        std::memset(&m_msgs[i], 0, sizeof(mmsghdr));
+        m_msgs[i].msg_hdr.msg_iov = &m_iovecs[i];
+        m_msgs[i].msg_hdr.msg_iovlen = 1;
+        m_msgs[i].msg_hdr.msg_name = &m_addrs[i];
+        m_msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+    }
+    int count = ::recvmmsg(socket, m_msgs, BATCH_SIZE, MSG_DONTWAIT, 0);
+    m_count = count > 0 ? count : 0;
+    return count;
+}
+///////////////////////////////////////////////////////////////////////////////
+/// GetLength
+/// @description Gives the size of a datagram read by Receive.
+/// @pre index is less than the count Receive returned.
+/// @post None
+/// @param index the position of the datagram in the batch.
+/// @return The number of bytes read into the datagram's part of the buffer.
+///////////////////////////////////////////////////////////////////////////////
+std::size_t CDatagramBatch::GetLength(unsigned int index) const
+{
+    return m_msgs[index].msg_len;
+}
+///////////////////////////////////////////////////////////////////////////////
+/// GetSender
+/// @description Gives the address a datagram read by Receive came from.
+/// @pre index is less than the count Receive returned.
+/// @post None
+/// @param index the position of the datagram in the batch.
+/// @return The endpoint of the sender.
+///////////////////////////////////////////////////////////////////////////////
+boost::asio::ip::udp::endpoint CDatagramBatch::GetSender(unsigned int index) const
+{
+    boost::asio::ip::udp::endpoint from;
+    std::memcpy(from.data(), &m_addrs[index], m_msgs[index].msg_hdr.msg_namelen);
+    from.resize(m_msgs[index].msg_hdr.msg_namelen);
+    return from;
+}
+
+} // namespace broker
+
+} // namespace freedm
+
+#endif // BATCHED_UDP
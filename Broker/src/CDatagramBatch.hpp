@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CDatagramBatch.hpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Sends or receives several datagrams with one system call
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CDATAGRAMBATCH_HPP
+#define CDATAGRAMBATCH_HPP
+
+#include "config.hpp"
+
+#ifdef BATCHED_UDP
+
+#include <cstddef>
+
+#include <sys/socket.h>
+
+#include <boost/asio/ip/udp.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace freedm {
+
+namespace broker {
+
+/// The message headers of one sendmmsg or recvmmsg call
+class CDatagramBatch
+    : private boost::noncopyable
+{
+public:
+    /// The most datagrams passed to a single sendmmsg or recvmmsg call
+    static const unsigned int BATCH_SIZE = 16;
+
+    /// Creates an empty batch
+    CDatagramBatch();
+
+    /// Adds a datagram to send, if the batch is not full
+    bool Add(const char* data, std::size_t length,
+        const boost::asio::ip::udp::endpoint& to);
+
+    /// Returns how many datagrams were added or received
+    unsigned int GetCount() const { return m_count; }
+
+    /// Removes the datagrams added to the batch
+    void Clear() { m_count = 0; }
+
+    /// Sends the added datagrams with one sendmmsg call
+    int Send(int socket);
+
+    /// Reads the datagrams waiting on a socket with one recvmmsg call
+    int Receive(int socket, char* buffer, std::size_t size);
+
+    /// The length of a received datagram
+    std::size_t GetLength(unsigned int index) const;
+
+    /// The endpoint a received datagram came from
+    boost::asio::ip::udp::endpoint GetSender(unsigned int index) const;
+
+private:
+    /// The header of each datagram
+    mmsghdr m_msgs[BATCH_SIZE];
+
+    /// The contents of each datagram
+    iovec m_iovecs[BATCH_SIZE];
+
+    /// The address each received datagram came from
+    sockaddr_storage m_addrs[BATCH_SIZE];
+
+    /// The number of datagrams in the batch
+    unsigned int m_count;
+};
+
+} // namespace broker
+
+} // namespace freedm
+
+#endif // BATCHED_UDP
+
+#endif // CDATAGRAMBATCH_HPP
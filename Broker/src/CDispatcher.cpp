@@ -24,11 +24,18 @@
 
 #include "CBroker.hpp"
 #include "CDispatcher.hpp"
+#include "CEventLog.hpp"
 #include "CGlobalPeerList.hpp"
 #include "CLogger.hpp"
 #include "IDGIModule.hpp"
+#include "Messages.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 #include <boost/bind.hpp>
+#include <boost/foreach.hpp>
 #include <boost/smart_ptr/shared_ptr.hpp>
 #include <boost/thread/locks.hpp>
 
@@ -55,6 +62,21 @@ CDispatcher& CDispatcher::Instance()
     return dispatcher;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// CDispatcher::CDispatcher
+/// @description Creates an empty handler table with a slot for every
+///     recipient id. Inbound queues are unbounded until a limit is set.
+/// @pre None
+/// @post m_handlers can be indexed by any RecipientId.
+///////////////////////////////////////////////////////////////////////////////
+CDispatcher::CDispatcher()
+    : m_handlers(ModuleMessage::RecipientId_MAX + 1)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    m_defaultlimit.limit = 0;
+    m_defaultlimit.policy = DROP_OLDEST;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// CDispatcher::HandleRequest
 /// @description Given an input property tree determine which handlers should
@@ -65,55 +87,275 @@ CDispatcher& CDispatcher::Instance()
 /// @param msg The message to distribute to modules.
 /// @param uuid The UUID of the DGI that sent the message.
 ///////////////////////////////////////////////////////////////////////////////
-void CDispatcher::HandleRequest(boost::shared_ptr<const ModuleMessage> msg, std::string uuid)
+void CDispatcher::HandleRequest(boost::shared_ptr<const ModuleMessage> msg,
+    const std::string& uuid)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    Logger.Debug << "Processing message addressed to: " << msg->recipient_module() << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_DEBUG(Logger) << "Processing message addressed to: " << msg->recipient_module() << std::endl;
+
+    CEventLog::Instance().MessageReceived(*msg, uuid);
+    const RegistrationList* targets = FindTargets(*msg);
 
-    bool processed = false;
+    if(targets == NULL || targets->empty())
+    {
+        FREEDM_LOG_WARN(Logger) << "Message was not processed by any module:\n" << msg->DebugString();
+        return;
+    }
 
-    for(std::multimap<boost::shared_ptr<IDGIModule>, const std::string>::const_iterator it
-            = m_registrations.begin();
-        it != m_registrations.end(); ++it)
+    BOOST_FOREACH(const RegistrationPtr& r, *targets)
     {
-        if (it->second == msg->recipient_module() || msg->recipient_module() == "all")
+        Deliver(r, msg, uuid);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CDispatcher::IsAccepting
+/// @description Checks whether a message can be queued for the modules it is
+///   addressed to. A message is refused only when one of those modules has a
+///   full inbound queue with the REJECT policy; the listener then reports the
+///   refusal to the sender, which backs off and sends the message again.
+///   Senders that cannot read refusals are left unacknowledged instead.
+/// @pre None
+/// @post The registrations the message is for are resolved.
+/// @param msg The message that is about to be accepted.
+/// @return False if the message should be refused.
+///////////////////////////////////////////////////////////////////////////////
+bool CDispatcher::IsAccepting(const ModuleMessage& msg)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    const RegistrationList* targets = FindTargets(msg);
+    if(targets == NULL)
+    {
+        return true;
+    }
+
+    BOOST_FOREACH(RegistrationPtr r, *targets)
+    {
+        Resolve(*r);
+        if(r->queue.policy != REJECT || r->queue.limit == 0)
+            continue;
+
+        boost::mutex::scoped_lock lock(m_queuemutex);
+        if(r->inbox.size() >= r->queue.limit)
         {
-            // Scheduled modules receive messages only during that module's phase.
-            // Unscheduled modules receive messages immediately.
-            if (CBroker::Instance().IsModuleRegistered(it->second))
-            {
-                CBroker::Instance().Schedule(
-                    it->second,
-                    boost::bind(
-                        &CDispatcher::ReadHandlerCallback, this, it->first, msg, uuid));
-            }
-            else
+            r->stats.rejected++;
+            return false;
+        }
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CDispatcher::FindTargets
+/// @description Finds the registrations for the module a message is addressed
+///   to, by its recipient id or, for DGIs which predate the id, by name.
+/// @pre None
+/// @post None
+/// @param msg The message to look up.
+/// @return The registrations for the recipient, or NULL if there are none.
+///////////////////////////////////////////////////////////////////////////////
+const CDispatcher::RegistrationList* CDispatcher::FindTargets(const ModuleMessage& msg) const
+{
+    ModuleMessage::RecipientId id = msg.has_recipient_id() ? msg.recipient_id()
+        : GetRecipientId(msg.recipient_module());
+
+    if(id == ModuleMessage::UNKNOWN_MODULE)
+    {
+        std::map<std::string, RegistrationList>::const_iterator it
+            = m_unknown.find(msg.recipient_module());
+        return (it != m_unknown.end() ? &it->second : NULL);
+    }
+    else if(id != ModuleMessage::ALL_MODULES)
+    {
+        return &m_handlers[id];
+    }
+    return &m_registrations;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CDispatcher::Resolve
+/// @description Looks up the broker's index and cost class for a registration
+///     and its queue bound. This is done on its first message, since the
+///     broker registers the synchronizer while it is still being constructed.
+/// @pre Called from the network strand.
+/// @post r.resolved is true.
+/// @param r The registration to resolve.
+///////////////////////////////////////////////////////////////////////////////
+void CDispatcher::Resolve(SRegistration& r)
+{
+    if(r.resolved)
+        return;
+
+    r.module = CBroker::Instance().GetModuleIndex(r.id);
+    r.cost = CBroker::Instance().GetCostClass(r.id, "read");
+    std::map<std::string, SQueueLimit>::const_iterator it = m_limits.find(r.id);
+    r.queue = (it != m_limits.end() ? it->second : m_defaultlimit);
+    r.resolved = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CDispatcher::Deliver
+/// @description Delivers a message to a registered module. Unscheduled modules
+///     receive it immediately. Messages for scheduled modules with a queue
+///     limit wait in the registration's inbound queue, which is read by one
+///     task at a time, so the broker's ready queue holds at most one read
+///     task per registration however many messages a peer sends. Without a
+///     limit, the default, each message is scheduled as its own read task.
+/// @pre None
+/// @post Message is scheduled to be delivered to the module, unless its
+///     inbound queue is full and the queue's policy discards it.
+/// @param r The registration that receives the message.
+/// @param msg The message to deliver.
+/// @param uuid The UUID of the DGI that sent the message.
+///////////////////////////////////////////////////////////////////////////////
+void CDispatcher::Deliver(const RegistrationPtr& r,
+    const boost::shared_ptr<const ModuleMessage>& msg, const std::string& uuid)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    Resolve(*r);
+
+    // Scheduled modules receive messages only during that module's phase.
+    // Unscheduled modules receive messages immediately.
+    if (!CBroker::Instance().IsModuleRegistered(r->module))
+    {
+        ReadHandlerCallback(r->handler, msg, uuid);
+        return;
+    }
+
+    SInbound in;
+    in.msg = msg;
+    in.uuid = uuid;
+
+    bool schedule = false;
+    {
+        boost::mutex::scoped_lock lock(m_queuemutex);
+        if(r->queue.limit == 0 && !r->draining)
+        {
+            // An unlimited queue would only add a copy and a lock per
+            // message, so each message is its own read task. A queue left
+            // over from an earlier limit is drained first, to keep the order.
+            lock.unlock();
+            CBroker::Instance().Schedule(r->module, r->cost,
+                boost::bind(&CDispatcher::ReadHandlerCallback, this, r->handler, msg, uuid));
+            return;
+        }
+        if(r->queue.limit > 0 && r->inbox.size() >= r->queue.limit && !MakeRoom(*r, in))
+        {
+            return;
+        }
+        r->inbox.push_back(in);
+        r->stats.peak = std::max<unsigned int>(r->stats.peak, r->inbox.size());
+        schedule = !r->draining;
+        r->draining = true;
+    }
+
+    // The broker's lock is taken without holding the queue lock.
+    if(schedule)
+    {
+        CBroker::Instance().Schedule(r->module, r->cost,
+            boost::bind(&CDispatcher::Drain, this, r));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CDispatcher::MakeRoom
+/// @description Applies the policy of a full inbound queue to a message that
+///     has arrived for it. DROP_OLDEST discards the front of the queue.
+///     COALESCE replaces the oldest queued message from the same peer with the
+///     same type as the new one, which supersedes it, in place, so the queue
+///     keeps its order; if there is none, the new message is discarded.
+///     REJECT discards the new message. The listener checks IsAccepting for
+///     every module message a peer sends, including those released from the
+///     reorder buffer and those reassembled from fragments, and refuses it
+///     rather than delivering it, so only local and multicast messages are
+///     discarded here.
+/// @pre m_queuemutex is held by the caller and the inbox is full.
+/// @post The inbox has room for the message if true is returned.
+/// @param r The registration whose inbox is full.
+/// @param in The message that arrived.
+/// @return True if the message should be appended to the queue.
+///////////////////////////////////////////////////////////////////////////////
+bool CDispatcher::MakeRoom(SRegistration& r, const SInbound& in)
+{
+    if(r.queue.policy == DROP_OLDEST)
+    {
+        FREEDM_LOG_INFO(Logger) << "Inbound queue for " << r.id << " is full, dropping the "
+                    << "message from " << r.inbox.front().uuid << std::endl;
+        r.inbox.pop_front();
+        r.stats.dropped++;
+        return true;
+    }
+    else if(r.queue.policy == COALESCE)
+    {
+        std::pair<int, int> type = GetMessageType(*in.msg);
+        for(std::deque<SInbound>::iterator it = r.inbox.begin(); it != r.inbox.end(); it++)
+        {
+            if(it->uuid == in.uuid && GetMessageType(*it->msg) == type)
             {
-                ReadHandlerCallback(it->first, msg, uuid);
+                *it = in;
+                r.stats.coalesced++;
+                return false;
             }
-            processed = true;
         }
     }
+    FREEDM_LOG_INFO(Logger) << "Inbound queue for " << r.id << " is full, dropping the "
+                << "message from " << in.uuid << std::endl;
+    r.stats.dropped++;
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CDispatcher::Drain
+/// @description Hands the oldest message of an inbound queue to its module.
+///     If more messages wait, another read task is scheduled behind the
+///     module's other ready tasks, so a long queue is read interleaved with
+///     the module's own work and its cost is estimated per message.
+/// @pre Scheduled by Deliver or Drain, and r->draining is true.
+/// @post One message has been handed to the module.
+/// @param r The registration whose inbox is read.
+///////////////////////////////////////////////////////////////////////////////
+void CDispatcher::Drain(RegistrationPtr r)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
-    if( processed == false )
+    SInbound in;
+    bool more = false;
     {
-        Logger.Warn << "Message was not processed by any module:\n" << msg->DebugString();
+        boost::mutex::scoped_lock lock(m_queuemutex);
+        if(r->inbox.empty())
+        {
+            r->draining = false;
+            return;
+        }
+        in = r->inbox.front();
+        r->inbox.pop_front();
+        more = !r->inbox.empty();
+        r->draining = more;
     }
 
+    if(more)
+    {
+        CBroker::Instance().Schedule(r->module, r->cost,
+            boost::bind(&CDispatcher::Drain, this, r));
+    }
+    ReadHandlerCallback(r->handler, in.msg, in.uuid);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 /// CDispatcher::ReadHandlerCallback
 /// @description Calls the receiving module's message handler for the received
-///		message. 
+///		message. The arguments are references, so a message delivered at once
+///		is not copied; a scheduled delivery binds its own copies.
 /// @param h The module that will receive the message.
 /// @param msg The message to deliver to that module.
 /// @param uuid the UUID of the peer that sent the message.
 ///////////////////////////////////////////////////////////////////////////////
-void CDispatcher::ReadHandlerCallback(
-    boost::shared_ptr<IDGIModule> h, boost::shared_ptr<const ModuleMessage> msg, std::string uuid)
+void CDispatcher::ReadHandlerCallback(const boost::shared_ptr<IDGIModule>& h,
+    const boost::shared_ptr<const ModuleMessage>& msg, const std::string& uuid)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     CPeerNode peer;
     try
     {
@@ -121,9 +363,9 @@ void CDispatcher::ReadHandlerCallback(
     }
     catch(std::runtime_error& e)
     {
-        if(CGlobalPeerList::instance().begin() == CGlobalPeerList::instance().end())
+        if(CGlobalPeerList::instance().Empty())
         {
-            Logger.Info<<"Didn't have a peer to construct the new peer from (might be ok)"<<std::endl;
+            FREEDM_LOG_INFO(Logger)<<"Didn't have a peer to construct the new peer from (might be ok)"<<std::endl;
             return;
         }
         peer = CGlobalPeerList::instance().Create(uuid);
@@ -144,9 +386,114 @@ void CDispatcher::ReadHandlerCallback(
 void CDispatcher::RegisterReadHandler(
     boost::shared_ptr<IDGIModule> handler, std::string id)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    Logger.Debug << "Registered module listening on " << id << std::endl;
-    m_registrations.insert(std::make_pair(handler,id));
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_DEBUG(Logger) << "Registered module listening on " << id << std::endl;
+
+    RegistrationPtr r(new SRegistration);
+    r->handler = handler;
+    r->id = id;
+    r->module = 0;
+    r->cost = 0;
+    r->resolved = false;
+    r->draining = false;
+
+    ModuleMessage::RecipientId rid = GetRecipientId(id);
+    if(rid == ModuleMessage::UNKNOWN_MODULE)
+    {
+        m_unknown[id].push_back(r);
+    }
+    else
+    {
+        m_handlers[rid].push_back(r);
+    }
+    m_registrations.push_back(r);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CDispatcher::SetQueueLimit
+/// @description Bounds the inbound queue of every module registered for an
+///     identifier. A module registered for several identifiers has a queue
+///     for each of them.
+/// @pre No message has been delivered for the identifier yet.
+/// @post Queues for the identifier hold at most limit messages.
+/// @param id The identifier the modules registered for.
+/// @param limit The most messages queued at once, or 0 for no bound.
+/// @param policy What to do with messages that arrive for a full queue.
+///////////////////////////////////////////////////////////////////////////////
+void CDispatcher::SetQueueLimit(std::string id, unsigned int limit, QueuePolicy policy)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    SQueueLimit q;
+    q.limit = limit;
+    q.policy = policy;
+    m_limits[id] = q;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CDispatcher::SetDefaultQueueLimit
+/// @description Bounds the inbound queues of identifiers without a limit set
+///     by SetQueueLimit.
+/// @pre No message has been delivered yet.
+/// @post Queues without their own limit hold at most limit messages.
+/// @param limit The most messages queued at once, or 0 for no bound.
+/// @param policy What to do with messages that arrive for a full queue.
+///////////////////////////////////////////////////////////////////////////////
+void CDispatcher::SetDefaultQueueLimit(unsigned int limit, QueuePolicy policy)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    m_defaultlimit.limit = limit;
+    m_defaultlimit.policy = policy;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CDispatcher::GetQueueStats
+/// @description Returns the statistics of the inbound queues of the modules
+///     registered for an identifier, added together.
+/// @pre None
+/// @post None
+/// @param id The identifier the modules registered for.
+/// @return The combined queue statistics.
+///////////////////////////////////////////////////////////////////////////////
+CDispatcher::SQueueStats CDispatcher::GetQueueStats(std::string id)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    SQueueStats total;
+    boost::mutex::scoped_lock lock(m_queuemutex);
+    BOOST_FOREACH(RegistrationPtr r, m_registrations)
+    {
+        if(r->id != id)
+            continue;
+        total.depth += r->inbox.size();
+        total.peak += r->stats.peak;
+        total.dropped += r->stats.dropped;
+        total.coalesced += r->stats.coalesced;
+        total.rejected += r->stats.rejected;
+    }
+    return total;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CDispatcher::LogQueueStatistics
+/// @description Writes the depth, the peak depth and the discarded messages of
+///     every inbound queue to the log. The broker calls this at the start of
+///     each round, so the peak is the deepest the queue got during the round.
+/// @pre None
+/// @post The peaks restart from the current depths.
+///////////////////////////////////////////////////////////////////////////////
+void CDispatcher::LogQueueStatistics()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    boost::mutex::scoped_lock lock(m_queuemutex);
+    BOOST_FOREACH(RegistrationPtr r, m_registrations)
+    {
+        if(r->stats.peak == 0 && r->stats.dropped == 0 && r->stats.rejected == 0)
+            continue;
+        FREEDM_LOG_INFO(Logger)<<"Inbound queue for "<<r->id<<": depth "<<r->inbox.size()
+                   <<" peak "<<r->stats.peak<<" dropped "<<r->stats.dropped
+                   <<" coalesced "<<r->stats.coalesced
+                   <<" rejected "<<r->stats.rejected<<std::endl;
+        r->stats.peak = r->inbox.size();
+    }
 }
 
     } //namespace broker
@@ -40,8 +40,10 @@
 #include <boost/smart_ptr/shared_ptr.hpp>
 #include <boost/thread/mutex.hpp>
 
+#include <deque>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace freedm {
     namespace broker {
@@ -53,27 +55,144 @@ class CDispatcher
   : private boost::noncopyable
 {
 public:
+    /// What happens to a message that arrives for a full inbound queue
+    enum QueuePolicy
+    {
+        /// Discard the oldest queued message to make room
+        DROP_OLDEST,
+        /// Replace a queued message of the same type from the same peer
+        COALESCE,
+        /// Refuse the message so the peer sends it again later
+        REJECT
+    };
+
+    /// The inbound queue of one registration, as reported each round
+    struct SQueueStats
+    {
+        SQueueStats() : depth(0), peak(0), dropped(0), coalesced(0), rejected(0) { }
+        /// Messages waiting for the module
+        unsigned int depth;
+        /// Most messages waiting at once since the last report
+        unsigned int peak;
+        /// Messages discarded because the queue was full
+        unsigned long dropped;
+        /// Queued messages replaced by a newer one of the same type
+        unsigned long coalesced;
+        /// Messages refused because the queue was full
+        unsigned long rejected;
+    };
+
     /// Access the singleton instance of the CDispatcher
     static CDispatcher& Instance();
 
     /// Schedules a message delivery to the receiving modules.
-    void HandleRequest(boost::shared_ptr<const ModuleMessage> msg, std::string uuid);
+    void HandleRequest(boost::shared_ptr<const ModuleMessage> msg, const std::string& uuid);
+
+    /// Checks whether the modules a message is for have room to queue it.
+    bool IsAccepting(const ModuleMessage& msg);
 
     /// Registers a module's identifier with the dispatcher.
     void RegisterReadHandler(boost::shared_ptr<IDGIModule> p_handler, std::string id);
 
+    /// Bounds the inbound queue of the modules registered for an identifier.
+    void SetQueueLimit(std::string id, unsigned int limit, QueuePolicy policy);
+
+    /// Bounds the inbound queues without a limit of their own.
+    void SetDefaultQueueLimit(unsigned int limit, QueuePolicy policy);
+
+    /// Returns the combined inbound queue statistics of an identifier.
+    SQueueStats GetQueueStats(std::string id);
+
+    /// Writes the inbound queue statistics to the log and resets the peaks.
+    void LogQueueStatistics();
+
 private:
+    /// A message waiting for a module's phase
+    struct SInbound
+    {
+        /// The message
+        boost::shared_ptr<const ModuleMessage> msg;
+        /// The UUID of the DGI that sent the message
+        std::string uuid;
+    };
+
+    /// A queue bound and the policy applied when it is reached
+    struct SQueueLimit
+    {
+        /// The most messages queued at once, or 0 for no bound
+        unsigned int limit;
+        /// What to do with messages that arrive when the queue is full
+        QueuePolicy policy;
+    };
+
+    /// A module registered to receive the messages addressed to an identifier
+    struct SRegistration
+    {
+        /// The module that receives the messages
+        boost::shared_ptr<IDGIModule> handler;
+        /// The identifier the module registered for
+        std::string id;
+        /// The broker's index for the identifier, whose phase delivers them
+        unsigned int module;
+        /// The broker's cost class for reading a message
+        unsigned int cost;
+        /// True once module, cost and queue have been looked up
+        bool resolved;
+        /// The bound of the inbound queue
+        SQueueLimit queue;
+        /// Messages waiting for the module's phase, guarded by m_queuemutex
+        std::deque<SInbound> inbox;
+        /// True while a task to read the inbox is scheduled
+        bool draining;
+        /// Statistics of the inbox, guarded by m_queuemutex
+        SQueueStats stats;
+    };
+
+    typedef boost::shared_ptr<SRegistration> RegistrationPtr;
+    typedef std::vector<RegistrationPtr> RegistrationList;
+
     /// Private constructor for the singleton instance
-    CDispatcher() {};
+    CDispatcher();
+
+    /// Finds the registrations a message is addressed to.
+    const RegistrationList* FindTargets(const ModuleMessage& msg) const;
+
+    /// Looks up the broker's indexes and the queue bound of a registration.
+    void Resolve(SRegistration& r);
+
+    /// Schedules the delivery of a message to one registration.
+    void Deliver(const RegistrationPtr& r,
+        const boost::shared_ptr<const ModuleMessage>& msg, const std::string& uuid);
+
+    /// Makes room for a message in a full inbox, requires m_queuemutex.
+    bool MakeRoom(SRegistration& r, const SInbound& in);
+
+    /// Hands the oldest message of an inbox to its module.
+    void Drain(RegistrationPtr r);
 
     /// Making the handler calls bindable
     void ReadHandlerCallback(
-        boost::shared_ptr<IDGIModule> h,
-        boost::shared_ptr<const ModuleMessage> msg,
-        std::string uuid);
+        const boost::shared_ptr<IDGIModule>& h,
+        const boost::shared_ptr<const ModuleMessage>& msg,
+        const std::string& uuid);
+
+    /// Registrations for identifiers with a recipient id, indexed by the id.
+    std::vector<RegistrationList> m_handlers;
+
+    /// Registrations for identifiers without a recipient id.
+    std::map<std::string, RegistrationList> m_unknown;
+
+    /// Every registration, in order, for messages addressed to "all".
+    RegistrationList m_registrations;
+
+    /// Queue bounds set for particular identifiers.
+    std::map<std::string, SQueueLimit> m_limits;
+
+    /// Queue bound of identifiers without one of their own.
+    SQueueLimit m_defaultlimit;
 
-    /// Reverse map to get the calling module from the handler pointer.
-    std::multimap<boost::shared_ptr<IDGIModule>, const std::string> m_registrations;
+    /// Lock for the inboxes, which the network and module threads share.
+    boost::mutex m_queuemutex;
 };
 
 } // namespace broker
@@ -0,0 +1,504 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CEventLog.cpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Records structured events to a memory mapped binary file.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CEventLog.hpp"
+
+#include "CGlobalConfiguration.hpp"
+#include "CLogger.hpp"
+#include "Messages.hpp"
+#include "messages/ModuleMessage.pb.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/locks.hpp>
+
+namespace freedm {
+namespace broker {
+
+namespace {
+
+/// This file's logger.
+CLocalLogger Logger(__FILE__);
+
+/// Copies a string into a fixed size field, truncating it to fit.
+template <std::size_t N>
+void CopyField(char (&field)[N], const std::string& s)
+{
+    std::memcpy(field, s.data(), std::min(N, s.size()));
+}
+
+/// Describes the error of the last system call.
+std::string SystemError(const std::string& what, const std::string& path)
+{
+    return what + " " + path + ": " + std::strerror(errno);
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CEventLog::Instance
+/// @description Gets the event log, which is closed until Open is called.
+/// @pre None
+/// @post None
+/// @return The instance of the event log.
+///////////////////////////////////////////////////////////////////////////////
+CEventLog& CEventLog::Instance()
+{
+    static CEventLog singleton;
+    return singleton;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CEventLog::CEventLog
+/// @description Creates a closed event log.
+/// @pre None
+/// @post None
+///////////////////////////////////////////////////////////////////////////////
+CEventLog::CEventLog()
+    : m_capacity(0)
+    , m_files(0)
+    , m_fd(-1)
+    , m_base(NULL)
+    , m_header(NULL)
+    , m_records(NULL)
+    , m_sequence(0)
+    , m_open(false)
+{
+    //pass
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CEventLog::~CEventLog
+/// @description Trims the current file when the program exits.
+/// @pre None
+/// @post The log is closed.
+///////////////////////////////////////////////////////////////////////////////
+CEventLog::~CEventLog()
+{
+    Close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CEventLog::Open
+/// @description Creates the first file of the log, replacing any file at the
+///     path, and starts recording events to it.
+/// @ErrorHandling Throws a std::runtime_error if the file can't be created or
+///     mapped.
+/// @pre The log is closed.
+/// @post Events are recorded to path.
+/// @param path where the current file of the log is written.
+/// @param filesize the size each file is capped at, in bytes.
+/// @param files the number of full files kept besides the current one.
+/// @param uuid the UUID of this DGI, for the header of each file.
+///////////////////////////////////////////////////////////////////////////////
+void CEventLog::Open(const std::string& path, std::size_t filesize,
+        unsigned int files, const std::string& uuid)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    if(m_base != NULL)
+    {
+        throw std::runtime_error("The event log is already open");
+    }
+    if(filesize < 2 * sizeof(SEventRecord))
+    {
+        throw std::runtime_error("The event log size is too small for a record");
+    }
+
+    m_path = path;
+    m_uuid = uuid;
+    m_capacity = filesize / sizeof(SEventRecord) - 1;
+    m_files = files;
+    Map();
+    m_open = true;
+
+    FREEDM_LOG_STATUS(Logger) << "Recording events to " << m_path << " ("
+            << m_capacity << " events per file)" << std::endl;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CEventLog::Close
+/// @description Stops recording events. The current file is trimmed to the
+///     records written to it. The broker calls this before it exits on a
+///     signal.
+/// @pre None
+/// @post Events are ignored.
+///////////////////////////////////////////////////////////////////////////////
+void CEventLog::Close()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_open = false;
+    Unmap();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CEventLog::PhaseChange
+/// @description Records the start of a module's phase.
+/// @pre None
+/// @post The event is recorded if the log is open.
+/// @param module the identifier of the module which owns the phase.
+/// @param count the number of phases started since the broker ran.
+/// @param late how late the phase started, in milliseconds.
+/// @param duration how long the phase is scheduled for, in milliseconds.
+///////////////////////////////////////////////////////////////////////////////
+void CEventLog::PhaseChange(const std::string& module, unsigned long count,
+        unsigned int late, unsigned int duration)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    if(!IsOpen())
+        return;
+
+    SEventRecord r = SEventRecord();
+    r.type = EVENT_PHASE_CHANGE;
+    r.module = GetRecipientId(module);
+    r.code = static_cast<boost::int32_t>(count);
+    r.detail = late;
+    r.value = duration;
+    CopyField(r.subject, module);
+    Append(r);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CEventLog::MessageSent
+/// @description Records a module message sent to a peer, including this DGI.
+/// @pre None
+/// @post The event is recorded if the log is open.
+/// @param msg the message that was sent.
+/// @param peer the UUID of the receiver.
+///////////////////////////////////////////////////////////////////////////////
+void CEventLog::MessageSent(const ModuleMessage& msg, const std::string& peer)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    if(IsOpen())
+    {
+        Message(EVENT_MESSAGE_SENT, msg, peer);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CEventLog::MessageReceived
+/// @description Records a module message handed to the dispatcher.
+/// @pre None
+/// @post The event is recorded if the log is open.
+/// @param msg the message that was received.
+/// @param peer the UUID of the sender.
+///////////////////////////////////////////////////////////////////////////////
+void CEventLog::MessageReceived(const ModuleMessage& msg, const std::string& peer)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    if(IsOpen())
+    {
+        Message(EVENT_MESSAGE_RECEIVED, msg, peer);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CEventLog::StateChange
+/// @description Records a module's change of state. What the states and the
+///     value mean is up to the module.
+/// @pre None
+/// @post The event is recorded if the log is open.
+/// @param module the ModuleMessage::RecipientId of the module.
+/// @param state the new state.
+/// @param previous the state before the change.
+/// @param subject the module's view of its group, such as the coordinator.
+/// @param value a measure of the new state, such as the size of the group.
+///////////////////////////////////////////////////////////////////////////////
+void CEventLog::StateChange(int module, int state, int previous,
+        const std::string& subject, double value)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    if(!IsOpen())
+        return;
+
+    SEventRecord r = SEventRecord();
+    r.type = EVENT_STATE_CHANGE;
+    r.module = module;
+    r.code = state;
+    r.detail = previous;
+    r.value = value;
+    CopyField(r.subject, subject);
+    Append(r);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CEventLog::DeviceRead
+/// @description Records a device signal that was read.
+/// @pre None
+/// @post The event is recorded if the log is open.
+/// @param device the identifier of the device.
+/// @param signal the name of the signal.
+/// @param value the value that was read.
+///////////////////////////////////////////////////////////////////////////////
+void CEventLog::DeviceRead(const std::string& device, const std::string& signal,
+        double value)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    if(IsOpen())
+    {
+        Device(EVENT_DEVICE_READ, device, signal, value);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CEventLog::DeviceCommand
+/// @description Records a device command that was set.
+/// @pre None
+/// @post The event is recorded if the log is open.
+/// @param device the identifier of the device.
+/// @param signal the name of the signal.
+/// @param value the value of the command.
+///////////////////////////////////////////////////////////////////////////////
+void CEventLog::DeviceCommand(const std::string& device, const std::string& signal,
+        double value)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    if(IsOpen())
+    {
+        Device(EVENT_DEVICE_COMMAND, device, signal, value);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CEventLog::Message
+/// @description Records a message event. The message is identified by its
+///     recipient and by the fields it has set, not by its contents.
+/// @pre None
+/// @post The event is recorded.
+/// @param type EVENT_MESSAGE_SENT or EVENT_MESSAGE_RECEIVED.
+/// @param msg the message.
+/// @param peer the UUID of the other DGI.
+///////////////////////////////////////////////////////////////////////////////
+void CEventLog::Message(EventType type, const ModuleMessage& msg, const std::string& peer)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    SEventRecord r = SEventRecord();
+    r.type = type;
+    r.module = msg.has_recipient_id() ? msg.recipient_id() :
+            GetRecipientId(msg.recipient_module());
+    std::pair<int, int> kind = GetMessageType(msg);
+    r.code = kind.first;
+    r.detail = kind.second;
+    CopyField(r.subject, peer);
+    Append(r);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CEventLog::Device
+/// @description Records a device event.
+/// @pre None
+/// @post The event is recorded.
+/// @param type EVENT_DEVICE_READ or EVENT_DEVICE_COMMAND.
+/// @param device the identifier of the device.
+/// @param signal the name of the signal.
+/// @param value the value of the signal.
+///////////////////////////////////////////////////////////////////////////////
+void CEventLog::Device(EventType type, const std::string& device,
+        const std::string& signal, double value)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    SEventRecord r = SEventRecord();
+    r.type = type;
+    r.value = value;
+    CopyField(r.subject, device);
+    CopyField(r.signal, signal);
+    Append(r);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CEventLog::Append
+/// @description Stamps a record with the time and its sequence number and
+///     copies it into the current file. The count in the header is updated
+///     after the record, so a reader never sees a partial record. A full file
+///     is rotated first; if that fails, the log is closed.
+/// @pre None
+/// @post The record is in the current file, unless the log was closed.
+/// @param r the record to write.
+///////////////////////////////////////////////////////////////////////////////
+void CEventLog::Append(SEventRecord& r)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    r.time = TimeToMicroseconds(boost::posix_time::microsec_clock::universal_time()
+            + CGlobalConfiguration::Instance().GetClockSkew());
+
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    if(m_base == NULL)
+    {
+        return;
+    }
+    if(m_header->count >= m_capacity)
+    {
+        try
+        {
+            Unmap();
+            Rotate();
+            Map();
+        }
+        catch(std::exception& e)
+        {
+            FREEDM_LOG_ERROR(Logger) << "Stopped recording events: " << e.what()
+                    << std::endl;
+            m_open = false;
+            Unmap();
+            return;
+        }
+    }
+    r.sequence = m_sequence++;
+    std::memcpy(&m_records[m_header->count], &r, sizeof(SEventRecord));
+    m_header->count++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CEventLog::Map
+/// @description Creates the current file at its full size, maps it and
+///     writes its header.
+/// @ErrorHandling Throws a std::runtime_error if the file can't be created or
+///     mapped.
+/// @pre m_mutex is held and no file is mapped.
+/// @post The current file is mapped with no records.
+///////////////////////////////////////////////////////////////////////////////
+void CEventLog::Map()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    std::size_t size = (m_capacity + 1) * sizeof(SEventRecord);
+
+    m_fd = open(m_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(m_fd < 0)
+    {
+        throw std::runtime_error(SystemError("Unable to create", m_path));
+    }
+    if(ftruncate(m_fd, size) != 0)
+    {
+        std::string error = SystemError("Unable to size", m_path);
+        close(m_fd);
+        m_fd = -1;
+        throw std::runtime_error(error);
+    }
+    m_base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if(m_base == MAP_FAILED)
+    {
+        std::string error = SystemError("Unable to map", m_path);
+        m_base = NULL;
+        close(m_fd);
+        m_fd = -1;
+        throw std::runtime_error(error);
+    }
+
+    // The file was created empty, so the header starts out zeroed.
+    m_header = static_cast<SEventLogHeader*>(m_base);
+    m_records = reinterpret_cast<SEventRecord*>(m_header + 1);
+    std::memcpy(m_header->magic, EVENT_LOG_MAGIC, sizeof(m_header->magic));
+    m_header->version = EVENT_LOG_VERSION;
+    m_header->recordsize = sizeof(SEventRecord);
+    m_header->byteorder = EVENT_LOG_BYTE_ORDER;
+    m_header->capacity = m_capacity;
+    m_header->count = 0;
+    CopyField(m_header->uuid, m_uuid);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CEventLog::Unmap
+/// @description Unmaps the current file and trims it to its records, so a
+///     file that was closed early doesn't keep its unused space.
+/// @pre m_mutex is held.
+/// @post No file is mapped.
+///////////////////////////////////////////////////////////////////////////////
+void CEventLog::Unmap()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    if(m_base == NULL)
+    {
+        return;
+    }
+
+    std::size_t used = (m_header->count + 1) * sizeof(SEventRecord);
+    munmap(m_base, (m_capacity + 1) * sizeof(SEventRecord));
+    if(ftruncate(m_fd, used) != 0)
+    {
+        FREEDM_LOG_WARN(Logger) << SystemError("Unable to trim", m_path) << std::endl;
+    }
+    close(m_fd);
+    m_fd = -1;
+    m_base = NULL;
+    m_header = NULL;
+    m_records = NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CEventLog::Rotate
+/// @description Renames the full file to path.1, after moving each older
+///     file path.N to path.N+1. The file moved onto path.N for the largest
+///     N kept replaces the oldest one. If no files are kept, the full file is
+///     left to be replaced by the next one.
+/// @ErrorHandling Throws a std::runtime_error if the full file can't be
+///     renamed.
+/// @pre m_mutex is held and no file is mapped.
+/// @post There is no file at path.
+///////////////////////////////////////////////////////////////////////////////
+void CEventLog::Rotate()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    if(m_files == 0)
+    {
+        return;
+    }
+    for(unsigned int i = m_files; i > 1; i--)
+    {
+        std::string from = m_path + "." + boost::lexical_cast<std::string>(i - 1);
+        std::string to = m_path + "." + boost::lexical_cast<std::string>(i);
+        // The older files don't exist until the log has rotated enough.
+        std::rename(from.c_str(), to.c_str());
+    }
+    std::string full = m_path + ".1";
+    if(std::rename(m_path.c_str(), full.c_str()) != 0)
+    {
+        throw std::runtime_error(SystemError("Unable to rotate", m_path));
+    }
+    FREEDM_LOG_INFO(Logger) << "Rotated the event log to " << full << std::endl;
+}
+
+} // namespace broker
+} // namespace freedm
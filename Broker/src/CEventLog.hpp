@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CEventLog.hpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Records structured events to a memory mapped binary file.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CEVENTLOG_HPP
+#define CEVENTLOG_HPP
+
+#include "SEventRecord.hpp"
+
+#include <cstddef>
+#include <string>
+
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace freedm {
+namespace broker {
+
+class ModuleMessage;
+
+/// Writes the binary event log
+class CEventLog : private boost::noncopyable
+{
+    ///////////////////////////////////////////////////////////////////////////
+    /// @description Each event is a fixed size SEventRecord copied into a
+    ///     file mapped into memory, so recording one costs a lock and a copy.
+    ///     When the file is full it is renamed to path.1, the older files
+    ///     move up one number, and a new file is started; the oldest file is
+    ///     deleted once there are more than the configured number. Records
+    ///     written to the mapping survive a crash of the DGI.
+    ///
+    /// @limitations Singleton. Until the log is opened, events are ignored.
+    ///     The files are written in the byte order of the DGI.
+    ///////////////////////////////////////////////////////////////////////////
+    public:
+        /// Retrieves the singleton instance of the event log.
+        static CEventLog& Instance();
+        /// Closes the log.
+        ~CEventLog();
+        /// Starts recording events to a file.
+        void Open(const std::string& path, std::size_t filesize,
+                unsigned int files, const std::string& uuid);
+        /// Stops recording events and trims the current file.
+        void Close();
+        /// Checks whether events are recorded.
+        bool IsOpen() const { return m_open.load(boost::memory_order_relaxed); }
+        /// Records the start of a module's phase.
+        void PhaseChange(const std::string& module, unsigned long count,
+                unsigned int late, unsigned int duration);
+        /// Records a module message sent to a peer.
+        void MessageSent(const ModuleMessage& msg, const std::string& peer);
+        /// Records a module message received from a peer.
+        void MessageReceived(const ModuleMessage& msg, const std::string& peer);
+        /// Records a module's change of state.
+        void StateChange(int module, int state, int previous,
+                const std::string& subject, double value);
+        /// Records a device signal that was read.
+        void DeviceRead(const std::string& device, const std::string& signal,
+                double value);
+        /// Records a device command that was set.
+        void DeviceCommand(const std::string& device, const std::string& signal,
+                double value);
+    private:
+        /// Private constructor for the singleton instance
+        CEventLog();
+        /// Records a message event.
+        void Message(EventType type, const ModuleMessage& msg, const std::string& peer);
+        /// Records a device event.
+        void Device(EventType type, const std::string& device,
+                const std::string& signal, double value);
+        /// Stamps a record and copies it to the file, rotating it when full.
+        void Append(SEventRecord& r);
+        /// Creates the current file and maps it, requires m_mutex.
+        void Map();
+        /// Unmaps the current file, trimming it to its records, requires m_mutex.
+        void Unmap();
+        /// Moves the full file and its predecessors up one number, requires m_mutex.
+        void Rotate();
+        /// The path of the current file.
+        std::string m_path;
+        /// The UUID written to the header of each file.
+        std::string m_uuid;
+        /// The number of records each file has room for.
+        std::size_t m_capacity;
+        /// The number of full files kept besides the current one.
+        unsigned int m_files;
+        /// Descriptor of the current file, or -1.
+        int m_fd;
+        /// The mapping of the current file.
+        void* m_base;
+        /// The header of the current file.
+        SEventLogHeader* m_header;
+        /// The records of the current file.
+        SEventRecord* m_records;
+        /// The sequence number of the next record.
+        boost::uint32_t m_sequence;
+        /// True while events are recorded.
+        boost::atomic<bool> m_open;
+        /// Lock for the file and the sequence.
+        boost::mutex m_mutex;
+};
+
+} // namespace broker
+} // namespace freedm
+
+#endif // CEVENTLOG_HPP
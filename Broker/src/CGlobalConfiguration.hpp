@@ -38,6 +38,8 @@
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/asio/io_service.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
 
 namespace freedm {
 namespace broker {
@@ -62,7 +64,8 @@ class CGlobalConfiguration : private boost::noncopyable
         void SetListenAddress(std::string a) { m_address = a; };
         /// Set the clock skew
         void SetClockSkew(boost::posix_time::time_duration t)
-                { m_clockskew = t; };
+                { boost::lock_guard<boost::mutex> lock(m_skewMutex);
+                  m_clockskew = t; };
         /// Set the plug-and-play port number
         void SetFactoryPort(unsigned short port) { m_factory_port = port; }
         /// Set the socket endpoint address
@@ -85,6 +88,14 @@ class CGlobalConfiguration : private boost::noncopyable
         void SetMQTTAddress(std::string address) { m_mqtt_address = address; }
         /// Set the MQTT subscriptions
         void SetMQTTSubscriptions(std::vector<std::string> subs) { m_mqtt_subscriptions = subs; }
+        /// Set the number of threads that run the broker's io_service
+        void SetBrokerThreads(unsigned int n) { m_broker_threads = n; }
+        /// Set whether retransmissions only resend the head of the window
+        void SetResendHeadOnly(bool v) { m_resend_head_only = v; }
+        /// Set the multicast or broadcast address for group-wide messages
+        void SetMulticastGroup(std::string g) { m_multicast_group = g; }
+        /// Set the port of the multicast group
+        void SetMulticastPort(std::string p) { m_multicast_port = p; }
         /// Get the hostname
         std::string GetHostname() const { return m_hostname; };
         /// Get the port
@@ -95,7 +106,8 @@ class CGlobalConfiguration : private boost::noncopyable
         std::string GetListenAddress() const { return m_address; };
         /// Get the Skew of the local clock
         boost::posix_time::time_duration GetClockSkew() const
-                { return m_clockskew; };
+                { boost::lock_guard<boost::mutex> lock(m_skewMutex);
+                  return m_clockskew; };
         /// Get the plug-and-play port number
         unsigned short GetFactoryPort() const { return m_factory_port; }
         /// Get the socket endpoint address
@@ -120,12 +132,23 @@ class CGlobalConfiguration : private boost::noncopyable
         std::string GetMQTTAddress() const { return m_mqtt_address; }
         /// Get the MQTT subscriptions
         std::vector<std::string> GetMQTTSubscriptions() const { return m_mqtt_subscriptions; }
+        /// Get the number of threads that run the broker's io_service
+        unsigned int GetBrokerThreads() const { return m_broker_threads; }
+        /// Get whether retransmissions only resend the head of the window
+        bool GetResendHeadOnly() const { return m_resend_head_only; }
+        /// Get the multicast or broadcast address, empty if disabled
+        std::string GetMulticastGroup() const { return m_multicast_group; }
+        /// Get the port of the multicast group
+        std::string GetMulticastPort() const { return m_multicast_port; }
     private:
+        /// Private constructor for the singleton instance
+        CGlobalConfiguration() : m_broker_threads(1), m_resend_head_only(false) { }
         std::string m_hostname; /// Node hostname
         std::string m_port; /// Port number
         std::string m_uuid; /// The node uuid
         std::string m_address; /// The listening address.
         boost::posix_time::time_duration m_clockskew; /// The skew of the clock
+        mutable boost::mutex m_skewMutex; /// The skew is written by the synchronizer
         unsigned short m_factory_port; /// Port number for adapter factory
         std::string m_devicesEndpoint; /// Socket endpoint address for devices
         std::string m_adapterConfigPath; /// Path to the adapter configuration
@@ -137,6 +160,10 @@ class CGlobalConfiguration : private boost::noncopyable
         std::string m_mqtt_id; /// Identifier of the MQTT client.
         std::string m_mqtt_address; /// Address of the MQTT broker.
         std::vector<std::string> m_mqtt_subscriptions; /// Subscription topics for MQTT.
+        unsigned int m_broker_threads; /// Threads running the broker io_service
+        bool m_resend_head_only; /// Retransmit only the unacknowledged head
+        std::string m_multicast_group; /// Address for group-wide messages
+        std::string m_multicast_port; /// Port for group-wide messages
 };
 
 } // namespace broker
@@ -27,10 +27,23 @@
 #include <stdexcept>
 #include <string>
 
+#include <boost/thread/locks.hpp>
+
 namespace freedm {
 
 namespace broker {
 
+////////////////////////////////////////////////////////
+/// CGlobalPeerList::CGlobalPeerList
+/// @description Creates the peer list without any peers
+/// @pre None
+/// @post The peer list holds an empty snapshot.
+////////////////////////////////////////////////////////
+CGlobalPeerList::CGlobalPeerList()
+    : m_peerlist(new PeerSet)
+{
+    //Pass
+}
 ////////////////////////////////////////////////////////
 /// CGlobalPeerList::GetPeer
 /// @description Fetch a peer based on uuid, throws an exception if they aren't found
@@ -40,8 +53,9 @@ namespace broker {
 ////////////////////////////////////////////////////////
 CPeerNode CGlobalPeerList::GetPeer(const std::string& uuid)
 {
-    PeerSetIterator pst = Find(uuid);
-    if(pst == end())
+    boost::shared_ptr<const PeerSet> peers = PeerList();
+    PeerSet::const_iterator pst = peers->find(uuid);
+    if(pst == peers->end())
     {
         throw EDgiNoSuchPeerError("Peer " + uuid + " was not found in the global table");
     }
@@ -55,46 +69,35 @@ CPeerNode CGlobalPeerList::GetPeer(const std::string& uuid)
 ////////////////////////////////////////////////////////
 int CGlobalPeerList::Count(const std::string& uuid)
 {
-    return m_peerlist.count(uuid);
-}
-///////////////////////////////////////////////////////
-/// CGlobalPeerList::Find
-/// @description Return an iterator to the peer with the given uuid
-/// @param uuid The UUID of the peer you are attempting to access
-/// @return An iterator to the peer if found or end() if not found.
-///////////////////////////////////////////////////////
-CGlobalPeerList::PeerSetIterator CGlobalPeerList::Find(const std::string& uuid)
-{
-    return m_peerlist.find(uuid);
-}
-//////////////////////////////////////////////////////
-/// CGlobalPeerList::begin
-/// @description Return an iterator to the beginning of the container's table.
-/// @return An iterator to the beginning of the peer list.
-//////////////////////////////////////////////////////
-CGlobalPeerList::PeerSetIterator CGlobalPeerList::begin()
-{
-    return m_peerlist.begin();
+    return PeerList()->count(uuid);
 }
 //////////////////////////////////////////////////////
-/// CGlobalPeerList::end
-/// @description Return an iterator to the end of the container's table.
-/// @return An iterator to the end of the peer list.
+/// CGlobalPeerList::Empty
+/// @description Checks whether any peer has been added yet.
+/// @return True if the peer list has no peers.
 //////////////////////////////////////////////////////
-CGlobalPeerList::PeerSetIterator CGlobalPeerList::end()
+bool CGlobalPeerList::Empty()
 {
-    return m_peerlist.end();
+    return PeerList()->empty();
 }
 //////////////////////////////////////////////////////
 /// CGlobalPeerList::Insert
 /// @description Pushes a peer node into the set
 ///	@pre None
-/// @post p has been added to the global peer list.
+/// @post p has been added to the global peer list, unless a peer with its
+///     uuid was already there.
 /// @param p A CPeerNode to put into the container.
 //////////////////////////////////////////////////////
 void CGlobalPeerList::Insert(CPeerNode p)
 {
-    m_peerlist.insert(std::make_pair(p.GetUUID(),p));
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    if(m_peerlist->count(p.GetUUID()) > 0)
+    {
+        return;
+    }
+    boost::shared_ptr<PeerSet> updated(new PeerSet(*m_peerlist));
+    updated->insert(std::make_pair(p.GetUUID(),p));
+    boost::atomic_store(&m_peerlist, boost::shared_ptr<const PeerSet>(updated));
 }
 //////////////////////////////////////////////////////
 /// CGlobalPeerList::Create
@@ -107,25 +110,38 @@ void CGlobalPeerList::Insert(CPeerNode p)
 //////////////////////////////////////////////////////
 CPeerNode CGlobalPeerList::Create(std::string uuid)
 {
-    if(Count(uuid) > 0)
+    boost::shared_ptr<const PeerSet> peers = PeerList();
+    PeerSet::const_iterator it = peers->find(uuid);
+    if(it != peers->end())
     {
-        return GetPeer(uuid);
+        return it->second;
+    }
+
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    // Another thread may have created the peer before the lock was taken.
+    it = m_peerlist->find(uuid);
+    if(it != m_peerlist->end())
+    {
+        return it->second;
     }
     CPeerNode p = CPeerNode(uuid);
-    Insert(p);
+    boost::shared_ptr<PeerSet> updated(new PeerSet(*m_peerlist));
+    updated->insert(std::make_pair(uuid,p));
+    boost::atomic_store(&m_peerlist, boost::shared_ptr<const PeerSet>(updated));
     return p;
 }
 /////////////////////////////////////////////////////
 /// CGlobalPeerList::PeerList
-/// @description Gets a copy of the global peer list.
-/// @return A copy of the global peer list
+/// @description Gets a snapshot of the global peer list. The snapshot does
+///     not change, so it can be iterated while other threads add peers;
+///     those peers appear in the next snapshot.
+/// @return A snapshot of the global peer list
 /////////////////////////////////////////////////////
-CGlobalPeerList::PeerSet& CGlobalPeerList::PeerList()
+boost::shared_ptr<const CGlobalPeerList::PeerSet> CGlobalPeerList::PeerList()
 {
-    return m_peerlist;
+    return boost::atomic_load(&m_peerlist);
 }
 
-
 }
 
 }
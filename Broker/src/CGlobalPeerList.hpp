@@ -27,6 +27,8 @@
 #include <string>
 
 #include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 namespace freedm {
 
@@ -41,6 +43,10 @@ class GMAgent;
 
 class CPeerNode;
 
+/// The peers this DGI knows of. Module tasks, the clock synchronizer and the
+/// dispatcher use it from different threads, so readers take a snapshot of
+/// the peer map without locking; writers copy it under the mutex and publish
+/// the copy.
 class CGlobalPeerList
     : private boost::noncopyable
 {
@@ -48,8 +54,6 @@ class CGlobalPeerList
         friend class freedm::broker::gm::GMAgent;
         /// The peerset type
         typedef std::map<std::string, CPeerNode> PeerSet;
-        /// Provides and Iterator
-        typedef PeerSet::iterator PeerSetIterator;
         /// Provides the global instance
         static CGlobalPeerList& instance()
         {
@@ -60,22 +64,21 @@ class CGlobalPeerList
         CPeerNode GetPeer(const std::string& uuid);
         /// Count the number of peers with a specified uuid (should be 1 or 0)
         int Count(const std::string& uuid);
-        /// Return an iterator to the peer with the given uuid
-        PeerSetIterator Find(const std::string& uuid);
-        /// Iterator to the beginning of the peerset
-        PeerSetIterator begin();
-        /// Iterator to the end of the peerset
-        PeerSetIterator end();
-        /// Returns a copy of the peer map
-        PeerSet& PeerList();
+        /// Whether the peerset is empty
+        bool Empty();
+        /// Returns a snapshot of the peer map
+        boost::shared_ptr<const PeerSet> PeerList();
         /// Construct a peer
         CPeerNode Create(std::string uuid);
         /// Pushes a peer node into the set
         void Insert(CPeerNode p);
     private:
-        /// The set of peers to present
-        PeerSet m_peerlist;
-
+        /// Creates an empty peer list
+        CGlobalPeerList();
+        /// The set of peers to present, replaced rather than modified
+        boost::shared_ptr<const PeerSet> m_peerlist;
+        /// Serializes the writers of m_peerlist
+        boost::mutex m_mutex;
 };
 
 }
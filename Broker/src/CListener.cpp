@@ -31,9 +31,15 @@
 #include "CLogger.hpp"
 #include "CClockSynchronizer.hpp"
 #include "CConnection.hpp"
+#include "CDatagramBatch.hpp"
+#include "CTimings.hpp"
+#include "Messages.hpp"
 #include "messages/ModuleMessage.pb.h"
 #include "messages/ProtocolMessage.pb.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <vector>
 
 #include <boost/bind.hpp>
@@ -62,8 +68,10 @@ CLocalLogger Logger(__FILE__);
 ///////////////////////////////////////////////////////////////////////////////
 CListener::CListener()
     : m_socket(CBroker::Instance().GetIOService())
+    , m_mcsocket(CBroker::Instance().GetIOService())
+    , m_mcenabled(false)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -86,10 +94,14 @@ CListener& CListener::Instance()
 ///////////////////////////////////////////////////////////////////////////////
 void CListener::Start(boost::asio::ip::udp::endpoint& endpoint)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     m_socket.open(endpoint.protocol());
     m_socket.bind(endpoint);
     ScheduleListen();
+    if(!CGlobalConfiguration::Instance().GetMulticastGroup().empty())
+    {
+        StartMulticast();
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -100,21 +112,28 @@ void CListener::Start(boost::asio::ip::udp::endpoint& endpoint)
 ///////////////////////////////////////////////////////////////////////////////
 void CListener::Stop()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     try
     {
         m_socket.close();
+        if(m_mcenabled)
+        {
+            m_mcenabled = false;
+            m_mcsocket.close();
+        }
     }
     catch (boost::system::system_error& e)
     {
-        Logger.Error << "Error calling close: " << e.what() << std::endl;
+        FREEDM_LOG_ERROR(Logger) << "Error calling close: " << e.what() << std::endl;
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 /// CListener::HandleRead
 /// @description The callback which accepts messages from the remote sender.
+///     With BATCHED_UDP, the datagrams already waiting on the socket are read
+///     and processed before listening again.
 /// @param e The errorcode if any associated.
 /// @param bytes_transferred The size of the datagram being read.
 /// @pre The connection has had start called and some message has been placed
@@ -127,67 +146,703 @@ void CListener::Stop()
 void CListener::HandleRead(const boost::system::error_code& e,
                            std::size_t bytes_transferred)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if (e)
     {
-        Logger.Error<<"HandleRead failed: " << e.message();
+        FREEDM_LOG_ERROR(Logger)<<"HandleRead failed: " << e.message();
         ScheduleListen();
+        return;
     }
 
-    Logger.Debug<<"Loading protobuf"<<std::endl;
-    ProtocolMessageWindow pmw;
-    if(!pmw.ParseFromArray(m_buffer.begin(), bytes_transferred))
+    ProcessDatagram(m_buffer.begin(), bytes_transferred, m_recv_from);
+#ifdef BATCHED_UDP
+    DrainSocket();
+#endif
+    ScheduleListen();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CListener::ProcessDatagram
+/// @description Parses a received window and passes each of its messages to
+///     the connection with the sender. Accepted messages are handed to the
+///     dispatcher.
+/// @pre None
+/// @post The messages of the datagram have been processed by the CConnection
+///     that manages messages between this process and the sender.
+/// @param data the contents of the datagram.
+/// @param length the size of the datagram.
+/// @param from the endpoint the datagram was received from.
+///////////////////////////////////////////////////////////////////////////////
+void CListener::ProcessDatagram(const char* data, std::size_t length,
+                                const boost::asio::ip::udp::endpoint& from)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    FREEDM_LOG_DEBUG(Logger)<<"Loading protobuf"<<std::endl;
+    // The window outlives this handler while modules hold messages from it.
+    WindowPtr window = m_windows.Acquire();
+    ProtocolMessageWindow& pmw = *window;
+    if(!pmw.ParseFromArray(data, length))
     {
-        Logger.Error<<"Failed to load protobuf"<<std::endl;
-        ScheduleListen();
+        FREEDM_LOG_ERROR(Logger)<<"Failed to load protobuf"<<std::endl;
         return;
     }
 
-#ifdef CUSTOMNETWORK
-    if((rand()%100) >= GetReliability())
+    if(pmw.multicast())
     {
-        Logger.Debug<<"Dropped datagram "<<pm.hash()<<":"<<pm.sequence_num()<<std::endl;
-        ScheduleListen();
+        ProcessMulticast(window);
         return;
     }
-#endif
 
-    Logger.Debug<<"Fetching Connection"<<std::endl;
+    FREEDM_LOG_DEBUG(Logger)<<"Fetching Connection"<<std::endl;
     std::string uuid = pmw.source_uuid();
     /// We can make the remote host from the endpoint:
-    SRemoteHost host = { m_recv_from.address().to_string(), boost::lexical_cast<std::string>(m_recv_from.port()) };
+    SRemoteHost host = { from.address().to_string(), boost::lexical_cast<std::string>(from.port()) };
 
     ///Make sure the hostname is registered:
     CConnectionManager::Instance().PutHost(uuid,host);
 
     ///Get the pointer to the connection:
-    ConnectionPtr conn = CConnectionManager::Instance().CreateConnection(uuid, m_recv_from);
+    ConnectionPtr conn = CConnectionManager::Instance().CreateConnection(uuid, from);
     //ConnectionPtr conn = CConnectionManager::Instance().GetConnectionByUUID(uuid);
-    Logger.Debug<<"Fetched Connection"<<std::endl;
+    FREEDM_LOG_DEBUG(Logger)<<"Fetched Connection"<<std::endl;
+
+#ifdef CUSTOMNETWORK
+    if((rand()%100) >= conn->GetReliability())
+    {
+        FREEDM_LOG_DEBUG(Logger)<<"Dropped datagram from "<<uuid<<std::endl;
+        return;
+    }
+#endif
+
+    // Peers that read the binary timestamps don't need the text ones.
+    conn->SetBinaryTimestamps(pmw.binary_timestamps());
+    // Peers that read cumulative ACKs are acknowledged once per window.
+    conn->SetSelectiveAck(pmw.selective_ack());
 
     BOOST_FOREACH(const ProtocolMessage &pm, pmw.messages())
     {
-        if(pm.status() == ProtocolMessage::ACCEPTED)
+        if(pm.status() == ProtocolMessage::ACCEPTED || pm.status() == ProtocolMessage::REFUSED)
         {
-            Logger.Debug<<"Processing Accept Message"<<std::endl;
-            Logger.Debug<<"Received ACK"<<pm.hash()<<":"<<pm.sequence_num()<<std::endl;
+            FREEDM_LOG_DEBUG(Logger)<<"Processing Accept Message"<<std::endl;
+            FREEDM_LOG_DEBUG(Logger)<<"Received ACK"<<pm.hash()<<":"<<pm.sequence_num()<<std::endl;
             conn->ReceiveACK(pm);
         }
+        else if(!pmw.selective_ack() && pm.status() == ProtocolMessage::MESSAGE
+                && pm.has_module_message()
+                && !CDispatcher::Instance().IsAccepting(pm.module_message()))
+        {
+            // Peers which cannot read a refusal do not hold messages out of
+            // order, so the message is left unacknowledged and written again
+            // after the sender's retransmission timeout.
+            FREEDM_LOG_DEBUG(Logger)<<"Refused message "<<pm.hash()<<":"<<pm.sequence_num()
+                        <<" for a full queue"<<std::endl;
+        }
         else if(conn->Receive(pm))
         {
-            Logger.Debug<<"Accepted message "<<pm.hash()<<":"<<pm.sequence_num()<<std::endl;
-            CDispatcher::Instance().HandleRequest(
-                boost::make_shared<const ModuleMessage>(
-                    ModuleMessage(pm.module_message())), uuid);
+            FREEDM_LOG_DEBUG(Logger)<<"Accepted message "<<pm.hash()<<":"<<pm.sequence_num()<<std::endl;
+            // Share ownership of the window rather than copying the message.
+            Accept(*conn, boost::shared_ptr<const ProtocolMessage>(window, &pm), uuid);
+            // Messages held out of order may now follow the accepted one.
+            boost::shared_ptr<const ProtocolMessage> next;
+            while((next = conn->NextInOrder()))
+            {
+                FREEDM_LOG_DEBUG(Logger)<<"Released held message "<<next->hash()<<":"
+                            <<next->sequence_num()<<std::endl;
+                Accept(*conn, next, uuid);
+            }
         }
         else if(pm.status() != ProtocolMessage::CREATED)
         {
-            Logger.Debug<<"Rejected message "<<pm.hash()<<":"<<pm.sequence_num()<<std::endl;
+            FREEDM_LOG_DEBUG(Logger)<<"Rejected message "<<pm.hash()<<":"<<pm.sequence_num()<<std::endl;
         }
     }
     conn->OnReceive();
-    ScheduleListen();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CListener::Accept
+/// @description Passes a message the sender's connection accepted in order to
+///     the dispatcher, unless Admit refuses it. The connection has
+///     acknowledged the message either way, so the messages behind it are not
+///     held up; a refused one is reported to the sender, which sends it again
+///     later. A fragmented message is
+///     checked once its last fragment completes it, and then every fragment
+///     of it is refused, so the sender sends the whole message again.
+/// @pre pm was accepted by conn, in order.
+/// @post The message is scheduled for delivery or its refusal is queued.
+/// @param conn The connection with the sender.
+/// @param pm The accepted message.
+/// @param uuid The UUID of the DGI that sent the message.
+///////////////////////////////////////////////////////////////////////////////
+void CListener::Accept(CConnection& conn, boost::shared_ptr<const ProtocolMessage> pm,
+                       const std::string& uuid)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    if(pm->has_fragment_count())
+    {
+        std::vector<ProtocolMessage> pieces;
+        boost::shared_ptr<const ModuleMessage> msg = Reassemble(uuid, *pm, &pieces);
+        if(!msg)
+        {
+            return;
+        }
+        if(!Admit(uuid, *pm, *msg))
+        {
+            FREEDM_LOG_DEBUG(Logger)<<"Refused "<<pieces.size()<<" piece message ending "
+                        <<pm->hash()<<":"<<pm->sequence_num()<<std::endl;
+            BOOST_FOREACH(const ProtocolMessage& piece, pieces)
+            {
+                conn.Refuse(piece);
+            }
+            return;
+        }
+        CDispatcher::Instance().HandleRequest(msg, uuid);
+        return;
+    }
+    if(pm->has_module_message() && !Admit(uuid, *pm, pm->module_message()))
+    {
+        FREEDM_LOG_DEBUG(Logger)<<"Refused message "<<pm->hash()<<":"<<pm->sequence_num()<<std::endl;
+        conn.Refuse(*pm);
+        return;
+    }
+    Deliver(pm, uuid);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CListener::Admit
+/// @description Decides if a module message accepted in order is delivered.
+///     It is refused if a module it is for has a full queue with the REJECT
+///     policy. A refused message comes back under a new sequence number, so
+///     to keep a sender's messages to a module in order, every later message
+///     to that module is refused too until the oldest refused one comes back.
+///     The sender sends them again in the order they were refused. A message
+///     is known by its hash, which the sender keeps when it sends it again.
+/// @pre pm was accepted by the sender's connection, in order, and carries
+///     msg, or is the last fragment of it.
+/// @post If msg is refused and was not already outstanding, it is recorded
+///     as outstanding. If the oldest outstanding message is delivered, it is
+///     no longer outstanding. Outstanding messages the sender has stopped
+///     sending because they expired are forgotten.
+/// @param uuid The UUID of the DGI that sent the message.
+/// @param pm The accepted message, for its hash and expiration time.
+/// @param msg The module message pm carries or completes.
+/// @return True if the message should be delivered, false to refuse it.
+///////////////////////////////////////////////////////////////////////////////
+bool CListener::Admit(const std::string& uuid, const ProtocolMessage& pm,
+                      const ModuleMessage& msg)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    std::deque<ProtocolMessage>* refused = NULL;
+    std::map<std::string, RefusalMap>::iterator sender = m_refused.find(uuid);
+    if(sender != m_refused.end())
+    {
+        RefusalMap::iterator it = sender->second.find(msg.recipient_module());
+        if(it != sender->second.end())
+        {
+            refused = &it->second;
+            refused->erase(std::remove_if(refused->begin(), refused->end(), &MessageIsExpired),
+                refused->end());
+        }
+    }
+
+    bool outstanding = refused && !refused->empty();
+    bool oldest = outstanding && refused->front().hash() == pm.hash();
+    if((!outstanding || oldest) && CDispatcher::Instance().IsAccepting(msg))
+    {
+        if(oldest)
+        {
+            refused->pop_front();
+        }
+        return true;
+    }
+
+    if(!refused)
+    {
+        refused = &m_refused[uuid][msg.recipient_module()];
+    }
+    BOOST_FOREACH(const ProtocolMessage& earlier, *refused)
+    {
+        if(earlier.hash() == pm.hash())
+        {
+            return false;
+        }
+    }
+    FREEDM_LOG_DEBUG(Logger)<<"Holding back "<<msg.recipient_module()<<" messages from "<<uuid
+                <<" until "<<(outstanding ? refused->front().hash() : pm.hash())
+                <<" is sent again"<<std::endl;
+    refused->push_back(ProtocolMessage());
+    ProtocolMessage& stamp = refused->back();
+    stamp.set_hash(pm.hash());
+    if(pm.has_expire_time_us())
+    {
+        stamp.set_expire_time_us(pm.expire_time_us());
+    }
+    if(pm.has_expire_time())
+    {
+        stamp.set_expire_time(pm.expire_time());
+    }
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CListener::Deliver
+/// @description Passes an accepted message to the dispatcher. Fragments are
+///     added to the message being reassembled and the module message is only
+///     dispatched once its last fragment arrives.
+/// @pre pm was accepted by the sender's connection, in order.
+/// @post The module message, if complete, is scheduled for delivery.
+/// @param pm The accepted message; the dispatched module message shares its
+///     ownership.
+/// @param uuid The UUID of the DGI that sent the message.
+///////////////////////////////////////////////////////////////////////////////
+void CListener::Deliver(boost::shared_ptr<const ProtocolMessage> pm, const std::string& uuid)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    if(pm->has_fragment_count())
+    {
+        boost::shared_ptr<const ModuleMessage> msg = Reassemble(uuid, *pm);
+        if(msg)
+        {
+            CDispatcher::Instance().HandleRequest(msg, uuid);
+        }
+        return;
+    }
+    CDispatcher::Instance().HandleRequest(
+        boost::shared_ptr<const ModuleMessage>(pm, &pm->module_message()), uuid);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CListener::Reassemble
+/// @description Adds a fragment of a module message to the message being
+///     reassembled for its sender. The protocol accepts messages in order, so
+///     fragments arrive in order unless some expired at the sender; in that
+///     case the partial message is discarded, since its missing pieces will
+///     never arrive.
+/// @pre pm was accepted by the sender's connection and carries a fragment.
+/// @post The fragment is stored, or the completed message is removed from
+///     the reassembly table.
+/// @param uuid The UUID of the DGI that sent the fragment.
+/// @param pm The accepted message carrying the fragment.
+/// @param pieces If not null, receives the sequence number, hash and
+///     expiration time of every fragment of the completed message.
+/// @return The module message if pm was its last fragment, otherwise null.
+///////////////////////////////////////////////////////////////////////////////
+boost::shared_ptr<const ModuleMessage> CListener::Reassemble(const std::string& uuid,
+    const ProtocolMessage& pm, std::vector<ProtocolMessage>* pieces)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    if(pm.fragment_index() == 0)
+    {
+        m_fragments[uuid].data.clear();
+        m_fragments[uuid].next = 0;
+        m_fragments[uuid].pieces.clear();
+    }
+    std::map<std::string, SReassembly>::iterator it = m_fragments.find(uuid);
+    if(it == m_fragments.end() || pm.fragment_index() != it->second.next)
+    {
+        FREEDM_LOG_WARN(Logger)<<"Discarding fragmented message from "<<uuid<<": got piece "
+                   <<pm.fragment_index()<<" out of order"<<std::endl;
+        if(it != m_fragments.end())
+        {
+            m_fragments.erase(it);
+        }
+        return boost::shared_ptr<const ModuleMessage>();
+    }
+    SReassembly& partial = it->second;
+    partial.data.append(pm.fragment());
+    partial.next++;
+    partial.pieces.push_back(ProtocolMessage());
+    ProtocolMessage& piece = partial.pieces.back();
+    piece.set_sequence_num(pm.sequence_num());
+    piece.set_hash(pm.hash());
+    if(pm.has_expire_time_us())
+    {
+        piece.set_expire_time_us(pm.expire_time_us());
+    }
+    if(pm.has_expire_time())
+    {
+        piece.set_expire_time(pm.expire_time());
+    }
+
+    if(partial.next < pm.fragment_count())
+    {
+        return boost::shared_ptr<const ModuleMessage>();
+    }
+
+    boost::shared_ptr<ModuleMessage> msg = boost::make_shared<ModuleMessage>();
+    bool parsed = msg->ParseFromString(partial.data);
+    if(pieces)
+    {
+        pieces->swap(partial.pieces);
+    }
+    m_fragments.erase(uuid);
+    if(!parsed)
+    {
+        FREEDM_LOG_ERROR(Logger)<<"Failed to load reassembled protobuf from "<<uuid<<std::endl;
+        return boost::shared_ptr<const ModuleMessage>();
+    }
+    FREEDM_LOG_DEBUG(Logger)<<"Reassembled message for "<<msg->recipient_module()<<std::endl;
+    return msg;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CListener::DrainSocket
+/// @description Reads the datagrams that are already waiting on the socket
+///     with recvmmsg, up to CDatagramBatch::BATCH_SIZE per call, and
+///     processes each of them. Stops as soon as the socket has nothing more
+///     to read. Does nothing unless the broker was built with BATCHED_UDP.
+/// @pre The socket is open.
+/// @post The socket had no datagrams waiting when the last call was made.
+///////////////////////////////////////////////////////////////////////////////
+void CListener::DrainSocket()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+#ifdef BATCHED_UDP
+    const std::size_t size = CGlobalConfiguration::MAX_PACKET_SIZE;
+    m_batchbuffer.resize(CDatagramBatch::BATCH_SIZE * size);
+    CDatagramBatch batch;
+
+    while(true)
+    {
+        int count = batch.Receive(m_socket.native_handle(), &m_batchbuffer[0], size);
+        if(count < 0)
+        {
+            if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                FREEDM_LOG_ERROR(Logger)<<"recvmmsg failed: "<<std::strerror(errno)<<std::endl;
+            }
+            return;
+        }
+        FREEDM_LOG_DEBUG(Logger)<<"Drained "<<count<<" datagrams"<<std::endl;
+
+        for(int i = 0; i < count; i++)
+        {
+            ProcessDatagram(&m_batchbuffer[i * size], batch.GetLength(i), batch.GetSender(i));
+        }
+
+        if(count < static_cast<int>(CDatagramBatch::BATCH_SIZE))
+        {
+            return;
+        }
+    }
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CListener::QueueDatagram
+/// @description Copies a serialized window into the outgoing queue. The first
+///     datagram queued after a flush posts FlushDatagrams to the network
+///     strand, so everything written to any peer while the current handlers
+///     run goes out together.
+/// @pre None
+/// @post The datagram will be sent by the next FlushDatagrams.
+/// @param data the serialized window.
+/// @param length the size of the serialized window.
+/// @param to the endpoint to send the window to.
+/// @param sender the protocol to stop if the window cannot be sent.
+///////////////////////////////////////////////////////////////////////////////
+void CListener::QueueDatagram(const char* data, std::size_t length,
+    const boost::asio::ip::udp::endpoint& to, boost::weak_ptr<IProtocol> sender)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    boost::mutex::scoped_lock lock(m_outgoingMutex);
+    m_outgoing.push_back(SDatagram());
+    m_outgoing.back().data.assign(data, data + length);
+    m_outgoing.back().to = to;
+    m_outgoing.back().sender = sender;
+    if(m_outgoing.size() == 1)
+    {
+        CBroker::Instance().GetIOService().post(
+            CBroker::Instance().GetNetworkStrand().wrap(
+                boost::bind(&CListener::FlushDatagrams, this)));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CListener::FlushDatagrams
+/// @description Sends the queued datagrams with sendmmsg, up to
+///     CDatagramBatch::BATCH_SIZE per call. A datagram the kernel cannot take
+///     right away is sent with a blocking send_to instead. If a datagram cannot be sent at all, the
+///     protocol that wrote it is stopped, as IProtocol::Write does for an
+///     unbatched send.
+/// @pre None
+/// @post The outgoing queue is empty.
+///////////////////////////////////////////////////////////////////////////////
+void CListener::FlushDatagrams()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+#ifdef BATCHED_UDP
+    std::vector<SDatagram> outgoing;
+    {
+        boost::mutex::scoped_lock lock(m_outgoingMutex);
+        outgoing.swap(m_outgoing);
+    }
+
+    CDatagramBatch batch;
+
+    std::size_t next = 0;
+    while(next < outgoing.size())
+    {
+        batch.Clear();
+        for(std::size_t i = next; i < outgoing.size(); i++)
+        {
+            const SDatagram& dgram = outgoing[i];
+            if(!batch.Add(&dgram.data[0], dgram.data.size(), dgram.to))
+            {
+                break;
+            }
+        }
+
+        int sent = batch.Send(m_socket.native_handle());
+        if(sent > 0)
+        {
+            FREEDM_LOG_DEBUG(Logger)<<"Sent "<<sent<<" datagrams in one batch"<<std::endl;
+            next += sent;
+            continue;
+        }
+        if(sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        // The first datagram of the batch could not be sent right away.
+        SDatagram& dgram = outgoing[next];
+        try
+        {
+            m_socket.send_to(boost::asio::buffer(dgram.data), dgram.to);
+        }
+        catch(boost::system::system_error &e)
+        {
+            FREEDM_LOG_DEBUG(Logger) << "Writing Failed: " << e.what() << std::endl;
+            boost::shared_ptr<IProtocol> sender = dgram.sender.lock();
+            if(sender)
+            {
+                sender->Stop();
+            }
+        }
+        next++;
+    }
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CListener::StartMulticast
+/// @description Opens a second socket for group-wide messages. A multicast
+///     group is joined; an IPv4 broadcast address is instead enabled on the
+///     listening socket, which sends the group-wide messages either way. The
+///     port may be shared by several DGIs on one host, and loopback is left
+///     on so they hear each other.
+/// @pre The listening socket is open.
+/// @post If the group could be joined, IsMulticastEnabled returns true and
+///     HandleMulticastRead is called when a group-wide message arrives.
+///     Otherwise a warning is logged and messages are sent to each peer.
+///////////////////////////////////////////////////////////////////////////////
+void CListener::StartMulticast()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    std::string group = CGlobalConfiguration::Instance().GetMulticastGroup();
+    std::string port = CGlobalConfiguration::Instance().GetMulticastPort();
+    try
+    {
+        boost::asio::ip::address address = boost::asio::ip::address::from_string(group);
+        m_mcgroup = boost::asio::ip::udp::endpoint(address,
+            boost::lexical_cast<unsigned short>(port));
+        boost::asio::ip::udp::endpoint listen(m_mcgroup.protocol(), m_mcgroup.port());
+        m_mcsocket.open(listen.protocol());
+        m_mcsocket.set_option(boost::asio::ip::udp::socket::reuse_address(true));
+        m_mcsocket.bind(listen);
+        if(address.is_multicast())
+        {
+            m_mcsocket.set_option(boost::asio::ip::multicast::join_group(address));
+            m_socket.set_option(boost::asio::ip::multicast::enable_loopback(true));
+        }
+        else
+        {
+            m_socket.set_option(boost::asio::socket_base::broadcast(true));
+        }
+    }
+    catch(std::exception& e)
+    {
+        FREEDM_LOG_WARN(Logger)<<"Couldn't join multicast group "<<group<<":"<<port<<": "
+                   <<e.what()<<std::endl;
+        boost::system::error_code ignored;
+        m_mcsocket.close(ignored);
+        return;
+    }
+    FREEDM_LOG_STATUS(Logger)<<"Joined multicast group "<<m_mcgroup<<std::endl;
+    m_mcenabled = true;
+    ScheduleMulticastListen();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CListener::ScheduleMulticastListen
+/// @description Requests that HandleMulticastRead is called when a datagram
+///     arrives on the multicast socket.
+/// @pre The multicast socket is bound.
+/// @post HandleMulticastRead will be called when a datagram arrives.
+///////////////////////////////////////////////////////////////////////////////
+void CListener::ScheduleMulticastListen()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    m_mcsocket.async_receive_from(
+        boost::asio::buffer(m_mcbuffer, CGlobalConfiguration::MAX_PACKET_SIZE),
+        m_mcrecv_from, CBroker::Instance().GetNetworkStrand().wrap(
+            boost::bind(&CListener::HandleMulticastRead, this,
+                boost::asio::placeholders::error,
+                boost::asio::placeholders::bytes_transferred)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CListener::HandleMulticastRead
+/// @description The callback which accepts messages sent to the multicast
+///     group. They are parsed like any other datagram.
+/// @param e The errorcode if any associated.
+/// @param bytes_transferred The size of the datagram being read.
+/// @pre A datagram has been placed in the multicast buffer.
+/// @post The datagram is processed and the socket listens for another, unless
+///     it was closed.
+///////////////////////////////////////////////////////////////////////////////
+void CListener::HandleMulticastRead(const boost::system::error_code& e,
+                                    std::size_t bytes_transferred)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    if(!m_mcenabled)
+    {
+        return;
+    }
+    if(e)
+    {
+        FREEDM_LOG_ERROR(Logger)<<"HandleMulticastRead failed: " << e.message() << std::endl;
+    }
+    else
+    {
+        ProcessDatagram(m_mcbuffer.begin(), bytes_transferred, m_mcrecv_from);
+    }
+    ScheduleMulticastListen();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CListener::ProcessMulticast
+/// @description Delivers the messages of a window sent to the multicast
+///     group. These are idempotent broadcasts; they are not sequenced or
+///     acknowledged, and a lost one is simply superseded by the next. Only
+///     known peers are listened to, since a peer would otherwise only have
+///     sent the message to the DGIs in its host list. A DGI's own broadcasts
+///     are looped back and dropped here.
+/// @pre pmw.multicast() is set.
+/// @post Unexpired messages from known peers are scheduled for delivery.
+/// @param window The parsed window.
+///////////////////////////////////////////////////////////////////////////////
+void CListener::ProcessMulticast(WindowPtr window)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    std::string uuid = window->source_uuid();
+    if(uuid == CGlobalConfiguration::Instance().GetUUID())
+    {
+        return;
+    }
+    if(!CConnectionManager::Instance().HasHost(uuid))
+    {
+        FREEDM_LOG_DEBUG(Logger)<<"Ignoring multicast from unknown peer "<<uuid<<std::endl;
+        return;
+    }
+    BOOST_FOREACH(const ProtocolMessage &pm, window->messages())
+    {
+        if(pm.status() != ProtocolMessage::MESSAGE || MessageIsExpired(pm))
+        {
+            continue;
+        }
+        FREEDM_LOG_DEBUG(Logger)<<"Accepted multicast message "<<pm.hash()<<" from "<<uuid<<std::endl;
+        Deliver(boost::shared_ptr<const ProtocolMessage>(window, &pm), uuid);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CListener::Broadcast
+/// @description Sends a module message to every DGI in the multicast group
+///     with one serialization and one datagram. The message is not
+///     acknowledged, so only idempotent messages whose loss is repaired by
+///     the next broadcast should be sent this way; replies go through the
+///     peers' connections as usual.
+/// @pre None
+/// @post If multicast is enabled and the message fits in a datagram, it is
+///     sent to the group, from the network strand if the broker is
+///     multithreaded.
+/// @param msg The message to broadcast.
+/// @return False if the message must instead be sent to each peer.
+///////////////////////////////////////////////////////////////////////////////
+bool CListener::Broadcast(const ModuleMessage& msg)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    if(!m_mcenabled)
+    {
+        return false;
+    }
+
+    // The one encoding of the module message is hashed and embedded as is.
+    std::string payload;
+    msg.SerializeToString(&payload);
+    ProtocolMessage pm;
+    pm.set_sequence_num(0);
+    pm.set_status(ProtocolMessage::MESSAGE);
+    pm.set_hash(ComputeHash(payload.data(), payload.size()));
+    SetExpirationTimeFromNow(pm,
+        CTimings::GetDuration(CTimings::CSRC_DEFAULT_TIMEOUT), false);
+    std::string encoded;
+    pm.SerializeToString(&encoded);
+    AppendField(encoded, ProtocolMessage::kModuleMessageFieldNumber, payload);
+
+    ProtocolMessageWindow pmw;
+    pmw.set_source_uuid(CGlobalConfiguration::Instance().GetUUID());
+    StampMessageSendtime(pmw, false);
+    pmw.set_binary_timestamps(true);
+    pmw.set_multicast(true);
+    boost::shared_ptr<std::string> data = boost::make_shared<std::string>();
+    pmw.SerializeToString(data.get());
+    AppendField(*data, ProtocolMessageWindow::kMessagesFieldNumber, encoded);
+    if(data->size() > CGlobalConfiguration::MAX_PACKET_SIZE)
+    {
+        return false;
+    }
+
+    if(CBroker::Instance().IsMultithreaded())
+    {
+        CBroker::Instance().GetNetworkStrand().dispatch(
+            boost::bind(&CListener::SendBroadcast, this, data));
+    }
+    else
+    {
+        SendBroadcast(data);
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CListener::SendBroadcast
+/// @description Writes an encoded multicast window to the group from the
+///     listening socket, so receivers see the sender's usual endpoint.
+/// @pre Called through the network strand if the broker is multithreaded.
+/// @post The datagram is sent, or a warning is logged.
+/// @param data The encoded window.
+///////////////////////////////////////////////////////////////////////////////
+void CListener::SendBroadcast(boost::shared_ptr<std::string> data)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    try
+    {
+        m_socket.send_to(boost::asio::buffer(*data), m_mcgroup);
+    }
+    catch(boost::system::system_error& e)
+    {
+        FREEDM_LOG_WARN(Logger)<<"Multicast to "<<m_mcgroup<<" failed: "<<e.what()<<std::endl;
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -200,15 +855,16 @@ void CListener::HandleRead(const boost::system::error_code& e,
 ///////////////////////////////////////////////////////////////////////////////
 void CListener::ScheduleListen()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    Logger.Debug<<"Listening for next message"<<std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_DEBUG(Logger)<<"Listening for next message"<<std::endl;
     // We don't care where the messages are coming from, but async_receive_from
     // requires that this variable remain valid until the handler is called.
     m_socket.async_receive_from(
         boost::asio::buffer(m_buffer, CGlobalConfiguration::MAX_PACKET_SIZE),
-        m_recv_from, boost::bind(&CListener::HandleRead, this,
-            boost::asio::placeholders::error,
-            boost::asio::placeholders::bytes_transferred));
+        m_recv_from, CBroker::Instance().GetNetworkStrand().wrap(
+            boost::bind(&CListener::HandleRead, this,
+                boost::asio::placeholders::error,
+                boost::asio::placeholders::bytes_transferred)));
 }
 
     } // namespace broker
@@ -25,17 +25,30 @@
 #define CLISTENER_HPP
 
 #include "CGlobalConfiguration.hpp"
+#include "CWindowPool.hpp"
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
 
 #include <boost/asio.hpp>
 #include <boost/array.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
 
 namespace freedm {
     namespace broker {
 
 class CBroker;
+class CConnection;
 class CConnectionManager;
+class IProtocol;
+class ModuleMessage;
+class ProtocolMessage;
+class ProtocolMessageWindow;
 
 /// Represents a single CListener from a client.
 class CListener
@@ -53,7 +66,46 @@ public:
 
     /// Gets the listener socket
     boost::asio::ip::udp::socket& GetSocket() { return m_socket; };
+
+    /// Queues a datagram to be sent in the next batch
+    void QueueDatagram(const char* data, std::size_t length,
+        const boost::asio::ip::udp::endpoint& to, boost::weak_ptr<IProtocol> sender);
+
+    /// Sends a message once to every DGI in the multicast group
+    bool Broadcast(const ModuleMessage& msg);
+
+    /// Returns true if group-wide messages can be multicast
+    bool IsMulticastEnabled() const { return m_mcenabled; };
 private:
+    /// A serialized window waiting for the next batched send
+    struct SDatagram
+    {
+        /// The serialized window
+        std::vector<char> data;
+        /// Where the window is going
+        boost::asio::ip::udp::endpoint to;
+        /// The protocol that wrote the window, stopped if the send fails
+        boost::weak_ptr<IProtocol> sender;
+    };
+
+    /// A module message being put back together from its fragments
+    struct SReassembly
+    {
+        /// The fragments received so far, in order
+        std::string data;
+        /// The index of the fragment expected next
+        unsigned int next;
+        /// The sequence numbers and hashes of the fragments received so far
+        std::vector<ProtocolMessage> pieces;
+    };
+
+    /// The refused messages a sender has yet to send again, oldest first,
+    /// by the module they are for
+    typedef std::map<std::string, std::deque<ProtocolMessage> > RefusalMap;
+
+    /// A parsed window shared by the messages delivered from it
+    typedef CWindowPool::WindowPtr WindowPtr;
+
     /// Private constructor for the singleton instance
     CListener();
 
@@ -63,6 +115,45 @@ private:
     /// Asynchronously listen for a new message
     void ScheduleListen();
 
+    /// Opens the multicast socket and joins the configured group
+    void StartMulticast();
+
+    /// Asynchronously listen for a message to the multicast group
+    void ScheduleMulticastListen();
+
+    /// Handle completion of a read from the multicast group.
+    void HandleMulticastRead(const boost::system::error_code& e, std::size_t bytes_transferred);
+
+    /// Hands the unsequenced messages of a multicast window to the dispatcher
+    void ProcessMulticast(WindowPtr window);
+
+    /// Writes an encoded window to the multicast group
+    void SendBroadcast(boost::shared_ptr<std::string> data);
+
+    /// Parses a datagram and hands its messages to the connection and dispatcher
+    void ProcessDatagram(const char* data, std::size_t length,
+        const boost::asio::ip::udp::endpoint& from);
+
+    /// Reads and processes the datagrams already waiting on the socket
+    void DrainSocket();
+
+    /// Hands an accepted message to the dispatcher, reassembling fragments
+    void Deliver(boost::shared_ptr<const ProtocolMessage> pm, const std::string& uuid);
+
+    /// Delivers a message accepted in order, or refuses it for a full queue
+    void Accept(CConnection& conn, boost::shared_ptr<const ProtocolMessage> pm,
+        const std::string& uuid);
+
+    /// Decides if a module message accepted in order is delivered or refused
+    bool Admit(const std::string& uuid, const ProtocolMessage& pm, const ModuleMessage& msg);
+
+    /// Adds an accepted fragment to the module message it belongs to
+    boost::shared_ptr<const ModuleMessage> Reassemble(const std::string& uuid,
+        const ProtocolMessage& pm, std::vector<ProtocolMessage>* pieces = NULL);
+
+    /// Sends every queued datagram with as few system calls as possible
+    void FlushDatagrams();
+
     /// Buffer for incoming data.
     boost::array<char, CGlobalConfiguration::MAX_PACKET_SIZE> m_buffer;
 
@@ -71,6 +162,39 @@ private:
 
     /// Endpoint for incoming message
     boost::asio::ip::udp::endpoint m_recv_from;
+
+    /// Buffer for incoming multicast data.
+    boost::array<char, CGlobalConfiguration::MAX_PACKET_SIZE> m_mcbuffer;
+
+    /// Socket joined to the multicast group.
+    boost::asio::ip::udp::socket m_mcsocket;
+
+    /// Endpoint for incoming multicast messages
+    boost::asio::ip::udp::endpoint m_mcrecv_from;
+
+    /// The multicast group, or broadcast address, and its port
+    boost::asio::ip::udp::endpoint m_mcgroup;
+
+    /// True once the multicast socket has joined the group
+    bool m_mcenabled;
+
+    /// Windows which can be reused for the next datagram
+    CWindowPool m_windows;
+
+    /// Datagrams waiting for the next batched send
+    std::vector<SDatagram> m_outgoing;
+
+    /// Lock for the outgoing datagrams, any broker thread can write
+    boost::mutex m_outgoingMutex;
+
+    /// Buffers for the datagrams read by a single recvmmsg call
+    std::vector<char> m_batchbuffer;
+
+    /// Partially received module messages, by the UUID of the sender
+    std::map<std::string, SReassembly> m_fragments;
+
+    /// Refused messages that have not come back, by the UUID of the sender
+    std::map<std::string, RefusalMap> m_refused;
 };
 
 
@@ -0,0 +1,339 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file           CLogWriter.cpp
+///
+/// @project        FREEDM DGI
+///
+/// @description    Writes log records, optionally from a background thread.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CLogWriter.hpp"
+#include "CGlobalConfiguration.hpp"
+#include "CLogger.hpp"
+
+#include <set>
+
+#include <boost/bind.hpp>
+#include <boost/date_time/c_local_time_adjustor.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/locks.hpp>
+
+using namespace boost::posix_time;
+
+namespace freedm {
+
+namespace broker {
+
+namespace {
+
+/// This file's logger.
+CLocalLogger Logger(__FILE__);
+
+/// Only one record can be written at a time.
+boost::mutex mutex;
+
+/// How long the log writer sleeps when every buffer is empty, in ms.
+const unsigned int DRAIN_INTERVAL = 5;
+
+/// Converts the UTC times of the records to local time.
+typedef boost::date_time::c_local_adjustor<ptime> c_local_adjustor;
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CLogWriter::instance
+/// @description Gets the writer which moves log records to their streams.
+/// @pre None
+/// @post None
+/// @return The instance of the log writer.
+///////////////////////////////////////////////////////////////////////////////
+CLogWriter& CLogWriter::instance()
+{
+    static CLogWriter singleton;
+    return singleton;
+}
+///////////////////////////////////////////////////////////////////////////////
+/// CLogWriter::CLogWriter
+/// @description Creates a stopped log writer; until it is started, records
+///     are written by the threads that log them.
+/// @pre None
+/// @post None
+///////////////////////////////////////////////////////////////////////////////
+CLogWriter::CLogWriter()
+    : m_running(false)
+    , m_writers(0)
+    , m_stopping(false)
+    , m_capacity(0)
+    , m_policy(DROP)
+    , m_dropped(0)
+{
+    //pass
+}
+///////////////////////////////////////////////////////////////////////////////
+/// CLogWriter::~CLogWriter
+/// @description Writes the records still buffered when the program exits.
+/// @pre None
+/// @post The background thread has exited.
+///////////////////////////////////////////////////////////////////////////////
+CLogWriter::~CLogWriter()
+{
+    Stop();
+}
+///////////////////////////////////////////////////////////////////////////////
+/// CLogWriter::Start
+/// @description Starts the background thread. From then on, each thread that
+///     logs gets a buffer of its own the first time it writes a record.
+/// @pre capacity is greater than zero.
+/// @post Records are written by the background thread.
+/// @param capacity the number of records each thread can buffer.
+/// @param policy what a thread does when its buffer is full.
+///////////////////////////////////////////////////////////////////////////////
+void CLogWriter::Start(const std::size_t capacity, const OverflowPolicy policy)
+{
+    if (m_running)
+    {
+        return;
+    }
+    m_capacity = capacity;
+    m_policy = policy;
+    m_stopping = false;
+    m_running = true;
+    boost::thread thread(boost::bind(&CLogWriter::Run, this));
+    m_thread.swap(thread);
+}
+///////////////////////////////////////////////////////////////////////////////
+/// CLogWriter::Stop
+/// @description Stops the background thread and writes the records it had
+///     not yet written. The broker calls this before it exits on a signal.
+///     Threads that log after m_running is cleared write their records
+///     themselves; the final drain waits for the threads that were already
+///     queueing a record, so no record is left behind in a buffer.
+/// @pre None
+/// @post Records are written by the threads that log them.
+///////////////////////////////////////////////////////////////////////////////
+void CLogWriter::Stop()
+{
+    if (!m_running)
+    {
+        return;
+    }
+    m_running = false;
+    {
+        boost::lock_guard<boost::mutex> lock(m_statemutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    if (boost::this_thread::get_id() != m_thread.get_id())
+    {
+        m_thread.join();
+    }
+    while (m_writers > 0)
+    {
+        boost::this_thread::yield();
+    }
+    Drain();
+}
+///////////////////////////////////////////////////////////////////////////////
+/// CLogWriter::IsRunning
+/// @description Checks whether the background thread writes the records.
+/// @pre None
+/// @post None
+/// @return True if records should be passed to Write.
+///////////////////////////////////////////////////////////////////////////////
+bool CLogWriter::IsRunning() const
+{
+    return m_running;
+}
+///////////////////////////////////////////////////////////////////////////////
+/// CLogWriter::Write
+/// @description Writes a record to its stream under the output lock, or
+///     once the writer is running, appends it to the calling thread's buffer.
+///     The buffer has a single producer and a single consumer, so this takes
+///     no lock. Only the time is taken here; converting it to local time and
+///     formatting it is left to the background thread.
+/// @pre name outlives the writer, as the names of the static loggers do.
+/// @post The record is written to out, will be written to out by the
+///     background thread or by Stop, or it is counted as dropped.
+/// @param out the stream to write the record to.
+/// @param name the name of the log.
+/// @param level the level of the log.
+/// @param s the text written to the log.
+/// @param n the length of the text.
+///////////////////////////////////////////////////////////////////////////////
+void CLogWriter::Write(std::ostream* const out, const std::string& name,
+        const unsigned int level, const char* const s, std::streamsize n)
+{
+    SRecord r;
+    r.out = out;
+    r.time = microsec_clock::universal_time();
+    r.name = &name;
+    r.level = level;
+
+    // Counted before m_running is read, so Stop either waits for the record
+    // or this thread sees the writer stopped and writes it itself.
+    m_writers++;
+    if (!m_running)
+    {
+        m_writers--;
+        boost::lock_guard<boost::mutex> lock(mutex);
+        *out << c_local_adjustor::utc_to_local(r.time)
+                + CGlobalConfiguration::Instance().GetClockSkew()
+                << " : " << name << "(" << level << "):\n\t";
+        out->write(s, n);
+        return;
+    }
+
+    r.text.assign(s, n);
+    RecordQueue& queue = GetQueue();
+    while (!queue.push(r))
+    {
+        // The background thread can't wait for itself to make room.
+        if (m_policy == DROP || boost::this_thread::get_id() == m_thread.get_id())
+        {
+            m_dropped++;
+            break;
+        }
+        if (!m_running)
+        {
+            boost::lock_guard<boost::mutex> lock(mutex);
+            Format(r, CGlobalConfiguration::Instance().GetClockSkew());
+            break;
+        }
+        boost::this_thread::yield();
+    }
+    m_writers--;
+}
+///////////////////////////////////////////////////////////////////////////////
+/// CLogWriter::GetQueue
+/// @description Returns the calling thread's buffer. The buffer is shared with
+///     the background thread, which writes what is left of it and lets it go
+///     after the thread exits.
+/// @pre None
+/// @post The calling thread has a buffer in m_queues.
+/// @return The calling thread's buffer.
+///////////////////////////////////////////////////////////////////////////////
+CLogWriter::RecordQueue& CLogWriter::GetQueue()
+{
+    QueuePtr* local = m_local.get();
+    if (local == NULL)
+    {
+        local = new QueuePtr(new RecordQueue(m_capacity));
+        m_local.reset(local);
+        boost::lock_guard<boost::mutex> lock(m_queuesmutex);
+        m_queues.push_back(*local);
+    }
+    return **local;
+}
+///////////////////////////////////////////////////////////////////////////////
+/// CLogWriter::Run
+/// @description Writes the buffered records until the writer is stopped,
+///     sleeping for DRAIN_INTERVAL whenever the buffers are empty. Threads
+///     that log never wake the writer, so that logging takes no lock.
+/// @pre Started by Start.
+/// @post m_stopping is true.
+///////////////////////////////////////////////////////////////////////////////
+void CLogWriter::Run()
+{
+    boost::unique_lock<boost::mutex> lock(m_statemutex);
+    while (!m_stopping)
+    {
+        lock.unlock();
+        std::size_t written = Drain();
+        lock.lock();
+        if (written == 0 && !m_stopping)
+        {
+            m_wake.timed_wait(lock, milliseconds(DRAIN_INTERVAL));
+        }
+    }
+}
+///////////////////////////////////////////////////////////////////////////////
+/// CLogWriter::Drain
+/// @description Writes the records of every buffer and flushes the streams
+///     they were written to once. At most one buffer's worth of records is
+///     taken from each thread per pass, so a busy thread can't hold back the
+///     others. Buffers of threads which have exited are released once empty.
+/// @pre None
+/// @post The records buffered before the call have been written, up to the
+///     per-pass limit.
+/// @return The number of records written.
+///////////////////////////////////////////////////////////////////////////////
+std::size_t CLogWriter::Drain()
+{
+    std::vector<QueuePtr> queues;
+    {
+        boost::lock_guard<boost::mutex> lock(m_queuesmutex);
+        std::vector<QueuePtr>::iterator it = m_queues.begin();
+        while (it != m_queues.end())
+        {
+            // Only m_queues refers to the buffer of a thread that has exited.
+            if (it->unique() && (*it)->read_available() == 0)
+            {
+                it = m_queues.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+        queues = m_queues;
+    }
+
+    // The skew is applied as of the write, which is at most a pass late.
+    time_duration skew = CGlobalConfiguration::Instance().GetClockSkew();
+    std::size_t written = 0;
+    std::set<std::ostream*> streams;
+    {
+        boost::lock_guard<boost::mutex> lock(mutex);
+        SRecord r;
+        BOOST_FOREACH(QueuePtr queue, queues)
+        {
+            for (std::size_t i = 0; i < m_capacity && queue->pop(r); i++)
+            {
+                Format(r, skew);
+                streams.insert(r.out);
+                written++;
+            }
+        }
+        BOOST_FOREACH(std::ostream* out, streams)
+        {
+            out->flush();
+        }
+    }
+
+    unsigned long dropped = m_dropped.exchange(0);
+    if (dropped > 0)
+    {
+        FREEDM_LOG_WARN(Logger) << "Dropped " << dropped << " log records because the "
+                << "log buffers were full" << std::endl;
+    }
+    return written;
+}
+///////////////////////////////////////////////////////////////////////////////
+/// CLogWriter::Format
+/// @description Writes a record to its stream with the same header that
+///     Write gives the records it writes itself.
+/// @pre The output lock is held by the caller.
+/// @post The record is written to its stream.
+/// @param r the record to write.
+/// @param skew the clock skew to add to the time of the record.
+///////////////////////////////////////////////////////////////////////////////
+void CLogWriter::Format(const SRecord& r, const time_duration& skew)
+{
+    *r.out << c_local_adjustor::utc_to_local(r.time) + skew
+            << " : " << *r.name << "(" << r.level << "):\n\t" << r.text;
+}
+
+} // namespace broker
+
+} // namespace freedm
@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file           CLogWriter.hpp
+///
+/// @project        FREEDM DGI
+///
+/// @description    Writes log records, optionally from a background thread.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CLOGWRITER_HPP
+#define CLOGWRITER_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
+
+namespace freedm {
+namespace broker {
+
+/// Writes the log from a background thread
+class CLogWriter : private boost::noncopyable
+{
+    ///////////////////////////////////////////////////////////////////////////
+    /// @description Writes the records of every CLog. Until it is started,
+    ///     each record is written by the thread that logs it. Once started,
+    ///     log records are timestamped by the thread that writes them and
+    ///     appended to a ring buffer owned by that thread. A background thread
+    ///     drains the buffers, formats the timestamps and writes the records
+    ///     to their streams in batches, so a thread that logs never waits for
+    ///     the stream or for other threads.
+    ///
+    /// @limitations Singleton. Records from different threads are written in
+    ///     batches per thread, so they may appear slightly out of order.
+    ///////////////////////////////////////////////////////////////////////////
+    public:
+        /// What a thread does when its buffer is full
+        enum OverflowPolicy
+        {
+            /// Discard the record and count it
+            DROP,
+            /// Wait for the background thread to make room
+            BLOCK
+        };
+        /// Retrieves the singleton instance of the log writer.
+        static CLogWriter& instance();
+        /// Stops the background thread, writing the remaining records.
+        ~CLogWriter();
+        /// Starts writing the log from the background thread.
+        void Start(const std::size_t capacity, const OverflowPolicy policy);
+        /// Writes the remaining records and returns to synchronous writes.
+        void Stop();
+        /// Checks whether records are written by the background thread.
+        bool IsRunning() const;
+        /// Writes a record to a stream, or queues it if the writer is running.
+        void Write(std::ostream* const out, const std::string& name,
+                const unsigned int level, const char* const s, std::streamsize n);
+    private:
+        /// A record and the stream it is written to
+        struct SRecord
+        {
+            /// The stream to write the record to
+            std::ostream* out;
+            /// When the record was written, in UTC
+            boost::posix_time::ptime time;
+            /// Name of the log, which outlives the writer
+            const std::string* name;
+            /// Level of the log
+            unsigned int level;
+            /// The text written to the log
+            std::string text;
+        };
+        /// Type of the buffer each thread writes its records to.
+        typedef boost::lockfree::spsc_queue<SRecord> RecordQueue;
+        /// Buffers are shared with the background thread.
+        typedef boost::shared_ptr<RecordQueue> QueuePtr;
+        /// Private constructor for the singleton instance
+        CLogWriter();
+        /// Returns the calling thread's buffer, creating it on first use.
+        RecordQueue& GetQueue();
+        /// Body of the background thread.
+        void Run();
+        /// Writes every buffered record, returning how many there were.
+        std::size_t Drain();
+        /// Formats a record with its header, requires the output lock.
+        static void Format(const SRecord& r, const boost::posix_time::time_duration& skew);
+        /// True while the background thread writes the records.
+        boost::atomic<bool> m_running;
+        /// The number of threads inside Write, which Stop waits for.
+        boost::atomic<unsigned int> m_writers;
+        /// Set to ask the background thread to exit.
+        bool m_stopping;
+        /// Records each thread can buffer.
+        std::size_t m_capacity;
+        /// What a thread does when its buffer is full.
+        OverflowPolicy m_policy;
+        /// The buffers of every thread that has logged.
+        std::vector<QueuePtr> m_queues;
+        /// Lock for m_queues.
+        boost::mutex m_queuesmutex;
+        /// The calling thread's buffer.
+        boost::thread_specific_ptr<QueuePtr> m_local;
+        /// Records discarded because a buffer was full.
+        boost::atomic<unsigned long> m_dropped;
+        /// Lock for m_stopping.
+        boost::mutex m_statemutex;
+        /// Wakes the background thread to stop.
+        boost::condition_variable m_wake;
+        /// The background thread.
+        boost::thread m_thread;
+};
+
+} // namespace broker
+} // namespace freedm
+
+#endif // CLOGWRITER_HPP
@@ -22,11 +22,9 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "CLogger.hpp"
-#include "CGlobalConfiguration.hpp"
+#include "CLogWriter.hpp"
 
 #include <boost/program_options/options_description.hpp>
-#include <boost/thread/locks.hpp>
-#include <boost/thread/mutex.hpp>
 
 using namespace boost::posix_time;
 
@@ -39,9 +37,6 @@ namespace {
 /// This file's logger.
 CLocalLogger Logger(__FILE__);
 
-/// Only one logger can write at a time.
-boost::mutex mutex;
-
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -94,10 +89,7 @@ std::streamsize CLog::write(const char* const s, std::streamsize n)
 {
     if (GetOutputLevel() >= m_level)
     {
-        boost::lock_guard<boost::mutex> lock(mutex);
-        *m_ostream << microsec_clock::local_time() + CGlobalConfiguration::Instance().GetClockSkew() << " : "
-                << m_name << "(" << m_level << "):\n\t";
-        boost::iostreams::write(*m_ostream, s, n);
+        CLogWriter::instance().Write(m_ostream, m_name, m_level, s, n);
     }
     return n;
 }
@@ -121,7 +113,8 @@ unsigned int CLog::GetOutputLevel() const
 /// @param loggername The name of this logger set.
 /// @pre None
 /// @post Creates log levels 0-8 for the logger specified by loggername.
-///     Registers this local logger with the GlobalLogger.
+///     Registers this local logger with the GlobalLogger, which sets the
+///     cached output level.
 ///////////////////////////////////////////////////////////////////////////////
 CLocalLogger::CLocalLogger(const std::string loggername)
 : Trace(this, 8, basename(loggername) + " : Trace"),
@@ -133,9 +126,10 @@ Warn(this, 3, basename(loggername) + " : Warn"),
 Error(this, 2, basename(loggername) + " : Error"),
 Alert(this, 1, basename(loggername) + " : Alert"),
 Fatal(this, 0, basename(loggername) + " : Fatal"),
-m_name(basename(loggername))
+m_name(basename(loggername)),
+m_level(0)
 {
-    CGlobalLogger::instance().RegisterLocalLogger(m_name);
+    CGlobalLogger::instance().RegisterLocalLogger(*this);
 }
 ///////////////////////////////////////////////////////////////////////////////
 /// CLocalLogger::GetName
@@ -152,21 +146,23 @@ std::string CLocalLogger::GetName() const
 ///////////////////////////////////////////////////////////////////////////////
 /// CLocalLogger::GetOutputLevel
 /// @description Gets the logger's output level, which decides how verbose the
-///     logger will be
+///     logger will be. The level is cached here so that checking it doesn't
+///     search the global logger's table.
 /// @pre None
 /// @post None
 /// @return The output level of this logger.
 ///////////////////////////////////////////////////////////////////////////////
 unsigned int CLocalLogger::GetOutputLevel() const
 {
-    return CGlobalLogger::instance().GetOutputLevel(m_name);
+    return m_level.load(boost::memory_order_relaxed);
 }
 ///////////////////////////////////////////////////////////////////////////////
 /// CLocalLogger::SetOutputLevel
 /// @description Sets the logger's output level, which describes how verbose
 ///     the logger is
 /// @pre None
-/// @post The level value is stored in the GlobalLogger.
+/// @post The level value is stored in the GlobalLogger, which updates the
+///     cached level of every local logger with this name.
 ///////////////////////////////////////////////////////////////////////////////
 void CLocalLogger::SetOutputLevel(const unsigned int level)
 {
@@ -188,14 +184,37 @@ CGlobalLogger& CGlobalLogger::instance()
 ///////////////////////////////////////////////////////////////////////////////
 /// CGlobalLogger::RegisterLocalLogger
 /// @description Registers a local logger with the global logger so it can
-///     be enumerated for functions like SetGlobalLevel.
+///     be enumerated for functions like SetGlobalLevel. Loggers may share a
+///     name, in which case they share a level.
 /// @pre None
-/// @post The loggers name is added to the loggers table.
-/// @param logger the name of the CLogger being added.
+/// @post The loggers name is added to the loggers table, and the logger
+///     caches the level of that name.
+/// @param logger the CLogger being added.
+///////////////////////////////////////////////////////////////////////////////
+void CGlobalLogger::RegisterLocalLogger(CLocalLogger& logger)
+{
+    const std::string name = logger.GetName();
+    m_loggers.insert(std::make_pair(name, m_default));
+    m_instances.insert(std::make_pair(name, &logger));
+    Publish(name);
+}
 ///////////////////////////////////////////////////////////////////////////////
-void CGlobalLogger::RegisterLocalLogger(const std::string logger)
+/// CGlobalLogger::Publish
+/// @description Copies the level of a logger from the table to the local
+///     loggers registered with that name, which check it on every log.
+/// @pre The logger has been registered with the GlobalLogger.
+/// @post The cached levels of the local loggers match the table.
+/// @param logger the name of the logger to update.
+///////////////////////////////////////////////////////////////////////////////
+void CGlobalLogger::Publish(const std::string logger)
 {
-    m_loggers.insert(std::make_pair(logger, m_default));
+    unsigned int level = m_loggers[logger];
+    std::pair<InstanceMap::iterator, InstanceMap::iterator> range;
+    range = m_instances.equal_range(logger);
+    for (InstanceMap::iterator it = range.first; it != range.second; it++)
+    {
+        it->second->m_level.store(level, boost::memory_order_relaxed);
+    }
 }
 ///////////////////////////////////////////////////////////////////////////////
 /// CGlobalLogger::SetGlobalLevel
@@ -213,6 +232,7 @@ void CGlobalLogger::SetGlobalLevel(const unsigned int level)
     for (it = m_loggers.begin(); it != m_loggers.end(); it++)
     {
         ( *it ).second = level;
+        Publish(it->first);
     }
     m_default = level;
 }
@@ -229,6 +249,7 @@ void CGlobalLogger::SetOutputLevel(const std::string logger,
 {
     //Fetch the specified logger and set its level to the one specified
     m_loggers[logger] = level;
+    Publish(logger);
 }
 ///////////////////////////////////////////////////////////////////////////////
 /// CGlobalLogger::GetOutputLevel
@@ -251,11 +272,13 @@ unsigned int CGlobalLogger::GetOutputLevel(const std::string logger) const
 ///////////////////////////////////////////////////////////////////////////////
 /// CGlobalLogger::SetInitialLoggerLevels
 /// @description Sets the logger verbosity levels to the values specified as
-///     default or in one of the configuration files.
+///     default or in one of the configuration files. Loggers the file does
+///     not mention are set to the global level, so the file can be reloaded
+///     while the DGI runs to undo an earlier setting.
 /// @pre None
 /// @post Logger levels are set to the levels specified in the logger config
 ///     file. Exceptions may be thrown if the file is not correctly formatted
-///     or contains invalid entries.
+///     or contains invalid entries, in which case no level is changed.
 /// @param loggerCfgFile the name of the config file to process the values
 ///     from.
 ///////////////////////////////////////////////////////////////////////////////
@@ -279,7 +302,7 @@ void CGlobalLogger::SetInitialLoggerLevels(const std::string loggerCfgFile)
     ifs.open(loggerCfgFile.c_str());
     if (!ifs)
     {
-        Logger.Warn << "Unable to load logger config file: "
+        FREEDM_LOG_WARN(Logger) << "Unable to load logger config file: "
                 << loggerCfgFile << std::endl;
         return;
     }
@@ -296,7 +319,7 @@ void CGlobalLogger::SetInitialLoggerLevels(const std::string loggerCfgFile)
                     + e.get_option_name() + "' in " + loggerCfgFile );
         }
         po::notify(vm);
-        Logger.Info << "Logger config file " << loggerCfgFile <<
+        FREEDM_LOG_INFO(Logger) << "Logger config file " << loggerCfgFile <<
                 " successfully loaded." << std::endl;
     }
     ifs.close();
@@ -305,9 +328,11 @@ void CGlobalLogger::SetInitialLoggerLevels(const std::string loggerCfgFile)
     typedef std::pair<std::string, po::variable_value> VerbosityPair;
     BOOST_FOREACH(VerbosityPair pair, vm)
     {
-        if (!vm[pair.first].defaulted())
+        unsigned int level = pair.second.as<unsigned int>( );
+        if (m_loggers[pair.first] != level)
         {
-            m_loggers[pair.first] = pair.second.as<unsigned int>( );
+            m_loggers[pair.first] = level;
+            Publish(pair.first);
         }
     }
 }
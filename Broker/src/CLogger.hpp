@@ -24,10 +24,14 @@
 #ifndef CLOGGER_HPP
 #define CLOGGER_HPP
 
+#include "config.hpp"
+
 #include <cstdlib>
 #include <fstream>
+#include <map>
 #include <string>
 
+#include <boost/atomic.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/foreach.hpp>
 #include <boost/iostreams/concepts.hpp>
@@ -45,6 +49,40 @@ namespace po = boost::program_options;
 std::string(" line ") + boost::lexical_cast<std::string>(__LINE__) ).c_str()
 #endif
 
+// Hints that a log level is usually disabled, so the check stays out of the
+// way of the code around it.
+#ifdef __GNUG__
+#define FREEDM_LOG_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define FREEDM_LOG_UNLIKELY(x) (x)
+#endif
+
+// Writes to a log of a local logger, as in FREEDM_LOG_INFO(Logger) << x;
+// The rest of the statement, including every argument, is evaluated only if
+// the level is enabled. The check reads the level cached in the logger.
+#define FREEDM_LOG_AT(logger, log, level) \
+    !FREEDM_LOG_UNLIKELY((logger).IsEnabled(level)) ? (void) 0 : \
+    freedm::broker::CLogVoidify() & (logger).log
+
+// A log that is compiled out. The statement is still type checked.
+#define FREEDM_LOG_OFF(logger, log) \
+    true ? (void) 0 : freedm::broker::CLogVoidify() & (logger).log
+
+#ifdef NO_DEBUG_LOGGING
+#define FREEDM_LOG_TRACE(logger) FREEDM_LOG_OFF(logger, Trace)
+#define FREEDM_LOG_DEBUG(logger) FREEDM_LOG_OFF(logger, Debug)
+#else
+#define FREEDM_LOG_TRACE(logger) FREEDM_LOG_AT(logger, Trace, 8)
+#define FREEDM_LOG_DEBUG(logger) FREEDM_LOG_AT(logger, Debug, 7)
+#endif
+#define FREEDM_LOG_INFO(logger) FREEDM_LOG_AT(logger, Info, 6)
+#define FREEDM_LOG_NOTICE(logger) FREEDM_LOG_AT(logger, Notice, 5)
+#define FREEDM_LOG_STATUS(logger) FREEDM_LOG_AT(logger, Status, 4)
+#define FREEDM_LOG_WARN(logger) FREEDM_LOG_AT(logger, Warn, 3)
+#define FREEDM_LOG_ERROR(logger) FREEDM_LOG_AT(logger, Error, 2)
+#define FREEDM_LOG_ALERT(logger) FREEDM_LOG_AT(logger, Alert, 1)
+#define FREEDM_LOG_FATAL(logger) FREEDM_LOG_AT(logger, Fatal, 0)
+
 namespace freedm {
 namespace broker {
 
@@ -70,7 +108,7 @@ class CGlobalLogger : private boost::noncopyable
         /// Retrieves the singleton instance of the global logger.
         static CGlobalLogger& instance();
         /// Register a local logger with the global logger.
-        void RegisterLocalLogger(const std::string logger);
+        void RegisterLocalLogger(CLocalLogger& logger);
         /// Sets the logging level of a specific logger.
         void SetOutputLevel(const std::string logger, const unsigned int level);
         /// Fetch the logging level of a specific logger.
@@ -82,12 +120,25 @@ class CGlobalLogger : private boost::noncopyable
         /// Lists all the avaible loggers and their current levels
         void ListLoggers() const;
     private:
+        /// Copies the level of a logger to the local loggers of that name.
+        void Publish(const std::string logger);
         /// What the output level is if not set specifically.
         unsigned int m_default;
         /// Type of container for the output levels.
         typedef std::map< const std::string, unsigned int > OutputMap;
         /// The map of loggers to logger levels.
         OutputMap m_loggers;
+        /// Type of container for the registered local loggers.
+        typedef std::multimap< const std::string, CLocalLogger* > InstanceMap;
+        /// The local loggers which cache each logger's level.
+        InstanceMap m_instances;
+};
+
+/// Discards the stream expression of the logging macros
+struct CLogVoidify
+{
+    /// Lower precedence than << and higher than ?:, so it takes the stream.
+    void operator&(std::ostream&) { }
 };
 
 /// Logging Output Software
@@ -156,10 +207,16 @@ class CLocalLogger : private boost::noncopyable
         unsigned int GetOutputLevel() const;
         /// Sets the output level for this set of loggers.
         void SetOutputLevel(const unsigned int level);
+        /// Checks whether a log of the given level is written.
+        bool IsEnabled(const unsigned int level) const
+            { return level <= m_level.load(boost::memory_order_relaxed); }
 
     private:
+        friend class CGlobalLogger;
         /// The name of this logger
         const std::string m_name;
+        /// The output level, kept in step by the global logger.
+        boost::atomic<unsigned int> m_level;
 };
 
 } // namespace broker
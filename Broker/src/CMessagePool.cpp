@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CMessagePool.cpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Reuses the module messages a module builds from phase to phase
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CMessagePool.hpp"
+
+#include <boost/foreach.hpp>
+
+namespace freedm {
+
+namespace broker {
+
+///////////////////////////////////////////////////////////////////////////////
+/// CMessagePool
+/// @description Constructor for an empty message pool.
+/// @pre None
+/// @post The pool holds no messages.
+///////////////////////////////////////////////////////////////////////////////
+CMessagePool::CMessagePool()
+    : m_messagephase(0)
+{
+    //Pass
+}
+///////////////////////////////////////////////////////////////////////////////
+/// NewMessage
+/// @description Returns an empty message for the caller to build and send.
+///  Messages are pooled per phase: a message built in one phase is cleared
+///  and handed out again once messages are built two phases later, so the
+///  sub-messages and strings it allocated are reused rather than freed and
+///  allocated again every round.
+/// @pre Calls are serialized, as the broker serializes a module's tasks.
+/// @post The message is recorded in the pool of the phase.
+/// @param phase the broker's current phase count
+/// @return A message which stays valid until the end of the next phase. The
+///  caller should send it (Send encodes it immediately) and not keep it.
+///////////////////////////////////////////////////////////////////////////////
+ModuleMessage& CMessagePool::NewMessage(unsigned long phase)
+{
+    RecycleMessages(phase);
+
+    boost::shared_ptr<ModuleMessage> msg;
+    if(m_free.empty())
+    {
+        msg.reset(new ModuleMessage);
+    }
+    else
+    {
+        msg.swap(m_free.back());
+        m_free.pop_back();
+    }
+    m_current.push_back(msg);
+    return *msg;
+}
+///////////////////////////////////////////////////////////////////////////////
+/// ShareMessage
+/// @description Returns a shared pointer to a message, so it can be sent to
+///  this process without the copy CPeerNode::Send makes of messages it does
+///  not own. A message from NewMessage is shared as it is and leaves the pool
+///  once the last reference to it goes; any other message is copied once.
+///  The newest messages are searched first, since a message is usually
+///  shared right after it is built.
+/// @pre The message is not modified after it is shared.
+/// @post None
+/// @param msg the message to share
+/// @return A pointer to the message, or to a copy of it.
+///////////////////////////////////////////////////////////////////////////////
+boost::shared_ptr<const ModuleMessage> CMessagePool::ShareMessage(const ModuleMessage& msg)
+{
+    BOOST_REVERSE_FOREACH(const boost::shared_ptr<ModuleMessage>& pooled, m_current)
+    {
+        if(pooled.get() == &msg)
+            return pooled;
+    }
+    BOOST_FOREACH(const boost::shared_ptr<ModuleMessage>& pooled, m_previous)
+    {
+        if(pooled.get() == &msg)
+            return pooled;
+    }
+    return boost::shared_ptr<const ModuleMessage>(new ModuleMessage(msg));
+}
+///////////////////////////////////////////////////////////////////////////////
+/// GetFreeCount
+/// @description Counts the messages which NewMessage can hand out without
+///  allocating.
+/// @pre None
+/// @post None
+/// @return The size of the free list.
+///////////////////////////////////////////////////////////////////////////////
+std::size_t CMessagePool::GetFreeCount() const
+{
+    return m_free.size();
+}
+///////////////////////////////////////////////////////////////////////////////
+/// RecycleMessages
+/// @description Frees the messages which were built before the previous
+///  phase. A task that is still running when its phase ends can keep using
+///  the messages it built, since those are only moved to m_previous.
+/// @pre None
+/// @post If the phase has changed, m_previous holds the messages of the last
+///  phase messages were built in, and the older ones are cleared onto the
+///  free list, up to MAX_POOLED_MESSAGES of them. Messages which were shared
+///  and are still referenced elsewhere are dropped from the pool.
+/// @param phase the broker's current phase count
+///////////////////////////////////////////////////////////////////////////////
+void CMessagePool::RecycleMessages(unsigned long phase)
+{
+    if(phase == m_messagephase)
+        return;
+
+    // By reference: a copy of the pointer would never be unique.
+    BOOST_FOREACH(const boost::shared_ptr<ModuleMessage>& msg, m_previous)
+    {
+        if(m_free.size() >= MAX_POOLED_MESSAGES)
+            break;
+        // A shared message may still be queued for delivery; let it go.
+        if(!msg.unique())
+            continue;
+        msg->Clear();
+        m_free.push_back(msg);
+    }
+    m_previous.clear();
+    m_previous.swap(m_current);
+    m_messagephase = phase;
+}
+
+} // namespace freedm
+
+} // namespace broker
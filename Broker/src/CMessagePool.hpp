@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CMessagePool.hpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Reuses the module messages a module builds from phase to phase
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CMESSAGEPOOL_HPP
+#define CMESSAGEPOOL_HPP
+
+#include "messages/ModuleMessage.pb.h"
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace freedm {
+
+namespace broker {
+
+/// The module messages built by one module, reused once their phase is over
+class CMessagePool
+    : private boost::noncopyable
+{
+public:
+    /// Creates an empty pool
+    CMessagePool();
+
+    /// Returns an empty message to build during a phase
+    ModuleMessage& NewMessage(unsigned long phase);
+
+    /// Returns a shared pointer to a built message, to send it without copies
+    boost::shared_ptr<const ModuleMessage> ShareMessage(const ModuleMessage& msg);
+
+    /// Returns how many messages are cleared and ready to be built again
+    std::size_t GetFreeCount() const;
+
+private:
+    typedef std::vector< boost::shared_ptr<ModuleMessage> > MessageList;
+
+    /// Moves the messages of finished phases to the free list
+    void RecycleMessages(unsigned long phase);
+
+    /// Messages built during the phase m_messagephase
+    MessageList m_current;
+
+    /// Messages built during the phase before m_messagephase
+    MessageList m_previous;
+
+    /// Cleared messages which are ready to be built again
+    MessageList m_free;
+
+    /// The phase when m_current was started
+    unsigned long m_messagephase;
+
+    /// The most messages kept on the free list
+    static const unsigned int MAX_POOLED_MESSAGES = 64;
+};
+
+} // namespace freedm
+
+} // namespace broker
+
+#endif // CMESSAGEPOOL_HPP
@@ -22,15 +22,21 @@
 /// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "CBroker.hpp"
 #include "CLogger.hpp"
 #include "CPeerNode.hpp"
 #include "CConnectionManager.hpp"
 #include "CConnection.hpp"
+#include "CDispatcher.hpp"
+#include "CEventLog.hpp"
+#include "CGlobalConfiguration.hpp"
 #include "messages/ModuleMessage.pb.h"
 
 #include <map>
 #include <stdexcept>
 
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
 #include <boost/shared_ptr.hpp>
 
 namespace freedm {
@@ -44,6 +50,19 @@ CLocalLogger Logger(__FILE__);
 
 }
 
+/// The interned identifier of a peer and its last known connection. Copies
+/// of a peer node share the handle, so the connection is looked up once.
+struct CPeerNode::SPeerHandle
+{
+    /// The peer's identifier in the connection manager, or NO_PEER until it
+    /// is looked up on the network strand
+    CConnectionManager::PeerId id;
+    /// The connection last used to send to the peer, read and written atomically
+    ConnectionPtr connection;
+    /// True if the peer is this process
+    bool local;
+};
+
 /////////////////////////////////////////////////////////////
 /// CPeerNode::CPeerNode
 /// @description Prepares a peer node. Provides node status
@@ -52,12 +71,15 @@ CLocalLogger Logger(__FILE__);
 /////////////////////////////////////////////////////////////
 CPeerNode::CPeerNode(std::string uuid)
     : m_uuid(uuid)
+    , m_handle(new SPeerHandle)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    m_handle->id = CConnectionManager::NO_PEER;
+    m_handle->local = (uuid == CGlobalConfiguration::Instance().GetUUID());
 }
 CPeerNode::CPeerNode()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 }
 
 
@@ -108,7 +130,8 @@ std::string CPeerNode::GetPort() const
 ///   now, we use UDP and it doesn't matter.
 /// @pre None
 /// @post A message is sent to the peer represented by this
-///   object
+///   object. If the broker is multithreaded, the message is
+///   handed to the network strand and sent from there.
 /// @param msg the message to write to channel.
 /// @return True if the message was sent.
 /////////////////////////////////////////////////////////////
@@ -118,17 +141,166 @@ void CPeerNode::Send(const ModuleMessage& msg)
     {
         throw std::runtime_error("Couldn't send to peer, CPeerNode is empty");
     }
-    boost::shared_ptr<CConnection> c
-            = CConnectionManager::Instance().GetConnectionByUUID(m_uuid);
-    if(c.get() != NULL)
+    CEventLog::Instance().MessageSent(msg, m_uuid);
+    if(m_handle->local)
+    {
+        // The dispatcher keeps the message, so it gets the only copy.
+        DeliverLocal(boost::make_shared<ModuleMessage>(msg));
+        return;
+    }
+    if(CBroker::Instance().IsMultithreaded())
+    {
+        // The connections belong to the network strand, so the connection
+        // is looked up there. The bind keeps its own copy of the node and of
+        // the message until the strand gets to it.
+        CBroker::Instance().GetNetworkStrand().dispatch(
+            boost::bind(&CPeerNode::DeliverOnStrand, *this, msg));
+    }
+    else
+    {
+        GetConnection()->Send(msg);
+    }
+}
+
+/////////////////////////////////////////////////////////////
+/// CPeerNode::Send
+/// @description Sends a message which the caller shares
+///   rather than owns. A message to this process is handed to
+///   the dispatcher as it is, and a message to a peer is kept
+///   alive by the pointer until the network strand writes it,
+///   so neither path copies the message.
+/// @pre The message is not modified once it has been sent.
+/// @post A message is sent to the peer represented by this
+///   object.
+/// @param msg the message to write to channel.
+/////////////////////////////////////////////////////////////
+void CPeerNode::Send(boost::shared_ptr<const ModuleMessage> msg)
+{
+    if(m_uuid.size() == 0)
+    {
+        throw std::runtime_error("Couldn't send to peer, CPeerNode is empty");
+    }
+    CEventLog::Instance().MessageSent(*msg, m_uuid);
+    if(m_handle->local)
+    {
+        DeliverLocal(msg);
+        return;
+    }
+    if(CBroker::Instance().IsMultithreaded())
+    {
+        CBroker::Instance().GetNetworkStrand().dispatch(
+            boost::bind(&CPeerNode::DeliverShared, *this, msg));
+    }
+    else
+    {
+        GetConnection()->Send(*msg);
+    }
+}
+
+/////////////////////////////////////////////////////////////
+/// CPeerNode::DeliverLocal
+/// @description Delivers a message addressed to this process
+///   without looking up the connection to it. Messages to
+///   unscheduled modules are handled as soon as the
+///   dispatcher gets them, so with more than one thread the
+///   dispatcher is still called from the network strand.
+/// @pre This node refers to this process.
+/// @post The message is scheduled to be delivered.
+/// @param msg the message to deliver.
+/////////////////////////////////////////////////////////////
+void CPeerNode::DeliverLocal(boost::shared_ptr<const ModuleMessage> msg)
+{
+    if(CBroker::Instance().IsMultithreaded())
     {
-        c->Send(msg);
+        CBroker::Instance().GetNetworkStrand().dispatch(
+            boost::bind(&CDispatcher::HandleRequest,
+                &CDispatcher::Instance(), msg, m_uuid));
     }
     else
     {
-        Logger.Error << "Got empty pointer back for peer: "<<m_uuid<<std::endl;        
+        CDispatcher::Instance().HandleRequest(msg, m_uuid);
+    }
+}
+
+/////////////////////////////////////////////////////////////
+/// CPeerNode::GetConnection
+/// @description Returns the connection to the peer. The
+///   connection is cached in the handle shared by the copies
+///   of this node, so the connection manager is only asked
+///   for it again once it has stopped.
+/// @pre The node refers to a peer. Called from the network strand, or
+///   from the only broker thread, since it may stop or create connections.
+/// @post The handle holds the returned connection.
+/// @return The connection to the peer.
+/////////////////////////////////////////////////////////////
+ConnectionPtr CPeerNode::GetConnection()
+{
+    ConnectionPtr c = boost::atomic_load(&m_handle->connection);
+    if(c.get() != NULL && !c->GetStopped())
+    {
+        return c;
+    }
+    if(m_handle->id == CConnectionManager::NO_PEER)
+    {
+        m_handle->id = CConnectionManager::Instance().FindPeer(m_uuid);
+    }
+    c = CConnectionManager::Instance().GetConnection(m_handle->id);
+    if(c.get() == NULL || c->GetStopped())
+    {
+        c = CConnectionManager::Instance().GetConnectionByUUID(m_uuid);
+    }
+    if(c.get() == NULL)
+    {
+        FREEDM_LOG_ERROR(Logger) << "Got empty pointer back for peer: "<<m_uuid<<std::endl;
         throw std::runtime_error("Couldn't send to peer, CConnectionManager returned empty pointer");
     }
+    boost::atomic_store(&m_handle->connection, c);
+    return c;
+}
+
+/////////////////////////////////////////////////////////////
+/// CPeerNode::DeliverOnStrand
+/// @description Delivers a message that was handed to the
+///   network strand, looking up the connection there. The
+///   module that sent the message is no longer waiting on the
+///   call, so errors are logged rather than thrown into the
+///   ioservice.
+/// @pre Called through the broker's network strand.
+/// @post The message is written to the peer's connection.
+/// @param msg the message to write to channel.
+/////////////////////////////////////////////////////////////
+void CPeerNode::DeliverOnStrand(const ModuleMessage& msg)
+{
+    try
+    {
+        GetConnection()->Send(msg);
+    }
+    catch(std::exception& e)
+    {
+        FREEDM_LOG_ERROR(Logger) << "Couldn't send to peer " << m_uuid << ": "
+                     << e.what() << std::endl;
+    }
+}
+/////////////////////////////////////////////////////////////
+/// CPeerNode::DeliverShared
+/// @description Delivers a shared message that was handed to
+///   the network strand, logging any error like
+///   DeliverOnStrand.
+/// @pre Called through the broker's network strand.
+/// @post The message is written to the peer's connection.
+/// @param msg the message to write to channel.
+/////////////////////////////////////////////////////////////
+void CPeerNode::DeliverShared(boost::shared_ptr<const ModuleMessage> msg)
+{
+    try
+    {
+        GetConnection()->Send(msg);
+    }
+    catch(std::exception& e)
+    {
+        FREEDM_LOG_ERROR(Logger) << "Couldn't send to peer " << m_uuid << ": "
+                     << e.what() << std::endl;
+    }
 }
 ///////////////////////////////////////////////////////////////////////////////
 /// @fn operator==
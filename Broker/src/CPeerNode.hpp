@@ -27,10 +27,13 @@
 
 #include <string>
 
+#include <boost/shared_ptr.hpp>
+
 namespace freedm {
 
 namespace broker {
 
+class CConnection;
 class ModuleMessage;
 
 /// Base interface for agents/broker modules
@@ -49,8 +52,21 @@ class CPeerNode
         std::string GetPort() const;
         /// Sends a message to peer
         void Send(const ModuleMessage& msg);
+        /// Sends a shared message to peer, without copying it if local
+        void Send(boost::shared_ptr<const ModuleMessage> msg);
     private:
+        /// The peer's identifier and connection, shared by copies of the node
+        struct SPeerHandle;
+        /// Returns the connection to the peer, creating it if needed
+        boost::shared_ptr<CConnection> GetConnection();
+        /// Writes the message from the network strand, logging any failure
+        void DeliverOnStrand(const ModuleMessage& msg);
+        /// Writes a shared message from the network strand, logging any failure
+        void DeliverShared(boost::shared_ptr<const ModuleMessage> msg);
+        /// Hands a message addressed to this process to the dispatcher
+        void DeliverLocal(boost::shared_ptr<const ModuleMessage> msg);
         std::string m_uuid; /// This node's uuid.
+        boost::shared_ptr<SPeerHandle> m_handle; /// The cached connection.
 };
 
 bool operator==(const CPeerNode& a, const CPeerNode& b);
@@ -60,7 +60,7 @@ CPhysicalTopology& CPhysicalTopology::Instance()
 ///////////////////////////////////////////////////////////////////////////////
 CPhysicalTopology::CPhysicalTopology()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     m_available = false;
     LoadTopology();
 }
@@ -92,7 +92,7 @@ bool CPhysicalTopology::IsAvailable()
 CPhysicalTopology::VertexSet CPhysicalTopology::ReachablePeers(std::string source,
     CPhysicalTopology::FIDState fidstate)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     typedef std::pair<int, std::string> BFSExplorer;
     typedef std::priority_queue< BFSExplorer > BFSPQueue;
 
@@ -122,20 +122,20 @@ CPhysicalTopology::VertexSet CPhysicalTopology::ReachablePeers(std::string sourc
         if(consider.find(VNAME_PREFIX) == std::string::npos)
             solutionset.insert(consider);
         
-        Logger.Debug<<"Considering "<<consider<<" ("<<hops<<" hops) ("
+        FREEDM_LOG_DEBUG(Logger)<<"Considering "<<consider<<" ("<<hops<<" hops) ("
                     <<m_adjlist[consider].size()<<" Neighbors)"<<std::endl;
 
         BOOST_FOREACH( std::string neighbor, m_adjlist[consider] )
         {
-            Logger.Debug<<"Neighbor: "<<neighbor;
+            FREEDM_LOG_DEBUG(Logger)<<"Neighbor: "<<neighbor;
             if(closedset.count(neighbor) > 0)
             {
-                Logger.Debug<<" closed!"<<std::endl;
+                FREEDM_LOG_DEBUG(Logger)<<" closed!"<<std::endl;
                 continue;
             }
             else
             {
-                Logger.Debug<<std::endl;
+                FREEDM_LOG_DEBUG(Logger)<<std::endl;
             }
             CPhysicalTopology::VertexPair vx = CPhysicalTopology::VertexPair(consider,neighbor);
             bool good_edge = true;
@@ -151,7 +151,7 @@ CPhysicalTopology::VertexSet CPhysicalTopology::ReachablePeers(std::string sourc
                     // If we don't have the state of an FID, assume it is OPEN.
                     // If the fid is OPEN (false) then that edge is not
                     // available.
-                    Logger.Debug<<"Edge to "<<neighbor<<" is bad: "<<controlfid
+                    FREEDM_LOG_DEBUG(Logger)<<"Edge to "<<neighbor<<" is bad: "<<controlfid
                                 <<" Is Open or undefined"<<std::endl;
                     good_edge = false;
                     break;
@@ -159,7 +159,7 @@ CPhysicalTopology::VertexSet CPhysicalTopology::ReachablePeers(std::string sourc
             }
             if(good_edge)
             {
-                Logger.Debug<<"Node "<<neighbor<<" is reachable"<<std::endl;
+                FREEDM_LOG_DEBUG(Logger)<<"Node "<<neighbor<<" is reachable"<<std::endl;
                 // This edge is not controlled by an FID, assume it is open.
                 openset.push(BFSExplorer(hops+1, neighbor));
             }
@@ -181,7 +181,7 @@ CPhysicalTopology::VertexSet CPhysicalTopology::ReachablePeers(std::string sourc
 ///////////////////////////////////////////////////////////////////////////////
 void CPhysicalTopology::LoadTopology()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     const std::string EDGE_TOKEN = "edge";
     const std::string VERTEX_TOKEN = "sst";
     const std::string CONTROL_TOKEN = "fid";
@@ -193,7 +193,7 @@ void CPhysicalTopology::LoadTopology()
     std::string fp = CGlobalConfiguration::Instance().GetTopologyConfigPath();
     if(fp == "")
     {
-        Logger.Warn<<"No topology configuration file specified"<<std::endl;
+        FREEDM_LOG_WARN(Logger)<<"No topology configuration file specified"<<std::endl;
         return;
     }
     std::ifstream topf(fp.c_str());
@@ -217,7 +217,7 @@ void CPhysicalTopology::LoadTopology()
             {
                 throw std::runtime_error("Failed Reading Edge Topology Entry (EOF?)");
             }
-            Logger.Debug<<"Got Edge: "<<v_symbol1<<","<<v_symbol2<<std::endl;
+            FREEDM_LOG_DEBUG(Logger)<<"Got Edge: "<<v_symbol1<<","<<v_symbol2<<std::endl;
 
             if(!altmp.count(v_symbol1))
                 altmp[v_symbol1] = VertexSet();
@@ -240,7 +240,7 @@ void CPhysicalTopology::LoadTopology()
                 throw std::runtime_error("Failed Reading Vertex Topology Entry (EOF?)");
             }
             m_strans[vsymbol] = uuid;
-            Logger.Debug<<"Got Vertex: "<<vsymbol<<"->"<<uuid<<std::endl;
+            FREEDM_LOG_DEBUG(Logger)<<"Got Vertex: "<<vsymbol<<"->"<<uuid<<std::endl;
         }
         else if(token == CONTROL_TOKEN)
         {
@@ -253,7 +253,7 @@ void CPhysicalTopology::LoadTopology()
             {
                 throw std::runtime_error("Failed Reading Control Topology Entry (EOF?)");
             }
-            Logger.Debug<<"Got Control: "<<v_symbol1<<","<<v_symbol2<<" via "<<fidname<<std::endl;
+            FREEDM_LOG_DEBUG(Logger)<<"Got Control: "<<v_symbol1<<","<<v_symbol2<<" via "<<fidname<<std::endl;
             // Bi directional!
             vx1 = VertexPair(v_symbol1, v_symbol2);
             vx2 = VertexPair(v_symbol2, v_symbol1);
@@ -266,7 +266,7 @@ void CPhysicalTopology::LoadTopology()
         }
         else
         {
-            Logger.Error<<"Expected control token, saw '"<<token<<"'"<<std::endl;
+            FREEDM_LOG_ERROR(Logger)<<"Expected control token, saw '"<<token<<"'"<<std::endl;
             // raise exception, malformed input
             throw std::runtime_error("Physical Topology: Input topology file is malformed.");
         }
@@ -282,7 +282,7 @@ void CPhysicalTopology::LoadTopology()
         {
             //all_valid = false;
             // Warn user about bad name.
-            Logger.Status<<"Couldn't find UUID for virtualname: "<<vname<<" (Might be OK)"<<std::endl;
+            FREEDM_LOG_STATUS(Logger)<<"Couldn't find UUID for virtualname: "<<vname<<" (Might be OK)"<<std::endl;
         }
     }
 
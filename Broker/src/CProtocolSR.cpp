@@ -28,14 +28,18 @@
 #include "Messages.hpp"
 #include "messages/ProtocolMessage.pb.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iomanip>
 #include <set>
+#include <stdexcept>
 
 #include <boost/asio.hpp>
 #include <boost/bind.hpp>
 
 #include <google/protobuf/message.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
 
 namespace freedm {
     namespace broker {
@@ -62,7 +66,7 @@ CProtocolSR::CProtocolSR(std::string uuid, boost::asio::ip::udp::endpoint endpoi
       m_timeout(CBroker::Instance().GetIOService()),
       m_timer_active(false)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     //Sequence Numbers
     m_outseq = 0;
     m_inseq = 0;
@@ -76,6 +80,17 @@ CProtocolSR::CProtocolSR(std::string uuid, boost::asio::ip::udp::endpoint endpoi
     m_sendkills = false;
     m_sendkill = 0;
     m_dropped = 0;
+    // Retransmission timeout, until the first round trip is measured
+    m_srtt = 0;
+    m_rttvar = 0;
+    m_rto = CTimings::Get(CTimings::CSRC_RESEND_TIME) * 1000L;
+    m_rttvalid = false;
+    m_backoff = 0;
+    m_lastackedbytes = 0;
+    // Cumulative ACKs
+    m_lasthash = 0;
+    m_ackpending = false;
+    m_flushpending = false;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -85,41 +100,253 @@ CProtocolSR::CProtocolSR(std::string uuid, boost::asio::ip::udp::endpoint endpoi
 ///   delivery won't be attempted after the deadline is passed. Killed messages
 ///   are noted in the next outgoing message. The receiver tracks the killed
 ///   messages and uses them to help maintain ordering.
+///   The message is staged in the window and written by Flush, which runs
+///   once the current handler finishes, so the messages sent by a module in
+///   one task share a datagram.
 /// @pre The protocol is intialized.
-/// @post At least one message is in the channel and actively being resent.
-///     The send window is greater than or equal to one. The timer for the
-///     resend is freshly set or is currently running for a resend.
-///     If a message is written to the channel, the m_killable flag is set.
+/// @post The message is in the send window and a Flush is posted to the
+///     network strand, unless one already is. The send window is greater than
+///     or equal to one.
+///     Messages larger than FRAGMENT_SIZE, or whose encoding does not fit in
+///     one datagram with the window header, are split across several
+///     sequence numbers, see SendFragmented.
 /// @param msg The message to write to the channel.
 ///////////////////////////////////////////////////////////////////////////////
 void CProtocolSR::Send(const ModuleMessage& msg)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if(m_outsync == false)
     {
         SendSYN();
     }
-    
-    ProtocolMessage pm;
-    pm.mutable_module_message()->CopyFrom(msg);
+
+    // The one encoding of the message is hashed and then sent as is.
+    std::string payload;
+    msg.SerializeToString(&payload);
+    if(payload.size() > FRAGMENT_SIZE)
+    {
+        SendFragmented(payload, msg.recipient_module());
+    }
+    else
+    {
+        ProtocolMessage pm;
+        pm.set_hash(ComputeHash(payload.data(), payload.size()));
+        QueueMessage(pm, payload);
+        if(!FitsDatagram(m_window.back()))
+        {
+            // The protocol fields and the window header push the message
+            // over a datagram, so it is sent in pieces after all.
+            payload.swap(m_window.back().payload);
+            m_outseq = m_window.back().msg.sequence_num();
+            m_window.pop_back();
+            SendFragmented(payload, msg.recipient_module());
+        }
+    }
+    m_stats.messages++;
+
+    if(!m_flushpending)
+    {
+        m_flushpending = true;
+        CBroker::Instance().GetNetworkStrand().post(
+            boost::bind(&CProtocolSR::HandleFlush,
+                boost::static_pointer_cast<CProtocolSR>(shared_from_this())));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::Flush
+/// @description Writes the messages staged by Send to the channel now,
+///     rather than when the posted flush runs.
+/// @pre None
+/// @post The staged messages have been written and the resend timer is set.
+///////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::Flush()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    m_flushpending = false;
+    Transmit(false);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::HandleFlush
+/// @description Runs the flush posted by Send, unless an explicit Flush has
+///     written the staged messages already.
+/// @pre Called through the network strand.
+/// @post The staged messages have been written to the channel.
+///////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::HandleFlush()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    if(m_flushpending)
+    {
+        Flush();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::SendFragmented
+/// @description Splits a module message that is too large for one datagram
+///   into fragments of at most FRAGMENT_SIZE bytes, so each fragment fills
+///   most of a datagram. Each fragment is queued
+///   as its own message, so it is sequenced, acknowledged and resent like any
+///   other. The receiver's listener puts the module message back together.
+/// @pre The protocol is intialized.
+/// @post The fragments of the message are at the back of the window. The
+///   last one keeps the whole encoding, in case the receiver refuses the
+///   reassembled message and it has to be sent again.
+/// @param encoded The encoded module message; it is left empty.
+/// @param recipient The module the message is for, for the log.
+/// @param expiry If not null, the message whose expiration time the
+///   fragments keep, as a refused message sent again does.
+///////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::SendFragmented(std::string& encoded, const std::string& recipient,
+                                 const ProtocolMessage* expiry)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    unsigned int count = (encoded.size() + FRAGMENT_SIZE - 1) / FRAGMENT_SIZE;
+    FREEDM_LOG_INFO(Logger)<<"Fragmenting "<<encoded.size()<<" byte message for "
+               <<recipient<<" into "<<count<<" pieces"<<std::endl;
+
+    for(unsigned int i = 0; i < count; i++)
+    {
+        ProtocolMessage pm;
+        pm.set_fragment(encoded.substr(i * FRAGMENT_SIZE, FRAGMENT_SIZE));
+        pm.set_fragment_index(i);
+        pm.set_fragment_count(count);
+        pm.set_hash(ComputeHash(pm.fragment().data(), pm.fragment().size(), i));
+        if(expiry && expiry->has_expire_time_us())
+        {
+            pm.set_expire_time_us(expiry->expire_time_us());
+        }
+        if(expiry && expiry->has_expire_time())
+        {
+            pm.set_expire_time(expiry->expire_time());
+        }
+        std::string nopayload;
+        QueueMessage(pm, nopayload);
+    }
+    m_window.back().fragmented.swap(encoded);
+    encoded.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::FitsDatagram
+/// @description Checks that a queued message can be written in a datagram
+///     of its own, with the window header as it would be stamped now.
+/// @pre The entry's encoding is cached.
+/// @post None
+/// @param entry The queued message.
+/// @return True if the message fits in one datagram.
+///////////////////////////////////////////////////////////////////////////////
+bool CProtocolSR::FitsDatagram(const SWindowEntry& entry)
+{
+    std::string header;
+    StampWindow(m_header);
+    m_header.set_selective_ack(true);
+    m_header.AppendToString(&header);
+    return header.size() + ENTRY_OVERHEAD + entry.encoded.size()
+        <= CGlobalConfiguration::MAX_PACKET_SIZE;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::QueueMessage
+/// @description Assigns the next sequence number and an expiration time to
+///   an outgoing message and appends it to the window.
+/// @pre pm carries its hash, and its fragment if it has one. If it carries
+///   an expiration time, as a refused message sent again does, it is kept.
+/// @post pm has been swapped into a new entry at the back of the window,
+///   and the entry's encoding is cached.
+/// @param pm The message to queue; it is left empty.
+/// @param payload The encoded module message, or empty for a fragment; it
+///   is left empty.
+///////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::QueueMessage(ProtocolMessage& pm, std::string& payload)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     unsigned int msgseq = m_outseq;
     pm.set_sequence_num(msgseq);
     m_outseq = (m_outseq+1) % SEQUENCE_MODULO;
-    pm.set_hash(ComputeMessageHash(pm.module_message()));
     pm.set_status(ProtocolMessage::MESSAGE);
 
-    SetExpirationTimeFromNow(pm, boost::posix_time::millisec(CTimings::Get("CSRC_DEFAULT_TIMEOUT")));
-    Logger.Debug<<"Set Expire time: "<< pm.expire_time() << std::endl;
+    if(!pm.has_expire_time_us() && !pm.has_expire_time())
+    {
+        SetExpirationTimeFromNow(pm, CTimings::GetDuration(CTimings::CSRC_DEFAULT_TIMEOUT),
+            !GetBinaryTimestamps());
+    }
+    FREEDM_LOG_DEBUG(Logger)<<"Set Expire time: "<< pm.expire_time_us() << std::endl;
 
-	m_window.push_back(pm);
-    boost::system::error_code x;
-    Resend(x);
+    // Encode the message once; every resend reuses the encoding.
+    m_window.push_back(SWindowEntry());
+    m_window.back().msg.Swap(&pm);
+    m_window.back().payload.swap(payload);
+    EncodeEntry(m_window.back());
+    m_window.back().size = m_window.back().encoded.size();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// CProtocolSR::CProtocolSR
+/// CProtocolSR::EncodeEntry
+/// @description Encodes a queued message. The module message was encoded by
+///     Send and is appended as the module_message field, after the fields of
+///     the ProtocolMessage; protobuf accepts fields in any order.
+/// @pre None
+/// @post The entry's encoding is cached.
+/// @param entry the queued message to encode.
+///////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::EncodeEntry(SWindowEntry& entry)
+{
+    entry.encoded.clear();
+    entry.msg.AppendToString(&entry.encoded);
+    if(!entry.payload.empty())
+    {
+        AppendField(entry.encoded, ProtocolMessage::kModuleMessageFieldNumber, entry.payload);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::Resend
+/// @description Called when the retransmission timer expires. If the head of
+///     the window has already been written, it went a whole timeout without
+///     an ACK, so the timeout is backed off before the window is written
+///     again.
+/// @pre The timer was armed by SetTimer.
+/// @post The backoff is increased if the head was unacknowledged, and the
+///     window has been transmitted. After SACK_TIMEOUTS consecutive timeouts
+///     the messages the receiver reported holding are written again too.
+///     Refused messages which are due are queued again first. The timer is no longer pending unless
+///     Transmit set it again.
+/// @param err The timer error code. If the err is 0 then the timer expired
+///////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::Resend(const boost::system::error_code& err)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    if(err == boost::asio::error::operation_aborted)
+    {
+        // Cancelled by SetTimer or Stop, which have updated m_timer_active.
+        return;
+    }
+    m_timer_active = false;
+    if(!err && !GetStopped())
+    {
+        if(!m_window.empty() && m_window.front().transmissions > 0 && m_backoff < MAX_BACKOFF)
+        {
+            m_backoff++;
+        }
+        if(m_backoff >= SACK_TIMEOUTS)
+        {
+            // The receiver may no longer hold what it reported, so the
+            // SACKs are only trusted for a few timeouts.
+            ClearSacks();
+        }
+        RequeueRefused();
+        Transmit(true);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::Transmit
 /// @description Handles refiring ACKs and Sent Messages.
 /// @pre The connection has received or sent at least one message.
 /// @post One of the following conditions or combination of states is
@@ -135,49 +362,57 @@ void CProtocolSR::Send(const ModuleMessage& msg)
 ///          was successfully sent) so a sync is inserted at the front of the queue
 ///          to skip that case on the receiver side. The sendkill flag is cleared
 ///          and the sendkill value is cleared.
-///       5) If there is still a message to resend, the timer is reset.
-/// @param err The timer error code. If the err is 0 then the timer expired
+///       5) If there is still a message to resend and the timer is not
+///          already pending, the timer is set to the retransmission timeout.
+/// @param resend True if the messages already written should be written
+///       again, as when the retransmission timer expires.
 ///////////////////////////////////////////////////////////////////////////////
-void CProtocolSR::Resend(const boost::system::error_code& err)
+void CProtocolSR::Transmit(bool resend)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-	if(!err && !GetStopped())
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    if(!IsResolved())
     {
-        std::deque<ProtocolMessage>::iterator it;
+        // The messages wait in the window until SetEndpoint is called.
+        FREEDM_LOG_DEBUG(Logger)<<"Waiting for "<<GetUUID()<<" to be resolved"<<std::endl;
+        return;
+    }
+	if(!GetStopped())
+    {
+        WindowQueue::iterator it;
         it = m_window.begin();
         unsigned int todrop = 0;
-        if(it != m_window.end() && m_window.front().status() == ProtocolMessage::CREATED)
+        if(it != m_window.end() && m_window.front().msg.status() == ProtocolMessage::CREATED)
         {
             it++;
             for(; it != m_window.end(); it++)
             {
-                if(MessageIsExpired(*it))
+                if(MessageIsExpired(it->msg))
                     todrop++;
             }   
         }
         else
         {
-            while(m_window.size() > 0 && m_window.front().status() != ProtocolMessage::CREATED && MessageIsExpired(m_window.front()))
+            while(m_window.size() > 0 && m_window.front().msg.status() != ProtocolMessage::CREATED && MessageIsExpired(m_window.front().msg))
             {
-                Logger.Trace<<__PRETTY_FUNCTION__<<" Flushing"<<std::endl;
+                FREEDM_LOG_TRACE(Logger)<<__PRETTY_FUNCTION__<<" Flushing"<<std::endl;
                 //First message in the window should be the only one
                 //ever to have been written.
                 m_sendkills = true;
-                Logger.Debug<<"Message Expired: "<<m_window.front().DebugString();
+                FREEDM_LOG_DEBUG(Logger)<<"Message Expired: "<<m_window.front().msg.DebugString();
                 m_window.pop_front();
                 m_dropped++;
             }
         }
         if(m_dropped > MAX_DROPPED_MSGS || todrop > MAX_DROPPED_MSGS)
         {
-            Logger.Warn<<"Connection to "<<GetUUID()<<" has lost "<<m_dropped<<" messages. Attempting to reconnect."<<std::endl;
+            FREEDM_LOG_WARN(Logger)<<"Connection to "<<GetUUID()<<" has lost "<<m_dropped<<" messages. Attempting to reconnect."<<std::endl;
             Stop();
             return;
         }
-        Logger.Trace<<__PRETTY_FUNCTION__<<" Flushed Expired"<<std::endl;
+        FREEDM_LOG_TRACE(Logger)<<__PRETTY_FUNCTION__<<" Flushed Expired"<<std::endl;
         if(m_window.size() > 0)
         {
-            if(m_sendkills &&  m_sendkill > m_window.front().sequence_num())
+            if(m_sendkills &&  m_sendkill > m_window.front().msg.sequence_num())
             {
                 // If we have expired a message and caused the seqnos
                 // to wrap, we resync the connection. This shouldn't
@@ -187,22 +422,78 @@ void CProtocolSR::Resend(const boost::system::error_code& err)
                 m_sendkill = 0;
                 SendSYN();
             }
-            if(m_sendkills)
+            if(m_sendkills && (!m_window.front().msg.has_kill() ||
+                static_cast<unsigned int>(m_window.front().msg.kill()) != m_sendkill))
             {
                 // kill will be set to the last message accepted by receiver
                 // (and whose ack has been received)
-                m_window.front().set_kill(m_sendkill);
+                m_window.front().msg.set_kill(m_sendkill);
+                m_window.front().encoded.clear();
+                // The receiver must see the kill to skip the expired gap.
+                m_window.front().sacked = false;
             }
         }
-        WriteWindow();
+        WriteWindow(resend);
+        // A pending timer is left alone, so traffic on the connection does
+        // not postpone the resend of a lost message.
+        SetTimer(false);
+    }
+    FREEDM_LOG_TRACE(Logger)<<__PRETTY_FUNCTION__<<" Resend Finished"<<std::endl;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::SetTimer
+/// @description Keeps the retransmission timer pending exactly while there
+///     are messages in the window or refused messages to send again. Once set, the timer is only restarted when
+///     an ACK moves the window forward, as in RFC 6298, so the messages that
+///     are sent and received meanwhile do not hold off a resend.
+/// @pre None
+/// @post If there is nothing to send the timer is cancelled. Otherwise it is
+///     pending, and restarted with the current timeout if restart is set or
+///     it was not pending. m_timer_active reflects the timer.
+/// @param restart True to restart a pending timer.
+///////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::SetTimer(bool restart)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    if((m_window.empty() && m_refused.empty()) || GetStopped())
+    {
+        if(m_timer_active)
+        {
+            m_timeout.cancel();
+            m_timer_active = false;
+        }
+    }
+    else if(!m_timer_active || restart)
+    {
         /// We use static pointer cast to convert the IPROTOCOL pointer to this
         /// derived type
-        m_timeout.expires_from_now(boost::posix_time::milliseconds(CTimings::Get("CSRC_RESEND_TIME")));
-        m_timeout.async_wait(boost::bind(&CProtocolSR::Resend,
-            boost::static_pointer_cast<CProtocolSR>(shared_from_this()),
-            boost::asio::placeholders::error));
+        m_timeout.expires_from_now(GetRTO());
+        m_timeout.async_wait(CBroker::Instance().GetNetworkStrand().wrap(
+            boost::bind(&CProtocolSR::Resend,
+                boost::static_pointer_cast<CProtocolSR>(shared_from_this()),
+                boost::asio::placeholders::error)));
+        m_timer_active = true;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::SetEndpoint
+/// @description Sets the destination of the connection once the peer's
+///     hostname has been resolved. Messages sent before then wait in the
+///     window and are written now.
+/// @pre None
+/// @post The window is written to the new endpoint and the timer is set.
+/// @param endpoint The resolved destination.
+///////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::SetEndpoint(boost::asio::ip::udp::endpoint endpoint)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    IProtocol::SetEndpoint(endpoint);
+    if(!m_window.empty())
+    {
+        Transmit(true);
     }
-    Logger.Trace<<__PRETTY_FUNCTION__<<" Resend Finished"<<std::endl;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -215,30 +506,124 @@ void CProtocolSR::Resend(const boost::system::error_code& err)
 ///       killable flag is set to false, since the head of the window has never
 ///       been sent.
 ///       If the there is still an message in the window to send, the
-///       resend function is called.
+///       resend function is called. The retransmission timer is restarted
+///       for the new head of the window.
+///       Cumulative ACKs are handled by ReceiveCumulativeACK and refusals by
+///       ReceiveRefusal.
 /// @param msg The received ACK message
 ///////////////////////////////////////////////////////////////////////////////
 void CProtocolSR::ReceiveACK(const ProtocolMessage& msg)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    if(msg.status() == ProtocolMessage::REFUSED)
+    {
+        ReceiveRefusal(msg);
+        return;
+    }
+    if(msg.has_sack_bitmap())
+    {
+        ReceiveCumulativeACK(msg);
+        return;
+    }
     unsigned int seq = msg.sequence_num();
     if(m_window.size() > 0)
     {
         // Assuming hash collisions are small, we will check the hash
         // of the front message. On hit, we can accept the acknowledge.
-        unsigned int fseq = m_window.front().sequence_num();
-        Logger.Debug<<"Received ACK "<<seq<<" expecting ACK "<<fseq<<std::endl;
-        google::protobuf::uint64 expectedHash = m_window.front().hash();
+        unsigned int fseq = m_window.front().msg.sequence_num();
+        FREEDM_LOG_DEBUG(Logger)<<"Received ACK "<<seq<<" expecting ACK "<<fseq<<std::endl;
+        google::protobuf::uint64 expectedHash = m_window.front().msg.hash();
         if(fseq == seq && expectedHash == msg.hash())
         {
-            m_sendkill = fseq;
-            m_window.pop_front();
-            m_sendkills = false;
-            m_dropped = 0;
+            AcknowledgeFront(true);
+            SetTimer(true);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::ReceiveCumulativeACK
+/// @description Handles an ACK from a receiver that holds messages which
+///     arrive out of order. The ACK names the last message the receiver
+///     accepted in order, which acknowledges every message before it as well,
+///     and its bitmap lists the later messages the receiver already holds.
+/// @pre msg has a sack_bitmap.
+/// @post If a message in the window matches the sequence number and hash of
+///       the ACK, it and every message before it are popped. The messages
+///       marked in the bitmap are flagged so they are not written again.
+///       The retransmission timer is restarted if the window moved.
+/// @param msg The received ACK message
+///////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::ReceiveCumulativeACK(const ProtocolMessage& msg)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    unsigned int seq = msg.sequence_num();
+    unsigned int position = 0;
+    for(; position < m_window.size(); position++)
+    {
+        const ProtocolMessage& pm = m_window[position].msg;
+        if(pm.sequence_num() == seq && pm.hash() == msg.hash())
+        {
+            break;
+        }
+    }
+    FREEDM_LOG_DEBUG(Logger)<<"Received cumulative ACK "<<seq<<" bitmap "<<msg.sack_bitmap()<<std::endl;
+    if(position < m_window.size())
+    {
+        for(unsigned int i = 0; i <= position; i++)
+        {
+            // Only the named message was certainly just received, so only
+            // it is timed.
+            AcknowledgeFront(i == position);
+        }
+        SetTimer(true);
+    }
+    else if(m_window.empty() ||
+        m_window.front().msg.sequence_num() != (seq+1)%SEQUENCE_MODULO)
+    {
+        // A stale ACK; its bitmap may describe an earlier sequence.
+        return;
+    }
+    BOOST_FOREACH(SWindowEntry& entry, m_window)
+    {
+        unsigned int ahead = (entry.msg.sequence_num() + SEQUENCE_MODULO - seq)
+            % SEQUENCE_MODULO;
+        if(ahead >= 2 && ahead - 2 < MAX_SACK && (msg.sack_bitmap() >> (ahead - 2)) & 1)
+        {
+            entry.sacked = true;
         }
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::AcknowledgeFront
+/// @description Removes the acknowledged message at the front of the window.
+/// @pre The window is not empty.
+/// @post The front message is popped and counted in the link statistics, the
+///       backoff is reset and no kill is sent until another message expires.
+/// @param sample True if the ACK may be used to measure the round trip time.
+///////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::AcknowledgeFront(bool sample)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    SWindowEntry& front = m_window.front();
+    // Karn's algorithm: an ACK for a retransmitted message could be
+    // for any of its copies, so only time messages sent once.
+    if(sample && front.transmissions == 1)
+    {
+        SampleRTT(boost::posix_time::microsec_clock::universal_time()
+            - front.firstsent);
+    }
+    m_backoff = 0;
+    m_stats.acked++;
+    // The encoding may have been cleared to add a kill.
+    m_stats.ackedbytes += front.size;
+    m_sendkill = front.msg.sequence_num();
+    m_window.pop_front();
+    m_sendkills = false;
+    m_dropped = 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// CProtocolSR::Receive
 /// @description Accepts a message into the protocol, if that message should
@@ -275,43 +660,49 @@ void CProtocolSR::ReceiveACK(const ProtocolMessage& msg)
 ///         be rejected.
 ///      8) The message should be accepted because one or more message expired
 ///         in the gap of sequence numbers.
+///      If the peer reads cumulative ACKs, rejected messages up to MAX_SACK
+///      ahead of the expected one are held until NextInOrder releases them.
 /// @param msg The received message
 /// @return True if the message is accepted, false otherwise.
 ///////////////////////////////////////////////////////////////////////////////
 bool CProtocolSR::Receive(const ProtocolMessage& msg)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;  
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;  
     if(msg.status() == ProtocolMessage::BAD_REQUEST)
     {
         //See if we are already trying to sync:
-        if(m_window.front().status() != ProtocolMessage::CREATED)
+        if(m_window.front().msg.status() != ProtocolMessage::CREATED)
         {
 			// See if we are getting a bad request we've already synced for.
             if(msg.hash() != m_outsynchash)
             {
-                Logger.Debug<<"Syncronizing Connection (BAD REQUEST)"<<std::endl;
+                FREEDM_LOG_DEBUG(Logger)<<"Syncronizing Connection (BAD REQUEST)"<<std::endl;
                 m_outsynchash = msg.hash();
                 SendSYN();
             }
             else
             {
-                Logger.Debug<<"Already synced for this time"<<std::endl;
+                FREEDM_LOG_DEBUG(Logger)<<"Already synced for this time"<<std::endl;
             }
         }
         return false;
     }
     else if(msg.status() == ProtocolMessage::CREATED)
     {
-		boost::posix_time::ptime sendtime = boost::posix_time::time_from_string(msg.expire_time());
+		boost::posix_time::ptime sendtime = GetExpirationTime(msg);
         //Check to see if we've already seen this SYN:
         if(sendtime == m_insynctime)
         {
-		    Logger.Debug<<"Duplicate Sync"<<std::endl;
+		    FREEDM_LOG_DEBUG(Logger)<<"Duplicate Sync"<<std::endl;
             return false;
         }
-        Logger.Debug<<"Got Sync"<<std::endl;
+        FREEDM_LOG_DEBUG(Logger)<<"Got Sync"<<std::endl;
         m_inseq = (msg.sequence_num()+1)%SEQUENCE_MODULO;
         m_insynctime = sendtime;
+        // Held and refused messages belong to the previous sequence.
+        m_reorder.clear();
+        m_refusals.clear();
+        m_lasthash = msg.hash();
         m_inresyncs++;
         m_insync = true;
         SendACK(msg);
@@ -319,7 +710,7 @@ bool CProtocolSR::Receive(const ProtocolMessage& msg)
     }
     else if(m_insync == false)
     {
-        Logger.Debug<<"Connection Needs Resync"<<std::endl;
+        FREEDM_LOG_DEBUG(Logger)<<"Connection Needs Resync"<<std::endl;
         //If the connection hasn't been synchronized, we want to
         //tell them it is a bad request so they know they need to sync.
         ProtocolMessage outmsg;
@@ -356,23 +747,63 @@ bool CProtocolSR::Receive(const ProtocolMessage& msg)
         //Consider the window you expect to see
         // If the killed message is the one immediately preceeding this
         // message in terms of sequence number we should accept it
-        Logger.Debug<<"Recv: "<<msg.sequence_num()<<" Expected "<<m_inseq<<" Using kill: "<<usekill<<" with "<<kill<<std::endl;
+        FREEDM_LOG_DEBUG(Logger)<<"Recv: "<<msg.sequence_num()<<" Expected "<<m_inseq<<" Using kill: "<<usekill<<" with "<<kill<<std::endl;
         if(msg.sequence_num() == m_inseq)
         {
+            m_reorder.erase(m_inseq);
             m_inseq = (m_inseq+1)%SEQUENCE_MODULO;
+            m_lasthash = msg.hash();
+            m_ackpending = true;
             return true;
         }
         else if(usekill == true && kill < m_inseq && msg.sequence_num() > m_inseq)
         {
+            // Messages held from before the jump will never be delivered.
+            unsigned int jump = msg.sequence_num() - m_inseq;
+            ReorderBuffer::iterator it = m_reorder.begin();
+            while(it != m_reorder.end())
+            {
+                if((it->first + SEQUENCE_MODULO - m_inseq) % SEQUENCE_MODULO <= jump)
+                {
+                    m_reorder.erase(it++);
+                }
+                else
+                {
+                    it++;
+                }
+            }
             //m_inseq will be right for the next expected message.
             m_inseq = (msg.sequence_num()+1)%SEQUENCE_MODULO;
+            m_lasthash = msg.hash();
+            m_ackpending = true;
             return true;
         }
         else if(usekill == true)
         {
-            Logger.Debug<<"KILL: "<<kill<<" INSEQ "<<m_inseq<<" SEQ: "
+            FREEDM_LOG_DEBUG(Logger)<<"KILL: "<<kill<<" INSEQ "<<m_inseq<<" SEQ: "
                           <<msg.sequence_num()<<std::endl;
         }
+        if(GetSelectiveAck())
+        {
+            // Hold messages that arrive shortly after a lost one, so only the
+            // lost one has to be written again.
+            unsigned int ahead = (msg.sequence_num() + SEQUENCE_MODULO - m_inseq)
+                % SEQUENCE_MODULO;
+            if(ahead <= MAX_SACK && m_reorder.count(msg.sequence_num()) == 0)
+            {
+                FREEDM_LOG_DEBUG(Logger)<<"Holding "<<msg.sequence_num()<<" out of order"<<std::endl;
+                m_reorder[msg.sequence_num()].reset(new ProtocolMessage(msg));
+            }
+            // Acknowledge duplicates too, in case the last ACK was lost.
+            m_ackpending = true;
+            std::map<unsigned int, google::protobuf::uint64>::iterator it
+                = m_refusals.find(msg.sequence_num());
+            if(it != m_refusals.end() && it->second == msg.hash())
+            {
+                // So was the refusal sent with it.
+                SendRefusal(it->first, it->second);
+            }
+        }
         // Justin case.
         return false;
     }
@@ -388,31 +819,46 @@ bool CProtocolSR::Receive(const ProtocolMessage& msg)
 /// @param msg The message to ACK.
 /// @pre A message has been accepted.
 /// @post The m_currentack member is set to the ack and the message will
-///     be resent during resend until it expires.
+///     be resent during resend until it expires. Messages from peers that
+///     read cumulative ACKs are not acknowledged individually.
 ///////////////////////////////////////////////////////////////////////////////
 void CProtocolSR::SendACK(const ProtocolMessage& msg)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    if(GetSelectiveAck() && msg.status() == ProtocolMessage::MESSAGE)
+    {
+        // The cumulative ACK written by OnReceive covers the message.
+        return;
+    }
     unsigned int seq = msg.sequence_num();
     ProtocolMessage outmsg;
     // Presumably, if we are here, the connection is registered
     outmsg.set_status(ProtocolMessage::ACCEPTED);
     outmsg.set_sequence_num(seq);
-    Logger.Debug<<"Generating ACK. Source exp time "<<msg.expire_time()<<std::endl;
-    outmsg.set_expire_time(msg.expire_time());
+    FREEDM_LOG_DEBUG(Logger)<<"Generating ACK. Source exp time "<<GetExpirationTime(msg)<<std::endl;
+    if(msg.has_expire_time_us())
+    {
+        outmsg.set_expire_time_us(msg.expire_time_us());
+    }
+    if(msg.has_expire_time())
+    {
+        outmsg.set_expire_time(msg.expire_time());
+    }
     outmsg.set_hash(msg.hash());
-    m_ack_window.push_back(outmsg);
+    m_ack_window.push_back(SWindowEntry());
+    m_ack_window.back().msg.Swap(&outmsg);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 /// CProtocolSR::SendSYN
 /// @description Composes an SYN and writes it to the channel.
 /// @pre A message has been accepted.
-/// @post A syn has been written to the channel
+/// @post A syn has been written to the channel, and every message behind
+///     it will be written again.
 ///////////////////////////////////////////////////////////////////////////////
 void CProtocolSR::SendSYN()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     unsigned int seq = m_outseq;
     if(m_window.size() == 0)
     {
@@ -421,12 +867,12 @@ void CProtocolSR::SendSYN()
     else
     {
         //Don't bother if front of queue is already a SYN
-        if(m_window.front().has_status() && m_window.front().status() == ProtocolMessage::CREATED)
+        if(m_window.front().msg.has_status() && m_window.front().msg.status() == ProtocolMessage::CREATED)
         {
             return;
         }
         //Set it as the seq before the front of queue
-        seq = m_window.front().sequence_num();
+        seq = m_window.front().msg.sequence_num();
         if(seq == 0)
         {
             seq = SEQUENCE_MODULO-1;
@@ -440,47 +886,506 @@ void CProtocolSR::SendSYN()
     ProtocolMessage outmsg;
     outmsg.set_status(ProtocolMessage::CREATED);
     outmsg.set_sequence_num(seq);
-    SetExpirationTimeFromNow(outmsg, boost::posix_time::millisec(CTimings::Get("CSRC_DEFAULT_TIMEOUT")));
-    m_window.push_front(outmsg);
+    SetExpirationTimeFromNow(outmsg, CTimings::GetDuration(CTimings::CSRC_DEFAULT_TIMEOUT),
+        !GetBinaryTimestamps());
+    // The receiver discards the messages it holds when it accepts the SYN.
+    ClearSacks();
+    m_window.push_front(SWindowEntry());
+    m_window.front().msg.Swap(&outmsg);
     m_outsync = true;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::ClearSacks
+/// @description Forgets which messages the receiver reported holding out of
+///     order, so the next resend writes them as well.
+/// @pre None
+/// @post No message in the window is marked as sacked.
+///////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::ClearSacks()
+{
+    BOOST_FOREACH(SWindowEntry& entry, m_window)
+    {
+        entry.sacked = false;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::SendCumulativeACK
+/// @description Queues an ACK for the last message accepted in order, with a
+///     bitmap of the messages held out of order after it.
+/// @pre The connection is synced.
+/// @post The ACK is in the ack queue.
+///////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::SendCumulativeACK()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    google::protobuf::uint32 bitmap = 0;
+    BOOST_FOREACH(const ReorderBuffer::value_type& held, m_reorder)
+    {
+        unsigned int ahead = (held.first + SEQUENCE_MODULO - m_inseq) % SEQUENCE_MODULO;
+        bitmap |= 1u << (ahead - 1);
+    }
+    m_ack_window.push_back(SWindowEntry());
+    ProtocolMessage& outmsg = m_ack_window.back().msg;
+    outmsg.set_status(ProtocolMessage::ACCEPTED);
+    outmsg.set_sequence_num((m_inseq + SEQUENCE_MODULO - 1) % SEQUENCE_MODULO);
+    outmsg.set_hash(m_lasthash);
+    outmsg.set_sack_bitmap(bitmap);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::Refuse
+/// @description Reports to the sender that a message accepted in order was
+///     not delivered, because a module it is for has a full inbound queue.
+///     The message stays accepted, so the messages behind it are delivered;
+///     the sender sends the module message again under a new sequence number.
+/// @pre msg was accepted by Receive or NextInOrder, and the sender reads
+///     refusals, which peers that read cumulative ACKs do.
+/// @post The refusal is queued ahead of the cumulative ACK covering msg, and
+///     repeated if msg arrives again.
+/// @param msg The refused message.
+///////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::Refuse(const ProtocolMessage& msg)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    unsigned int seq = msg.sequence_num();
+    // Forget the refusals too old to be repeated.
+    std::map<unsigned int, google::protobuf::uint64>::iterator it = m_refusals.begin();
+    while(it != m_refusals.end())
+    {
+        if((seq + SEQUENCE_MODULO - it->first) % SEQUENCE_MODULO > MAX_SACK)
+        {
+            m_refusals.erase(it++);
+        }
+        else
+        {
+            it++;
+        }
+    }
+    m_refusals[seq] = msg.hash();
+    SendRefusal(seq, msg.hash());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::SendRefusal
+/// @description Queues the notice that a message was refused.
+/// @pre None
+/// @post The refusal is in the ack queue.
+/// @param seq The sequence number of the refused message.
+/// @param hash The hash of the refused message.
+///////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::SendRefusal(unsigned int seq, google::protobuf::uint64 hash)
+{
+    m_ack_window.push_back(SWindowEntry());
+    ProtocolMessage& outmsg = m_ack_window.back().msg;
+    outmsg.set_status(ProtocolMessage::REFUSED);
+    outmsg.set_sequence_num(seq);
+    outmsg.set_hash(hash);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::ReceiveRefusal
+/// @description Handles the receiver's notice that a message was accepted
+///     but not delivered. The ACK that follows it removes the message from
+///     the window, so its module message is set aside here and sent again
+///     once the receiver has had time to drain its queue. The wait doubles
+///     with each refusal of the same module message. A reassembled message
+///     is refused fragment by fragment, and set aside whole when the refusal
+///     of its last fragment arrives.
+/// @pre msg is a refusal.
+/// @post If the refused message is in the window, its module message waits
+///     in m_refused, due no sooner than the messages refused before it, and
+///     the timer is set to send it again.
+/// @param msg The received refusal.
+///////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::ReceiveRefusal(const ProtocolMessage& msg)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    BOOST_FOREACH(SWindowEntry& entry, m_window)
+    {
+        if(entry.msg.sequence_num() != msg.sequence_num() || entry.msg.hash() != msg.hash())
+        {
+            continue;
+        }
+        // Only the last fragment of a message can be sent again, with the
+        // whole message; the refusals of the others are for the same run.
+        if(entry.refused || (entry.payload.empty() && entry.fragmented.empty()))
+        {
+            return;
+        }
+        entry.refused = true;
+        m_refused.push_back(SRefusal());
+        SRefusal& refusal = m_refused.back();
+        refusal.msg.set_hash(entry.msg.hash());
+        if(entry.msg.has_expire_time_us())
+        {
+            refusal.msg.set_expire_time_us(entry.msg.expire_time_us());
+        }
+        if(entry.msg.has_expire_time())
+        {
+            refusal.msg.set_expire_time(entry.msg.expire_time());
+        }
+        refusal.fragmented = entry.payload.empty();
+        refusal.payload = refusal.fragmented ? entry.fragmented : entry.payload;
+        refusal.refusals = entry.refusals + 1;
+        unsigned int backoff = refusal.refusals < MAX_BACKOFF ? refusal.refusals : MAX_BACKOFF;
+        refusal.due = boost::posix_time::microsec_clock::universal_time()
+            + GetRTO() * (1 << backoff);
+        // The receiver holds back the messages refused after this one until
+        // it comes back, so it must not be sent after them.
+        if(m_refused.size() > 1 && refusal.due < m_refused[m_refused.size() - 2].due)
+        {
+            refusal.due = m_refused[m_refused.size() - 2].due;
+        }
+        m_stats.refused++;
+        FREEDM_LOG_DEBUG(Logger)<<"Message "<<msg.sequence_num()<<" refused by "<<GetUUID()
+                    <<", sending it again at "<<refusal.due<<std::endl;
+        SetTimer(false);
+        return;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::RequeueRefused
+/// @description Queues the refused module messages whose wait is over under
+///     new sequence numbers. They keep their original expiration time, and
+///     one that was fragmented is fragmented again.
+/// @pre None
+/// @post The due messages are at the back of the window, or discarded if
+///     they have expired.
+///////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::RequeueRefused()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+    // The refusals are due in the order they were received, so the messages
+    // are sent again in the order the receiver expects them.
+    std::deque<SRefusal>::iterator it = m_refused.begin();
+    while(it != m_refused.end())
+    {
+        if(it->due > now)
+        {
+            break;
+        }
+        if(MessageIsExpired(it->msg))
+        {
+            FREEDM_LOG_DEBUG(Logger)<<"Refused message to "<<GetUUID()<<" expired"<<std::endl;
+        }
+        else if(it->fragmented)
+        {
+            SendFragmented(it->payload, GetUUID(), &it->msg);
+            m_window.back().refusals = it->refusals;
+        }
+        else
+        {
+            ProtocolMessage pm;
+            pm.Swap(&it->msg);
+            QueueMessage(pm, it->payload);
+            m_window.back().refusals = it->refusals;
+        }
+        it = m_refused.erase(it);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::NextInOrder
+/// @description Releases the held message which follows the last message
+///     accepted, once the messages before it have arrived.
+/// @pre None
+/// @post If a message is returned, it is accepted and the next one is
+///     expected.
+/// @return The next message in order, or null if it isn't held.
+///////////////////////////////////////////////////////////////////////////////
+boost::shared_ptr<const ProtocolMessage> CProtocolSR::NextInOrder()
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    ReorderBuffer::iterator it = m_reorder.find(m_inseq);
+    if(it == m_reorder.end())
+    {
+        return boost::shared_ptr<const ProtocolMessage>();
+    }
+    boost::shared_ptr<const ProtocolMessage> next = it->second;
+    m_reorder.erase(it);
+    m_inseq = (m_inseq+1)%SEQUENCE_MODULO;
+    m_lasthash = next->hash();
+    m_ackpending = true;
+    return next;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// CProtocolSR::OnReceive
-/// @description When a message is received, write the window to the channel,
-///     then flush the ack queue.
+/// @description When a message is received, write the ack queue to the
+///     channel, with any message not yet written, then flush the ack queue.
+///     Messages already written are left to the retransmission timer, so
+///     traffic from the peer does not resend them. Peers that read
+///     cumulative ACKs get one for all the messages of their window.
+///     If Send has posted a flush, it is run now, so the staged messages go
+///     out with the acks and the retransmission timer is set for them.
 /// @pre None
 /// @post There are no acks queued and the message has been written to the
 ///     channel.
 ///////////////////////////////////////////////////////////////////////////////
 void CProtocolSR::OnReceive()
 {
-    WriteWindow();
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    if(m_ackpending && m_insync && GetSelectiveAck())
+    {
+        SendCumulativeACK();
+    }
+    m_ackpending = false;
+    if(m_flushpending && IsResolved())
+    {
+        Flush();
+    }
+    else
+    {
+        WriteWindow(false);
+    }
     m_ack_window.clear();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 /// CProtocolSR::WriteWindow
 /// @description Creates a message bundle of outstanding messages to write to
-///     the channel.
+///     the channel. Only the window header is encoded each time; the queued
+///     messages are appended from their cached encodings, which is the same
+///     byte sequence protobuf would produce for the repeated messages field.
+///     When the messages do not fit in one datagram, they are split across
+///     as many datagrams as needed, each carrying the same header and as many
+///     whole messages as fit.
+///     A message counts as transmitted each time it is written, so only the
+///     first write and the resends of the retransmission timer write it;
+///     otherwise one ACK could answer any of several copies and the round
+///     trip time could not be sampled.
+/// @pre None
+/// @post Writes the ACKs and the messages that are due to the channel.
+/// @param resend True to write the messages already written as well as
+///     the new ones. A message whose encoding changed, such as a head which
+///     now carries a kill, is written either way.
+//////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::WriteWindow(bool resend)
+{
+    if(m_ack_window.empty() && m_window.empty())
+    {
+        return;
+    }
+
+    StampWindow(m_header);
+    m_header.set_selective_ack(true);
+    m_header.CheckInitialized();
+    m_headerbuffer.clear();
+    m_header.AppendToString(&m_headerbuffer);
+    m_outbuffer = m_headerbuffer;
+    BOOST_FOREACH(SWindowEntry& entry, m_ack_window)
+    {
+        AppendEntry(entry);
+    }
+    bool headonly = CGlobalConfiguration::Instance().GetResendHeadOnly();
+    boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+    unsigned int position = 0;
+    BOOST_FOREACH(SWindowEntry& entry, m_window)
+    {
+        // The head is the first message, or the two first if it is a SYN.
+        bool head = position == 0 || (position == 1 &&
+            m_window.front().msg.status() == ProtocolMessage::CREATED);
+        position++;
+        if(entry.sacked)
+        {
+            // The receiver already holds it.
+            continue;
+        }
+        if(entry.transmissions > 0 && !entry.encoded.empty() &&
+            (!resend || (headonly && !head)))
+        {
+            continue;
+        }
+        if(!AppendEntry(entry))
+        {
+            FREEDM_LOG_ERROR(Logger)<<"Message "<<entry.msg.sequence_num()<<" to "<<GetUUID()
+                        <<" is too long for a datagram: "<<entry.encoded.size()<<" bytes"<<std::endl;
+            continue;
+        }
+        if(entry.transmissions == 0)
+        {
+            entry.firstsent = now;
+        }
+        else
+        {
+            m_stats.retransmitted++;
+        }
+        entry.transmissions++;
+        m_stats.sent++;
+    }
+    FlushDatagram();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::SampleRTT
+/// @description Updates the smoothed round trip time and its variation with a
+///     new measurement, and recomputes the retransmission timeout from them,
+///     as in RFC 6298: RTO = SRTT + max(G, 4 * RTTVAR) where G is REFIRE_TIME.
+/// @pre None
+/// @post m_srtt, m_rttvar and m_rto include the sample.
+/// @param rtt The time between writing a message once and receiving its ACK.
+//////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::SampleRTT(const boost::posix_time::time_duration& rtt)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    long sample = rtt.total_microseconds();
+    if(sample < 0)
+    {
+        return;
+    }
+    if(!m_rttvalid)
+    {
+        m_srtt = sample;
+        m_rttvar = sample / 2;
+        m_rttvalid = true;
+    }
+    else
+    {
+        long delta = m_srtt > sample ? m_srtt - sample : sample - m_srtt;
+        m_rttvar = (3 * m_rttvar + delta) / 4;
+        m_srtt = (7 * m_srtt + sample) / 8;
+    }
+    m_rto = m_srtt + std::max(REFIRE_TIME * 1000L, 4 * m_rttvar);
+    FREEDM_LOG_DEBUG(Logger)<<"RTT to "<<GetUUID()<<" "<<sample<<"us, SRTT "<<m_srtt
+                <<"us, RTO "<<m_rto<<"us"<<std::endl;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::GetRTO
+/// @description Computes the time to wait before writing the window again:
+///     the measured retransmission timeout doubled for each consecutive
+///     timeout of the head of the window. Bounded below by REFIRE_TIME and
+///     above by CSRC_DEFAULT_TIMEOUT, after which the message has expired.
+/// @pre None
+/// @post None
+/// @return The retransmission timeout.
+//////////////////////////////////////////////////////////////////////////////
+boost::posix_time::time_duration CProtocolSR::GetRTO() const
+{
+    long rto = m_rto << m_backoff;
+    rto = std::max(rto, REFIRE_TIME * 1000L);
+    rto = std::min(rto, CTimings::Get(CTimings::CSRC_DEFAULT_TIMEOUT) * 1000L);
+    return boost::posix_time::microseconds(rto);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::GetStats
+/// @description Returns the round trip time estimate, the retransmission
+///     timeout and the message counters of the connection.
+/// @pre None
+/// @post None
+/// @return The link statistics.
+//////////////////////////////////////////////////////////////////////////////
+SLinkStats CProtocolSR::GetStats() const
+{
+    SLinkStats stats = m_stats;
+    stats.srtt = boost::posix_time::microseconds(m_srtt);
+    stats.rttvar = boost::posix_time::microseconds(m_rttvar);
+    stats.rto = GetRTO();
+    return stats;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::ChangePhase
+/// @description Logs the link statistics at the start of each round, so the
+///     round trip time, retransmissions and goodput of every peer can be
+///     followed over time. Goodput is the rate of acknowledged bytes over the
+///     last round.
+/// @pre None
+/// @post The statistics are logged if newround is set.
+/// @param newround True if the phase change starts a new round.
+//////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::ChangePhase(bool newround)
+{
+    if(!newround)
+    {
+        return;
+    }
+    boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+    if(m_stats.sent > 0 && !m_lastround.is_not_a_date_time())
+    {
+        long elapsed = (now - m_lastround).total_microseconds();
+        unsigned long goodput = elapsed > 0 ?
+            (m_stats.ackedbytes - m_lastackedbytes) * 1000000UL / elapsed : 0;
+        FREEDM_LOG_INFO(Logger)<<"Link to "<<GetUUID()<<": SRTT "<<boost::posix_time::microseconds(m_srtt)
+                   <<" RTTVAR "<<boost::posix_time::microseconds(m_rttvar)
+                   <<" RTO "<<GetRTO()<<" sent "<<m_stats.sent
+                   <<" retransmitted "<<m_stats.retransmitted<<" acked "<<m_stats.acked
+                   <<" refused "<<m_stats.refused
+                   <<" goodput "<<goodput<<" B/s datagrams/message "
+                   <<(m_stats.messages > 0 ?
+                       static_cast<double>(m_stats.datagrams) / m_stats.messages : 0)
+                   <<std::endl;
+    }
+    m_lastround = now;
+    m_lastackedbytes = m_stats.ackedbytes;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::FlushDatagram
+/// @description Writes the datagram assembled in m_outbuffer, if it carries
+///     any messages, and starts a new one with the current header.
+/// @pre m_outbuffer starts with m_headerbuffer.
+/// @post m_outbuffer holds only the header.
+//////////////////////////////////////////////////////////////////////////////
+void CProtocolSR::FlushDatagram()
+{
+    if(m_outbuffer.size() > m_headerbuffer.size())
+    {
+        // AppendEntry never overfills the datagram.
+        WriteDatagram(m_outbuffer.data(), m_outbuffer.size());
+        m_stats.datagrams++;
+    }
+    m_outbuffer = m_headerbuffer;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CProtocolSR::AppendEntry
+/// @description Appends a queued message to the outgoing window as an element
+///     of the window's repeated messages field. The message is encoded only if
+///     it has no cached encoding.
 /// @pre None
-/// @post Writes the window to the channel.
+/// @post The tag, length and encoding of the message are at the end of
+///     m_outbuffer, unless it is too long for any datagram, and the entry's
+///     encoding is cached.
+/// @param entry the queued message to append.
+/// @return False if the message does not fit in a datagram of its own.
 //////////////////////////////////////////////////////////////////////////////
-void CProtocolSR::WriteWindow()
+bool CProtocolSR::AppendEntry(SWindowEntry& entry)
 {
-    ProtocolMessageWindow outmsg;
-    BOOST_FOREACH(const ProtocolMessage& msg, m_ack_window)
+    using google::protobuf::io::CodedOutputStream;
+    using google::protobuf::internal::WireFormatLite;
+
+    // One byte of tag and up to five bytes of varint length.
+    google::protobuf::uint8 prefix[6];
+
+    if(entry.encoded.empty())
     {
-        *outmsg.add_messages() = msg;
+        EncodeEntry(entry);
     }
-    BOOST_FOREACH(const ProtocolMessage& msg, m_window)
+    if(m_headerbuffer.size() + sizeof(prefix) + entry.encoded.size()
+        > CGlobalConfiguration::MAX_PACKET_SIZE)
     {
-        *outmsg.add_messages() = msg;
+        return false;
     }
-    if(outmsg.messages().size() > 0)
+    // Start a new datagram if this message would overfill the current one.
+    if(m_outbuffer.size() + sizeof(prefix) + entry.encoded.size()
+        > CGlobalConfiguration::MAX_PACKET_SIZE)
     {
-        Write(outmsg);
-    } 
+        FlushDatagram();
+    }
+
+    google::protobuf::uint8* end = prefix;
+    *end++ = WireFormatLite::MakeTag(ProtocolMessageWindow::kMessagesFieldNumber,
+        WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+    end = CodedOutputStream::WriteVarint32ToArray(entry.encoded.size(), end);
+    m_outbuffer.append(reinterpret_cast<const char*>(prefix), end - prefix);
+    m_outbuffer.append(entry.encoded);
+    return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -493,9 +1398,9 @@ void CProtocolSR::WriteWindow()
 ///////////////////////////////////////////////////////////////////////////////
 void CProtocolSR::Write(ProtocolMessageWindow& msg)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
+    msg.set_selective_ack(true);
     IProtocol::Write(msg);
 }
 
@@ -29,9 +29,12 @@
 #include "messages/ProtocolMessage.pb.h"
 
 #include <deque>
+#include <map>
+#include <string>
 
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/shared_ptr.hpp>
 
 namespace freedm {
     namespace broker {
@@ -43,8 +46,10 @@ class CProtocolSR
     public:
         /// Initializes the protocol with the underlying connection
         explicit CProtocolSR(std::string uuid, boost::asio::ip::udp::endpoint endpoint);
-        /// Public facing send function that sends a message
+        /// Public facing send function that stages a message for the next flush
         void Send(const ModuleMessage& msg);
+        /// Writes the staged messages to the channel
+        void Flush();
         /// Public facing function that handles marking down ACKs for sent messages
         void ReceiveACK(const ProtocolMessage& msg);
         /// deterimines if a  messageshould be given to the dispatcher
@@ -53,17 +58,106 @@ class CProtocolSR
         void OnReceive();
         /// Handles Writing an ack for the input message to the channel
         void SendACK(const ProtocolMessage& msg);
+        /// Tells the sender an accepted message was not delivered
+        void Refuse(const ProtocolMessage& msg);
         /// Sends a synchronizer
         void SendSYN();
         /// Stops the timers
-        void Stop() { m_timeout.cancel(); SetStopped(true);  };
+        void Stop() { m_timeout.cancel(); m_timer_active = false; SetStopped(true);  };
         /// Handles writing the message to the underlying connection
         void Write(ProtocolMessageWindow & msg);
-        /// Writes a whole window to the channel
-        void WriteWindow();
+        /// Writes the new messages of the window, or all of them when resending
+        void WriteWindow(bool resend);
+        /// Logs the link statistics at the start of each round
+        void ChangePhase(bool newround);
+        /// Returns the link statistics
+        SLinkStats GetStats() const;
+        /// Sets the destination and writes the messages queued for it
+        void SetEndpoint(boost::asio::ip::udp::endpoint endpoint);
+        /// Releases the next held message that is now in order
+        boost::shared_ptr<const ProtocolMessage> NextInOrder();
     private:
-        /// Resend outstanding messages
+        /// A queued message and its cached encoding
+        struct SWindowEntry
+        {
+            SWindowEntry() : size(0), transmissions(0), sacked(false), refused(false),
+                refusals(0) { }
+            /// The message, without its module message
+            ProtocolMessage msg;
+            /// The encoded module message, if the message carries one
+            std::string payload;
+            /// The whole encoded module message, kept with its last fragment
+            std::string fragmented;
+            /// The encoded message, empty until encoded or after a change
+            std::string encoded;
+            /// The size of the encoded message when it was queued
+            std::size_t size;
+            /// When the message was first written to the channel
+            boost::posix_time::ptime firstsent;
+            /// How many times the message has been written to the channel
+            unsigned int transmissions;
+            /// True if the receiver holds the message out of order
+            bool sacked;
+            /// True if the receiver refused the message for a full queue
+            bool refused;
+            /// How many times the receiver refused the module message
+            unsigned int refusals;
+        };
+        /// A module message the receiver refused, waiting to be sent again
+        struct SRefusal
+        {
+            /// The hash and expiration of the message
+            ProtocolMessage msg;
+            /// The encoded module message
+            std::string payload;
+            /// True if the module message was sent in fragments
+            bool fragmented;
+            /// How many times the receiver refused the module message
+            unsigned int refusals;
+            /// When the module message should be sent again
+            boost::posix_time::ptime due;
+        };
+        typedef std::deque<SWindowEntry> WindowQueue;
+        typedef std::map<unsigned int, boost::shared_ptr<const ProtocolMessage> > ReorderBuffer;
+        /// Handles an ACK that acknowledges every message up to the one it names
+        void ReceiveCumulativeACK(const ProtocolMessage& msg);
+        /// Sets aside a message the receiver refused, to send it again later
+        void ReceiveRefusal(const ProtocolMessage& msg);
+        /// Queues the notice that a message was refused
+        void SendRefusal(unsigned int seq, google::protobuf::uint64 hash);
+        /// Queues the refused messages that are due to be sent again
+        void RequeueRefused();
+        /// Pops the acknowledged front of the window
+        void AcknowledgeFront(bool sample);
+        /// Queues an ACK for every message accepted in order
+        void SendCumulativeACK();
+        /// Marks every message in the window as not held by the receiver
+        void ClearSacks();
+        /// Appends the encoding of a queued message to the outgoing window
+        bool AppendEntry(SWindowEntry& entry);
+        /// Checks that a queued message fits in a datagram with the header
+        bool FitsDatagram(const SWindowEntry& entry);
+        /// Writes the assembled datagram and starts the next one
+        void FlushDatagram();
+        /// Sequences a message and adds it to the window
+        void QueueMessage(ProtocolMessage& pm, std::string& payload);
+        /// Encodes a queued message together with its module message
+        void EncodeEntry(SWindowEntry& entry);
+        /// Splits a message too large for one datagram into fragments
+        void SendFragmented(std::string& encoded, const std::string& recipient,
+            const ProtocolMessage* expiry = NULL);
+        /// Resend outstanding messages when the retransmission timer expires
         void Resend(const boost::system::error_code& err);
+        /// Drops expired messages, writes the window and arms the timer
+        void Transmit(bool resend);
+        /// Arms or cancels the retransmission timer for the window
+        void SetTimer(bool restart);
+        /// Runs the flush posted by Send
+        void HandleFlush();
+        /// Updates the round trip time estimate with a new sample
+        void SampleRTT(const boost::posix_time::time_duration& rtt);
+        /// The retransmission timeout, including backoff
+        boost::posix_time::time_duration GetRTO() const;
         /// Timeout for resends
         boost::asio::deadline_timer m_timeout;
         /// The expected next in sequence number
@@ -85,18 +179,69 @@ class CProtocolSR
         /// The hash to... MURDER.
         unsigned int m_sendkill;
         /// The window
-        std::deque<ProtocolMessage> m_window;
-        std::deque<ProtocolMessage> m_ack_window;
+        WindowQueue m_window;
+        WindowQueue m_ack_window;
+        /// Messages received ahead of a lost one, by sequence number
+        ReorderBuffer m_reorder;
+        /// Hashes of the messages recently refused, by sequence number
+        std::map<unsigned int, google::protobuf::uint64> m_refusals;
+        /// Messages the receiver refused, waiting to be sent again
+        std::deque<SRefusal> m_refused;
+        /// The hash of the last message accepted in order
+        google::protobuf::uint64 m_lasthash;
+        /// True if a cumulative ACK should be written with the window
+        bool m_ackpending;
+        /// The header of the outgoing window, restamped on every write
+        ProtocolMessageWindow m_header;
+        /// The encoded outgoing window, kept to reuse its storage
+        std::string m_outbuffer;
+        /// The encoded header that starts every datagram of the window
+        std::string m_headerbuffer;
         /// Sequence modulo
         static const unsigned int SEQUENCE_MODULO = 1024;
+        /// Largest backoff exponent applied to the retransmission timeout
+        static const unsigned int MAX_BACKOFF = 6;
+        /// How far ahead of the expected message one is held, and the bits of a SACK
+        static const unsigned int MAX_SACK = 32;
+        /// Consecutive timeouts after which messages reported as held are resent
+        static const unsigned int SACK_TIMEOUTS = 2;
+        /// Smoothed round trip time in microseconds
+        long m_srtt;
+        /// Round trip time variation in microseconds
+        long m_rttvar;
+        /// Retransmission timeout before backoff in microseconds
+        long m_rto;
+        /// True once a round trip time has been measured
+        bool m_rttvalid;
+        /// Exponent of the backoff applied to the retransmission timeout
+        unsigned int m_backoff;
+        /// Link statistics
+        SLinkStats m_stats;
+        /// When the last round started, for the goodput
+        boost::posix_time::ptime m_lastround;
+        /// The acknowledged bytes when the last round started
+        unsigned long m_lastackedbytes;
+        /// Bound on the window header and the fields of one message around
+        /// its module message: a hostname UUID, text and binary timestamps
+        static const unsigned int WINDOW_OVERHEAD = 512;
+        /// Bound on what is added to a queued message's encoding when it is
+        /// written: its tag and length in the window, and a kill
+        static const unsigned int ENTRY_OVERHEAD = 16;
+        /// Largest module message sent whole, and the largest piece of one
+        /// carried by a fragment. Messages which still do not fit in one
+        /// datagram once encoded are fragmented too.
+        static const unsigned int FRAGMENT_SIZE =
+            CGlobalConfiguration::MAX_PACKET_SIZE - WINDOW_OVERHEAD;
         /// Refire time in MS
         static const unsigned int REFIRE_TIME = 10;
         /// The number of messages that have to be dropped before the connection is dead
         static const unsigned int MAX_DROPPED_MSGS = 3;
         /// The number that have been dropped.
         unsigned int m_dropped;
-		/// Indicates if the timer is active.
-		bool m_timer_active;
+        /// True while the retransmission timer is pending.
+        bool m_timer_active;
+        /// True while a flush is posted for the staged messages
+        bool m_flushpending;
 };
 
     }
@@ -26,8 +26,10 @@
 
 #include <fstream>
 
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/foreach.hpp>
 #include <boost/range/adaptor/map.hpp>
+#include <boost/static_assert.hpp>
 
 
 namespace freedm {
@@ -39,14 +41,42 @@ CLocalLogger Logger(__FILE__);
 
 }
 
-CTimings::TimingMap CTimings::timing_values;
+const char* const CTimings::TIMING_NAMES[] = {
+    "GM_AYC_RESPONSE_TIMEOUT",
+    "GM_PREMERGE_MAX_TIMEOUT",
+    "GM_INVITE_RESPONSE_TIMEOUT",
+    "GM_AYT_RESPONSE_TIMEOUT",
+    "GM_PREMERGE_MIN_TIMEOUT",
+    "GM_PREMERGE_GRANULARITY",
+    "GM_PHASE_TIME",
+    "LB_PHASE_TIME",
+    "LB_ROUND_TIME",
+    "LB_REQUEST_TIMEOUT",
+    "VVC_PHASE_TIME",
+    "VVC_ROUND_TIME",
+    "VVC_REQUEST_TIMEOUT",
+    "SC_PHASE_TIME",
+    "DEV_PNP_HEARTBEAT",
+    "DEV_RTDS_DELAY",
+    "DEV_SOCKET_TIMEOUT",
+    "CSRC_RESEND_TIME",
+    "CSRC_DEFAULT_TIMEOUT"
+    /////////////////////////////////////////////
+    // ADD YOUR TIMING PARAMETER NAMES ABOVE HERE
+    /////////////////////////////////////////////
+};
+
+CTimings::TimingMap CTimings::timing_index = CTimings::BuildIndex();
+CTimings::STimingSet CTimings::timing_sets[2];
+boost::atomic<const CTimings::STimingSet*> CTimings::timing_active(&CTimings::timing_sets[0]);
 
 ///////////////////////////////////////////////////////////////////////////////
 /// CTimings::TimingParameters
 /// @description Registers all the expected timing values with the
 ///     configuration file loader. If a programmer needs to add timing values,
-///     they should make additional calls to RegisterTimingValue in this
-///     function, which will add their value to the DGI.
+///     they should add them to the TimingParameter enumeration and their names
+///     to TIMING_NAMES, in the same order, which will add their value to the
+///     DGI.
 /// @pre None
 /// @post The program options have been modified to include the new timings
 ///     options added by this function
@@ -55,40 +85,22 @@ CTimings::TimingMap CTimings::timing_values;
 ///////////////////////////////////////////////////////////////////////////////
 void CTimings::TimingParameters(po::options_description& opts)
 {
+    // Every timing parameter needs a name, in the order of the enumeration.
+    BOOST_STATIC_ASSERT(sizeof(TIMING_NAMES) / sizeof(TIMING_NAMES[0]) ==
+        TIMING_PARAMETER_COUNT);
 
-    RegisterTimingValue(opts,"GM_AYC_RESPONSE_TIMEOUT");
-    RegisterTimingValue(opts,"GM_PREMERGE_MAX_TIMEOUT");
-    RegisterTimingValue(opts,"GM_INVITE_RESPONSE_TIMEOUT");
-    RegisterTimingValue(opts,"GM_AYT_RESPONSE_TIMEOUT");
-    RegisterTimingValue(opts,"GM_PREMERGE_MIN_TIMEOUT");
-    RegisterTimingValue(opts,"GM_PREMERGE_GRANULARITY");
-    RegisterTimingValue(opts,"GM_PHASE_TIME");
-    RegisterTimingValue(opts,"LB_PHASE_TIME");
-    RegisterTimingValue(opts,"LB_ROUND_TIME");
-    RegisterTimingValue(opts,"LB_REQUEST_TIMEOUT");
-    RegisterTimingValue(opts,"VVC_PHASE_TIME");
-    RegisterTimingValue(opts,"VVC_ROUND_TIME");
-    RegisterTimingValue(opts,"VVC_REQUEST_TIMEOUT");    
-    RegisterTimingValue(opts,"SC_PHASE_TIME");
-    RegisterTimingValue(opts,"DEV_PNP_HEARTBEAT");
-    RegisterTimingValue(opts,"DEV_RTDS_DELAY");
-    RegisterTimingValue(opts,"DEV_SOCKET_TIMEOUT");
-    RegisterTimingValue(opts,"CSRC_RESEND_TIME");
-    RegisterTimingValue(opts,"CSRC_DEFAULT_TIMEOUT");
-    /////////////////////////////////////////////
-    // ADD YOUR TIMING PARAMETERS BELOW HERE
-    /////////////////////////////////////////////
-
-    /////////////////////////////////////////////
-    // ADD YOUR TIMING PARAMETERS ABOVE HERE
-    ////////////////////////////////////////////
+    for(int i = 0; i < TIMING_PARAMETER_COUNT; i++)
+    {
+        RegisterTimingValue(opts, static_cast<TimingParameter>(i));
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 /// CTimings::Get
 /// @description Returns the value of the specified timing parameter, in
 ///     milliseconds, or throws an exception if the timing parameter does not
-///     exist in the timings set.
+///     exist in the timings set. The DGI itself reads the timings through
+///     their TimingParameter, which needs no lookup.
 /// @pre None
 /// @post Throws exception if timing parameter has not been registered.
 /// @return The requested timing parameter in ms.
@@ -96,10 +108,10 @@ void CTimings::TimingParameters(po::options_description& opts)
 unsigned int CTimings::Get(std::string param)
 {
     TimingMapIterator it;
-    it = timing_values.find(param);
-    if(it == timing_values.end())
+    it = timing_index.find(param);
+    if(it == timing_index.end())
         throw std::runtime_error("CTimings:: Requested timing parameter, "+param+", does not exist");
-    return it->second;  
+    return Get(it->second);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -108,29 +120,53 @@ unsigned int CTimings::Get(std::string param)
 ///     parser.
 /// @pre None
 /// @post The configuration file parser expects a new parameter when loading
-///     the file. The timing value for the parameter is defaulted to zero.
+///     the file.
 /// @param opts The options parser that will parse the timings config
-/// @param param the name of the timing parameter being added.
+/// @param param the timing parameter being added.
 ///////////////////////////////////////////////////////////////////////////////
-void CTimings::RegisterTimingValue(po::options_description& opts, const std::string param)
+void CTimings::RegisterTimingValue(po::options_description& opts, TimingParameter param)
 {
-    std::string desc = "The timing value "+param;
+    std::string name = TIMING_NAMES[param];
+    std::string desc = "The timing value "+name;
     opts.add_options()
-        (param.c_str(),
+        (name.c_str(),
         po::value<unsigned int>( ),
         desc.c_str() );
-    timing_values[param] = 0;    
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// CTimings::BuildIndex
+/// @description Builds the index Get uses to find a timing parameter by name.
+///     It is built once, during static initialization, so loading the
+///     timings never modifies it while other threads read it.
+/// @pre None
+/// @post None
+/// @return The timing parameters by name.
+///////////////////////////////////////////////////////////////////////////////
+CTimings::TimingMap CTimings::BuildIndex()
+{
+    TimingMap index;
+    for(int i = 0; i < TIMING_PARAMETER_COUNT; i++)
+    {
+        index[TIMING_NAMES[i]] = static_cast<TimingParameter>(i);
+    }
+    return index;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 /// CTimings::SetTimings
 /// @description Loads the specified timing configuration file and sets all
 ///     the timing values from that file. If a timing value is missing from
-///     that file, an exception is thrown.
-/// @pre None
+///     that file, an exception is thrown. The values are written to the set
+///     that is not being read, which is then swapped in, so the file can be
+///     reloaded while the DGI runs and readers see either all of the old
+///     values or all of the new ones.
+/// @pre Calls to SetTimings do not overlap. A reader must finish with a set
+///     before the timings are loaded twice more, which holds as long as
+///     reloads are not back to back.
 /// @post The timings values are loaded from the specified file, or an
 ///     exception is thrown because the file was missing one or more timing
-///     parameters.
+///     parameters. The values are only changed if every one was loaded.
 /// @param timingsFile The name of the file that contains the timings config.
 ///////////////////////////////////////////////////////////////////////////////
 void CTimings::SetTimings(const std::string timingsFile)
@@ -140,6 +176,8 @@ void CTimings::SetTimings(const std::string timingsFile)
     po::options_description opts("Timing Parameters");
     po::variables_map vm;
     std::string param;
+    const STimingSet* active = timing_active.load(boost::memory_order_relaxed);
+    STimingSet* next = (active == &timing_sets[0] ? &timing_sets[1] : &timing_sets[0]);
 	
     TimingParameters(opts);
 
@@ -153,27 +191,31 @@ void CTimings::SetTimings(const std::string timingsFile)
         // Process the config
         po::store(parse_config_file(ifs, opts), vm);
         po::notify(vm);
-        Logger.Info << "timer config file " << timingsFile <<
+        FREEDM_LOG_INFO(Logger) << "timer config file " << timingsFile <<
                 " successfully loaded." << std::endl;
     }
     ifs.close();
 
-    TimingMapIterator it;
-    for(it=timing_values.begin(); it!=timing_values.end(); it++)
+    for(int i = 0; i < TIMING_PARAMETER_COUNT; i++)
     {
-        param = it->first;
+        param = TIMING_NAMES[i];
         try
         {
-            timing_values[param] = vm[param].as<unsigned int>();
+            next->values[i] = vm[param].as<unsigned int>();
         }
         catch (boost::bad_any_cast& e)
         {
             throw EDgiConfigError(
                     param+" is missing, please check your timings config");
         }
-    } 
+    }
+
+    for(int i = 0; i < TIMING_PARAMETER_COUNT; i++)
+    {
+        next->durations[i] = boost::posix_time::milliseconds(next->values[i]);
+    }
+    timing_active.store(next, boost::memory_order_release);
 }
 
 }
 }
-
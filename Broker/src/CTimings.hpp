@@ -23,6 +23,8 @@
 #include <string>
 #include <map>
 
+#include <boost/atomic.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/program_options.hpp>
 #include <boost/program_options/options_description.hpp>
 
@@ -36,21 +38,72 @@ namespace broker {
 class CTimings
 {
 public:
+    /// The timing parameters, named as they are in the timings config
+    enum TimingParameter
+    {
+        GM_AYC_RESPONSE_TIMEOUT,
+        GM_PREMERGE_MAX_TIMEOUT,
+        GM_INVITE_RESPONSE_TIMEOUT,
+        GM_AYT_RESPONSE_TIMEOUT,
+        GM_PREMERGE_MIN_TIMEOUT,
+        GM_PREMERGE_GRANULARITY,
+        GM_PHASE_TIME,
+        LB_PHASE_TIME,
+        LB_ROUND_TIME,
+        LB_REQUEST_TIMEOUT,
+        VVC_PHASE_TIME,
+        VVC_ROUND_TIME,
+        VVC_REQUEST_TIMEOUT,
+        SC_PHASE_TIME,
+        DEV_PNP_HEARTBEAT,
+        DEV_RTDS_DELAY,
+        DEV_SOCKET_TIMEOUT,
+        CSRC_RESEND_TIME,
+        CSRC_DEFAULT_TIMEOUT,
+        /////////////////////////////////////////////
+        // ADD YOUR TIMING PARAMETERS ABOVE HERE,
+        // AND THEIR NAMES TO TIMING_NAMES
+        /////////////////////////////////////////////
+        /// The number of timing parameters
+        TIMING_PARAMETER_COUNT
+    };
     /// Loads timings values from the specified file
     static void SetTimings(const std::string timingsFile);
     /// Returns the value of the specified timing parameter
     static unsigned int Get(const std::string param);
+    /// Returns the value of a timing parameter in ms, without a lookup
+    static unsigned int Get(TimingParameter param)
+        { return timing_active.load(boost::memory_order_acquire)->values[param]; }
+    /// Returns the value of a timing parameter as a duration
+    static boost::posix_time::time_duration GetDuration(TimingParameter param)
+        { return timing_active.load(boost::memory_order_acquire)->durations[param]; }
 private:
-    /// Typedef for timing datastore.
-    typedef std::map<std::string, unsigned int> TimingMap;
+    /// One complete set of timing values
+    struct STimingSet
+    {
+        /// The timing parameter values in ms
+        unsigned int values[TIMING_PARAMETER_COUNT];
+        /// The timing parameter values as durations
+        boost::posix_time::time_duration durations[TIMING_PARAMETER_COUNT];
+    };
+    /// Typedef for the parameters by name.
+    typedef std::map<std::string, TimingParameter> TimingMap;
     /// Typedef for timing datastore iterator
-    typedef TimingMap::iterator TimingMapIterator;
+    typedef TimingMap::const_iterator TimingMapIterator;
     /// Registers all the expected timing parameters
     static void TimingParameters(po::options_description& opts);
     /// Adds individual parameter to the expected options
-	static void RegisterTimingValue(po::options_description&, const std::string param);
-    /// Data store for the timing parameter values
-    static TimingMap timing_values;
+	static void RegisterTimingValue(po::options_description&, TimingParameter param);
+    /// Builds the index of the timing parameters by name
+    static TimingMap BuildIndex();
+    /// The names of the timing parameters, indexed by TimingParameter
+    static const char* const TIMING_NAMES[];
+    /// The timing parameters by name, for Get(std::string)
+    static TimingMap timing_index;
+    /// The loaded set and the set the next load is written to
+    static STimingSet timing_sets[2];
+    /// The set the timing parameters are read from
+    static boost::atomic<const STimingSet*> timing_active;
 
 };
 
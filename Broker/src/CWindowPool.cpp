@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CWindowPool.cpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Reuses the windows received datagrams are parsed into
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CWindowPool.hpp"
+
+#include "messages/ProtocolMessage.pb.h"
+
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+
+namespace freedm {
+
+namespace broker {
+
+///////////////////////////////////////////////////////////////////////////////
+/// CWindowPool
+/// @description Constructor for an empty window pool.
+/// @pre None
+/// @post The pool holds no windows.
+///////////////////////////////////////////////////////////////////////////////
+CWindowPool::CWindowPool()
+{
+    //Pass
+}
+///////////////////////////////////////////////////////////////////////////////
+/// ~CWindowPool
+/// @description Destructor. Frees the windows held in the pool.
+/// @pre No window handed out by Acquire is still referenced, since its
+///  deleter returns it to this pool.
+/// @post The pool is empty.
+///////////////////////////////////////////////////////////////////////////////
+CWindowPool::~CWindowPool()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    BOOST_FOREACH(ProtocolMessageWindow* window, m_free)
+    {
+        delete window;
+    }
+    m_free.clear();
+}
+///////////////////////////////////////////////////////////////////////////////
+/// Acquire
+/// @description Gets an empty window to parse a datagram into. Windows are
+///  recycled, and protobuf keeps the storage of cleared repeated fields, so
+///  parsing into a recycled window reuses the messages and strings of an
+///  earlier datagram instead of allocating new ones.
+/// @pre None
+/// @post The returned window is removed from the pool. It returns to the
+///  pool when the last shared_ptr to it, or to any message inside of it, is
+///  destroyed.
+/// @return A shared pointer to an empty window.
+///////////////////////////////////////////////////////////////////////////////
+CWindowPool::WindowPtr CWindowPool::Acquire()
+{
+    ProtocolMessageWindow* window = 0;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if(!m_free.empty())
+        {
+            window = m_free.back();
+            m_free.pop_back();
+        }
+    }
+    if(!window)
+    {
+        window = new ProtocolMessageWindow();
+    }
+    return WindowPtr(window, boost::bind(&CWindowPool::Release, this, _1));
+}
+///////////////////////////////////////////////////////////////////////////////
+/// GetFreeCount
+/// @description Counts the windows waiting in the pool to be reused.
+/// @pre None
+/// @post None
+/// @return The number of pooled windows.
+///////////////////////////////////////////////////////////////////////////////
+std::size_t CWindowPool::GetFreeCount() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_free.size();
+}
+///////////////////////////////////////////////////////////////////////////////
+/// Release
+/// @description The deleter of the windows handed out by Acquire. Clears the
+///  window and puts it back into the pool, unless the pool is already full.
+/// @pre Nothing references the window or the messages inside of it.
+/// @post The window is in the pool or has been deleted.
+/// @param window the window to release.
+///////////////////////////////////////////////////////////////////////////////
+void CWindowPool::Release(ProtocolMessageWindow* window)
+{
+    window->Clear();
+    boost::mutex::scoped_lock lock(m_mutex);
+    if(m_free.size() < MAX_POOLED_WINDOWS)
+    {
+        m_free.push_back(window);
+    }
+    else
+    {
+        delete window;
+    }
+}
+
+} // namespace broker
+
+} // namespace freedm
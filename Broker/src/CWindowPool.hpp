@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CWindowPool.hpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Reuses the windows received datagrams are parsed into
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CWINDOWPOOL_HPP
+#define CWINDOWPOOL_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace freedm {
+
+namespace broker {
+
+class ProtocolMessageWindow;
+
+/// Parsed windows, shared by the messages delivered from them and reused
+/// once the last of those messages is released
+class CWindowPool
+    : private boost::noncopyable
+{
+public:
+    /// A parsed window shared by the messages delivered from it
+    typedef boost::shared_ptr<ProtocolMessageWindow> WindowPtr;
+
+    /// Creates an empty pool
+    CWindowPool();
+
+    /// Frees the pooled windows
+    ~CWindowPool();
+
+    /// Takes a window from the pool, or allocates one if the pool is empty
+    WindowPtr Acquire();
+
+    /// Returns how many windows are cleared and ready to be parsed into
+    std::size_t GetFreeCount() const;
+
+private:
+    /// Returns a window to the pool once nothing references it
+    void Release(ProtocolMessageWindow* window);
+
+    /// Windows which can be reused for the next datagram
+    std::vector<ProtocolMessageWindow*> m_free;
+
+    /// Lock for the free list, windows can be released by any broker thread
+    mutable boost::mutex m_mutex;
+
+    /// The most windows kept for reuse once their messages are released
+    static const unsigned int MAX_POOLED_WINDOWS = 32;
+};
+
+} // namespace broker
+
+} // namespace freedm
+
+#endif // CWINDOWPOOL_HPP
@@ -0,0 +1,278 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         EventLogDecoder.cpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Converts the binary event log of a DGI to CSV or JSON.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "SEventRecord.hpp"
+#include "messages/ModuleMessage.pb.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/foreach.hpp>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+using namespace freedm::broker;
+
+namespace {
+
+/// Returns the name written for an event type.
+std::string GetTypeName(boost::uint16_t type)
+{
+    switch(type)
+    {
+        case EVENT_PHASE_CHANGE:
+            return "phase_change";
+        case EVENT_MESSAGE_SENT:
+            return "message_sent";
+        case EVENT_MESSAGE_RECEIVED:
+            return "message_received";
+        case EVENT_STATE_CHANGE:
+            return "state_change";
+        case EVENT_DEVICE_READ:
+            return "device_read";
+        case EVENT_DEVICE_COMMAND:
+            return "device_command";
+    }
+    std::ostringstream ss;
+    ss << "unknown_" << type;
+    return ss.str();
+}
+
+/// Returns the name written for a module.
+std::string GetModuleName(boost::uint16_t module)
+{
+    if(module == ModuleMessage::UNKNOWN_MODULE)
+    {
+        return "";
+    }
+    if(ModuleMessage::RecipientId_IsValid(module))
+    {
+        return ModuleMessage::RecipientId_Name(
+            static_cast<ModuleMessage::RecipientId>(module));
+    }
+    std::ostringstream ss;
+    ss << module;
+    return ss.str();
+}
+
+/// Reads a NUL padded field, which may fill the whole field.
+template <std::size_t N>
+std::string GetField(const char (&field)[N])
+{
+    const void* end = std::memchr(field, '\0', N);
+    return std::string(field, end ? static_cast<const char*>(end) : field + N);
+}
+
+/// Converts a record's time to ISO 8601.
+std::string GetTime(boost::uint64_t us)
+{
+    static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+    return boost::posix_time::to_iso_extended_string(epoch +
+        boost::posix_time::microseconds(static_cast<boost::int64_t>(us)));
+}
+
+/// Quotes a CSV field if it needs to be.
+std::string QuoteCsv(const std::string& s)
+{
+    if(s.find_first_of(",\"\r\n") == std::string::npos)
+    {
+        return s;
+    }
+    std::string quoted = "\"";
+    BOOST_FOREACH(char c, s)
+    {
+        if(c == '"')
+            quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+/// Quotes a JSON string.
+std::string QuoteJson(const std::string& s)
+{
+    std::string quoted = "\"";
+    BOOST_FOREACH(char c, s)
+    {
+        if(c == '"' || c == '\\')
+        {
+            quoted += '\\';
+            quoted += c;
+        }
+        else if(static_cast<unsigned char>(c) < 0x20)
+        {
+            char escape[8];
+            std::sprintf(escape, "\\u%04x", static_cast<unsigned int>(c));
+            quoted += escape;
+        }
+        else
+        {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+/// Writes one record as a CSV row.
+void WriteCsv(std::ostream& out, const std::string& dgi, const SEventRecord& r)
+{
+    out << GetTime(r.time) << ',' << QuoteCsv(dgi) << ',' << r.sequence << ','
+        << GetTypeName(r.type) << ',' << GetModuleName(r.module) << ','
+        << r.code << ',' << r.detail << ',' << r.value << ','
+        << QuoteCsv(GetField(r.subject)) << ',' << QuoteCsv(GetField(r.signal))
+        << '\n';
+}
+
+/// Writes one record as a line of JSON.
+void WriteJson(std::ostream& out, const std::string& dgi, const SEventRecord& r)
+{
+    out << "{\"time\":" << QuoteJson(GetTime(r.time))
+        << ",\"dgi\":" << QuoteJson(dgi)
+        << ",\"sequence\":" << r.sequence
+        << ",\"type\":" << QuoteJson(GetTypeName(r.type))
+        << ",\"module\":" << QuoteJson(GetModuleName(r.module))
+        << ",\"code\":" << r.code
+        << ",\"detail\":" << r.detail
+        << ",\"value\":" << r.value
+        << ",\"subject\":" << QuoteJson(GetField(r.subject))
+        << ",\"signal\":" << QuoteJson(GetField(r.signal))
+        << "}\n";
+}
+
+/// Writes the records of one file, returning false if it can't be read.
+bool Decode(const std::string& path, bool json, std::ostream& out)
+{
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if(!in)
+    {
+        std::cerr << path << ": unable to open" << std::endl;
+        return false;
+    }
+
+    SEventLogHeader header;
+    if(!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, EVENT_LOG_MAGIC, sizeof(header.magic)) != 0)
+    {
+        std::cerr << path << ": not an event log" << std::endl;
+        return false;
+    }
+    if(header.byteorder != EVENT_LOG_BYTE_ORDER)
+    {
+        std::cerr << path << ": written with a different byte order" << std::endl;
+        return false;
+    }
+    if(header.version != EVENT_LOG_VERSION || header.recordsize != sizeof(SEventRecord))
+    {
+        std::cerr << path << ": unsupported version " << header.version << std::endl;
+        return false;
+    }
+
+    std::string dgi = GetField(header.uuid);
+    SEventRecord r;
+    boost::uint64_t i;
+    for(i = 0; i < header.count; i++)
+    {
+        if(!in.read(reinterpret_cast<char*>(&r), sizeof(r)))
+        {
+            std::cerr << path << ": truncated after " << i << " of "
+                      << header.count << " events" << std::endl;
+            break;
+        }
+        if(json)
+        {
+            WriteJson(out, dgi, r);
+        }
+        else
+        {
+            WriteCsv(out, dgi, r);
+        }
+    }
+    return true;
+}
+
+} // unnamed namespace
+
+/// Decoder entry point
+int main(int argc, char* argv[])
+{
+    po::options_description opts("Options");
+    po::positional_options_description files;
+    po::variables_map vm;
+    std::string format;
+
+    opts.add_options()
+            ( "help,h", "print usage help (this screen)" )
+            ( "format,f",
+            po::value<std::string>( &format )->default_value("csv"),
+            "output format: csv, or json for one object per line" )
+            ( "file",
+            po::value<std::vector<std::string> >( )->composing(),
+            "event log file, oldest first" );
+    files.add("file", -1);
+
+    try
+    {
+        po::store(po::command_line_parser(argc, argv)
+                .options(opts).positional(files).run(), vm);
+        po::notify(vm);
+    }
+    catch (std::exception & e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    if (vm.count("help") || !vm.count("file"))
+    {
+        std::cout << "Usage: " << argv[0] << " [options] file..." << std::endl
+                  << opts << std::endl;
+        return vm.count("help") ? 0 : 1;
+    }
+    if (format != "csv" && format != "json")
+    {
+        std::cerr << "invalid format: " << format << std::endl;
+        return 1;
+    }
+
+    std::cout << std::setprecision(12);
+    if (format == "csv")
+    {
+        std::cout << "time,dgi,sequence,type,module,code,detail,value,subject,signal\n";
+    }
+
+    int result = 0;
+    BOOST_FOREACH(std::string path, vm["file"].as<std::vector<std::string> >())
+    {
+        if (!Decode(path, format == "json", std::cout))
+        {
+            result = 1;
+        }
+    }
+    return result;
+}
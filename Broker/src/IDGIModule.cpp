@@ -19,7 +19,9 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "IDGIModule.hpp"
+#include "CBroker.hpp"
 #include "CGlobalConfiguration.hpp"
+#include "Messages.hpp"
 
 namespace freedm {
 
@@ -55,6 +57,37 @@ CPeerNode IDGIModule::GetMe()
 {
     return m_me;
 }
+///////////////////////////////////////////////////////////////////////////////
+/// NewMessage
+/// @description Returns an empty message addressed to a module for the caller
+///  to build and send. The message comes from the module's CMessagePool, so
+///  the messages of a phase are reused two phases later.
+/// @pre Called from the module's own tasks, which the broker serializes.
+/// @post The message is recorded in the pool of the current phase.
+/// @param recipient the module the message will be delivered to
+/// @return A message which stays valid until the end of the next phase. The
+///  caller should send it (Send encodes it immediately) and not keep it.
+///////////////////////////////////////////////////////////////////////////////
+ModuleMessage& IDGIModule::NewMessage(std::string recipient)
+{
+    ModuleMessage& msg = m_pool.NewMessage(CBroker::Instance().GetPhaseCount());
+    SetRecipient(msg, recipient);
+    return msg;
+}
+///////////////////////////////////////////////////////////////////////////////
+/// ShareMessage
+/// @description Returns a shared pointer to a message, so it can be sent to
+///  this process without the copy CPeerNode::Send makes of messages it does
+///  not own. See CMessagePool::ShareMessage.
+/// @pre The message is not modified after it is shared.
+/// @post None
+/// @param msg the message to share
+/// @return A pointer to the message, or to a copy of it.
+///////////////////////////////////////////////////////////////////////////////
+boost::shared_ptr<const ModuleMessage> IDGIModule::ShareMessage(const ModuleMessage& msg)
+{
+    return m_pool.ShareMessage(msg);
+}
 
 } // namespace freedm
 
@@ -21,10 +21,13 @@
 #ifndef IDGIMODULE_HPP
 #define IDGIMODULE_HPP
 
+#include "CMessagePool.hpp"
 #include "CPeerNode.hpp"
 
 #include "messages/ModuleMessage.pb.h"
 
+#include <string>
+
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
 
@@ -59,9 +62,18 @@ protected:
     /// Gets a CPeerNode representing this process.
     CPeerNode GetMe();
 
+    /// Returns an empty message to build, reused once the phase has passed
+    ModuleMessage& NewMessage(std::string recipient);
+
+    /// Returns a shared pointer to a built message, to send it without copies
+    boost::shared_ptr<const ModuleMessage> ShareMessage(const ModuleMessage& msg);
+
 private: 
     /// The CPeerNode this represents.
     CPeerNode m_me;
+
+    /// The messages built by the module
+    CMessagePool m_pool;
 };
 
 } // namespace freedm
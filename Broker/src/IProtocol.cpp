@@ -50,14 +50,18 @@ IProtocol::IProtocol(std::string uuid, boost::asio::ip::udp::endpoint endpoint)
     , m_uuid(uuid)
     , m_stopped(false)
     , m_reliability(100)
+    , m_binarytime(false)
+    , m_selectiveack(false)
 {
     //pass
 }
 ///////////////////////////////////////////////////////////////////////////////
 /// IProtocol::Write 
 /// @description Sends a message over the connection associated with this 
-/// IProtocol. This is a blocking send. An asynchronous send is not currently 
-/// provided because:
+/// IProtocol. This is a blocking send, unless the broker was built with
+/// BATCHED_UDP, in which case the datagram is queued on the listener and sent
+/// with the other datagrams written during the same io_service turn. An
+/// asynchronous send is not currently provided because:
 /// (a) this would require a second io_service, or a second thread in our
 /// io_service's thread pool, (b) because it would make the code more
 /// complicated: e.g. modules would be required to use an async callback (write
@@ -73,10 +77,9 @@ IProtocol::IProtocol(std::string uuid, boost::asio::ip::udp::endpoint endpoint)
 ///////////////////////////////////////////////////////////////////////////////
 void IProtocol::Write(ProtocolMessageWindow& msg)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
-    msg.set_source_uuid(CGlobalConfiguration::Instance().GetUUID());
-    StampMessageSendtime(msg);
+    StampWindow(msg);
 
     msg.CheckInitialized();
 
@@ -86,35 +89,87 @@ void IProtocol::Write(ProtocolMessageWindow& msg)
     /// Check to make sure it isn't going to overfill our message packet
     if(msg.ByteSize() > CGlobalConfiguration::MAX_PACKET_SIZE)
     {
-        Logger.Warn << "Message too long for buffer: " << std::endl
+        FREEDM_LOG_WARN(Logger) << "Message too long for buffer: " << std::endl
                 << msg.DebugString() << std::endl;
         throw std::runtime_error("Outgoing message is too long for buffer");
     }
 
+    boost::array<char, CGlobalConfiguration::MAX_PACKET_SIZE> write_buffer;
+    msg.SerializeToArray(&write_buffer[0], CGlobalConfiguration::MAX_PACKET_SIZE);
+
+    WriteDatagram(&write_buffer[0], msg.ByteSize());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// IProtocol::StampWindow
+/// @description Sets the fields of an outgoing window that describe the
+///     sender: its UUID, the send time and the timestamp capability.
+/// @pre None
+/// @post The window is stamped with the current time.
+/// @param msg the window to stamp
+///////////////////////////////////////////////////////////////////////////////
+void IProtocol::StampWindow(ProtocolMessageWindow& msg)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    msg.set_source_uuid(CGlobalConfiguration::Instance().GetUUID());
+    StampMessageSendtime(msg, !m_binarytime);
+    msg.set_binary_timestamps(true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// IProtocol::WriteDatagram
+/// @description Sends an encoded window to the Protocol's endpoint. This is
+/// the part of Write that follows serialization, for protocols which encode
+/// their windows themselves.
+/// @pre data holds a complete ProtocolMessageWindow no longer than
+///     MAX_PACKET_SIZE.
+/// @post Writes the datagram using the listening socket to the Protocol's
+///		endpoint, unless the protocol is stopped or the endpoint is not yet
+///     resolved.
+/// @param data the encoded window
+/// @param length the size of the encoded window
+///////////////////////////////////////////////////////////////////////////////
+void IProtocol::WriteDatagram(const char* data, std::size_t length)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    if(m_stopped)
+        return;
+
+    if(!IsResolved())
+    {
+        FREEDM_LOG_DEBUG(Logger)<<"Not writing to "<<GetUUID()<<" until it is resolved"<<std::endl;
+        return;
+    }
+
     #ifdef CUSTOMNETWORK
     if((rand()%100) >= GetReliability())
     {
-        Logger.Info<<"Outgoing Packet Dropped ("<<GetReliability()
+        FREEDM_LOG_INFO(Logger)<<"Outgoing Packet Dropped ("<<GetReliability()
                       <<") -> "<<GetUUID()<<std::endl;
         return;
     }
     #endif
 
-    boost::array<char, CGlobalConfiguration::MAX_PACKET_SIZE> write_buffer;
-    msg.SerializeToArray(&write_buffer[0], CGlobalConfiguration::MAX_PACKET_SIZE);
+    FREEDM_LOG_DEBUG(Logger)<<"Writing "<<length<<" bytes to channel"<<std::endl;
 
-    Logger.Debug<<"Writing "<<msg.ByteSize()<<" bytes to channel"<<std::endl;
+#ifdef BATCHED_UDP
+    // The listener sends everything written this turn with one system call.
+    CListener::Instance().QueueDatagram(data, length, m_endpoint, shared_from_this());
+    return;
+#endif
 
     try
     {
         CListener::Instance().GetSocket().send_to(
-            boost::asio::buffer(&write_buffer[0], msg.ByteSize()),
+            boost::asio::buffer(data, length),
             m_endpoint
         );
     }
     catch(boost::system::system_error &e)
     {
-        Logger.Debug << "Writing Failed: " << e.what() << std::endl;
+        FREEDM_LOG_DEBUG(Logger) << "Writing Failed: " << e.what() << std::endl;
         Stop();
     }
 }
@@ -128,7 +183,7 @@ void IProtocol::Write(ProtocolMessageWindow& msg)
 ///////////////////////////////////////////////////////////////////////////////
 std::string IProtocol::GetUUID() const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     return m_uuid;
 }
@@ -143,7 +198,7 @@ std::string IProtocol::GetUUID() const
 ///////////////////////////////////////////////////////////////////////////////
 void IProtocol::SetReliability(int r)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     m_reliability = r;
 }
@@ -157,7 +212,7 @@ void IProtocol::SetReliability(int r)
 ///////////////////////////////////////////////////////////////////////////////
 int IProtocol::GetReliability() const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     return m_reliability;
 }
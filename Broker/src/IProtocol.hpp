@@ -29,8 +29,10 @@
 #include <set>
 
 #include <boost/asio.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
 
 namespace freedm {
     namespace broker {
@@ -39,6 +41,34 @@ class ModuleMessage;
 class ProtocolMessage;
 class ProtocolMessageWindow;
 
+/// Link statistics kept by a protocol
+struct SLinkStats
+{
+    SLinkStats()
+        : sent(0), retransmitted(0), acked(0), ackedbytes(0), messages(0), datagrams(0),
+          refused(0) { }
+    /// Smoothed round trip time
+    boost::posix_time::time_duration srtt;
+    /// Round trip time variation
+    boost::posix_time::time_duration rttvar;
+    /// Current retransmission timeout, including backoff
+    boost::posix_time::time_duration rto;
+    /// Messages written to the channel, counting each retransmission
+    unsigned long sent;
+    /// Messages written to the channel more than once
+    unsigned long retransmitted;
+    /// Messages acknowledged by the peer
+    unsigned long acked;
+    /// Encoded bytes of the messages acknowledged by the peer
+    unsigned long ackedbytes;
+    /// Module messages sent over the link
+    unsigned long messages;
+    /// Datagrams written for the module messages, counting retransmissions
+    unsigned long datagrams;
+    /// Messages the peer refused for a full inbound queue
+    unsigned long refused;
+};
+
 /// A connection protocol
 class IProtocol
     : private boost::noncopyable,
@@ -49,6 +79,8 @@ class IProtocol
         virtual ~IProtocol() { };
         /// Public write to channel function
         virtual void Send(const ModuleMessage& msg) = 0;
+        /// Writes any messages the protocol has staged
+        virtual void Flush() { };
         /// Public facing function that handles marking ACKS
         virtual void ReceiveACK(const ProtocolMessage& msg) = 0;
         /// Function that determines if a message should dispatched
@@ -57,10 +89,17 @@ class IProtocol
         virtual void OnReceive() = 0;
         /// Handles Writing an ack for the input message to the channel
         virtual void SendACK(const ProtocolMessage& msg) = 0;
+        /// Tells the peer an accepted message was not delivered, if it can tell
+        virtual void Refuse(const ProtocolMessage&) { };
         /// Handles Stopping the timers etc
         virtual void Stop() = 0;
         /// Handles the change phase even
         virtual void ChangePhase(bool) { };
+        /// Returns the link statistics, if the protocol keeps them
+        virtual SLinkStats GetStats() const { return SLinkStats(); };
+        /// Returns the next held message that is now in order, if any
+        virtual boost::shared_ptr<const ProtocolMessage> NextInOrder()
+            { return boost::shared_ptr<const ProtocolMessage>(); };
         /// Handles checking to see if the connection is stopped
         bool GetStopped() { return m_stopped; };
         /// Handles setting the stopped variable
@@ -73,6 +112,18 @@ class IProtocol
         int GetReliability() const;
         /// Gets the uuid:
         std::string GetUUID() const;
+        /// Sets the destination once the peer's hostname is resolved
+        virtual void SetEndpoint(boost::asio::ip::udp::endpoint endpoint) { m_endpoint = endpoint; };
+        /// Checks whether the destination is known
+        bool IsResolved() const { return m_endpoint.port() != 0; };
+        /// Records whether the peer reads the binary timestamps
+        void SetBinaryTimestamps(bool v) { m_binarytime = v; };
+        /// Checks whether the peer reads the binary timestamps
+        bool GetBinaryTimestamps() const { return m_binarytime; };
+        /// Records whether the peer reads cumulative and selective ACKs
+        void SetSelectiveAck(bool v) { m_selectiveack = v; };
+        /// Checks whether the peer reads cumulative and selective ACKs
+        bool GetSelectiveAck() const { return m_selectiveack; };
     protected:
         /// Initializes the protocol with the underlying connection
         IProtocol(std::string uuid, boost::asio::ip::udp::endpoint endpoint);
@@ -80,6 +131,10 @@ class IProtocol
         virtual void WriteCallback(const boost::system::error_code&) { }
         /// Handles writing the message to the underlying connection
         virtual void Write(ProtocolMessageWindow& msg);
+        /// Sets the source and send time of an outgoing window
+        void StampWindow(ProtocolMessageWindow& msg);
+        /// Sends an encoded window over the underlying connection
+        void WriteDatagram(const char* data, std::size_t length);
     private:
         /// Datagram socket connected to a single peer DGI
         boost::asio::ip::udp::endpoint m_endpoint;
@@ -92,6 +147,12 @@ class IProtocol
 
         /// The reliability of the connection (FOR -DCUSTOMNETWORK)
         int m_reliability;
+
+        /// True if the peer has advertised that it reads binary timestamps
+        bool m_binarytime;
+
+        /// True if the peer has advertised that it reads selective ACKs
+        bool m_selectiveack;
 };
 
     }
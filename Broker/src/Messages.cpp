@@ -27,10 +27,13 @@
 #include "messages/ProtocolMessage.pb.h"
 
 #include <cassert>
+#include <cstring>
+#include <vector>
 
 #include <boost/date_time/posix_time/posix_time.hpp>
-#include <boost/functional/hash.hpp>
 #include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
 
 namespace freedm {
 namespace broker {
@@ -40,20 +43,203 @@ namespace {
 /// This file's logger.
 CLocalLogger Logger(__FILE__);
 
+/// The multiplier of the message hash (0xc6a4a7935bd1e995)
+const google::protobuf::uint64 HASH_MULTIPLIER =
+    (static_cast<google::protobuf::uint64>(0xc6a4a793UL) << 32) | 0x5bd1e995UL;
+
+/// The shift of the message hash
+const int HASH_SHIFT = 47;
+
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 /// ComputeMessageHash
-/// @description Hash a message.
+/// @description Hash a message. Callers that also send the message should
+///     hash the encoding they send with ComputeHash instead.
 /// @param msg the message to hash
 /// @return a hash of the message
 ///////////////////////////////////////////////////////////////////////////////
 google::protobuf::uint64 ComputeMessageHash(const ModuleMessage& msg)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    std::string encoded;
+    msg.SerializeToString(&encoded);
+    return ComputeHash(encoded.data(), encoded.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// ComputeHash
+/// @description Hashes a buffer eight bytes at a time (MurmurHash64A). The
+///     hash only has to tell apart the messages of a window, and peers echo
+///     it back rather than recompute it, so it need not match across hosts
+///     of different byte order.
+/// @param data the bytes to hash
+/// @param length the number of bytes
+/// @param seed distinguishes hashes of equal buffers, such as fragments
+/// @return a 64 bit hash of the buffer
+///////////////////////////////////////////////////////////////////////////////
+google::protobuf::uint64 ComputeHash(const char* data, std::size_t length,
+    google::protobuf::uint64 seed)
+{
+    typedef google::protobuf::uint64 uint64;
+
+    uint64 h = seed ^ (static_cast<uint64>(length) * HASH_MULTIPLIER);
+    const char* end = data + (length & ~static_cast<std::size_t>(7));
+    for(; data != end; data += 8)
+    {
+        uint64 k;
+        std::memcpy(&k, data, sizeof(k));
+        k *= HASH_MULTIPLIER;
+        k ^= k >> HASH_SHIFT;
+        k *= HASH_MULTIPLIER;
+        h ^= k;
+        h *= HASH_MULTIPLIER;
+    }
+    const unsigned char* tail = reinterpret_cast<const unsigned char*>(data);
+    std::size_t rest = length & 7;
+    if(rest > 0)
+    {
+        for(std::size_t i = 0; i < rest; i++)
+        {
+            h ^= static_cast<uint64>(tail[i]) << (8 * i);
+        }
+        h *= HASH_MULTIPLIER;
+    }
+    h ^= h >> HASH_SHIFT;
+    h *= HASH_MULTIPLIER;
+    h ^= h >> HASH_SHIFT;
+    return h;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// AppendField
+/// @description Appends a length delimited field to an encoded message, as
+///     protobuf would encode a string, bytes or embedded message field.
+///     Protobuf accepts fields in any order, so an encoding cached once can be
+///     embedded in another message without being parsed again.
+/// @pre out holds an encoded message, or is empty.
+/// @post The tag, length and bytes of the field are at the end of out.
+/// @param out the encoded message to append to
+/// @param field the number of the field
+/// @param bytes the encoded value of the field
+///////////////////////////////////////////////////////////////////////////////
+void AppendField(std::string& out, int field, const std::string& bytes)
+{
+    using google::protobuf::io::CodedOutputStream;
+    using google::protobuf::internal::WireFormatLite;
+
+    // Up to five bytes each of varint tag and length.
+    google::protobuf::uint8 prefix[10];
+    google::protobuf::uint8* end = CodedOutputStream::WriteVarint32ToArray(
+        WireFormatLite::MakeTag(field, WireFormatLite::WIRETYPE_LENGTH_DELIMITED), prefix);
+    end = CodedOutputStream::WriteVarint32ToArray(bytes.size(), end);
+    out.append(reinterpret_cast<const char*>(prefix), end - prefix);
+    out.append(bytes);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// GetRecipientId
+/// @description Maps a module identifier to the id the dispatcher indexes its
+///     handlers by.
+/// @param module the identifier the module registers with the dispatcher
+/// @return the id of the module, or UNKNOWN_MODULE if it has none
+///////////////////////////////////////////////////////////////////////////////
+ModuleMessage::RecipientId GetRecipientId(const std::string& module)
+{
+    static const struct
+    {
+        const char* module;
+        ModuleMessage::RecipientId id;
+    } RECIPIENTS[] = {
+        { "all", ModuleMessage::ALL_MODULES },
+        { "gm", ModuleMessage::GM_MODULE },
+        { "sc", ModuleMessage::SC_MODULE },
+        { "lb", ModuleMessage::LB_MODULE },
+        { "clk", ModuleMessage::CLK_MODULE },
+        { "vvc", ModuleMessage::VVC_MODULE }
+    };
+
+    for(std::size_t i = 0; i < sizeof(RECIPIENTS) / sizeof(RECIPIENTS[0]); i++)
+    {
+        if(module == RECIPIENTS[i].module)
+            return RECIPIENTS[i].id;
+    }
+    return ModuleMessage::UNKNOWN_MODULE;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// SetRecipient
+/// @description Addresses a message to a module. The identifier is always
+///     set, for DGIs which only read recipient_module; the id is set as well
+///     when the module has one.
+/// @pre None
+/// @post recipient_module is set, and recipient_id unless the module is
+///     unknown.
+/// @param msg the message to address
+/// @param module the identifier of the receiving module
+///////////////////////////////////////////////////////////////////////////////
+void SetRecipient(ModuleMessage& msg, const std::string& module)
+{
+    msg.set_recipient_module(module);
+    ModuleMessage::RecipientId id = GetRecipientId(module);
+    if(id != ModuleMessage::UNKNOWN_MODULE)
+    {
+        msg.set_recipient_id(id);
+    }
+    else
+    {
+        msg.clear_recipient_id();
+    }
+}
 
-    static boost::hash<std::string> string_hash;
-    return static_cast<google::protobuf::uint64>(string_hash(msg.ShortDebugString()));
+///////////////////////////////////////////////////////////////////////////////
+/// GetMessageType
+/// @description Identifies the kind of a module message by the field number
+///     of the module's message it carries and of the first field set inside
+///     that one, which for every module message is the message it sends.
+/// @param msg the message to identify
+/// @return the two field numbers, or zero for the ones that are not set
+///////////////////////////////////////////////////////////////////////////////
+std::pair<int, int> GetMessageType(const ModuleMessage& msg)
+{
+    std::vector<const google::protobuf::FieldDescriptor*> fields;
+    msg.GetReflection()->ListFields(msg, &fields);
+    for(std::size_t i = 0; i < fields.size(); i++)
+    {
+        const google::protobuf::FieldDescriptor* f = fields[i];
+        if(f->type() != google::protobuf::FieldDescriptor::TYPE_MESSAGE || f->is_repeated())
+            continue;
+        const google::protobuf::Message& sub = msg.GetReflection()->GetMessage(msg, f);
+        std::vector<const google::protobuf::FieldDescriptor*> inner;
+        sub.GetReflection()->ListFields(sub, &inner);
+        return std::make_pair(f->number(), inner.empty() ? 0 : inner.front()->number());
+    }
+    return std::make_pair(0, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// TimeToMicroseconds
+/// @description Converts a time to the wire format of the *_us timestamps.
+/// @param time the UTC time to convert
+/// @return the number of microseconds between the UNIX epoch and time
+///////////////////////////////////////////////////////////////////////////////
+google::protobuf::uint64 TimeToMicroseconds(const boost::posix_time::ptime& time)
+{
+    static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+    return static_cast<google::protobuf::uint64>((time - epoch).total_microseconds());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// MicrosecondsToTime
+/// @description Converts the wire format of the *_us timestamps to a time.
+/// @param us the number of microseconds since the UNIX epoch
+/// @return the UTC time us microseconds after the UNIX epoch
+///////////////////////////////////////////////////////////////////////////////
+boost::posix_time::ptime MicrosecondsToTime(google::protobuf::uint64 us)
+{
+    static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+    return epoch + boost::posix_time::microseconds(us);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -65,7 +251,13 @@ google::protobuf::uint64 ComputeMessageHash(const ModuleMessage& msg)
 ///////////////////////////////////////////////////////////////////////////////
 bool MessageIsExpired(const ProtocolMessage& msg)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    if(msg.has_expire_time_us())
+    {
+        return msg.expire_time_us() < TimeToMicroseconds(
+            boost::posix_time::microsec_clock::universal_time());
+    }
 
     if(!msg.has_expire_time())
         return false;
@@ -74,37 +266,65 @@ bool MessageIsExpired(const ProtocolMessage& msg)
         < boost::posix_time::microsec_clock::universal_time();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// GetExpirationTime
+/// @description Gets the expiration time of this message, preferring the
+///     binary timestamp over the text one sent by older peers.
+/// @param msg the message to read
+/// @return the expiration time, or not_a_date_time if the message has none
+///////////////////////////////////////////////////////////////////////////////
+boost::posix_time::ptime GetExpirationTime(const ProtocolMessage& msg)
+{
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    if(msg.has_expire_time_us())
+        return MicrosecondsToTime(msg.expire_time_us());
+
+    if(msg.has_expire_time())
+        return boost::posix_time::time_from_string(msg.expire_time());
+
+    return boost::posix_time::ptime();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// SetExpirationTimeFromNow
 /// @description Set the expiration time for this message.
 /// @param msg the message to modify
 /// @param expires_in how long from now to set the expiration time
+/// @param legacy also set the text timestamp read by older peers
 /// @pre None
 /// @post Sets the expire time to the current UTC time + expires_in time.
 ///////////////////////////////////////////////////////////////////////////////
-void SetExpirationTimeFromNow(ProtocolMessage& msg, const boost::posix_time::time_duration& expires_in)
+void SetExpirationTimeFromNow(ProtocolMessage& msg, const boost::posix_time::time_duration& expires_in, bool legacy)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
-    msg.set_expire_time(
-        boost::posix_time::to_simple_string(
-            boost::posix_time::microsec_clock::universal_time() + expires_in));
+    boost::posix_time::ptime expires =
+        boost::posix_time::microsec_clock::universal_time() + expires_in;
+    msg.set_expire_time_us(TimeToMicroseconds(expires));
+    if(legacy)
+        msg.set_expire_time(boost::posix_time::to_simple_string(expires));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 /// StampMessageSendtime
 /// @description Sets the message's timestamp to the current time.
 /// @param msg the message to stamp, transfer-none
+/// @param legacy also set the text timestamp read by older peers
 /// @pre None
-/// @post Sets the send time for the message to the current UTC time.
+/// @post Sets the send time for the message to the current UTC time. The text
+///     send time is empty unless legacy is set.
 ///////////////////////////////////////////////////////////////////////////////
-void StampMessageSendtime(ProtocolMessageWindow& msg)
+void StampMessageSendtime(ProtocolMessageWindow& msg, bool legacy)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
-    msg.set_send_time(
-        boost::posix_time::to_simple_string(
-            boost::posix_time::microsec_clock::universal_time()));
+    boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+    msg.set_send_time_us(TimeToMicroseconds(now));
+    if(legacy)
+        msg.set_send_time(boost::posix_time::to_simple_string(now));
+    else
+        msg.set_send_time("");
 }
 
 } // namespace broker
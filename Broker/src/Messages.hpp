@@ -25,7 +25,10 @@
 
 #include "messages/ModuleMessage.pb.h"
 
+#include <cstddef>
 #include <memory>
+#include <string>
+#include <utility>
 
 #include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <google/protobuf/message.h>
@@ -39,14 +42,39 @@ class ProtocolMessageWindow;
 /// Hash a message.
 google::protobuf::uint64 ComputeMessageHash(const ModuleMessage& msg);
 
+/// Hash an encoded message.
+google::protobuf::uint64 ComputeHash(const char* data, std::size_t length,
+    google::protobuf::uint64 seed = 0);
+
+/// Appends a length delimited field to an encoded message.
+void AppendField(std::string& out, int field, const std::string& bytes);
+
+/// Finds the recipient id of a module identifier.
+ModuleMessage::RecipientId GetRecipientId(const std::string& module);
+
+/// Addresses a message to a module by identifier and by id.
+void SetRecipient(ModuleMessage& msg, const std::string& module);
+
+/// Identifies the kind of a module message by the fields it has set.
+std::pair<int, int> GetMessageType(const ModuleMessage& msg);
+
+/// Converts a time to microseconds since the UNIX epoch.
+google::protobuf::uint64 TimeToMicroseconds(const boost::posix_time::ptime& time);
+
+/// Converts microseconds since the UNIX epoch to a time.
+boost::posix_time::ptime MicrosecondsToTime(google::protobuf::uint64 us);
+
 /// Determines whether the message has expired.
 bool MessageIsExpired(const ProtocolMessage& msg);
 
+/// Gets the expiration time of this message.
+boost::posix_time::ptime GetExpirationTime(const ProtocolMessage& msg);
+
 /// Set the expiration time for this message.
-void SetExpirationTimeFromNow(ProtocolMessage& msg, const boost::posix_time::time_duration& expires_in);
+void SetExpirationTimeFromNow(ProtocolMessage& msg, const boost::posix_time::time_duration& expires_in, bool legacy = true);
 
 /// Sets the message's timestamp to the current time.
-void StampMessageSendtime(ProtocolMessageWindow& msg);
+void StampMessageSendtime(ProtocolMessageWindow& msg, bool legacy = true);
 
 } // namespace broker
 } // namespace freedm
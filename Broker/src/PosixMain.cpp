@@ -24,8 +24,10 @@
 #include "CBroker.hpp"
 #include "CConnectionManager.hpp"
 #include "CDispatcher.hpp"
+#include "CEventLog.hpp"
 #include "CGlobalConfiguration.hpp"
 #include "CLogger.hpp"
+#include "CLogWriter.hpp"
 #include "config.hpp"
 #include "gm/GroupManagement.hpp"
 #include "lb/LoadBalance.hpp"
@@ -107,6 +109,51 @@ unsigned short GetPortFromString(const std::string str)
     return static_cast<unsigned short>(port);
 }
 
+/// Converts the name of an inbound queue policy to the dispatcher's policy.
+CDispatcher::QueuePolicy GetQueuePolicy(const std::string str)
+{
+    if( str == "drop-oldest" )
+    {
+        return CDispatcher::DROP_OLDEST;
+    }
+    else if( str == "coalesce" )
+    {
+        return CDispatcher::COALESCE;
+    }
+    else if( str == "reject" )
+    {
+        return CDispatcher::REJECT;
+    }
+    throw EDgiConfigError("invalid inbound queue policy: " + str);
+}
+
+/// Rereads the logger and timings configs, on SIGHUP. A file that fails to
+/// load keeps its old settings without stopping the other from loading.
+void ReloadConfig(const std::string timingsFile, const std::string loggerCfgFile)
+{
+    try
+    {
+        CGlobalLogger::instance().SetInitialLoggerLevels(loggerCfgFile);
+        FREEDM_LOG_STATUS(Logger) << "Reloaded " << loggerCfgFile << std::endl;
+    }
+    catch(std::exception & e)
+    {
+        FREEDM_LOG_ERROR(Logger) << "Failed to reload " << loggerCfgFile << ": "
+                << e.what() << std::endl;
+    }
+
+    try
+    {
+        CTimings::SetTimings(timingsFile);
+        FREEDM_LOG_STATUS(Logger) << "Reloaded " << timingsFile << std::endl;
+    }
+    catch(std::exception & e)
+    {
+        FREEDM_LOG_ERROR(Logger) << "Failed to reload " << timingsFile << ": "
+                << e.what() << std::endl;
+    }
+}
+
 } // unnamed namespace
 
 /// Broker entry point
@@ -120,9 +167,11 @@ int main(int argc, char* argv[])
     std::ifstream ifs;
     std::string cfgFile, loggerCfgFile, timingsFile, adapterCfgFile, topologyCfgFile;
     std::string deviceCfgFile, listenIP, port, hostname, fport, id, mqttID, mqttAddress;
-    unsigned int globalVerbosity;
+    std::string multicastGroup, multicastPort, queuePolicy, logOverflow, eventLog;
+    unsigned int globalVerbosity, brokerThreads, queueLimit, logBuffer;
+    unsigned int eventLogSize, eventLogFiles;
     float migrationStep;
-    bool malicious, invariant;
+    bool malicious, invariant, resendHeadOnly, asyncLogging;
 
     try
     {
@@ -184,6 +233,48 @@ int main(int argc, char* argv[])
                 ( "check-invariant",
                 po::value<bool> ( &invariant )->default_value(false),
                 "Check the invariant prior to power migrations" )
+                ( "broker-threads",
+                po::value<unsigned int>( &brokerThreads )->default_value(1),
+                "number of threads that run network I/O and module tasks" )
+                ( "resend-head-only",
+                po::value<bool>( &resendHeadOnly )->default_value(false),
+                "retransmit only the oldest unacknowledged message of a window" )
+                ( "multicast-group",
+                po::value<std::string>( &multicastGroup )->default_value(""),
+                "multicast (or broadcast) address for group-wide messages, "
+                "empty to send them to each peer" )
+                ( "multicast-port",
+                po::value<std::string>( &multicastPort )->default_value("1871"),
+                "UDP port of the multicast group" )
+                ( "inbound-queue-limit",
+                po::value<unsigned int>( &queueLimit )->default_value(0),
+                "most messages queued for a module between its phases, "
+                "0 for no limit" )
+                ( "inbound-queue-policy",
+                po::value<std::string>( &queuePolicy )->default_value("drop-oldest"),
+                "what to do with a message for a full queue: drop-oldest, "
+                "coalesce or reject" )
+                ( "inbound-queue",
+                po::value<std::vector<std::string> >( )->composing(),
+                "module:limit[:policy] queue bound for one module" )
+                ( "async-logging",
+                po::value<bool>( &asyncLogging )->default_value(false),
+                "write the log from a background thread" )
+                ( "log-buffer",
+                po::value<unsigned int>( &logBuffer )->default_value(8192),
+                "log records each thread can buffer with async-logging" )
+                ( "log-overflow",
+                po::value<std::string>( &logOverflow )->default_value("drop"),
+                "what a thread does when its log buffer is full: drop or block" )
+                ( "event-log",
+                po::value<std::string>( &eventLog )->default_value(""),
+                "filename of the binary event log, empty to disable it" )
+                ( "event-log-size",
+                po::value<unsigned int>( &eventLogSize )->default_value(16),
+                "size in MB at which the event log is rotated" )
+                ( "event-log-files",
+                po::value<unsigned int>( &eventLogFiles )->default_value(2),
+                "rotated event log files kept besides the current one" )
                 ( "verbose,v",
                 po::value<unsigned int>( &globalVerbosity )->
                 implicit_value(5)->default_value(5),
@@ -220,7 +311,7 @@ int main(int argc, char* argv[])
             if (!vm.count("help") && !vm.count("version") &&
                 !vm.count("uuid") && !vm.count("list-loggers"))
             {
-                Logger.Status << "Config file " << cfgFile
+                FREEDM_LOG_STATUS(Logger) << "Config file " << cfgFile
                             << " successfully loaded." << std::endl;
             }
         }
@@ -252,6 +343,20 @@ int main(int argc, char* argv[])
             return 0;
         }
 
+        if (asyncLogging)
+        {
+            if (logBuffer == 0)
+            {
+                throw EDgiConfigError("log-buffer must be greater than 0");
+            }
+            if (logOverflow != "drop" && logOverflow != "block")
+            {
+                throw EDgiConfigError("invalid log overflow policy: " + logOverflow);
+            }
+            CLogWriter::instance().Start(logBuffer, logOverflow == "drop" ?
+                CLogWriter::DROP : CLogWriter::BLOCK);
+        }
+
         hostname = boost::asio::ip::host_name();
         id = GenerateUuid(hostname, port);
         if (vm.count("uuid"))
@@ -261,7 +366,7 @@ int main(int argc, char* argv[])
         }
         else
         {
-            Logger.Info << "Generated UUID: " << id << std::endl;
+            FREEDM_LOG_INFO(Logger) << "Generated UUID: " << id << std::endl;
         }
 
         // Load timings from files
@@ -290,6 +395,39 @@ int main(int argc, char* argv[])
             CGlobalConfiguration::Instance().SetMQTTSubscriptions(subscriptions);
         }
         CGlobalConfiguration::Instance().SetInvariantCheck(invariant);
+        CGlobalConfiguration::Instance().SetBrokerThreads(brokerThreads);
+        CGlobalConfiguration::Instance().SetResendHeadOnly(resendHeadOnly);
+        CGlobalConfiguration::Instance().SetMulticastGroup(multicastGroup);
+        CGlobalConfiguration::Instance().SetMulticastPort(multicastPort);
+
+        CDispatcher::Instance().SetDefaultQueueLimit(queueLimit,
+            GetQueuePolicy(queuePolicy));
+        if (vm.count("inbound-queue"))
+        {
+            std::vector<std::string> queues =
+                    vm["inbound-queue"].as< std::vector<std::string> >( );
+            BOOST_FOREACH(std::string s, queues)
+            {
+                std::vector<std::string> parts;
+                boost::algorithm::split(parts, s, boost::algorithm::is_any_of(":"));
+                if (parts.size() < 2 || parts.size() > 3)
+                {
+                    throw EDgiConfigError("invalid inbound queue: " + s);
+                }
+
+                unsigned int limit;
+                try
+                {
+                    limit = boost::lexical_cast<unsigned int>(parts[1]);
+                }
+                catch (boost::bad_lexical_cast &)
+                {
+                    throw EDgiConfigError("invalid inbound queue limit: " + s);
+                }
+                CDispatcher::Instance().SetQueueLimit(parts[0], limit,
+                    GetQueuePolicy(parts.size() == 3 ? parts[2] : queuePolicy));
+            }
+        }
 
         // Specify socket endpoint address, if provided
         if( vm.count("devices-endpoint") )
@@ -315,12 +453,12 @@ int main(int argc, char* argv[])
         {
             CGlobalConfiguration::Instance().SetAdapterConfigPath(
                 adapterCfgFile);
-            Logger.Status << "set adapter config" << std::endl;
+            FREEDM_LOG_STATUS(Logger) << "set adapter config" << std::endl;
         }
         else
         {
             CGlobalConfiguration::Instance().SetAdapterConfigPath("");
-            Logger.Status << "adatper config not set" << std::endl;
+            FREEDM_LOG_STATUS(Logger) << "adatper config not set" << std::endl;
         }
 
 
@@ -335,10 +473,21 @@ int main(int argc, char* argv[])
         }
 
         CGlobalConfiguration::Instance().SetDeviceConfigPath(deviceCfgFile);
+
+        if (!eventLog.empty())
+        {
+            if (eventLogSize == 0)
+            {
+                throw EDgiConfigError("event-log-size must be greater than 0");
+            }
+            CEventLog::Instance().Open(eventLog,
+                static_cast<std::size_t>(eventLogSize) * 1024 * 1024,
+                eventLogFiles, id);
+        }
     }
     catch (std::exception & e)
     {
-        Logger.Status << "Exception caught in main during start up: " << e.what() << std::endl;
+        FREEDM_LOG_STATUS(Logger) << "Exception caught in main during start up: " << e.what() << std::endl;
         return 1;
     }
 
@@ -350,23 +499,27 @@ int main(int argc, char* argv[])
 
     try
     {
+        // Reload the timings and logger levels on SIGHUP
+        CBroker::Instance().SetReloadHandler(
+            boost::bind(&ReloadConfig, timingsFile, loggerCfgFile));
+
         // Instantiate and register the group management module
-        CBroker::Instance().RegisterModule("gm",boost::posix_time::milliseconds(CTimings::Get("GM_PHASE_TIME")));
+        CBroker::Instance().RegisterModule("gm",CTimings::GM_PHASE_TIME);
         CDispatcher::Instance().RegisterReadHandler(GM, "gm");
         // Instantiate and register the state collection module
-        CBroker::Instance().RegisterModule("sc",boost::posix_time::milliseconds(CTimings::Get("SC_PHASE_TIME")));
+        CBroker::Instance().RegisterModule("sc",CTimings::SC_PHASE_TIME);
         CDispatcher::Instance().RegisterReadHandler(SC, "sc");
 
         // StateCollection wants to receive Accept messages addressed to lb.
         CDispatcher::Instance().RegisterReadHandler(SC, "lb");
         // Instantiate and register the power management module
-        CBroker::Instance().RegisterModule("lb",boost::posix_time::milliseconds(CTimings::Get("LB_PHASE_TIME")));
+        CBroker::Instance().RegisterModule("lb",CTimings::LB_PHASE_TIME);
         CDispatcher::Instance().RegisterReadHandler(LB, "lb");
 
         // StateCollection wants to receive Accept messages addressed to vvc.
         CDispatcher::Instance().RegisterReadHandler(SC, "vvc");
         // Instantiate and register the power management module
-        CBroker::Instance().RegisterModule("vvc",boost::posix_time::milliseconds(CTimings::Get("VVC_PHASE_TIME")));
+        CBroker::Instance().RegisterModule("vvc",CTimings::VVC_PHASE_TIME);
         CDispatcher::Instance().RegisterReadHandler(VVC, "vvc");
 
         // The peerlist should be passed into constructors as references or
@@ -397,13 +550,13 @@ int main(int argc, char* argv[])
         }
         else
         {
-            Logger.Info << "Not adding any hosts on startup." << std::endl;
+            FREEDM_LOG_INFO(Logger) << "Not adding any hosts on startup." << std::endl;
         }
 
         // Add the local connection to the hostname list
         CConnectionManager::Instance().PutHost(id, "localhost", port);
 
-        Logger.Debug << "Starting thread of Modules" << std::endl;
+        FREEDM_LOG_DEBUG(Logger) << "Starting thread of Modules" << std::endl;
         CBroker::Instance().Schedule(
             "gm",
             boost::bind(&gm::GMAgent::Run, boost::dynamic_pointer_cast<gm::GMAgent>(GM)),
@@ -419,7 +572,7 @@ int main(int argc, char* argv[])
     }
     catch (std::exception & e)
     {
-        Logger.Fatal << "Exception caught in module initialization: " << e.what() << std::endl;
+        FREEDM_LOG_FATAL(Logger) << "Exception caught in module initialization: " << e.what() << std::endl;
         return 1;
     }
 
@@ -429,7 +582,7 @@ int main(int argc, char* argv[])
     }
     catch (std::exception & e)
     {
-        Logger.Fatal << "Exception caught in Broker: " << e.what() << std::endl;
+        FREEDM_LOG_FATAL(Logger) << "Exception caught in Broker: " << e.what() << std::endl;
         CBroker::Instance().Stop();
         return 1;
     }
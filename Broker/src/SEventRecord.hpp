@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         SEventRecord.hpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  The layout of the binary event log, shared by the DGI which
+///               writes it and the decoder which reads it.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SEVENTRECORD_HPP
+#define SEVENTRECORD_HPP
+
+#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+
+namespace freedm {
+namespace broker {
+
+/// Identifies an event log file
+const char EVENT_LOG_MAGIC[8] = { 'F', 'R', 'E', 'E', 'D', 'M', 'E', 'V' };
+
+/// Incremented whenever the layout of the file changes
+const boost::uint32_t EVENT_LOG_VERSION = 1;
+
+/// Written in the byte order of the DGI, so a reader can tell if it differs
+const boost::uint32_t EVENT_LOG_BYTE_ORDER = 0x01020304;
+
+/// What an event record describes
+enum EventType
+{
+    /// A module's phase started.
+    ///   subject: the module identifier
+    ///   code: the number of phases started since the broker ran
+    ///   detail: how late the phase started, in milliseconds
+    ///   value: how long the phase was scheduled for, in milliseconds
+    EVENT_PHASE_CHANGE = 1,
+    /// A module message was sent.
+    ///   subject: the UUID of the receiver
+    ///   code, detail: the field numbers returned by GetMessageType
+    EVENT_MESSAGE_SENT = 2,
+    /// A module message was handed to the dispatcher.
+    ///   subject: the UUID of the sender
+    ///   code, detail: the field numbers returned by GetMessageType
+    EVENT_MESSAGE_RECEIVED = 3,
+    /// A module changed state.
+    ///   subject: the module's view of its group, such as the coordinator
+    ///   code: the new state
+    ///   detail: the previous state
+    ///   value: a measure of the state, such as the size of the group
+    EVENT_STATE_CHANGE = 4,
+    /// A device signal was read.
+    ///   subject: the device identifier
+    ///   signal: the signal name
+    ///   value: the value read
+    EVENT_DEVICE_READ = 5,
+    /// A device command was set.
+    ///   subject: the device identifier
+    ///   signal: the signal name
+    ///   value: the value of the command
+    EVENT_DEVICE_COMMAND = 6
+};
+
+/// The first record-sized block of an event log file
+struct SEventLogHeader
+{
+    /// EVENT_LOG_MAGIC
+    char magic[8];
+    /// EVENT_LOG_VERSION
+    boost::uint32_t version;
+    /// The size of the header and of each record
+    boost::uint32_t recordsize;
+    /// EVENT_LOG_BYTE_ORDER
+    boost::uint32_t byteorder;
+    /// Unused, zero
+    boost::uint32_t reserved;
+    /// The number of records the file has room for
+    boost::uint64_t capacity;
+    /// The number of records written, updated after each record
+    boost::uint64_t count;
+    /// The UUID of the DGI which wrote the file, NUL padded
+    char uuid[56];
+};
+
+/// One event, as it is laid out in the file
+struct SEventRecord
+{
+    /// When the event happened, in microseconds since the UNIX epoch, with
+    /// the DGI's clock skew applied
+    boost::uint64_t time;
+    /// Counts the events of the DGI, so gaps show where files were lost
+    boost::uint32_t sequence;
+    /// One of EventType
+    boost::uint16_t type;
+    /// The module the event concerns, one of ModuleMessage::RecipientId
+    boost::uint16_t module;
+    /// An integer argument; see EventType
+    boost::int32_t code;
+    /// A second integer argument; see EventType
+    boost::int32_t detail;
+    /// A numeric argument; see EventType
+    double value;
+    /// A UUID or identifier, NUL padded and truncated to fit
+    char subject[40];
+    /// A device signal name, NUL padded and truncated to fit
+    char signal[24];
+};
+
+// The files are read back field by field, so the layout must not change.
+BOOST_STATIC_ASSERT(sizeof(SEventRecord) == 96);
+BOOST_STATIC_ASSERT(sizeof(SEventLogHeader) == sizeof(SEventRecord));
+
+} // namespace broker
+} // namespace freedm
+
+#endif // SEVENTRECORD_HPP
@@ -55,6 +55,18 @@ struct SRemoteHost
     std::string port; /// Remote endpoint port
 };
 
+/// Compares two remote hosts by hostname, then port.
+inline bool operator<(const SRemoteHost& a, const SRemoteHost& b)
+{
+    return a.hostname < b.hostname || (a.hostname == b.hostname && a.port < b.port);
+}
+
+/// Two remote hosts are equal if their hostnames and ports are.
+inline bool operator==(const SRemoteHost& a, const SRemoteHost& b)
+{
+    return a.hostname == b.hostname && a.port == b.port;
+}
+
 }
 }
 
@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         AllocationCounter.hpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Replaces the global operator new to count heap allocations.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+///
+/// The replacement operators are defined here rather than declared, so only
+/// the source file with a benchmark's main may include this header.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ALLOCATIONCOUNTER_HPP
+#define ALLOCATIONCOUNTER_HPP
+
+#include <cstdlib>
+#include <new>
+
+#if __cplusplus >= 201103L
+#define BENCH_THROWS_BAD_ALLOC
+#else
+#define BENCH_THROWS_BAD_ALLOC throw(std::bad_alloc)
+#endif
+
+namespace freedm {
+namespace broker {
+namespace bench {
+
+/// The number of calls to operator new since the program started
+unsigned long g_allocations = 0;
+
+} // namespace bench
+} // namespace broker
+} // namespace freedm
+
+/// Counts each allocation before it is made.
+void* operator new(std::size_t size) BENCH_THROWS_BAD_ALLOC
+{
+    freedm::broker::bench::g_allocations++;
+    void* p = std::malloc(size ? size : 1);
+    if(!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) throw()
+{
+    std::free(p);
+}
+
+void* operator new[](std::size_t size) BENCH_THROWS_BAD_ALLOC
+{
+    return operator new(size);
+}
+
+void operator delete[](void* p) throw()
+{
+    operator delete(p);
+}
+
+#endif // ALLOCATIONCOUNTER_HPP
@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         Bench.hpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Timing helpers shared by the standalone benchmarks.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include "CLogger.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+namespace freedm {
+namespace broker {
+namespace bench {
+
+/// Measures the wall clock time since it was started
+class CStopwatch
+{
+    public:
+        /// Starts the stopwatch
+        CStopwatch() { Restart(); }
+        /// Starts the stopwatch again from zero
+        void Restart() { m_start = boost::posix_time::microsec_clock::universal_time(); }
+        /// The time since the stopwatch was started
+        boost::posix_time::time_duration Elapsed() const
+            { return boost::posix_time::microsec_clock::universal_time() - m_start; }
+    private:
+        /// When the stopwatch was started
+        boost::posix_time::ptime m_start;
+};
+
+/// Silences the loggers, so logging does not show up in the timings
+inline void QuietLogs()
+{
+    CGlobalLogger::instance().SetGlobalLevel(0);
+}
+
+/// Prints the time per operation and the rate of a timed loop
+inline void Report(const std::string& name, unsigned long count,
+    const boost::posix_time::time_duration& elapsed)
+{
+    double ns = elapsed.total_microseconds() * 1000.0;
+    std::cout << std::left << std::setw(40) << name << std::right
+              << std::setw(12) << count << " ops "
+              << std::setw(12) << std::fixed << std::setprecision(1)
+              << (count > 0 ? ns / count : 0) << " ns/op "
+              << std::setw(14) << std::setprecision(0)
+              << (ns > 0 ? count * 1e9 / ns : 0) << " ops/s" << std::endl;
+}
+
+} // namespace bench
+} // namespace broker
+} // namespace freedm
+
+#endif // BENCH_HPP
@@ -0,0 +1,243 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         BenchBatchedUdp.cpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Measures loopback packet rates with and without sendmmsg.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.hpp"
+#include "CDatagramBatch.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/foreach.hpp>
+#include <boost/shared_ptr.hpp>
+
+using namespace freedm::broker;
+
+namespace {
+
+typedef boost::asio::ip::udp::socket Socket;
+typedef boost::asio::ip::udp::endpoint Endpoint;
+
+/// The numbers of simulated peers measured.
+const unsigned int PEER_COUNTS[] = { 2, 8, 32 };
+
+/// The size of each datagram, about that of a window with a few messages.
+const std::size_t DATAGRAM_SIZE = 300;
+
+/// Opens a socket on an ephemeral loopback port.
+boost::shared_ptr<Socket> OpenSocket(boost::asio::io_service& ios)
+{
+    boost::shared_ptr<Socket> socket(new Socket(ios));
+    socket->open(boost::asio::ip::udp::v4());
+    socket->bind(Endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    return socket;
+}
+
+/// Writes one datagram to each peer with a send_to apiece, as IProtocol
+/// does without BATCHED_UDP.
+void SendEach(Socket& node, const std::string& data, const std::vector<Endpoint>& peers)
+{
+    BOOST_FOREACH(const Endpoint& peer, peers)
+    {
+        node.send_to(boost::asio::buffer(data), peer);
+    }
+}
+
+/// Writes one datagram to each peer with as few sendmmsg calls as possible,
+/// as CListener::FlushDatagrams does.
+bool SendBatched(Socket& node, const std::string& data, const std::vector<Endpoint>& peers)
+{
+    CDatagramBatch batch;
+    std::size_t next = 0;
+    while(next < peers.size())
+    {
+        batch.Clear();
+        for(std::size_t i = next; i < peers.size(); i++)
+        {
+            if(!batch.Add(data.data(), data.size(), peers[i]))
+            {
+                break;
+            }
+        }
+        int sent = batch.Send(node.native_handle());
+        if(sent <= 0)
+        {
+            return false;
+        }
+        next += sent;
+    }
+    return true;
+}
+
+/// Reads the datagrams waiting on the node with a receive_from apiece, as
+/// CListener::HandleRead does without BATCHED_UDP.
+unsigned int ReceiveEach(Socket& node, std::vector<char>& buffer, unsigned int count)
+{
+    Endpoint from;
+    for(unsigned int i = 0; i < count; i++)
+    {
+        node.receive_from(boost::asio::buffer(&buffer[0], DATAGRAM_SIZE), from);
+    }
+    return count;
+}
+
+/// Reads the datagrams waiting on the node with recvmmsg until it returns a
+/// partial batch, as CListener::DrainSocket does.
+unsigned int ReceiveBatched(Socket& node, std::vector<char>& buffer)
+{
+    CDatagramBatch batch;
+    unsigned int received = 0;
+    while(true)
+    {
+        int count = batch.Receive(node.native_handle(), &buffer[0], DATAGRAM_SIZE);
+        if(count > 0)
+        {
+            received += count;
+        }
+        if(count < static_cast<int>(CDatagramBatch::BATCH_SIZE))
+        {
+            return received;
+        }
+    }
+}
+
+/// Reads the one datagram waiting on each peer, outside of the timings.
+void DrainPeers(std::vector< boost::shared_ptr<Socket> >& peers, std::vector<char>& buffer)
+{
+    Endpoint from;
+    BOOST_FOREACH(boost::shared_ptr<Socket>& peer, peers)
+    {
+        peer->receive_from(boost::asio::buffer(&buffer[0], DATAGRAM_SIZE), from);
+    }
+}
+
+/// Writes one datagram from each peer to the node, outside of the timings.
+void FillNode(std::vector< boost::shared_ptr<Socket> >& peers, const std::string& data,
+    const Endpoint& node)
+{
+    BOOST_FOREACH(boost::shared_ptr<Socket>& peer, peers)
+    {
+        peer->send_to(boost::asio::buffer(data), node);
+    }
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Simulates 2, 8 and 32 peers as sockets on the loopback interface. For a
+/// number of turns the node writes one datagram to every peer, as the group
+/// management AYC broadcast does, and then reads one datagram from every
+/// peer, as it does for the responses. Each direction is measured with a
+/// system call per datagram and with the CDatagramBatch calls the listener
+/// makes under BATCHED_UDP. Only the node's calls are timed; the peers'
+/// side of each turn is not. Reports the datagrams per second of each. Exits
+/// with 1 if a batched send fails or a batched read does not find every
+/// datagram the peers wrote. Takes the number of turns, 20000 by default.
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    unsigned long turns = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 20000;
+    bool complete = true;
+    bench::QuietLogs();
+
+    boost::asio::io_service ios;
+    boost::shared_ptr<Socket> node = OpenSocket(ios);
+    std::string data(DATAGRAM_SIZE, 'x');
+    std::vector<char> buffer(CDatagramBatch::BATCH_SIZE * DATAGRAM_SIZE);
+
+    BOOST_FOREACH(unsigned int count, PEER_COUNTS)
+    {
+        std::vector< boost::shared_ptr<Socket> > peers;
+        std::vector<Endpoint> endpoints;
+        for(unsigned int i = 0; i < count; i++)
+        {
+            peers.push_back(OpenSocket(ios));
+            endpoints.push_back(peers.back()->local_endpoint());
+        }
+        unsigned long packets = turns * count;
+        std::ostringstream label;
+        label << ", " << count << " peers";
+        bench::CStopwatch watch;
+        boost::posix_time::time_duration elapsed;
+
+        elapsed = boost::posix_time::time_duration();
+        for(unsigned long i = 0; i < turns; i++)
+        {
+            watch.Restart();
+            SendEach(*node, data, endpoints);
+            elapsed += watch.Elapsed();
+            DrainPeers(peers, buffer);
+        }
+        bench::Report("send_to" + label.str(), packets, elapsed);
+
+        elapsed = boost::posix_time::time_duration();
+        for(unsigned long i = 0; i < turns; i++)
+        {
+            watch.Restart();
+            bool sent = SendBatched(*node, data, endpoints);
+            elapsed += watch.Elapsed();
+            if(!sent)
+            {
+                // The peers after the failed batch have nothing to read.
+                complete = false;
+                break;
+            }
+            DrainPeers(peers, buffer);
+        }
+        bench::Report("sendmmsg" + label.str(), packets, elapsed);
+
+        elapsed = boost::posix_time::time_duration();
+        for(unsigned long i = 0; i < turns; i++)
+        {
+            FillNode(peers, data, node->local_endpoint());
+            watch.Restart();
+            ReceiveEach(*node, buffer, count);
+            elapsed += watch.Elapsed();
+        }
+        bench::Report("receive_from" + label.str(), packets, elapsed);
+
+        elapsed = boost::posix_time::time_duration();
+        for(unsigned long i = 0; i < turns; i++)
+        {
+            FillNode(peers, data, node->local_endpoint());
+            watch.Restart();
+            unsigned int received = ReceiveBatched(*node, buffer);
+            elapsed += watch.Elapsed();
+            if(received != count)
+            {
+                complete = false;
+                // Leave nothing behind to be counted in the next turn.
+                ReceiveBatched(*node, buffer);
+            }
+        }
+        bench::Report("recvmmsg" + label.str(), packets, elapsed);
+    }
+
+    if(!complete)
+    {
+        std::cout << "a batch did not carry every datagram" << std::endl;
+        return 1;
+    }
+    return 0;
+}
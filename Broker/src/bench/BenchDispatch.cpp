@@ -0,0 +1,193 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         BenchDispatch.cpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Measures handing received messages to the modules.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.hpp"
+#include "CBroker.hpp"
+#include "CDispatcher.hpp"
+#include "CGlobalConfiguration.hpp"
+#include "CGlobalPeerList.hpp"
+#include "IDGIModule.hpp"
+#include "Messages.hpp"
+
+#include "messages/ModuleMessage.pb.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/foreach.hpp>
+#include <boost/shared_ptr.hpp>
+
+using namespace freedm::broker;
+
+namespace {
+
+/// The identifiers the broker registers its modules for.
+const char* MODULES[] = { "gm", "sc", "lb", "clk", "vvc" };
+
+/// The number of modules registered.
+const unsigned int MODULE_COUNT = sizeof(MODULES) / sizeof(MODULES[0]);
+
+/// The registrations as the dispatcher kept them before the table.
+typedef std::multimap<boost::shared_ptr<IDGIModule>, const std::string> Registrations;
+
+/// A module which counts the messages it receives.
+class CCounter
+    : public IDGIModule
+{
+public:
+    CCounter() : m_received(0) { }
+    /// Counts the message.
+    void HandleIncomingMessage(boost::shared_ptr<const ModuleMessage>, CPeerNode)
+    {
+        m_received++;
+    }
+    /// The messages received.
+    unsigned long GetReceived() const { return m_received; }
+private:
+    unsigned long m_received;
+};
+
+/// Calls a module's handler the way CDispatcher::ReadHandlerCallback did
+/// before the table, with its arguments by value.
+void CallHandler(boost::shared_ptr<IDGIModule> h, boost::shared_ptr<const ModuleMessage> msg,
+    std::string uuid)
+{
+    CPeerNode peer = CGlobalPeerList::instance().GetPeer(uuid);
+    h->HandleIncomingMessage(msg, peer);
+}
+
+/// Delivers a message the way CDispatcher::HandleRequest did before the
+/// table: every registration is scanned and its identifier compared with
+/// the recipient's name, and the broker is asked by name whether the module
+/// is scheduled. The modules are not, so each gets the message at once.
+void ScanRegistrations(const Registrations& registrations,
+    boost::shared_ptr<const ModuleMessage> msg, std::string uuid)
+{
+    for(Registrations::const_iterator it = registrations.begin();
+        it != registrations.end(); ++it)
+    {
+        if(it->second == msg->recipient_module() || msg->recipient_module() == "all")
+        {
+            if(!CBroker::Instance().IsModuleRegistered(it->second))
+            {
+                CallHandler(it->first, msg, uuid);
+            }
+        }
+    }
+}
+
+/// Builds one small message for each module, with or without the
+/// recipient id peers that predate it do not send.
+std::vector< boost::shared_ptr<const ModuleMessage> > BuildMessages(bool ids)
+{
+    std::vector< boost::shared_ptr<const ModuleMessage> > messages;
+    BOOST_FOREACH(const char* module, MODULES)
+    {
+        boost::shared_ptr<ModuleMessage> msg(new ModuleMessage);
+        SetRecipient(*msg, module);
+        if(!ids)
+        {
+            msg->clear_recipient_id();
+        }
+        msg->mutable_group_management_message()
+            ->mutable_are_you_coordinator_message()->set_sequence_no(1);
+        messages.push_back(msg);
+    }
+    return messages;
+}
+
+/// The messages received by all the modules.
+unsigned long CountReceived(const std::vector< boost::shared_ptr<CCounter> >& modules)
+{
+    unsigned long received = 0;
+    BOOST_FOREACH(const boost::shared_ptr<CCounter>& module, modules)
+    {
+        received += module->GetReceived();
+    }
+    return received;
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Registers a counting module for each of gm, sc, lb, clk and vvc, as the
+/// broker does, and hands them a number of messages from a known peer,
+/// addressed to each module in turn. The messages are delivered first by
+/// scanning the registrations as the dispatcher did before its table, then
+/// by CDispatcher::HandleRequest with the recipient id set, and then with
+/// only the recipient's name, as peers that predate the id send them. The
+/// broker is not running, so no module is scheduled and each message is
+/// handled as it is delivered. Reports the time per message of each. Takes
+/// the number of messages, 200000 by default. Exits with 1 if the modules
+/// did not receive as many messages as were delivered.
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    unsigned long count = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 200000;
+    bench::QuietLogs();
+
+    CGlobalConfiguration::Instance().SetUUID("localhost:51871");
+    std::string uuid = "peer.dgi.example.org:51870";
+    CGlobalPeerList::instance().Create(uuid);
+
+    std::vector< boost::shared_ptr<CCounter> > modules;
+    Registrations registrations;
+    BOOST_FOREACH(const char* module, MODULES)
+    {
+        modules.push_back(boost::shared_ptr<CCounter>(new CCounter));
+        registrations.insert(std::make_pair(modules.back(), std::string(module)));
+        CDispatcher::Instance().RegisterReadHandler(modules.back(), module);
+    }
+
+    std::vector< boost::shared_ptr<const ModuleMessage> > named = BuildMessages(false);
+    std::vector< boost::shared_ptr<const ModuleMessage> > numbered = BuildMessages(true);
+
+    bench::CStopwatch watch;
+    for(unsigned long i = 0; i < count; i++)
+    {
+        ScanRegistrations(registrations, named[i % MODULE_COUNT], uuid);
+    }
+    bench::Report("multimap scan", count, watch.Elapsed());
+
+    watch.Restart();
+    for(unsigned long i = 0; i < count; i++)
+    {
+        CDispatcher::Instance().HandleRequest(numbered[i % MODULE_COUNT], uuid);
+    }
+    bench::Report("table, recipient id", count, watch.Elapsed());
+
+    watch.Restart();
+    for(unsigned long i = 0; i < count; i++)
+    {
+        CDispatcher::Instance().HandleRequest(named[i % MODULE_COUNT], uuid);
+    }
+    bench::Report("table, recipient name", count, watch.Elapsed());
+
+    if(CountReceived(modules) != 3 * count)
+    {
+        std::cout << "the modules received " << CountReceived(modules)
+                  << " messages, not " << 3 * count << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         BenchHash.cpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Measures the cost per kilobyte of hashing module messages.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.hpp"
+#include "Messages.hpp"
+
+#include "messages/ModuleMessage.pb.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <boost/foreach.hpp>
+#include <boost/functional/hash.hpp>
+
+using namespace freedm::broker;
+
+namespace {
+
+/// The peers listed in the messages measured, from about 100 bytes to
+/// about 8 kilobytes encoded.
+const unsigned int PEER_COUNTS[] = { 1, 16, 128 };
+
+/// Builds a group management peer list of the given length.
+ModuleMessage BuildPeerList(unsigned int peers)
+{
+    ModuleMessage msg;
+    SetRecipient(msg, "gm");
+    gm::PeerListMessage* list =
+        msg.mutable_group_management_message()->mutable_peer_list_message();
+    for(unsigned int i = 0; i < peers; i++)
+    {
+        std::ostringstream uuid;
+        uuid << "peer-" << i << ".dgi.example.org:51870";
+        gm::ConnectedPeerMessage* peer = list->add_connected_peer_message();
+        peer->set_uuid(uuid.str());
+        peer->set_host("peer.dgi.example.org");
+        peer->set_port("51870");
+    }
+    return msg;
+}
+
+/// Hashes a message the way ComputeMessageHash did before ComputeHash was
+/// added: the text format of the whole message, through boost::hash.
+google::protobuf::uint64 TextHash(const ModuleMessage& msg)
+{
+    static boost::hash<std::string> string_hash;
+    return static_cast<google::protobuf::uint64>(string_hash(msg.ShortDebugString()));
+}
+
+/// The kilobytes hashed by a number of passes over an encoding.
+unsigned long Kilobytes(unsigned long passes, std::size_t length)
+{
+    return static_cast<unsigned long>(passes * static_cast<double>(length) / 1024 + 0.5);
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Hashes group management peer lists of 1, 16 and 128 peers a number of
+/// times each: with the text hash ComputeMessageHash used to compute, with
+/// ComputeMessageHash, which encodes the message and hashes the encoding,
+/// and with ComputeHash on an encoding made once, as CProtocolSR::Send does
+/// with the encoding it sends. Reports the time per kilobyte of the encoded
+/// message for each, so each op is a kilobyte. Takes the number of passes,
+/// 20000 by default. Exits with 1 if a hash of a message changes between
+/// passes, or ComputeMessageHash and ComputeHash disagree on it.
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    unsigned long passes = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 20000;
+    bool consistent = true;
+    bench::QuietLogs();
+
+    BOOST_FOREACH(unsigned int peers, PEER_COUNTS)
+    {
+        ModuleMessage msg = BuildPeerList(peers);
+        std::string encoded;
+        msg.SerializeToString(&encoded);
+        unsigned long kilobytes = Kilobytes(passes, encoded.size());
+        std::ostringstream label;
+        label << ", " << encoded.size() << " bytes";
+        google::protobuf::uint64 text = TextHash(msg);
+        google::protobuf::uint64 encoding = ComputeHash(encoded.data(), encoded.size());
+        // Checking every hash keeps the loops from being optimised away.
+        bool stable = ComputeMessageHash(msg) == encoding;
+        bench::CStopwatch watch;
+
+        for(unsigned long i = 0; i < passes; i++)
+        {
+            stable = TextHash(msg) == text && stable;
+        }
+        bench::Report("text hash" + label.str(), kilobytes, watch.Elapsed());
+
+        watch.Restart();
+        for(unsigned long i = 0; i < passes; i++)
+        {
+            stable = ComputeMessageHash(msg) == encoding && stable;
+        }
+        bench::Report("ComputeMessageHash" + label.str(), kilobytes, watch.Elapsed());
+
+        watch.Restart();
+        for(unsigned long i = 0; i < passes; i++)
+        {
+            stable = ComputeHash(encoded.data(), encoded.size()) == encoding && stable;
+        }
+        bench::Report("ComputeHash" + label.str(), kilobytes, watch.Elapsed());
+
+        consistent = consistent && stable;
+    }
+
+    if(!consistent)
+    {
+        std::cout << "a hash changed between passes, or ComputeMessageHash does not"
+                  << " hash the encoding" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         BenchLogWriter.cpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Times logging from two threads, synchronously and through
+///               the background log writer.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.hpp"
+#include "CLogWriter.hpp"
+#include "CLogger.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <streambuf>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+using namespace freedm::broker;
+
+namespace {
+
+/// The logger both threads write to.
+CLocalLogger Logger(__FILE__);
+
+/// Discards what is written to it, counting the records by the tab that
+/// follows each header. Records are written under the log's output lock.
+class CRecordCounter : public std::streambuf
+{
+public:
+    CRecordCounter() : m_records(0) { }
+    /// The number of records written since the last reset
+    unsigned long m_records;
+protected:
+    int overflow(int c)
+    {
+        if(c == '\t')
+            m_records++;
+        return c;
+    }
+    std::streamsize xsputn(const char* s, std::streamsize n)
+    {
+        m_records += std::count(s, s + n, '\t');
+        return n;
+    }
+};
+
+/// Writes status records, as the broker and the adapter factory do.
+void LogRecords(unsigned long count)
+{
+    for(unsigned long i = 0; i < count; i++)
+    {
+        FREEDM_LOG_STATUS(Logger) << "Status record " << i << " of " << count << std::endl;
+    }
+}
+
+/// Logs from a broker thread and an adapter factory thread at once, then
+/// reports the rate seen by the threads, the rate once every record is
+/// written, and how many records reached the stream.
+void RunPass(const std::string& name, unsigned long count, CRecordCounter& counter,
+    bool async)
+{
+    counter.m_records = 0;
+    bench::CStopwatch watch;
+    boost::thread broker(boost::bind(&LogRecords, count));
+    boost::thread adapters(boost::bind(&LogRecords, count));
+    broker.join();
+    adapters.join();
+    boost::posix_time::time_duration logged = watch.Elapsed();
+    if(async)
+    {
+        CLogWriter::instance().Stop();
+    }
+    boost::posix_time::time_duration written = watch.Elapsed();
+
+    bench::Report(name + " (logged)", 2 * count, logged);
+    bench::Report(name + " (written)", 2 * count, written);
+    std::cout << name << ": " << counter.m_records << " of " << 2 * count
+              << " records written" << std::endl;
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Writes Status records from two threads at once, standing in for the
+/// broker thread and the adapter factory thread, to a stream that discards
+/// them. Runs once with synchronous writes, then with the background writer
+/// under the BLOCK and DROP overflow policies. Every record must be written
+/// in the first two passes; the program exits with 1 if any is lost. Takes
+/// the records per thread, 200000 by default, and the records each thread
+/// can buffer, 8192 by default.
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    unsigned long count = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 200000;
+    std::size_t capacity = argc > 2 ? std::strtoul(argv[2], NULL, 10) : 8192;
+
+    // Only the status records are counted, not the writer's drop warnings.
+    bench::QuietLogs();
+    CGlobalLogger::instance().SetOutputLevel(Logger.GetName(), 4);
+    CRecordCounter counter;
+    std::streambuf* clog = std::clog.rdbuf(&counter);
+
+    RunPass("synchronous", count, counter, false);
+    unsigned long synchronous = counter.m_records;
+
+    CLogWriter::instance().Start(capacity, CLogWriter::BLOCK);
+    RunPass("background, block", count, counter, true);
+    unsigned long blocking = counter.m_records;
+
+    CLogWriter::instance().Start(capacity, CLogWriter::DROP);
+    RunPass("background, drop", count, counter, true);
+
+    std::clog.rdbuf(clog);
+    return synchronous == 2 * count && blocking == 2 * count ? 0 : 1;
+}
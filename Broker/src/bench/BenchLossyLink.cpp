@@ -0,0 +1,318 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         BenchLossyLink.cpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Measures throughput over a lossy loopback link, with and
+///               without selective acknowledgements.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.hpp"
+#include "CBroker.hpp"
+#include "CGlobalConfiguration.hpp"
+#include "CListener.hpp"
+#include "CProtocolSR.hpp"
+#include "CTimings.hpp"
+#include "Messages.hpp"
+
+#include "messages/ModuleMessage.pb.h"
+#include "messages/ProtocolMessage.pb.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/foreach.hpp>
+#include <boost/shared_ptr.hpp>
+
+using namespace freedm::broker;
+
+namespace {
+
+typedef boost::asio::ip::udp::socket Socket;
+typedef boost::asio::ip::udp::endpoint Endpoint;
+
+/// The percentages of datagrams let through, as in network.xml.
+const int RELIABILITIES[] = { 100, 95, 90, 80 };
+
+/// The most messages the sender has waiting for an ACK.
+const unsigned int IN_FLIGHT = 64;
+
+/// The size of the buffer each end reads a datagram into.
+const std::size_t BUFFER_SIZE = 65536;
+
+/// The longest a run may take before it is given up. Without selective
+/// ACKs a lost ACK is only recovered once its message expires, so lossy runs
+/// of the legacy protocol usually end here.
+const boost::posix_time::seconds RUN_LIMIT(10);
+
+/// Builds the message the sender streams: a small group management
+/// message, as most of the traffic is.
+ModuleMessage BuildMessage()
+{
+    ModuleMessage msg;
+    SetRecipient(msg, "gm");
+    gm::AreYouCoordinatorMessage* ayc =
+        msg.mutable_group_management_message()->mutable_are_you_coordinator_message();
+    ayc->set_sequence_no(1);
+    return msg;
+}
+
+/// One direction of the link: the socket a protocol's peer writes to, and
+/// the protocol that reads what arrives on it.
+struct SEnd
+{
+    SEnd(boost::asio::io_service& ios)
+        : socket(ios)
+        , buffer(BUFFER_SIZE)
+    {
+        socket.open(boost::asio::ip::udp::v4());
+        socket.bind(Endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    }
+    /// The socket datagrams for this end arrive on
+    Socket socket;
+    /// The sender of the datagram being read
+    Endpoint from;
+    /// The datagram being read
+    std::vector<char> buffer;
+    /// The protocol at this end of the link
+    boost::shared_ptr<CProtocolSR> protocol;
+};
+
+/// A sender and a receiver connected over loopback, each reading its
+/// datagrams the way CListener::ProcessDatagram does.
+class CLossyLink : public boost::enable_shared_from_this<CLossyLink>
+{
+public:
+    CLossyLink(boost::asio::io_service& ios, bool selective, int reliability,
+        unsigned long count)
+        : m_ios(ios)
+        , m_sender(ios)
+        , m_receiver(ios)
+        , m_deadline(ios)
+        , m_message(BuildMessage())
+        , m_selective(selective)
+        , m_count(count)
+        , m_sent(0)
+        , m_delivered(0)
+    {
+        m_sender.protocol.reset(
+            new CProtocolSR("receiver:51870", m_receiver.socket.local_endpoint()));
+        m_receiver.protocol.reset(
+            new CProtocolSR("sender:51870", m_sender.socket.local_endpoint()));
+        m_sender.protocol->SetReliability(reliability);
+        m_receiver.protocol->SetReliability(reliability);
+    }
+    /// Streams the messages until they are all delivered or time runs out.
+    void Start()
+    {
+        Listen(m_sender);
+        Listen(m_receiver);
+        m_deadline.expires_from_now(RUN_LIMIT);
+        m_deadline.async_wait(boost::bind(&CLossyLink::HandleDeadline,
+            shared_from_this(), boost::asio::placeholders::error));
+        TopUp();
+    }
+    /// Stops both protocols and the reads, once the io_service has returned.
+    void Close()
+    {
+        m_deadline.cancel();
+        m_sender.protocol->Stop();
+        m_receiver.protocol->Stop();
+        m_sender.socket.close();
+        m_receiver.socket.close();
+    }
+    /// The messages the receiver accepted in order.
+    unsigned long GetDelivered() const { return m_delivered; }
+    /// The sender's link statistics.
+    SLinkStats GetStats() const { return m_sender.protocol->GetStats(); }
+private:
+    void Listen(SEnd& end)
+    {
+        end.socket.async_receive_from(boost::asio::buffer(end.buffer), end.from,
+            boost::bind(&CLossyLink::HandleRead, shared_from_this(), boost::ref(end),
+                boost::asio::placeholders::error,
+                boost::asio::placeholders::bytes_transferred));
+    }
+    void HandleRead(SEnd& end, const boost::system::error_code& e, std::size_t bytes)
+    {
+        if(e)
+        {
+            return;
+        }
+        Process(end, &end.buffer[0], bytes);
+        if(&end == &m_sender)
+        {
+            TopUp();
+        }
+        if(m_delivered == m_count)
+        {
+            m_ios.stop();
+            return;
+        }
+        Listen(end);
+    }
+    /// Passes a window to the protocol at one end, as ProcessDatagram does
+    /// for a connection. Only the receiver's module messages are counted;
+    /// there is no dispatcher.
+    void Process(SEnd& end, const char* data, std::size_t length)
+    {
+        IProtocol& protocol = *end.protocol;
+        ProtocolMessageWindow pmw;
+        if(!pmw.ParseFromArray(data, length))
+        {
+            return;
+        }
+        // The listener's half of the network.xml loss; the sender's half is
+        // in IProtocol::WriteDatagram.
+        if((rand()%100) >= protocol.GetReliability())
+        {
+            return;
+        }
+        protocol.SetBinaryTimestamps(pmw.binary_timestamps());
+        // A link to a legacy peer is measured by not taking up the flag.
+        protocol.SetSelectiveAck(m_selective && pmw.selective_ack());
+        BOOST_FOREACH(const ProtocolMessage& pm, pmw.messages())
+        {
+            if(pm.status() == ProtocolMessage::ACCEPTED
+                || pm.status() == ProtocolMessage::REFUSED)
+            {
+                protocol.ReceiveACK(pm);
+            }
+            else if(protocol.Receive(pm))
+            {
+                protocol.SendACK(pm);
+                if(pm.status() == ProtocolMessage::MESSAGE)
+                {
+                    m_delivered++;
+                }
+                while(protocol.NextInOrder())
+                {
+                    m_delivered++;
+                }
+            }
+        }
+        protocol.OnReceive();
+    }
+    /// Sends new messages until IN_FLIGHT are waiting for an ACK. The ACK
+    /// of the SYN is counted too, so one more may be sent after it.
+    void TopUp()
+    {
+        while(m_sent < m_count && m_sent < GetStats().acked + IN_FLIGHT)
+        {
+            m_sender.protocol->Send(m_message);
+            m_sent++;
+        }
+    }
+    void HandleDeadline(const boost::system::error_code& e)
+    {
+        if(!e)
+        {
+            m_ios.stop();
+        }
+    }
+
+    boost::asio::io_service& m_ios;
+    SEnd m_sender;
+    SEnd m_receiver;
+    boost::asio::deadline_timer m_deadline;
+    ModuleMessage m_message;
+    bool m_selective;
+    unsigned long m_count;
+    unsigned long m_sent;
+    unsigned long m_delivered;
+};
+
+/// Streams the messages over a new link and reports the messages delivered
+/// per second. Returns false if they were not all delivered in time.
+bool Measure(bool selective, int reliability, unsigned long count)
+{
+    boost::asio::io_service& ios = CBroker::Instance().GetIOService();
+    boost::shared_ptr<CLossyLink> link(new CLossyLink(ios, selective, reliability, count));
+    bench::CStopwatch watch;
+    ios.reset();
+    link->Start();
+    ios.run();
+    boost::posix_time::time_duration elapsed = watch.Elapsed();
+    link->Close();
+    // Runs the cancelled handlers, so nothing is left for the next link.
+    ios.reset();
+    ios.poll();
+
+    std::ostringstream label;
+    label << (selective ? "selective acks" : "per-message acks") << ", "
+          << reliability << "% delivered";
+    bench::Report(label.str(), link->GetDelivered(), elapsed);
+    SLinkStats stats = link->GetStats();
+    std::cout << "    retransmitted " << stats.retransmitted << " of " << stats.sent
+              << " messages written" << std::endl;
+    return link->GetDelivered() == count;
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Streams small group management messages from one CProtocolSR to another
+/// over loopback, keeping at most 64 waiting for an ACK, and measures how
+/// many the receiver accepts in order per second. Each datagram may be
+/// dropped twice, as with network.xml under CUSTOMNETWORK: once as it is
+/// written, by IProtocol::WriteDatagram, and once as it is read, by the same
+/// check CListener::ProcessDatagram makes. Each end reads its windows as
+/// ProcessDatagram does. The link is measured at 100, 95, 90 and 80 percent
+/// reliability, first with selective ACKs and then as between two peers
+/// which do not advertise them, which ACK each message and drop those that
+/// arrive out of order. Those peers do not ACK a duplicate, so once an ACK
+/// is lost the window waits for its message to expire; their runs are
+/// reported with the messages delivered in the time allowed. Takes the
+/// number of messages, 2000 by default, and the timings file, the broker's
+/// ./config/timings.cfg by default, so it is run from the Broker directory.
+/// Exits with 1 if a run with selective ACKs did not deliver every message
+/// within 10 seconds.
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    unsigned long count = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 2000;
+    std::string timings = argc > 2 ? argv[2] : "./config/timings.cfg";
+    bool complete = true;
+    bench::QuietLogs();
+
+    CTimings::SetTimings(timings);
+    CGlobalConfiguration::Instance().SetUUID("localhost:51871");
+
+    // Both protocols write through the listener's socket, as in the broker.
+    boost::asio::ip::udp::socket& socket = CListener::Instance().GetSocket();
+    socket.open(boost::asio::ip::udp::v4());
+    socket.bind(Endpoint(boost::asio::ip::address_v4::loopback(), 0));
+
+    BOOST_FOREACH(int reliability, RELIABILITIES)
+    {
+        complete = Measure(true, reliability, count) && complete;
+        Measure(false, reliability, count);
+    }
+
+    if(!complete)
+    {
+        std::cout << "a run with selective acks did not deliver every message in time"
+                  << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         BenchMessagePool.cpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Counts the heap allocations of building module messages.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "AllocationCounter.hpp"
+#include "Bench.hpp"
+#include "CMessagePool.hpp"
+
+#include "messages/ModuleMessage.pb.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+using namespace freedm::broker;
+
+namespace {
+
+/// The number of peers in each peer list.
+const unsigned int PEERS = 8;
+
+/// The messages a module builds per phase.
+const unsigned int MESSAGES_PER_PHASE = 16;
+
+/// The peer names, made once so only the message allocates.
+std::string g_peers[PEERS];
+
+/// The host every peer is listed on.
+const std::string HOST = "peer.dgi.example.org";
+
+/// The port every peer is listed on.
+const std::string PORT = "51870";
+
+/// Builds the peer list a group leader sends its group, and encodes it the
+/// way CPeerNode::Send does.
+void BuildPeerList(ModuleMessage& msg, std::string& encoded)
+{
+    msg.set_recipient_module("gm");
+    msg.set_recipient_id(ModuleMessage::GM_MODULE);
+    gm::PeerListMessage* list =
+        msg.mutable_group_management_message()->mutable_peer_list_message();
+    for(unsigned int i = 0; i < PEERS; i++)
+    {
+        gm::ConnectedPeerMessage* peer = list->add_connected_peer_message();
+        peer->set_uuid(g_peers[i]);
+        peer->set_host(HOST);
+        peer->set_port(PORT);
+    }
+    msg.SerializeToString(&encoded);
+}
+
+/// Prints the allocations made per message by a loop.
+void ReportAllocations(const std::string& name, unsigned long messages,
+    unsigned long allocations)
+{
+    std::cout << name << ": " << allocations << " allocations, "
+              << (messages > 0 ? double(allocations) / messages : 0)
+              << " per message" << std::endl;
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Builds group management peer lists for a number of phases, first with a
+/// fresh message per send and then from a CMessagePool, and reports the heap
+/// allocations and time per message of each. Every other pooled message is
+/// also shared and released, as a self-send would. The first two phases only
+/// fill the pool and are not counted. Exits with 1 if the pool allocates as
+/// much as fresh messages do, which means it is not reusing anything. Takes
+/// the number of phases, 1000 by default.
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    unsigned long phases = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 1000;
+    unsigned long messages = phases * MESSAGES_PER_PHASE;
+    std::string encoded;
+    bench::QuietLogs();
+
+    for(unsigned int i = 0; i < PEERS; i++)
+    {
+        std::ostringstream uuid;
+        uuid << "peer-" << i << ".dgi.example.org:51870";
+        g_peers[i] = uuid.str();
+    }
+
+    bench::CStopwatch watch;
+    unsigned long start = bench::g_allocations;
+    for(unsigned long i = 0; i < messages; i++)
+    {
+        ModuleMessage* msg = new ModuleMessage;
+        BuildPeerList(*msg, encoded);
+        delete msg;
+    }
+    unsigned long fresh = bench::g_allocations - start;
+    bench::Report("new ModuleMessage", messages, watch.Elapsed());
+
+    CMessagePool pool;
+    for(unsigned long phase = 1; phase <= 2; phase++)
+    {
+        for(unsigned int i = 0; i < MESSAGES_PER_PHASE; i++)
+        {
+            BuildPeerList(pool.NewMessage(phase), encoded);
+        }
+    }
+
+    watch.Restart();
+    start = bench::g_allocations;
+    for(unsigned long phase = 3; phase < phases + 3; phase++)
+    {
+        for(unsigned int i = 0; i < MESSAGES_PER_PHASE; i++)
+        {
+            ModuleMessage& msg = pool.NewMessage(phase);
+            BuildPeerList(msg, encoded);
+            if(i % 2 == 0)
+            {
+                boost::shared_ptr<const ModuleMessage> shared = pool.ShareMessage(msg);
+            }
+        }
+    }
+    unsigned long pooled = bench::g_allocations - start;
+    bench::Report("CMessagePool::NewMessage", messages, watch.Elapsed());
+
+    ReportAllocations("new ModuleMessage", messages, fresh);
+    ReportAllocations("CMessagePool::NewMessage", messages, pooled);
+    std::cout << "free messages: " << pool.GetFreeCount() << std::endl;
+
+    if(messages > 0 && pooled >= fresh)
+    {
+        std::cout << "the pool did not reuse any messages" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,200 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         BenchReceiveLatency.cpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Measures how late datagrams are read while vvc is running.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.hpp"
+#include "CBroker.hpp"
+#include "CGlobalConfiguration.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/thread/thread.hpp>
+
+using namespace freedm::broker;
+
+namespace {
+
+/// The port the broker listens on during the benchmark.
+const char* const LISTEN_PORT = "51871";
+
+/// How long one vvc task keeps the module busy.
+const boost::posix_time::milliseconds SOLVE_TIME(200);
+
+/// How long the vvc phase lasts.
+const boost::posix_time::milliseconds VVC_PHASE(5000);
+
+/// The time between two probe datagrams.
+const boost::posix_time::milliseconds PROBE_INTERVAL(1);
+
+/// The microseconds since the epoch, which the probes carry.
+boost::int64_t Now()
+{
+    static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+    return (boost::posix_time::microsec_clock::universal_time() - epoch).total_microseconds();
+}
+
+/// A long volt/var solve, which busy waits so it holds its thread the whole
+/// time, then schedules the next one.
+void Solve()
+{
+    bench::CStopwatch watch;
+    while(watch.Elapsed() < SOLVE_TIME)
+    {
+    }
+    CBroker::Instance().Schedule("vvc", &Solve);
+}
+
+/// Reads probe datagrams on the network strand, as CListener reads messages.
+class CProbeReader
+{
+public:
+    /// Opens the probe socket on a free loopback port
+    CProbeReader()
+        : m_socket(CBroker::Instance().GetIOService(),
+            boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::loopback(), 0))
+    {
+    }
+
+    /// The endpoint the probes should be sent to
+    boost::asio::ip::udp::endpoint GetEndpoint() const
+    {
+        return m_socket.local_endpoint();
+    }
+
+    /// Starts reading probes
+    void Start()
+    {
+        m_socket.async_receive_from(boost::asio::buffer(m_buffer, sizeof(m_buffer)),
+            m_sender, CBroker::Instance().GetNetworkStrand().wrap(
+                boost::bind(&CProbeReader::HandleRead, this,
+                    boost::asio::placeholders::error,
+                    boost::asio::placeholders::bytes_transferred)));
+    }
+
+    /// The read delay of each probe in microseconds
+    std::vector<boost::int64_t>& GetLatencies()
+    {
+        return m_latencies;
+    }
+
+private:
+    /// Records how long the probe waited to be read
+    void HandleRead(const boost::system::error_code& e, std::size_t bytes)
+    {
+        if(e)
+            return;
+        boost::int64_t sent;
+        if(bytes == sizeof(sent))
+        {
+            std::memcpy(&sent, m_buffer, sizeof(sent));
+            m_latencies.push_back(Now() - sent);
+        }
+        Start();
+    }
+
+    /// The socket the probes arrive on
+    boost::asio::ip::udp::socket m_socket;
+    /// The sender of the last probe
+    boost::asio::ip::udp::endpoint m_sender;
+    /// The last probe
+    char m_buffer[64];
+    /// The read delays of the probes
+    std::vector<boost::int64_t> m_latencies;
+};
+
+/// Sends a probe holding the current time every PROBE_INTERVAL until stopped.
+void SendProbes(boost::asio::ip::udp::endpoint target, boost::atomic<bool>* stop)
+{
+    boost::asio::io_service ios;
+    boost::asio::ip::udp::socket socket(ios, boost::asio::ip::udp::v4());
+    while(!stop->load())
+    {
+        boost::int64_t now = Now();
+        socket.send_to(boost::asio::buffer(&now, sizeof(now)), target);
+        boost::this_thread::sleep(PROBE_INTERVAL);
+    }
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Runs the broker with a vvc module whose tasks each hold a thread for
+/// SOLVE_TIME, and sends it a timestamped datagram every millisecond. The
+/// datagrams are read on the network strand, the way CListener reads, and
+/// the report is how long each waited to be read. Run it once with one
+/// broker thread, where the vvc tasks block the reads, and once with more,
+/// where module tasks run on their own strands. Takes the number of broker
+/// threads, 1 by default, and the seconds to run, 5 by default.
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    unsigned int threads = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 1;
+    unsigned int seconds = argc > 2 ? std::strtoul(argv[2], NULL, 10) : 5;
+    bench::QuietLogs();
+
+    CGlobalConfiguration& config = CGlobalConfiguration::Instance();
+    config.SetHostname("localhost");
+    config.SetListenAddress("127.0.0.1");
+    config.SetListenPort(LISTEN_PORT);
+    config.SetUUID(std::string("localhost:") + LISTEN_PORT);
+    config.SetBrokerThreads(threads);
+
+    CBroker& broker = CBroker::Instance();
+    broker.RegisterModule("vvc", VVC_PHASE);
+    broker.Schedule("vvc", &Solve);
+
+    CProbeReader reader;
+    reader.Start();
+
+    boost::asio::deadline_timer stop(broker.GetIOService(), boost::posix_time::seconds(seconds));
+    stop.async_wait(boost::bind(&CBroker::Stop, &broker, 0));
+
+    boost::atomic<bool> done(false);
+    boost::thread sender(&SendProbes, reader.GetEndpoint(), &done);
+    broker.Run();
+    done.store(true);
+    sender.join();
+
+    std::vector<boost::int64_t>& latencies = reader.GetLatencies();
+    if(latencies.empty())
+    {
+        std::cout << "no probes were read" << std::endl;
+        return 1;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    boost::int64_t total = 0;
+    for(std::size_t i = 0; i < latencies.size(); i++)
+    {
+        total += latencies[i];
+    }
+    std::cout << threads << " broker thread(s), " << latencies.size() << " probes: "
+              << "mean " << total / static_cast<boost::int64_t>(latencies.size()) << " us, "
+              << "p50 " << latencies[latencies.size() / 2] << " us, "
+              << "p99 " << latencies[latencies.size() * 99 / 100] << " us, "
+              << "max " << latencies.back() << " us" << std::endl;
+    return 0;
+}
@@ -0,0 +1,189 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         BenchResend.cpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Profiles a retransmission of a 64 message window.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.hpp"
+#include "CBroker.hpp"
+#include "CGlobalConfiguration.hpp"
+#include "CListener.hpp"
+#include "CProtocolSR.hpp"
+#include "CTimings.hpp"
+#include "Messages.hpp"
+
+#include "messages/ModuleMessage.pb.h"
+#include "messages/ProtocolMessage.pb.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/foreach.hpp>
+#include <boost/shared_ptr.hpp>
+
+using namespace freedm::broker;
+
+namespace {
+
+/// The messages waiting for an ACK when the timer expires.
+const unsigned int WINDOW_SIZE = 64;
+
+/// The time of one retransmission, split into its two parts.
+struct SProfile
+{
+    /// Checking each message for expiration, as Transmit does
+    boost::posix_time::time_duration expiry;
+    /// Stamping and writing the window, as WriteWindow does
+    boost::posix_time::time_duration write;
+    /// False if the window expired or the protocol stopped during the run
+    bool valid;
+};
+
+/// Builds the module messages of the window: small group management
+/// messages, as most of the traffic is.
+ModuleMessage BuildMessage()
+{
+    ModuleMessage msg;
+    SetRecipient(msg, "gm");
+    gm::AreYouCoordinatorMessage* ayc =
+        msg.mutable_group_management_message()->mutable_are_you_coordinator_message();
+    ayc->set_sequence_no(1);
+    return msg;
+}
+
+/// Builds the expiration times of the window. Text messages carry only the
+/// text timestamp, as every message did before the binary ones were added.
+std::vector<ProtocolMessage> BuildExpirations(bool binary)
+{
+    std::vector<ProtocolMessage> window(WINDOW_SIZE);
+    BOOST_FOREACH(ProtocolMessage& pm, window)
+    {
+        SetExpirationTimeFromNow(pm, CTimings::GetDuration(CTimings::CSRC_DEFAULT_TIMEOUT),
+            !binary);
+        if(!binary)
+        {
+            pm.clear_expire_time_us();
+        }
+    }
+    return window;
+}
+
+/// Fills a window to a peer which does or does not read binary timestamps,
+/// and writes it once, as the posted flush would.
+boost::shared_ptr<CProtocolSR> OpenWindow(const boost::asio::ip::udp::endpoint& peer,
+    bool binary)
+{
+    boost::shared_ptr<CProtocolSR> protocol(new CProtocolSR("peer:51870", peer));
+    protocol->SetBinaryTimestamps(binary);
+    ModuleMessage msg = BuildMessage();
+    for(unsigned int i = 0; i < WINDOW_SIZE; i++)
+    {
+        protocol->Send(msg);
+    }
+    protocol->Flush();
+    return protocol;
+}
+
+/// Times a number of retransmissions of a full window.
+SProfile Profile(const boost::asio::ip::udp::endpoint& peer, bool binary,
+    unsigned long ticks)
+{
+    boost::shared_ptr<CProtocolSR> protocol = OpenWindow(peer, binary);
+    std::vector<ProtocolMessage> expirations = BuildExpirations(binary);
+    boost::asio::io_service& ios = CBroker::Instance().GetIOService();
+    SProfile profile;
+    bench::CStopwatch watch;
+    unsigned int expired = 0;
+    for(unsigned long i = 0; i < ticks; i++)
+    {
+        watch.Restart();
+        BOOST_FOREACH(const ProtocolMessage& pm, expirations)
+        {
+            expired += MessageIsExpired(pm);
+        }
+        profile.expiry += watch.Elapsed();
+
+        watch.Restart();
+        protocol->WriteWindow(true);
+        // Sends the batched datagrams, if the broker batches them.
+        ios.poll();
+        profile.write += watch.Elapsed();
+    }
+    profile.valid = expired == 0 && !protocol->GetStopped();
+    protocol->Stop();
+    return profile;
+}
+
+/// Prints the time per retransmission of each part of a profile.
+void ReportProfile(const std::string& name, unsigned long ticks, const SProfile& profile)
+{
+    bench::Report(name + ", expiry", ticks, profile.expiry);
+    bench::Report(name + ", write", ticks, profile.write);
+    bench::Report(name + ", total", ticks, profile.expiry + profile.write);
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Profiles the work of the retransmission timer on a window of 64 messages
+/// which have been written once and are waiting for an ACK. Each tick checks
+/// every message for expiration, as Transmit does, and then writes the whole
+/// window again with WriteWindow. The datagrams go to a loopback socket which
+/// does not read them. The window is measured for a peer which has not
+/// advertised binary timestamps, whose window header carries a text send
+/// time, with expirations that only have the text timestamp, which was the
+/// only one before binary timestamps were added; and then for a peer which
+/// reads binary timestamps. Reports the time per tick of each part. Takes the
+/// number of ticks, 2000 by default, and the timings file, the broker's
+/// ./config/timings.cfg by default, so it is run from the Broker directory.
+/// The messages expire CSRC_DEFAULT_TIMEOUT after they were sent, so a pass
+/// must finish before then. Exits with 1 if a window expired or was stopped
+/// before its last tick.
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    unsigned long ticks = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 2000;
+    std::string timings = argc > 2 ? argv[2] : "./config/timings.cfg";
+    bench::QuietLogs();
+
+    CTimings::SetTimings(timings);
+    CGlobalConfiguration::Instance().SetUUID("localhost:51871");
+
+    boost::asio::ip::udp::endpoint loopback(boost::asio::ip::address_v4::loopback(), 0);
+    boost::asio::ip::udp::socket& socket = CListener::Instance().GetSocket();
+    socket.open(boost::asio::ip::udp::v4());
+    socket.bind(loopback);
+    boost::asio::ip::udp::socket sink(CBroker::Instance().GetIOService());
+    sink.open(boost::asio::ip::udp::v4());
+    sink.bind(loopback);
+
+    SProfile text = Profile(sink.local_endpoint(), false, ticks);
+    SProfile binary = Profile(sink.local_endpoint(), true, ticks);
+    ReportProfile("text timestamps", ticks, text);
+    ReportProfile("binary timestamps", ticks, binary);
+
+    if(!text.valid || !binary.valid)
+    {
+        std::cout << "the window expired or was stopped during the benchmark" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         BenchScheduler.cpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Times enqueueing tasks into the broker's scheduler tables.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.hpp"
+#include "CBroker.hpp"
+
+#include <cstdlib>
+#include <string>
+
+using namespace freedm::broker;
+
+namespace {
+
+/// The modules a DGI schedules tasks for, in phase order.
+const char* const MODULES[] = { "gm", "sc", "lb", "vvc" };
+
+/// The number of modules.
+const unsigned int MODULE_COUNT = sizeof(MODULES) / sizeof(MODULES[0]);
+
+/// A task that is never run.
+void Task() { }
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Enqueues tasks round robin across gm, sc, lb and vvc, first by module
+/// identifier, which looks the module up by name, then by the index and cost
+/// class a module caches. The worker is not started, so only the enqueue is
+/// timed. Takes the number of tasks per pass, 1000000 by default.
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    unsigned long count = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 1000000;
+    bench::QuietLogs();
+
+    CBroker& broker = CBroker::Instance();
+    CBroker::ModuleIndex index[MODULE_COUNT];
+    CBroker::CostClass cost[MODULE_COUNT];
+    for(unsigned int i = 0; i < MODULE_COUNT; i++)
+    {
+        broker.RegisterModule(MODULES[i], boost::posix_time::milliseconds(1000));
+        index[i] = broker.GetModuleIndex(MODULES[i]);
+        cost[i] = broker.GetCostClass(MODULES[i], "bench");
+    }
+    CBroker::BoundScheduleable task = &Task;
+
+    bench::CStopwatch watch;
+    for(unsigned long i = 0; i < count; i++)
+    {
+        broker.Schedule(std::string(MODULES[i % MODULE_COUNT]), task, false);
+    }
+    bench::Report("Schedule(ModuleIdent)", count, watch.Elapsed());
+
+    watch.Restart();
+    for(unsigned long i = 0; i < count; i++)
+    {
+        broker.Schedule(index[i % MODULE_COUNT], task, false);
+    }
+    bench::Report("Schedule(ModuleIndex)", count, watch.Elapsed());
+
+    watch.Restart();
+    for(unsigned long i = 0; i < count; i++)
+    {
+        broker.Schedule(index[i % MODULE_COUNT], cost[i % MODULE_COUNT], task, false);
+    }
+    bench::Report("Schedule(ModuleIndex, CostClass)", count, watch.Elapsed());
+    return 0;
+}
@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         BenchSelfSend.cpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Measures sending messages from a module to this process.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "AllocationCounter.hpp"
+#include "Bench.hpp"
+#include "CDispatcher.hpp"
+#include "CGlobalConfiguration.hpp"
+#include "CGlobalPeerList.hpp"
+#include "CPeerNode.hpp"
+#include "IDGIModule.hpp"
+
+#include "messages/ModuleMessage.pb.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+using namespace freedm::broker;
+
+namespace {
+
+/// The values in each collected state message.
+const unsigned int VALUES = 8;
+
+/// Sends collected states to this process the way state collection answers
+/// load balancing, and receives them as load balancing.
+class CSelfSender
+    : public IDGIModule
+{
+public:
+    CSelfSender()
+        : m_received(0)
+        , m_shared(0)
+        , m_last(NULL)
+    {
+        //Pass
+    }
+    /// Sends a pooled message by reference, which the peer node copies.
+    void SendByReference()
+    {
+        ModuleMessage& msg = BuildState();
+        m_last = &msg;
+        GetMe().Send(msg);
+    }
+    /// Sends a pooled message through ShareMessage, as the modules do.
+    void SendShared()
+    {
+        ModuleMessage& msg = BuildState();
+        m_last = &msg;
+        GetMe().Send(ShareMessage(msg));
+    }
+    /// Counts the messages received, and those which were not copied.
+    void HandleIncomingMessage(boost::shared_ptr<const ModuleMessage> msg, CPeerNode)
+    {
+        m_received++;
+        m_shared += (msg.get() == m_last);
+    }
+    /// The messages received since the last reset.
+    unsigned long GetReceived() const { return m_received; }
+    /// The messages received as the message that was sent.
+    unsigned long GetShared() const { return m_shared; }
+    /// Starts counting again.
+    void Reset() { m_received = m_shared = 0; }
+private:
+    /// Builds a collected state message from the module's pool.
+    ModuleMessage& BuildState()
+    {
+        ModuleMessage& msg = NewMessage("lb");
+        sc::CollectedStateMessage* csm =
+            msg.mutable_state_collection_message()->mutable_collected_state_message();
+        csm->set_num_intransit_accepts(0);
+        for(unsigned int i = 0; i < VALUES; i++)
+        {
+            csm->add_gateway(i);
+        }
+        return msg;
+    }
+
+    unsigned long m_received;
+    unsigned long m_shared;
+    const ModuleMessage* m_last;
+};
+
+/// Prints the allocations made per send by a loop.
+void ReportAllocations(const std::string& name, unsigned long sends,
+    unsigned long allocations)
+{
+    std::cout << name << ": " << allocations << " allocations, "
+              << (sends > 0 ? double(allocations) / sends : 0)
+              << " per send" << std::endl;
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Sends collected state messages from a module to this process, as state
+/// collection answers load balancing on the same node, and receives them in
+/// a module registered for "lb". The messages are built in the module's pool
+/// and sent first by reference, which CPeerNode::Send copies for the
+/// dispatcher, and then through ShareMessage, which hands the dispatcher the
+/// pooled message itself. The broker is not running, so the module is not
+/// scheduled and gets each message as it is sent, on one thread. Reports the
+/// time and heap allocations per send of each. Takes the number of sends,
+/// 10000 by default. Exits with 1 if a message was not received, or a shared
+/// message was received as a copy.
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    unsigned long sends = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 10000;
+    bench::QuietLogs();
+
+    CGlobalConfiguration::Instance().SetUUID("localhost:51871");
+    // The dispatcher only delivers messages from peers it knows.
+    CGlobalPeerList::instance().Create(CGlobalConfiguration::Instance().GetUUID());
+    boost::shared_ptr<CSelfSender> module(new CSelfSender);
+    CDispatcher::Instance().RegisterReadHandler(module, "lb");
+
+    bench::CStopwatch watch;
+    unsigned long start = bench::g_allocations;
+    for(unsigned long i = 0; i < sends; i++)
+    {
+        module->SendByReference();
+    }
+    unsigned long copied = bench::g_allocations - start;
+    bench::Report("Send(const ModuleMessage&)", sends, watch.Elapsed());
+    bool complete = module->GetReceived() == sends;
+    module->Reset();
+
+    watch.Restart();
+    start = bench::g_allocations;
+    for(unsigned long i = 0; i < sends; i++)
+    {
+        module->SendShared();
+    }
+    unsigned long shared = bench::g_allocations - start;
+    bench::Report("Send(ShareMessage(msg))", sends, watch.Elapsed());
+    complete = complete && module->GetReceived() == sends;
+
+    ReportAllocations("Send(const ModuleMessage&)", sends, copied);
+    ReportAllocations("Send(ShareMessage(msg))", sends, shared);
+
+    if(!complete)
+    {
+        std::cout << "a message sent to this process was not received" << std::endl;
+        return 1;
+    }
+    if(module->GetShared() != sends)
+    {
+        std::cout << sends - module->GetShared() << " shared messages were copied" << std::endl;
+        return 1;
+    }
+    return 0;
+}
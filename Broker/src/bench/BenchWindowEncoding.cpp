@@ -0,0 +1,179 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         BenchWindowEncoding.cpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Measures writing a window of unacknowledged messages again.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.hpp"
+#include "CBroker.hpp"
+#include "CGlobalConfiguration.hpp"
+#include "CListener.hpp"
+#include "CProtocolSR.hpp"
+#include "CTimings.hpp"
+#include "Messages.hpp"
+
+#include "messages/ModuleMessage.pb.h"
+#include "messages/ProtocolMessage.pb.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/foreach.hpp>
+#include <boost/shared_ptr.hpp>
+
+using namespace freedm::broker;
+
+namespace {
+
+/// The messages waiting for an ACK.
+const unsigned int UNACKED = 100;
+
+/// The peers listed in each module message.
+const unsigned int PEERS = 4;
+
+/// Builds a peer list, a typical group management message of a few hundred
+/// bytes.
+ModuleMessage BuildMessage()
+{
+    ModuleMessage msg;
+    SetRecipient(msg, "gm");
+    gm::PeerListMessage* list =
+        msg.mutable_group_management_message()->mutable_peer_list_message();
+    for(unsigned int i = 0; i < PEERS; i++)
+    {
+        std::ostringstream uuid;
+        uuid << "peer-" << i << ".dgi.example.org:51870";
+        gm::ConnectedPeerMessage* peer = list->add_connected_peer_message();
+        peer->set_uuid(uuid.str());
+        peer->set_host("peer.dgi.example.org");
+        peer->set_port("51870");
+    }
+    return msg;
+}
+
+/// Builds the queued messages the way the window held them before their
+/// encodings were cached: whole ProtocolMessages, module message included.
+std::vector<ProtocolMessage> BuildQueue(const ModuleMessage& msg)
+{
+    std::vector<ProtocolMessage> queue(UNACKED);
+    for(unsigned int i = 0; i < UNACKED; i++)
+    {
+        ProtocolMessage& pm = queue[i];
+        pm.set_sequence_num(i);
+        pm.set_status(ProtocolMessage::MESSAGE);
+        pm.set_hash(ComputeMessageHash(msg));
+        SetExpirationTimeFromNow(pm, CTimings::GetDuration(CTimings::CSRC_DEFAULT_TIMEOUT),
+            false);
+        *pm.mutable_module_message() = msg;
+    }
+    return queue;
+}
+
+/// Writes the queue the way WriteWindow did before the encodings were
+/// cached: copies every message into a new window, then stamps, encodes and
+/// sends the window as IProtocol::Write does.
+void WriteCopied(const std::vector<ProtocolMessage>& queue, std::string& buffer,
+    boost::asio::ip::udp::socket& socket, const boost::asio::ip::udp::endpoint& peer)
+{
+    ProtocolMessageWindow pmw;
+    BOOST_FOREACH(const ProtocolMessage& pm, queue)
+    {
+        *pmw.add_messages() = pm;
+    }
+    pmw.set_source_uuid(CGlobalConfiguration::Instance().GetUUID());
+    StampMessageSendtime(pmw, false);
+    pmw.set_binary_timestamps(true);
+    pmw.set_selective_ack(true);
+    pmw.CheckInitialized();
+    pmw.SerializeToString(&buffer);
+    socket.send_to(boost::asio::buffer(buffer), peer);
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Holds 100 unacknowledged group management messages to one peer and
+/// writes them all again a number of times, as every retransmission timeout
+/// does. The window is written first the way CProtocolSR did before it
+/// cached encodings, copying each queued message into a new window and
+/// encoding the whole window, and then with CProtocolSR::WriteWindow, which
+/// encodes only the window header and appends the cached encoding of each
+/// message. Both write the same messages to a loopback socket which does not
+/// read them. Reports the time per write of each. Takes the number of writes,
+/// 2000 by default, and the timings file, the broker's ./config/timings.cfg
+/// by default, so it is run from the Broker directory. Exits with 1 if the
+/// window expired or the protocol was stopped before the last write.
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    unsigned long writes = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 2000;
+    std::string timings = argc > 2 ? argv[2] : "./config/timings.cfg";
+    bench::QuietLogs();
+
+    CTimings::SetTimings(timings);
+    CGlobalConfiguration::Instance().SetUUID("localhost:51871");
+
+    boost::asio::ip::udp::endpoint loopback(boost::asio::ip::address_v4::loopback(), 0);
+    boost::asio::ip::udp::socket& socket = CListener::Instance().GetSocket();
+    socket.open(boost::asio::ip::udp::v4());
+    socket.bind(loopback);
+    boost::asio::ip::udp::socket sink(CBroker::Instance().GetIOService());
+    sink.open(boost::asio::ip::udp::v4());
+    sink.bind(loopback);
+    boost::asio::ip::udp::endpoint peer = sink.local_endpoint();
+
+    ModuleMessage msg = BuildMessage();
+    std::vector<ProtocolMessage> queue = BuildQueue(msg);
+    std::string buffer;
+    bench::CStopwatch watch;
+    for(unsigned long i = 0; i < writes; i++)
+    {
+        WriteCopied(queue, buffer, socket, peer);
+    }
+    bench::Report("copied window", writes, watch.Elapsed());
+
+    boost::shared_ptr<CProtocolSR> protocol(new CProtocolSR("peer:51870", peer));
+    protocol->SetBinaryTimestamps(true);
+    for(unsigned int i = 0; i < UNACKED; i++)
+    {
+        protocol->Send(msg);
+    }
+    protocol->Flush();
+    boost::asio::io_service& ios = CBroker::Instance().GetIOService();
+    watch.Restart();
+    for(unsigned long i = 0; i < writes; i++)
+    {
+        protocol->WriteWindow(true);
+        // Sends the batched datagrams, if the broker batches them.
+        ios.poll();
+    }
+    bench::Report("cached encodings", writes, watch.Elapsed());
+
+    SLinkStats stats = protocol->GetStats();
+    std::cout << "datagrams per write: "
+              << static_cast<double>(stats.datagrams) / (writes + 1) << std::endl;
+    if(protocol->GetStopped())
+    {
+        std::cout << "the window expired or was stopped during the benchmark" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,190 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         BenchWindowPool.cpp
+///
+/// @project      FREEDM DGI
+///
+/// @description  Measures the receive path from a datagram to module messages.
+///
+/// These source code files were created at Missouri University of Science and
+/// Technology, and are intended for use in teaching or research. They may be
+/// freely copied, modified, and redistributed as long as modified versions are
+/// clearly marked as such and this notice is not removed. Neither the authors
+/// nor Missouri S&T make any warranty, express or implied, nor assume any legal
+/// responsibility for the accuracy, completeness, or usefulness of these files
+/// or any information distributed with these files.
+///
+/// Suggested modifications or questions about these files can be directed to
+/// Dr. Bruce McMillin, Department of Computer Science, Missouri University of
+/// Science and Technology, Rolla, MO 65409 <ff@mst.edu>.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "AllocationCounter.hpp"
+#include "Bench.hpp"
+#include "CWindowPool.hpp"
+
+#include "messages/ModuleMessage.pb.h"
+#include "messages/ProtocolMessage.pb.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/foreach.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+using namespace freedm::broker;
+
+namespace {
+
+/// The peers listed in each module message.
+const unsigned int PEERS = 4;
+
+/// The window sizes measured, in messages.
+const unsigned int WINDOW_SIZES[] = { 1, 10, 100 };
+
+/// The messages handed to the dispatcher from one window.
+typedef std::vector< boost::shared_ptr<const ModuleMessage> > DeliveredList;
+
+/// Encodes a window of peer list messages the way a peer's CProtocolSR
+/// writes them.
+std::string BuildWindow(unsigned int size)
+{
+    ProtocolMessageWindow pmw;
+    pmw.set_source_uuid("sender.dgi.example.org:51870");
+    pmw.set_send_time("");
+    pmw.set_send_time_us(1);
+    pmw.set_binary_timestamps(true);
+    pmw.set_selective_ack(true);
+    for(unsigned int i = 0; i < size; i++)
+    {
+        ProtocolMessage* pm = pmw.add_messages();
+        pm->set_sequence_num(i);
+        pm->set_status(ProtocolMessage::MESSAGE);
+        pm->set_hash(i);
+        pm->set_expire_time_us(1);
+        ModuleMessage* msg = pm->mutable_module_message();
+        msg->set_recipient_module("gm");
+        msg->set_recipient_id(ModuleMessage::GM_MODULE);
+        gm::PeerListMessage* list =
+            msg->mutable_group_management_message()->mutable_peer_list_message();
+        for(unsigned int j = 0; j < PEERS; j++)
+        {
+            std::ostringstream uuid;
+            uuid << "peer-" << j << ".dgi.example.org:51870";
+            gm::ConnectedPeerMessage* peer = list->add_connected_peer_message();
+            peer->set_uuid(uuid.str());
+            peer->set_host("peer.dgi.example.org");
+            peer->set_port("51870");
+        }
+    }
+    std::string encoded;
+    pmw.SerializeToString(&encoded);
+    return encoded;
+}
+
+/// Parses the window into a new window on the stack and copies each module
+/// message into its own allocation, as the listener used to.
+void ReceiveCopied(const std::string& datagram, DeliveredList& delivered)
+{
+    ProtocolMessageWindow pmw;
+    pmw.ParseFromArray(datagram.data(), datagram.size());
+    BOOST_FOREACH(const ProtocolMessage& pm, pmw.messages())
+    {
+        delivered.push_back(boost::make_shared<ModuleMessage>(pm.module_message()));
+    }
+}
+
+/// Parses the window into a pooled window and hands out pointers into it,
+/// as the listener does now.
+void ReceivePooled(CWindowPool& pool, const std::string& datagram,
+    DeliveredList& delivered)
+{
+    CWindowPool::WindowPtr window = pool.Acquire();
+    window->ParseFromArray(datagram.data(), datagram.size());
+    BOOST_FOREACH(const ProtocolMessage& pm, window->messages())
+    {
+        delivered.push_back(boost::shared_ptr<const ModuleMessage>(window,
+            &pm.module_message()));
+    }
+}
+
+/// Prints the allocations made per window by a loop.
+void ReportAllocations(const std::string& name, unsigned long windows,
+    unsigned long allocations)
+{
+    std::cout << name << ": " << allocations << " allocations, "
+              << (windows > 0 ? double(allocations) / windows : 0)
+              << " per window" << std::endl;
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Receives windows of 1, 10 and 100 group management messages, first the
+/// way the listener did before it pooled windows, parsing each datagram into
+/// a new window and copying every module message out of it, and then
+/// through a CWindowPool, handing out pointers into the parsed window.
+/// Every message is held until the whole window is received, as a module's
+/// inbound queue would hold it, and then released. Reports the messages
+/// received per second and the heap allocations per window of each. Exits
+/// with 1 if the pool allocates as much as the copies do for any window
+/// size. Takes the number of messages received per pass, 100000 by default.
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    unsigned long messages = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 100000;
+    bool reused = true;
+    bench::QuietLogs();
+
+    BOOST_FOREACH(unsigned int size, WINDOW_SIZES)
+    {
+        std::string datagram = BuildWindow(size);
+        unsigned long windows = messages / size;
+        DeliveredList delivered;
+        delivered.reserve(size);
+        std::ostringstream label;
+        label << size << (size == 1 ? " message" : " messages") << " per window";
+        std::cout << label.str() << ", " << datagram.size() << " bytes" << std::endl;
+
+        bench::CStopwatch watch;
+        unsigned long start = bench::g_allocations;
+        for(unsigned long i = 0; i < windows; i++)
+        {
+            ReceiveCopied(datagram, delivered);
+            delivered.clear();
+        }
+        unsigned long copied = bench::g_allocations - start;
+        bench::Report("copied messages", windows * size, watch.Elapsed());
+
+        CWindowPool pool;
+        ReceivePooled(pool, datagram, delivered);
+        delivered.clear();
+
+        watch.Restart();
+        start = bench::g_allocations;
+        for(unsigned long i = 0; i < windows; i++)
+        {
+            ReceivePooled(pool, datagram, delivered);
+            delivered.clear();
+        }
+        unsigned long pooled = bench::g_allocations - start;
+        bench::Report("pooled window", windows * size, watch.Elapsed());
+
+        ReportAllocations("copied messages", windows, copied);
+        ReportAllocations("pooled window", windows, pooled);
+        if(windows > 0 && pooled >= copied)
+        {
+            reused = false;
+        }
+    }
+
+    if(!reused)
+    {
+        std::cout << "the pool did not reuse its windows" << std::endl;
+        return 1;
+    }
+    return 0;
+}
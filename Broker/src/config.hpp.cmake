@@ -25,6 +25,8 @@
 
 #cmakedefine DATAGRAM
 #cmakedefine CUSTOMNETWORK
+#cmakedefine BATCHED_UDP
+#cmakedefine NO_DEBUG_LOGGING
 
 #endif // CONFIG_HPP
 
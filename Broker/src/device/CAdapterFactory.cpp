@@ -73,13 +73,13 @@ namespace freedm {
 ////////////////////////////////////////////////////////////////////////////////
             CAdapterFactory::CAdapterFactory()
                     : m_timeout(m_ios) {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 std::string deviceCfgFile =
                         CGlobalConfiguration::Instance().GetDeviceConfigPath();
 
                 if (deviceCfgFile.empty()) {
-                    Logger.Status << "System will start no device classes." << std::endl;
+                    FREEDM_LOG_STATUS(Logger) << "System will start no device classes." << std::endl;
                 } else {
                     m_builder = CDeviceBuilder(deviceCfgFile);
                 }
@@ -88,31 +88,31 @@ namespace freedm {
                         CGlobalConfiguration::Instance().GetFactoryPort();
 
                 if (factoryPort) {
-                    Logger.Status << "Plug and play devices enabled." << std::endl;
+                    FREEDM_LOG_STATUS(Logger) << "Plug and play devices enabled." << std::endl;
                     StartSessionProtocol(factoryPort);
                 } else {
-                    Logger.Status << "Plug and play devices disabled." << std::endl;
+                    FREEDM_LOG_STATUS(Logger) << "Plug and play devices disabled." << std::endl;
                 }
 
                 std::string mqttId = CGlobalConfiguration::Instance().GetMQTTId();
                 std::string mqttAddress = CGlobalConfiguration::Instance().GetMQTTAddress();
 
                 if (mqttId != "") {
-                    Logger.Status << "MQTT client enabled." << std::endl;
+                    FREEDM_LOG_STATUS(Logger) << "MQTT client enabled." << std::endl;
                     //   IAdapter::Pointer mqttClient = CMqttAdapter::Create(mqttId, mqttAddress);
                     //  m_adapters[mqttId] = mqttClient;
                     //  mqttClient->Start();
                 } else {
-                    Logger.Status << "MQTT client disabled." << std::endl;
+                    FREEDM_LOG_STATUS(Logger) << "MQTT client disabled." << std::endl;
                 }
 
                 std::string adapterCfgFile =
                         CGlobalConfiguration::Instance().GetAdapterConfigPath();
 
                 if (adapterCfgFile.empty()) {
-                    Logger.Status << "System will start without adapters." << std::endl;
+                    FREEDM_LOG_STATUS(Logger) << "System will start without adapters." << std::endl;
                 } else {
-                    Logger.Status << "Using devices in " << adapterCfgFile << std::endl;
+                    FREEDM_LOG_STATUS(Logger) << "Using devices in " << adapterCfgFile << std::endl;
 
                     try {
                         boost::property_tree::ptree adapterList;
@@ -146,7 +146,7 @@ namespace freedm {
 /// @limitations None.
 ////////////////////////////////////////////////////////////////////////////////
             CAdapterFactory &CAdapterFactory::Instance() {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
                 static CAdapterFactory instance;
                 return instance;
             }
@@ -160,22 +160,22 @@ namespace freedm {
 /// @limitations None.
 ///////////////////////////////////////////////////////////////////////////////
             void CAdapterFactory::RunService() {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 boost::asio::io_service::work workload(m_ios);
 
                 try {
-                    Logger.Status << "Starting the adapter i/o service." << std::endl;
+                    FREEDM_LOG_STATUS(Logger) << "Starting the adapter i/o service." << std::endl;
                     m_ios.run();
                 }
                 catch (std::exception &e) {
-                    Logger.Fatal << "Fatal exception in the device ioservice: "
+                    FREEDM_LOG_FATAL(Logger) << "Fatal exception in the device ioservice: "
                                  << e.what() << std::endl;
                     // The Broker will stop us.
                     raise(SIGTERM);
                 }
 
-                Logger.Status << "The adapter i/o service has stopped." << std::endl;
+                FREEDM_LOG_STATUS(Logger) << "The adapter i/o service has stopped." << std::endl;
             }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -190,7 +190,7 @@ namespace freedm {
 /// @limitations MUST be called from outside the devices thread.
 ///////////////////////////////////////////////////////////////////////////////
             void CAdapterFactory::Stop() {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 assert(boost::this_thread::get_id() != m_thread.get_id());
 
@@ -210,7 +210,7 @@ namespace freedm {
                     m_thread.join();
                 }
                 catch (std::exception &e) {
-                    Logger.Error << "Caught exception when stopping AdapterFactory: "
+                    FREEDM_LOG_ERROR(Logger) << "Caught exception when stopping AdapterFactory: "
                                  << e.what() << std::endl;
                 }
             }
@@ -233,7 +233,7 @@ namespace freedm {
 /// @limitations None.
 ////////////////////////////////////////////////////////////////////////////////
             void CAdapterFactory::CreateAdapter(const boost::property_tree::ptree &p) {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 boost::property_tree::ptree subtree;
                 IAdapter::Pointer adapter;
@@ -250,7 +250,7 @@ namespace freedm {
                                           + std::string(e.what()));
                 }
 
-                Logger.Debug << "Building " << type << " adapter " << name << std::endl;
+                FREEDM_LOG_DEBUG(Logger) << "Building " << type << " adapter " << name << std::endl;
 
                 // range check the properties
                 if (name.empty()) {
@@ -276,7 +276,7 @@ namespace freedm {
                 // store the adapter; note that InitializeAdapter can throw EBadRequest
                 InitializeAdapter(adapter, p);
                 m_adapters[name] = adapter;
-                Logger.Info << "Created the " << type << " adapter " << name << std::endl;
+                FREEDM_LOG_INFO(Logger) << "Created the " << type << " adapter " << name << std::endl;
 
                 // signal construction complete
                 adapter->Start();
@@ -294,7 +294,7 @@ namespace freedm {
 /// @limitations None.
 ////////////////////////////////////////////////////////////////////////////////
             void CAdapterFactory::RemoveAdapter(const std::string identifier) {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 std::set<std::string> devices;
 
@@ -306,7 +306,7 @@ namespace freedm {
 
                 m_adapters[identifier]->Stop();
                 m_adapters.erase(identifier);
-                Logger.Info << "Removed the adapter: " << identifier << std::endl;
+                FREEDM_LOG_INFO(Logger) << "Removed the adapter: " << identifier << std::endl;
 
                 BOOST_FOREACH(std::string device, devices) {
                                 CDeviceManager::Instance().RemoveDevice(device);
@@ -328,7 +328,7 @@ namespace freedm {
 ////////////////////////////////////////////////////////////////////////////////
             void CAdapterFactory::InitializeAdapter(IAdapter::Pointer adapter,
                                                     const boost::property_tree::ptree &p) {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 boost::property_tree::ptree subtree;
                 boost::optional<SignalValue> value;
@@ -360,7 +360,7 @@ namespace freedm {
                 // i = 0 parses state information
                 // i = 1 parses command information
                 for (int i = 0; i < 2; i++) {
-                    Logger.Debug << "Reading the " << (i == 0 ? "state" : "command")
+                    FREEDM_LOG_DEBUG(Logger) << "Reading the " << (i == 0 ? "state" : "command")
                                  << " property tree specification." << std::endl;
 
                     try {
@@ -391,7 +391,7 @@ namespace freedm {
                                                               + std::string(e.what()));
                                     }
 
-                                    Logger.Debug << "At index " << index << " for the device signal ("
+                                    FREEDM_LOG_DEBUG(Logger) << "At index " << index << " for the device signal ("
                                                  << name << "," << signal << ")." << std::endl;
 
                                     // create the device when first seen
@@ -428,10 +428,10 @@ namespace freedm {
                                     }
 
                                     if (buffer && i == 0) {
-                                        Logger.Debug << "Registering state info." << std::endl;
+                                        FREEDM_LOG_DEBUG(Logger) << "Registering state info." << std::endl;
                                         buffer->RegisterStateInfo(name, signal, index);
                                     } else if (buffer && i == 1) {
-                                        Logger.Debug << "Registering command info." << std::endl;
+                                        FREEDM_LOG_DEBUG(Logger) << "Registering command info." << std::endl;
                                         buffer->RegisterCommandInfo(name, signal, index);
                                     } else if (fake && value) {
                                         SignalValue oldval = fake->GetState(name, signal);
@@ -472,7 +472,7 @@ namespace freedm {
                     }
                 }
 
-                Logger.Debug << "Initialized the device adapter." << std::endl;
+                FREEDM_LOG_DEBUG(Logger) << "Initialized the device adapter." << std::endl;
             }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -491,7 +491,7 @@ namespace freedm {
 ////////////////////////////////////////////////////////////////////////////////
             void CAdapterFactory::CreateDevice(const std::string name,
                                                const std::string type, IAdapter::Pointer adapter) {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 if (CDeviceManager::Instance().DeviceExists(name)) {
                     throw std::runtime_error("The device " + name + " already exists.");
@@ -504,7 +504,7 @@ namespace freedm {
                 CDevice::Pointer device = m_builder.CreateDevice(name, type, adapter);
                 CDeviceManager::Instance().AddDevice(device);
 
-                Logger.Info << "Created new device: " << name << std::endl;
+                FREEDM_LOG_INFO(Logger) << "Created new device: " << name << std::endl;
             }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -543,10 +543,10 @@ namespace freedm {
 /// @limitations This function must only be called by m_server.
 ////////////////////////////////////////////////////////////////////////////////
             void CAdapterFactory::StartSession() {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
-                Logger.Notice << "A wild client appears!" << std::endl;
-                m_timeout.expires_from_now(boost::posix_time::seconds(CTimings::Get("DEV_PNP_HEARTBEAT")));
+                FREEDM_LOG_NOTICE(Logger) << "A wild client appears!" << std::endl;
+                m_timeout.expires_from_now(boost::posix_time::seconds(CTimings::Get(CTimings::DEV_PNP_HEARTBEAT)));
                 m_timeout.async_wait(boost::bind(&CAdapterFactory::Timeout, this,
                                                  boost::asio::placeholders::error));
 
@@ -566,16 +566,16 @@ namespace freedm {
 /// @limitations None.
 ////////////////////////////////////////////////////////////////////////////////
             void CAdapterFactory::HandleRead(const boost::system::error_code &e) {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 if (!e) {
                     if (m_timeout.cancel() == 1) {
                         SessionProtocol();
                     } else {
-                        Logger.Notice << "Dropped packet due to timeout." << std::endl;
+                        FREEDM_LOG_NOTICE(Logger) << "Dropped packet due to timeout." << std::endl;
                     }
                 } else if (e == boost::asio::error::operation_aborted) {
-                    Logger.Notice << "Controller failed to send valid Hello." << std::endl;
+                    FREEDM_LOG_NOTICE(Logger) << "Controller failed to send valid Hello." << std::endl;
                 }
             }
 
@@ -589,19 +589,19 @@ namespace freedm {
 /// @limitations None.
 ////////////////////////////////////////////////////////////////////////////////
             void CAdapterFactory::Timeout(const boost::system::error_code &e) {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 if (!e) {
-                    Logger.Notice << "Connection closed due to timeout." << std::endl;
+                    FREEDM_LOG_NOTICE(Logger) << "Connection closed due to timeout." << std::endl;
 
                     try {
                         std::string msg;
                         msg = "Error\r\nConnection closed due to timeout.\r\n\r\n";
                         TimedWrite(*m_server->GetClient(), boost::asio::buffer(msg),
-                                   CTimings::Get("DEV_SOCKET_TIMEOUT"));
+                                   CTimings::Get(CTimings::DEV_SOCKET_TIMEOUT));
                     }
                     catch (std::exception &e) {
-                        Logger.Info << "Failed to tell client about timeout." << std::endl;
+                        FREEDM_LOG_INFO(Logger) << "Failed to tell client about timeout." << std::endl;
                     }
 
                     m_server->GetClient()->cancel();
@@ -609,7 +609,7 @@ namespace freedm {
                 } else if (e == boost::asio::error::operation_aborted) {
                     // Timeout was cancelled. Hopefully a good Hello was received!
                 } else {
-                    Logger.Warn << "Connection closed: " << e.message() << std::endl;
+                    FREEDM_LOG_WARN(Logger) << "Connection closed: " << e.message() << std::endl;
                     m_server->GetClient()->cancel();
                     m_server->StartAccept();
                 }
@@ -626,7 +626,7 @@ namespace freedm {
 /// @limitations None.
 ////////////////////////////////////////////////////////////////////////////////
             void CAdapterFactory::SessionProtocol() {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 std::istream packet(&m_buffer);
                 boost::asio::streambuf response;
@@ -640,7 +640,7 @@ namespace freedm {
 
                 try {
                     packet >> header >> host;
-                    Logger.Info << "Received " << header << " from " << host << std::endl;
+                    FREEDM_LOG_INFO(Logger) << "Received " << header << " from " << host << std::endl;
 
                     if (header != "Hello") {
                         throw EBadRequest("Expected 'Hello' message: " + header);
@@ -659,7 +659,7 @@ namespace freedm {
                     config.put("command", "");
 
                     for (int i = 0; packet >> type >> name; i++) {
-                        Logger.Debug << "Processing " << type << ":" << name << std::endl;
+                        FREEDM_LOG_DEBUG(Logger) << "Processing " << type << ":" << name << std::endl;
 
                         try {
                             DeviceInfo info = m_builder.GetDeviceInfo(type);
@@ -672,10 +672,10 @@ namespace freedm {
 
                         name = host + ":" + name;
                         boost::replace_all(name, ".", ":");
-                        Logger.Debug << "Using adapter name " << name << std::endl;
+                        FREEDM_LOG_DEBUG(Logger) << "Using adapter name " << name << std::endl;
 
                         BOOST_FOREACH(std::string signal, states) {
-                                        Logger.Debug << "Adding state for " << signal << std::endl;
+                                        FREEDM_LOG_DEBUG(Logger) << "Adding state for " << signal << std::endl;
 
                                         boost::property_tree::ptree temp;
                                         temp.put("type", type);
@@ -690,7 +690,7 @@ namespace freedm {
                                     }
 
                         BOOST_FOREACH(std::string signal, commands) {
-                                        Logger.Debug << "Adding command for " << signal << std::endl;
+                                        FREEDM_LOG_DEBUG(Logger) << "Adding command for " << signal << std::endl;
 
                                         boost::property_tree::ptree temp;
                                         temp.put("type", type);
@@ -719,28 +719,28 @@ namespace freedm {
                     }
 
                     response_stream << "Start\r\n\r\n";
-                    Logger.Status << "Blocking to send Start to client" << std::endl;
+                    FREEDM_LOG_STATUS(Logger) << "Blocking to send Start to client" << std::endl;
                 }
                 catch (EBadRequest &e) {
-                    Logger.Warn << "Rejected client: " << e.what() << std::endl;
+                    FREEDM_LOG_WARN(Logger) << "Rejected client: " << e.what() << std::endl;
 
                     response_stream << "BadRequest\r\n";
                     response_stream << e.what() << "\r\n\r\n";
 
-                    Logger.Status << "Blocking to send BadRequest to client" << std::endl;
+                    FREEDM_LOG_STATUS(Logger) << "Blocking to send BadRequest to client" << std::endl;
                 }
                 catch (std::exception &e) {
-                    Logger.Warn << "Rejected client: " << e.what() << std::endl;
+                    FREEDM_LOG_WARN(Logger) << "Rejected client: " << e.what() << std::endl;
                     response_stream << "Error\r\n" << e.what() << "\r\n\r\n";
-                    Logger.Status << "Blocking to send Error to client" << std::endl;
+                    FREEDM_LOG_STATUS(Logger) << "Blocking to send Error to client" << std::endl;
                 }
 
                 try {
                     TimedWrite(*m_server->GetClient(), response,
-                               CTimings::Get("DEV_SOCKET_TIMEOUT"));
+                               CTimings::Get(CTimings::DEV_SOCKET_TIMEOUT));
                 }
                 catch (std::exception &e) {
-                    Logger.Warn << "Failed to respond to client: " << e.what() << std::endl;
+                    FREEDM_LOG_WARN(Logger) << "Failed to respond to client: " << e.what() << std::endl;
                 }
 
                 m_server->StartAccept();
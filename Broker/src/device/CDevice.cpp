@@ -32,6 +32,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "CDevice.hpp"
+#include "CEventLog.hpp"
 #include "CLogger.hpp"
 
 namespace freedm {
@@ -93,8 +94,8 @@ CDevice::CDevice(std::string id, DeviceInfo info, IAdapter::Pointer adapter)
     , m_devinfo(info)
     , m_adapter(adapter)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    Logger.Status << "CREATED NEW DEVICE:\n" << m_devid << "\n" << m_devinfo
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_STATUS(Logger) << "CREATED NEW DEVICE:\n" << m_devid << "\n" << m_devinfo
             << std::endl;
 }
 
@@ -109,7 +110,7 @@ CDevice::CDevice(std::string id, DeviceInfo info, IAdapter::Pointer adapter)
 ////////////////////////////////////////////////////////////////////////////////
 std::string CDevice::GetID() const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     return m_devid;
 }
 
@@ -125,7 +126,7 @@ std::string CDevice::GetID() const
 ////////////////////////////////////////////////////////////////////////////////
 bool CDevice::HasType(std::string type) const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     return m_devinfo.s_type.count(type) > 0;
 }
 
@@ -141,7 +142,7 @@ bool CDevice::HasType(std::string type) const
 ////////////////////////////////////////////////////////////////////////////////
 bool CDevice::HasState(std::string signal) const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     return m_devinfo.s_state.count(signal) > 0;
 }
 
@@ -157,7 +158,7 @@ bool CDevice::HasState(std::string signal) const
 ////////////////////////////////////////////////////////////////////////////////
 bool CDevice::HasCommand(std::string signal) const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     return m_devinfo.s_command.count(signal) > 0;
 }
 
@@ -177,18 +178,20 @@ bool CDevice::HasCommand(std::string signal) const
 ////////////////////////////////////////////////////////////////////////////////
 SignalValue CDevice::GetState(std::string signal) const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if( !HasState(signal) )
     {
         //error not warning ....should record error if state not right
-        Logger.Warn << "Bad Device State: " << signal << "\n" << m_devid
+        FREEDM_LOG_WARN(Logger) << "Bad Device State: " << signal << "\n" << m_devid
                 << "\n" << m_devinfo << std::endl;
        // throw std::runtime_error("Bad Device State: " + signal);
         return 0;
     }
 
-    return m_adapter->GetState(m_devid, signal);
+    SignalValue value = m_adapter->GetState(m_devid, signal);
+    CEventLog::Instance().DeviceRead(m_devid, signal, value);
+    return value;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -202,7 +205,7 @@ SignalValue CDevice::GetState(std::string signal) const
 ////////////////////////////////////////////////////////////////////////////////
 std::set<std::string> CDevice::GetStateSet() const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     return m_devinfo.s_state;
 }
 
@@ -217,7 +220,7 @@ std::set<std::string> CDevice::GetStateSet() const
 ////////////////////////////////////////////////////////////////////////////////
 std::set<std::string> CDevice::GetCommandSet() const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     return m_devinfo.s_command;
 }
 
@@ -237,17 +240,18 @@ std::set<std::string> CDevice::GetCommandSet() const
 ////////////////////////////////////////////////////////////////////////////////
 void CDevice::SetCommand(std::string signal, SignalValue value)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if( !HasCommand(signal) )
     {
-        Logger.Error << "Bad Device Command: " << signal << "\n" << m_devid
+        FREEDM_LOG_ERROR(Logger) << "Bad Device Command: " << signal << "\n" << m_devid
                 << "\n" << m_devinfo << std::endl;
         throw std::runtime_error("Bad Device Command: " + signal);
     }
 
     m_adapter->SetCommand(m_devid, signal, value);
-    Logger.Status << "Fired" << std::endl;
+    CEventLog::Instance().DeviceCommand(m_devid, signal, value);
+    FREEDM_LOG_STATUS(Logger) << "Fired" << std::endl;
 }
 
 } // namespace device
@@ -60,7 +60,7 @@ CLocalLogger Logger(__FILE__);
 ////////////////////////////////////////////////////////////////////////////////
 CDeviceBuilder::CDeviceBuilder(std::string filename)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     typedef std::map<std::string, DeviceInfo> map_type;
     using namespace boost::property_tree;
@@ -69,7 +69,7 @@ CDeviceBuilder::CDeviceBuilder(std::string filename)
 
     try
     {
-        Logger.Debug << "read_xml with the path: " << filename << std::endl;
+        FREEDM_LOG_DEBUG(Logger) << "read_xml with the path: " << filename << std::endl;
         read_xml(filename, root);
     }
     catch(std::exception & e)
@@ -86,7 +86,7 @@ CDeviceBuilder::CDeviceBuilder(std::string filename)
 
     BOOST_FOREACH(ptree::value_type & type, device_xml)
     {
-        Logger.Debug << "Processing the next device class..." << std::endl;
+        FREEDM_LOG_DEBUG(Logger) << "Processing the next device class..." << std::endl;
 
         if( type.first != "deviceType" )
         {
@@ -122,17 +122,17 @@ CDeviceBuilder::CDeviceBuilder(std::string filename)
             {
                 if( m_type_to_info.count(value) > 0 )
                 {
-                    Logger.Error << "XML error for type " << id << std::endl;
+                    FREEDM_LOG_ERROR(Logger) << "XML error for type " << id << std::endl;
                     throw std::runtime_error("Duplicate ID: " + value);
                 }
                 info.s_type.insert(value);
-                Logger.Debug << "id = " << value << std::endl;
+                FREEDM_LOG_DEBUG(Logger) << "id = " << value << std::endl;
             }
             else if( header == "extends" )
             {
                 if( info.s_type.count(value) > 0 )
                 {
-                    Logger.Error << "XML error for type " << id << std::endl;
+                    FREEDM_LOG_ERROR(Logger) << "XML error for type " << id << std::endl;
                     throw std::runtime_error("Duplicate Extend: " + value);
                 }
                 if( m_type_to_info.count(value) == 0 )
@@ -140,17 +140,17 @@ CDeviceBuilder::CDeviceBuilder(std::string filename)
                     vars.s_undefined_type.insert(value);
                 }
                 info.s_type.insert(value);
-                Logger.Debug << "type = " << value << std::endl;
+                FREEDM_LOG_DEBUG(Logger) << "type = " << value << std::endl;
             }
             else if( header == "state" )
             {
                 if( info.s_state.count(value) > 0 )
                 {
-                    Logger.Error << "XML error for type " << id << std::endl;
+                    FREEDM_LOG_ERROR(Logger) << "XML error for type " << id << std::endl;
                     throw std::runtime_error("Duplicate State: " + value);
                 }
                 info.s_state.insert(value);
-                Logger.Debug << "state = " << value << std::endl;
+                FREEDM_LOG_DEBUG(Logger) << "state = " << value << std::endl;
 
                 // Register conflict when another type has the same state.
                 BOOST_FOREACH(map_type::value_type & i, m_type_to_info)
@@ -167,11 +167,11 @@ CDeviceBuilder::CDeviceBuilder(std::string filename)
             {
                 if( info.s_command.count(value) > 0 )
                 {
-                    Logger.Error << "XML error for type " << id << std::endl;
+                    FREEDM_LOG_ERROR(Logger) << "XML error for type " << id << std::endl;
                     throw std::runtime_error("Duplicate Command: " + value);
                 }
                 info.s_command.insert(value);
-                Logger.Debug << "command = " << value << std::endl;
+                FREEDM_LOG_DEBUG(Logger) << "command = " << value << std::endl;
 
                 // Register conflict when another type has the same command.
                 BOOST_FOREACH(map_type::value_type & i, m_type_to_info)
@@ -186,7 +186,7 @@ CDeviceBuilder::CDeviceBuilder(std::string filename)
             }
             else
             {
-                Logger.Error << "XML error for type " << id << std::endl;
+                FREEDM_LOG_ERROR(Logger) << "XML error for type " << id << std::endl;
                 throw std::runtime_error("Unknown Tag: " + value);
             }
         }
@@ -229,8 +229,8 @@ CDeviceBuilder::CDeviceBuilder(std::string filename)
 void CDeviceBuilder::ExpandInfo(std::string target, std::set<std::string> path,
         BuildVars & vars)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    Logger.Debug << "ExpandInfo on target: " << target << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_DEBUG(Logger) << "ExpandInfo on target: " << target << std::endl;
 
     typedef std::map<std::pair<std::string, std::string>, std::string> map_type;
     DeviceInfo & info = m_type_to_info.at(target);
@@ -241,7 +241,7 @@ void CDeviceBuilder::ExpandInfo(std::string target, std::set<std::string> path,
     {
         if( path.count(target) > 0 )
         {
-            Logger.Error << "Cyclic extend from " << target << std::endl;
+            FREEDM_LOG_ERROR(Logger) << "Cyclic extend from " << target << std::endl;
             throw std::runtime_error("Device XML has cyclic inheritance.");
         }
         path.insert(target);
@@ -273,7 +273,7 @@ void CDeviceBuilder::ExpandInfo(std::string target, std::set<std::string> path,
             if( info.s_type.count(t.first.first) > 0 &&
                     info.s_type.count(t.first.second) > 0 )
             {
-                Logger.Error << "Signal conflict in device type: " << target
+                FREEDM_LOG_ERROR(Logger) << "Signal conflict in device type: " << target
                         << "\nSignal Name: " << t.second << "\nDefined By: "
                         << t.first.first << " and " << t.first.second
                         << std::endl;
@@ -319,7 +319,7 @@ DeviceInfo CDeviceBuilder::GetDeviceInfo(std::string type)
 CDevice::Pointer CDeviceBuilder::CreateDevice(std::string id, std::string type,
         IAdapter::Pointer adapter)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if( m_type_to_info.count(type) == 0 )
     {
@@ -60,7 +60,7 @@ CLocalLogger Logger(__FILE__);
 ///////////////////////////////////////////////////////////////////////////////
 CDeviceManager & CDeviceManager::Instance()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     static CDeviceManager instance;
     return instance;
 }
@@ -75,7 +75,7 @@ CDeviceManager & CDeviceManager::Instance()
 ///////////////////////////////////////////////////////////////////////////////
 CDeviceManager::CDeviceManager()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -92,7 +92,7 @@ CDeviceManager::CDeviceManager()
 ///////////////////////////////////////////////////////////////////////////////
 void CDeviceManager::AddDevice(CDevice::Pointer device)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     boost::unique_lock<boost::shared_mutex> lock(m_mutex);
 
@@ -106,7 +106,7 @@ void CDeviceManager::AddDevice(CDevice::Pointer device)
     }
 
     m_hidden_devices[device->GetID()] = device;
-    Logger.Info << "Stored " << device->GetID() << " as hidden device." << std::endl;
+    FREEDM_LOG_INFO(Logger) << "Stored " << device->GetID() << " as hidden device." << std::endl;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -121,7 +121,7 @@ void CDeviceManager::AddDevice(CDevice::Pointer device)
 ///////////////////////////////////////////////////////////////////////////////
 void CDeviceManager::RevealDevice(std::string devid)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     boost::unique_lock<boost::shared_mutex> lock(m_mutex);
 
@@ -133,7 +133,7 @@ void CDeviceManager::RevealDevice(std::string devid)
     m_devices[devid] = m_hidden_devices[devid];
     m_hidden_devices.erase(devid);
 
-    Logger.Status<< "Revealed the hidden device " << devid << std::endl;
+    FREEDM_LOG_STATUS(Logger)<< "Revealed the hidden device " << devid << std::endl;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -149,13 +149,13 @@ void CDeviceManager::RevealDevice(std::string devid)
 ///////////////////////////////////////////////////////////////////////////////
 bool CDeviceManager::RemoveDevice(std::string devid)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     boost::unique_lock<boost::shared_mutex> lock(m_mutex);
 
     if( m_devices.erase(devid) != 1 && m_hidden_devices.erase(devid) != 1 )
     {
-        Logger.Warn << "Could not remove the device " << devid << " from the "
+        FREEDM_LOG_WARN(Logger) << "Could not remove the device " << devid << " from the "
                 << " device manager: no such device exists." << std::endl;
         return false;
     }
@@ -174,7 +174,7 @@ bool CDeviceManager::RemoveDevice(std::string devid)
 ///////////////////////////////////////////////////////////////////////////////
 bool CDeviceManager::DeviceExists(std::string devid) const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     boost::shared_lock<boost::shared_mutex> lock(m_mutex);
     return( m_devices.count(devid) == 1 );
 }
@@ -195,7 +195,7 @@ bool CDeviceManager::DeviceExists(std::string devid) const
 ///////////////////////////////////////////////////////////////////////////////
 CDevice::Pointer CDeviceManager::GetDevice(std::string devid)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     boost::shared_lock<boost::shared_mutex> lock(m_mutex);
     iterator it = m_devices.find(devid);
@@ -205,7 +205,7 @@ CDevice::Pointer CDeviceManager::GetDevice(std::string devid)
     }
     else
     {
-        Logger.Warn << "Could not get the device " << devid << " from the "
+        FREEDM_LOG_WARN(Logger) << "Could not get the device " << devid << " from the "
                 << " device manager: no such device exists." << std::endl;
         return CDevice::Pointer();
     }
@@ -222,7 +222,7 @@ CDevice::Pointer CDeviceManager::GetDevice(std::string devid)
 ///////////////////////////////////////////////////////////////////////////////
 std::size_t CDeviceManager::DeviceCount() const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     boost::shared_lock<boost::shared_mutex> lock(m_mutex);
     return m_devices.size();
 }
@@ -239,7 +239,7 @@ std::size_t CDeviceManager::DeviceCount() const
 ///////////////////////////////////////////////////////////////////////////////
 std::set<CDevice::Pointer> CDeviceManager::GetDevicesOfType(std::string type)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     boost::shared_lock<boost::shared_mutex> lock(m_mutex);
     std::set<CDevice::Pointer> result;
@@ -268,7 +268,7 @@ std::set<CDevice::Pointer> CDeviceManager::GetDevicesOfType(std::string type)
 std::multiset<SignalValue> CDeviceManager::GetValues(std::string type,
         std::string signal)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     std::multiset<SignalValue> result;
 
@@ -295,7 +295,7 @@ std::multiset<SignalValue> CDeviceManager::GetValues(std::string type,
 ///////////////////////////////////////////////////////////////////////////////
 SignalValue CDeviceManager::GetNetValue(std::string type, std::string signal)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     SignalValue result = 0;
 
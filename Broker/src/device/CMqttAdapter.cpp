@@ -62,7 +62,7 @@ namespace freedm {
 
             CMqttAdapter::CMqttAdapter(std::string id, std::string address)
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
 
                 if(id.size() > 23)
@@ -80,19 +80,19 @@ namespace freedm {
 
             CMqttAdapter::~CMqttAdapter()
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
                 MQTTClient_destroy(&m_Client);
             }
 
 
             IAdapter::Pointer CMqttAdapter::Create(std::string id, std::string address) {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
                 return CMqttAdapter::Pointer(new CMqttAdapter(id, address));
             }
 
             void CMqttAdapter::Start()
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
                 MQTTClient_connectOptions connectOptions = MQTTClient_connectOptions_initializer;
                 connectOptions.keepAliveInterval = 20;
                 connectOptions.cleansession = 1;
@@ -102,7 +102,7 @@ namespace freedm {
                 if(returnCode != MQTTCLIENT_SUCCESS)
                 {
 
-                    Logger.Error << "MQTT Client Connection Failed with Return Code = " << returnCode << std::endl;
+                    FREEDM_LOG_ERROR(Logger) << "MQTT Client Connection Failed with Return Code = " << returnCode << std::endl;
 
                     throw std::runtime_error("Failed to connect to the MQTT Broker");
 
@@ -120,16 +120,16 @@ namespace freedm {
                                 std::string topic;
                                 topic = subscription + "/1/JSON";
                                 MQTTClient_subscribe(m_Client, topic.c_str(), 2);
-                                Logger.Notice << "Subscribed to MQTT topic " << topic << std::endl;
+                                FREEDM_LOG_NOTICE(Logger) << "Subscribed to MQTT topic " << topic << std::endl;
                                 topic = subscription + "/1/AOUT/#";
                                 MQTTClient_subscribe(m_Client, topic.c_str(), 2);
-                                Logger.Notice << "Subscribed to MQTT topic " << topic << std::endl;
+                                FREEDM_LOG_NOTICE(Logger) << "Subscribed to MQTT topic " << topic << std::endl;
                                 topic = subscription + "/1/DOUT/#";
                                 MQTTClient_subscribe(m_Client, topic.c_str(), 2);
-                                Logger.Notice << "Subscribed to MQTT topic " << topic << std::endl;
+                                FREEDM_LOG_NOTICE(Logger) << "Subscribed to MQTT topic " << topic << std::endl;
                                 topic = subscription+"/1/ACK";
                                 MQTTClient_subscribe(m_Client, topic.c_str(), 0);
-                                Logger.Notice << "Subscribed to MQTT topic " << topic << std::endl;
+                                FREEDM_LOG_NOTICE(Logger) << "Subscribed to MQTT topic " << topic << std::endl;
 
                                 // Publish(subscription+"/1/ACK", "ACK");
 
@@ -144,67 +144,67 @@ namespace freedm {
 
             void CMqttAdapter::Stop()
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
                 Publish("leave/DGIClient/1", "disconnect");
                 MQTTClient_disconnect(m_Client, 2000);
             }
 
             SignalValue CMqttAdapter::GetState(const std::string device, const std::string key) const
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
                 boost::lock_guard<boost::mutex> lock(m_DeviceDataLock);
                 if(m_DeviceData.count(device) != 1)
                 {
-                    Logger.Error << "Device " << device << " does not exist as an MQTT device" << std::endl;
+                    FREEDM_LOG_ERROR(Logger) << "Device " << device << " does not exist as an MQTT device" << std::endl;
                     throw std::runtime_error("Invalid Device Name");
                 }
                 if(m_DeviceData.at(device).s_SignalToValue.count(key) != 1)
                 {
-                    Logger.Error << "Device " << device << " does not have the signal " << key << std::endl;
+                    FREEDM_LOG_ERROR(Logger) << "Device " << device << " does not have the signal " << key << std::endl;
                     throw std::runtime_error("Invalid Device Signal");
                 }
                 SignalValue value = m_DeviceData.at(device).s_SignalToValue.at(key);
-                Logger.Debug << device << " " << key << ": " << value << std::endl;
+                FREEDM_LOG_DEBUG(Logger) << device << " " << key << ": " << value << std::endl;
                 return value;
             }
 
             void CMqttAdapter::SetCommand(const std::string device, const std::string key, const SignalValue value)
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
                 boost::lock_guard<boost::mutex> lock(m_DeviceDataLock);
                 if(m_DeviceData.count(device) != 1)
                 {
-                    Logger.Error << "Device " << device << " does not exist as an MQTT device" << std::endl;
+                    FREEDM_LOG_ERROR(Logger) << "Device " << device << " does not exist as an MQTT device" << std::endl;
                     throw std::runtime_error("Invalid Device Name");
                 }
                 if(m_DeviceData[device].s_SignalToValue.count(key) != 1)
                 {
-                    Logger.Error << "Device " << device << " does not have the signal " << key << std::endl;
+                    FREEDM_LOG_ERROR(Logger) << "Device " << device << " does not have the signal " << key << std::endl;
                     throw std::runtime_error("Invalid Device Signal");
                 }
                 m_DeviceData[device].s_SignalToValue[key] = value;
                 std::string strIndex = m_DeviceData[device].s_IndexReference.at(key);
                 Publish(device + "/1/" + strIndex, boost::lexical_cast<std::string>(value));
-                Logger.Info << "Sent Command " << device << "/1/" << strIndex << " = " << value << std::endl;
+                FREEDM_LOG_INFO(Logger) << "Sent Command " << device << "/1/" << strIndex << " = " << value << std::endl;
             }
 
             void CMqttAdapter::ConnectionLost(void * id, char * reason)
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-                Logger.Error << "MQTT Client " << (char *)id << " lost connection to broker: " << reason << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_ERROR(Logger) << "MQTT Client " << (char *)id << " lost connection to broker: " << reason << std::endl;
                 throw std::runtime_error("Lost Connection to the MQTT Broker");
             }
 
             int CMqttAdapter::HandleMessage(void * id, char * topic, int topicLen, MQTTClient_message * msg)
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
                 std::string strId((char *)id);
                 std::string strTopic(topic);
                 std::string message((char *)msg->payload, msg->payloadlen);
-                Logger.Status << "MQTT message received" <<topic<<":"<< message << std::endl;
+                FREEDM_LOG_STATUS(Logger) << "MQTT message received" <<topic<<":"<< message << std::endl;
                 if(topicLen != 0)
                 {
-                    Logger.Warn << "Dropped byte array topic for MQTT adapter with identifier " << strId << std::endl;
+                    FREEDM_LOG_WARN(Logger) << "Dropped byte array topic for MQTT adapter with identifier " << strId << std::endl;
                 }
                 else if(CAdapterFactory::Instance().m_adapters.count(strId) > 0)
                 {
@@ -213,7 +213,7 @@ namespace freedm {
                 }
                 else
                 {
-                    Logger.Warn << "Dropped message for missing MQTT adapter with identifier " << strId << std::endl;
+                    FREEDM_LOG_WARN(Logger) << "Dropped message for missing MQTT adapter with identifier " << strId << std::endl;
                 }
                 MQTTClient_freeMessage(&msg);
                 MQTTClient_free(topic);
@@ -222,19 +222,19 @@ namespace freedm {
 
             void CMqttAdapter::DeliveryComplete(void * id, MQTTClient_deliveryToken token)
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
                 std::string strId((char *)id);
                 std::list<CMqttMessage::Pointer>::iterator it;
                 Pointer client = boost::dynamic_pointer_cast<CMqttAdapter>(CAdapterFactory::Instance().m_adapters.at(strId));
                 for(it = client->m_MessageQueue.begin(); it != client->m_MessageQueue.end() && (*it)->GetToken() != token; it++);
                 if(it == client->m_MessageQueue.end())
                 {
-                    Logger.Error << "MQTT client " << strId << " does not recognize the token " << token << std::endl;
+                    FREEDM_LOG_ERROR(Logger) << "MQTT client " << strId << " does not recognize the token " << token << std::endl;
                     throw std::runtime_error("Unrecognized Delivery Token");
                 }
                 else
                 {
-                    Logger.Info << "MQTT client " << strId << " has delivered message " << token << std::endl;
+                    FREEDM_LOG_INFO(Logger) << "MQTT client " << strId << " has delivered message " << token << std::endl;
                     client->m_MessageQueue.erase(it);
                 }
             }
@@ -253,15 +253,15 @@ namespace freedm {
 
             void CMqttAdapter::HandleMessage(std::string topic, std::string message)
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 std::size_t index;
-                Logger.Status << "MQTT message received" <<topic<<":"<< message << std::endl;
+                FREEDM_LOG_STATUS(Logger) << "MQTT message received" <<topic<<":"<< message << std::endl;
                 if(topic.compare(0,4,"join") == 0)
                 {
 
                     std::string deviceName = split(topic,dem[0]).at(1);
-                    Logger.Status << "Received a join message for device: " << deviceName << std::endl;
+                    FREEDM_LOG_STATUS(Logger) << "Received a join message for device: " << deviceName << std::endl;
                     boost::lock_guard<boost::mutex> lock(m_DeviceDataLock);
                     if(m_DeviceData.count(deviceName) == 0)
                     {
@@ -270,7 +270,7 @@ namespace freedm {
 
                         /* if(MQTTClient_subscribe(m_Client, subscription.c_str(), 2) != MQTTCLIENT_SUCCESS)
             {
-                Logger.Error << "Failed to subscribe to the topic " << subscription << std::endl;
+                FREEDM_LOG_ERROR(Logger) << "Failed to subscribe to the topic " << subscription << std::endl;
                 throw std::runtime_error("MQTT Subscription Failure");
             }
                          */
@@ -279,7 +279,7 @@ namespace freedm {
                     }
                     else
                     {
-                        Logger.Status << "Dropped duplicate join message for device " << deviceName << std::endl;
+                        FREEDM_LOG_STATUS(Logger) << "Dropped duplicate join message for device " << deviceName << std::endl;
                     }
                 }
                 else if(topic.compare(0,5,"leave") == 0)
@@ -287,7 +287,7 @@ namespace freedm {
 
                     std::string deviceName =  split(topic,dem[0]).at(1);
 
-                    Logger.Status << "Received a leave message for device: " << deviceName << std::endl;
+                    FREEDM_LOG_STATUS(Logger) << "Received a leave message for device: " << deviceName << std::endl;
                     boost::lock_guard<boost::mutex> lock(m_DeviceDataLock);
                     if(m_DeviceData.count(deviceName) > 0 )//remove block comments
                     {
@@ -296,7 +296,7 @@ namespace freedm {
                         // UnsubscribeAll(deviceName);
                         /*if(MQTTClient_unsubscribe(m_Client, subscription.c_str()) != MQTTCLIENT_SUCCESS)
             {
-                Logger.Error << "Failed to unsubscribe to the topic " << subscription << std::endl;
+                FREEDM_LOG_ERROR(Logger) << "Failed to unsubscribe to the topic " << subscription << std::endl;
                 throw std::runtime_error("MQTT Subscription Failure");
             }
                          */
@@ -305,7 +305,7 @@ namespace freedm {
                     }
                     else
                     {
-                        Logger.Status << "Dropped leave message for unknown device " << deviceName << std::endl;
+                        FREEDM_LOG_STATUS(Logger) << "Dropped leave message for unknown device " << deviceName << std::endl;
                     }
                 }
                 else if(topic.find("JSON") != std::string::npos)
@@ -313,11 +313,11 @@ namespace freedm {
                     std::string deviceName = split(topic,dem[0]).at(0);
                     if(CDeviceManager::Instance().DeviceExists(deviceName))
                     {
-                        Logger.Status << "Dropped JSON for duplicate device " << deviceName << std::endl;
+                        FREEDM_LOG_STATUS(Logger) << "Dropped JSON for duplicate device " << deviceName << std::endl;
                     }
                     else
                     {
-                        Logger.Status << "Received JSON for device " << deviceName << ":\n" << message << std::endl;
+                        FREEDM_LOG_STATUS(Logger) << "Received JSON for device " << deviceName << ":\n" << message << std::endl;
                         CreateDevice(deviceName, message);
                     }
                 }
@@ -335,22 +335,22 @@ namespace freedm {
                         boost::lock_guard<boost::mutex> lock(m_DeviceDataLock);
                         signal = m_DeviceData.at(device).s_IndexReference.at(signal);
                         m_DeviceData.at(device).s_SignalToValue.at(signal) = value;
-                        Logger.Status << "Received AOUT for device " <<value<<std::endl;
+                        FREEDM_LOG_STATUS(Logger) << "Received AOUT for device " <<value<<std::endl;
                     }
                     catch(std::exception & e)
                     {
-                        Logger.Warn << "Device Signal (" << device << "," << signal << ") does not exist" << std::endl;
+                        FREEDM_LOG_WARN(Logger) << "Device Signal (" << device << "," << signal << ") does not exist" << std::endl;
                     }
                 }
                 else
                 {
-                    Logger.Warn << "Dropped MQTT Message:\n" << topic << "\n" << message << std::endl;
+                    FREEDM_LOG_WARN(Logger) << "Dropped MQTT Message:\n" << topic << "\n" << message << std::endl;
                 }
             }
 
             void CMqttAdapter::Publish(std::string topic, std::string content)
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
                 CMqttMessage::Pointer msg = CMqttMessage::Create(topic, content);
                 m_MessageQueue.push_back(msg);
                 msg->Publish(m_Client);
@@ -362,16 +362,16 @@ namespace freedm {
                 std::string topic;
                 topic = deviceName+ "/1/JSON";
                 MQTTClient_subscribe(m_Client, topic.c_str(), 2);
-                Logger.Notice << "Subscribed to MQTT topic " << topic << std::endl;
+                FREEDM_LOG_NOTICE(Logger) << "Subscribed to MQTT topic " << topic << std::endl;
                 topic = deviceName + "/1/AOUT/#";
                 MQTTClient_subscribe(m_Client, topic.c_str(), 2);
-                Logger.Notice << "Subscribed to MQTT topic " << topic << std::endl;
+                FREEDM_LOG_NOTICE(Logger) << "Subscribed to MQTT topic " << topic << std::endl;
                 topic = deviceName + "/1/DOUT/#";
                 MQTTClient_subscribe(m_Client, topic.c_str(), 2);
-                Logger.Notice << "Subscribed to MQTT topic " << topic << std::endl;
+                FREEDM_LOG_NOTICE(Logger) << "Subscribed to MQTT topic " << topic << std::endl;
                 topic = deviceName+"/1/ACK";
                 MQTTClient_subscribe(m_Client, topic.c_str(), 0);
-                Logger.Notice << "Subscribed to MQTT topic " << topic << std::endl;
+                FREEDM_LOG_NOTICE(Logger) << "Subscribed to MQTT topic " << topic << std::endl;
 
 
             }
@@ -383,13 +383,13 @@ namespace freedm {
                 std::string topic;
                 topic = deviceName+ "/1/JSON";
                 MQTTClient_subscribe(m_Client, topic.c_str(), 2);
-                Logger.Notice << "UnSubscribed to MQTT topic " << topic << std::endl;
+                FREEDM_LOG_NOTICE(Logger) << "UnSubscribed to MQTT topic " << topic << std::endl;
                 topic = deviceName + "/1/AOUT/#";
                 MQTTClient_subscribe(m_Client, topic.c_str(), 2);
-                Logger.Notice << "UnSubscribed to MQTT topic " << topic << std::endl;
+                FREEDM_LOG_NOTICE(Logger) << "UnSubscribed to MQTT topic " << topic << std::endl;
                 topic = deviceName + "/1/DOUT/#";
                 MQTTClient_subscribe(m_Client, topic.c_str(), 2);
-                Logger.Notice << "UnSubscribed to MQTT topic " << topic << std::endl;
+                FREEDM_LOG_NOTICE(Logger) << "UnSubscribed to MQTT topic " << topic << std::endl;
                 // topic = deviceName+"/1/ACK";
                 // MQTTClient_subscribe(m_Client, topic.c_str(), 0);
                 //  }
@@ -397,7 +397,7 @@ namespace freedm {
 
             void CMqttAdapter::CreateDevice(std::string deviceName, std::string json)
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 boost::property_tree::ptree propertyTree;
                 std::istringstream inputStream(json);
@@ -408,9 +408,9 @@ namespace freedm {
                             {
                                 if(property.first == "DEV_CHAR" || property.first == "AOUT" || property.first == "DOUT")
                                 {
-                                    Logger.Status<< "State property ssss  " << deviceName << std::endl;
+                                    FREEDM_LOG_STATUS(Logger)<< "State property ssss  " << deviceName << std::endl;
                                     AddSignals(deviceName, property, devinfo.s_state, devinfo.s_type);
-                                    Logger.Status<< "State property " << deviceName << std::endl;
+                                    FREEDM_LOG_STATUS(Logger)<< "State property " << deviceName << std::endl;
                                 }
                                 else if(property.first == "AIN" || property.first == "DIN")
                                 {
@@ -418,7 +418,7 @@ namespace freedm {
                                 }
                                 else
                                 {
-                                    Logger.Info << "Skipped property " << property.first << std::endl;
+                                    FREEDM_LOG_INFO(Logger) << "Skipped property " << property.first << std::endl;
                                 }
                             }
                 CDevice::Pointer device = CDevice::Pointer(new CDevice(deviceName, devinfo, shared_from_this()));
@@ -428,10 +428,10 @@ namespace freedm {
 
             void CMqttAdapter::AddSignals(std::string device, boost::property_tree::ptree::value_type & ptree, std::set<std::string> & sigset, std::set<std::string> & type)
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 boost::lock_guard<boost::mutex> lock(m_DeviceDataLock);
-                Logger.Info << "Parsing the " << ptree.first << " field of the JSON for device " << device << std::endl;
+                FREEDM_LOG_INFO(Logger) << "Parsing the " << ptree.first << " field of the JSON for device " << device << std::endl;
                 BOOST_FOREACH(boost::property_tree::ptree::value_type & signal, ptree.second)
                             {
                                 std::string name, index;
@@ -445,7 +445,7 @@ namespace freedm {
                                     {
                                         std::string strval = signal.second.get<std::string>("value");
                                         type.insert(strval);
-                                        Logger.Info << "Classified device " << device << " as type " << strval << std::endl;
+                                        FREEDM_LOG_INFO(Logger) << "Classified device " << device << " as type " << strval << std::endl;
                                         continue;
                                     }
                                     name = ptree.first + "/" + name;
@@ -458,28 +458,28 @@ namespace freedm {
                                     m_DeviceData[device].s_SignalToValue[name] = value;
                                     m_DeviceData[device].s_IndexReference[name] = index;
                                     m_DeviceData[device].s_IndexReference[index] = name;
-                                    Logger.Info << "Stored (" << index << "," << name << ") = " << value << std::endl;
+                                    FREEDM_LOG_INFO(Logger) << "Stored (" << index << "," << name << ") = " << value << std::endl;
                                     if(min)
                                     {
                                         sigset.insert(name + "_minimum");
                                         m_DeviceData[device].s_SignalToValue[name + "_minimum"] = min.get();
-                                        Logger.Status << "Set its minimum value to " << min.get() << std::endl;
+                                        FREEDM_LOG_STATUS(Logger) << "Set its minimum value to " << min.get() << std::endl;
                                     }
                                     if(max)
                                     {
                                         sigset.insert(name + "_maximum");
                                         m_DeviceData[device].s_SignalToValue[name + "_maximum"] = max.get();
-                                        Logger.Status << "Set its maximum value to " << max.get() << std::endl;
+                                        FREEDM_LOG_STATUS(Logger) << "Set its maximum value to " << max.get() << std::endl;
                                     }
                                 }
                                 catch(boost::property_tree::ptree_bad_data & e)
                                 {
                                     // this happens when value cannot be set as the float conversion fails
-                                    Logger.Warn << "Dropped field " << name << " due to non-numeric type" << std::endl;
+                                    FREEDM_LOG_WARN(Logger) << "Dropped field " << name << " due to non-numeric type" << std::endl;
                                 }
                                 catch(std::exception & e)
                                 {
-                                    Logger.Error << "Unexpected format for field " << ptree.first << std::endl;
+                                    FREEDM_LOG_ERROR(Logger) << "Unexpected format for field " << ptree.first << std::endl;
                                     throw std::runtime_error("Bad Device JSON");
                                 }
                             }
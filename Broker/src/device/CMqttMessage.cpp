@@ -40,7 +40,7 @@ CLocalLogger Logger(__FILE__);
 
 CMqttMessage::CMqttMessage(std::string topic, std::string content, int qos)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     m_Topic = topic;
 
@@ -62,7 +62,7 @@ CMqttMessage::CMqttMessage(std::string topic, std::string content, int qos)
 
 CMqttMessage::~CMqttMessage()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     
     if(m_Payload != NULL)
     {
@@ -72,26 +72,26 @@ CMqttMessage::~CMqttMessage()
 
 CMqttMessage::Pointer CMqttMessage::Create(std::string topic, std::string content, int qos)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     return Pointer(new CMqttMessage(topic, content, qos));
 }
 
 const MQTTClient_deliveryToken & CMqttMessage::GetToken() const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     return m_Token;
 }
 
 void CMqttMessage::Publish(MQTTClient client)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if(MQTTClient_publishMessage(client, m_Topic.c_str(), &m_Message, &m_Token) != MQTTCLIENT_SUCCESS)
     {
-        Logger.Error << "Message on topic " << m_Topic << " with value " << m_Payload << " rejected." << std::endl;
+        FREEDM_LOG_ERROR(Logger) << "Message on topic " << m_Topic << " with value " << m_Payload << " rejected." << std::endl;
         throw std::runtime_error("Message Rejected for Publication");
     }
-    Logger.Info << m_Topic << " " << m_Payload << " sent for delivery with token " << m_Token << std::endl;
+    FREEDM_LOG_INFO(Logger) << m_Topic << " " << m_Payload << " sent for delivery with token " << m_Token << std::endl;
 
 }
 
@@ -86,7 +86,7 @@ namespace freedm {
             IAdapter::Pointer COpenDssAdapter::Create(boost::asio::io_service & service,
                                                       const boost::property_tree::ptree & ptree)
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
                 return COpenDssAdapter::Pointer(new COpenDssAdapter(service, ptree));
             }
 
@@ -108,7 +108,7 @@ namespace freedm {
                     , m_host(ptree.get<std::string>("host"))
                     , m_port(ptree.get<std::string>("port"))
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
             }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -121,12 +121,12 @@ namespace freedm {
 ////////////////////////////////////////////////////////////////////////////////
             void COpenDssAdapter::Start()
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 IBufferAdapter::Start();
                 Connect();
                 m_runTimer.expires_from_now(
-                        boost::posix_time::milliseconds(CTimings::Get("DEV_RTDS_DELAY")));
+                        CTimings::GetDuration(CTimings::DEV_RTDS_DELAY));
                 m_runTimer.async_wait(boost::bind(&COpenDssAdapter::Run, shared_from_this(),
                                                   boost::asio::placeholders::error));
             }
@@ -151,7 +151,7 @@ namespace freedm {
             char COpenDssAdapter::buffer[COpenDssAdapter::BUFFER_SIZE] = "";
             void COpenDssAdapter::Run(const boost::system::error_code & e)
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 if( e )
                 {
@@ -161,7 +161,7 @@ namespace freedm {
                     }
                     else
                     {
-                        Logger.Fatal << "Run called with error: " << e.message()
+                        FREEDM_LOG_FATAL(Logger) << "Run called with error: " << e.message()
                                      << std::endl;
                         throw boost::system::system_error(e);
                     }
@@ -169,16 +169,16 @@ namespace freedm {
                 bzero(buffer,BUFFER_SIZE-1);
                 sd = m_socket.native();
                 if(!(read(sd,buffer, BUFFER_SIZE-1))){
-                    Logger.Status<<"Error reading socket!?"<<std::endl;
+                    FREEDM_LOG_STATUS(Logger)<<"Error reading socket!?"<<std::endl;
                 }
 
                 openDss_data = buffer;
-                Logger.Status << "opendss data: " << buffer << std::endl;
+                FREEDM_LOG_STATUS(Logger) << "opendss data: " << buffer << std::endl;
 
                 //std::string command = "Bus : 1,Node1 : 2,Basekv : 88.88,Magnitude1 : 8088.8,Angle1 : 88.8, pu1 : 1.088"; // generic command should be changed
                 //sendCommand(command);    //test sendop
 
-                Logger.Status<<"command sent to openDss device"<<std::endl;
+                FREEDM_LOG_STATUS(Logger)<<"command sent to openDss device"<<std::endl;
             }
 ///////////////////////////////////////////////////////////////////////////////
 /// gets openDss data
@@ -198,7 +198,7 @@ namespace freedm {
 ////////////////////////////////////////////////////////////////////////////
             void COpenDssAdapter::Stop()
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 try
                 {
@@ -206,7 +206,7 @@ namespace freedm {
                 }
                 catch( boost::system::system_error& e)
                 {
-                    Logger.Error << "Error cancelling timer: " << e.what() << std::endl;
+                    FREEDM_LOG_ERROR(Logger) << "Error cancelling timer: " << e.what() << std::endl;
                 }
 
                 if( m_socket.is_open() )
@@ -229,9 +229,9 @@ namespace freedm {
                 n = write(sd,buffer,command.size());
 
                 if(!n) {
-                    Logger.Error<<"Error writing to socket"<<std::endl;
+                    FREEDM_LOG_ERROR(Logger)<<"Error writing to socket"<<std::endl;
                 }
-                Logger.Status<<"command sent to openDss device: "<< buffer <<std::endl;
+                FREEDM_LOG_STATUS(Logger)<<"command sent to openDss device: "<< buffer <<std::endl;
             }
 ////////////////////////////////////////////////////////////////////////////
 /// Closes the socket before destroying an object instance.
@@ -243,7 +243,7 @@ namespace freedm {
 ////////////////////////////////////////////////////////////////////////////
             COpenDssAdapter::~COpenDssAdapter()
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
             }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -258,7 +258,7 @@ namespace freedm {
 ////////////////////////////////////////////////////////////////////////////////
             void COpenDssAdapter::ReverseBytes( char * buffer, const int numBytes )
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 for( std::size_t i = 0, j = numBytes-1; i < j; i++, j-- )
                 {
@@ -282,7 +282,7 @@ namespace freedm {
 ///////////////////////////////////////////////////////////////////////////////
             void COpenDssAdapter::EndianSwapIfNeeded(std::vector<SignalValue> & v)
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
 // check endianess at compile time.  Middle-Endian not allowed
 // The parameters __BYTE_ORDER, __LITTLE_ENDIAN, __BIG_ENDIAN should
@@ -295,7 +295,7 @@ namespace freedm {
                 }
 
 #elif __BYTE_ORDER == __BIG_ENDIAN
-                Logger.Debug << "Endian swap skipped: host is big-endian." << std::endl;
+                FREEDM_LOG_DEBUG(Logger) << "Endian swap skipped: host is big-endian." << std::endl;
 #else
 #error "unsupported endianness or __BYTE_ORDER not defined"
 #endif
@@ -312,7 +312,7 @@ namespace freedm {
 ////////////////////////////////////////////////////////////////////////////////
             void COpenDssAdapter::Connect()
             {
-                Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+                FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
                 boost::asio::ip::tcp::resolver resolver(m_socket.get_io_service());
                 boost::asio::ip::tcp::resolver::query query(m_host, m_port);
@@ -336,7 +336,7 @@ namespace freedm {
                                              + std::string(boost::system::system_error(error).what()));
                 }
 
-                Logger.Status << "Opened a TCP socket connection to host " << m_host
+                FREEDM_LOG_STATUS(Logger) << "Opened a TCP socket connection to host " << m_host
                               << ":" << m_port << "." << std::endl;
             }
 
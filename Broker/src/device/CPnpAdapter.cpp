@@ -75,7 +75,7 @@ CLocalLogger Logger(__FILE__);
 IAdapter::Pointer CPnpAdapter::Create(boost::asio::io_service & service,
         boost::property_tree::ptree & p, CTcpServer::Connection client)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     return CPnpAdapter::Pointer(new CPnpAdapter(service, p, client));
 }
 
@@ -98,7 +98,7 @@ CPnpAdapter::CPnpAdapter(boost::asio::io_service & service,
     , m_client(client)
     , m_stopping(false)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     m_identifier = p.get<std::string>("identifier");
 }
@@ -113,7 +113,7 @@ CPnpAdapter::CPnpAdapter(boost::asio::io_service & service,
 ////////////////////////////////////////////////////////////////////////////////
 CPnpAdapter::~CPnpAdapter()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -126,12 +126,12 @@ CPnpAdapter::~CPnpAdapter()
 ////////////////////////////////////////////////////////////////////////////////
 void CPnpAdapter::Start()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     IBufferAdapter::Start();
 
-    m_countdown->expires_from_now(boost::posix_time::milliseconds(
-            CTimings::Get("DEV_PNP_HEARTBEAT")));
+    m_countdown->expires_from_now(
+            CTimings::GetDuration(CTimings::DEV_PNP_HEARTBEAT));
     m_countdown->async_wait(boost::bind(&CPnpAdapter::Timeout,
             shared_from_this(), boost::asio::placeholders::error));
 
@@ -148,18 +148,18 @@ void CPnpAdapter::Start()
 ////////////////////////////////////////////////////////////////////////////////
 void CPnpAdapter::Heartbeat()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
-    if( m_countdown->expires_from_now(boost::posix_time::milliseconds(
-            CTimings::Get("DEV_PNP_HEARTBEAT"))) != 0 )
+    if( m_countdown->expires_from_now(
+            CTimings::GetDuration(CTimings::DEV_PNP_HEARTBEAT)) != 0 )
     {
-        Logger.Debug << "Reset an adapter heartbeat timer." << std::endl;
+        FREEDM_LOG_DEBUG(Logger) << "Reset an adapter heartbeat timer." << std::endl;
         m_countdown->async_wait(boost::bind(&CPnpAdapter::Timeout,
                 shared_from_this(), boost::asio::placeholders::error));
     }
     else
     {
-        Logger.Warn << "The heartbeat timer has already expired." << std::endl;
+        FREEDM_LOG_WARN(Logger) << "The heartbeat timer has already expired." << std::endl;
     }
 }
 
@@ -178,7 +178,7 @@ void CPnpAdapter::Heartbeat()
 ///////////////////////////////////////////////////////////////////////////////
 void CPnpAdapter::Stop()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     // The timer is not thread safe; it must be stopped from the device thread.
     // Note that this io_service may have already been stopped if the devices
@@ -202,22 +202,22 @@ void CPnpAdapter::Stop()
 ////////////////////////////////////////////////////////////////////////////////
 void CPnpAdapter::Timeout(const boost::system::error_code & e)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if( !e )
     {
-        Logger.Status << "Removing an adapter due to timeout." << std::endl;
+        FREEDM_LOG_STATUS(Logger) << "Removing an adapter due to timeout." << std::endl;
 
         try
         {
             std::string msg;
             msg = "Error\r\nConnection closed due to timeout.\r\n\r\n";
             TimedWrite(*m_client, boost::asio::buffer(msg),
-                    CTimings::Get("DEV_SOCKET_TIMEOUT"));
+                    CTimings::Get(CTimings::DEV_SOCKET_TIMEOUT));
         }
         catch(std::exception & e)
         {
-            Logger.Info << "Failed to tell client about timeout." << std::endl;
+            FREEDM_LOG_INFO(Logger) << "Failed to tell client about timeout." << std::endl;
         }
 
         CAdapterFactory::Instance().RemoveAdapter(m_identifier);
@@ -236,7 +236,7 @@ void CPnpAdapter::Timeout(const boost::system::error_code & e)
 ////////////////////////////////////////////////////////////////////////////////
 void CPnpAdapter::StartRead()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     Heartbeat();
     m_buffer.consume(m_buffer.size());
     boost::asio::async_read_until(*m_client, m_buffer, "\r\n\r\n",
@@ -256,7 +256,7 @@ void CPnpAdapter::StartRead()
 ////////////////////////////////////////////////////////////////////////////////
 void CPnpAdapter::StartWrite()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     Heartbeat();
 
     boost::asio::async_write(*m_client, m_buffer,
@@ -277,13 +277,13 @@ void CPnpAdapter::StartWrite()
 ////////////////////////////////////////////////////////////////////////////////
 void CPnpAdapter::HandleRead(const boost::system::error_code & e)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     {
         boost::lock_guard<boost::mutex> lock(m_stoppingMutex);
         if( m_stopping || e )
         {
-            Logger.Debug << "HandleRead giving up : "
+            FREEDM_LOG_DEBUG(Logger) << "HandleRead giving up : "
                 << (m_stopping ? "received stop" : e.message()) << std::endl;
             return;
         }
@@ -299,7 +299,7 @@ void CPnpAdapter::HandleRead(const boost::system::error_code & e)
 
         packet >> header;
         data = std::string(std::istreambuf_iterator<char>(packet), end);
-        Logger.Debug << "Received " << header << " packet." << std::endl;
+        FREEDM_LOG_DEBUG(Logger) << "Received " << header << " packet." << std::endl;
 
         m_buffer.consume(m_buffer.size());
         if( header == "DeviceStates" )
@@ -317,18 +317,18 @@ void CPnpAdapter::HandleRead(const boost::system::error_code & e)
             catch(boost::bad_lexical_cast &)
             {
                 std::string str = "received non-numeric value";
-                Logger.Warn << "Corrupt state: " << str << std::endl;
+                FREEDM_LOG_WARN(Logger) << "Corrupt state: " << str << std::endl;
                 packet << "BadRequest\r\n" << str << "\r\n\r\n";
             }
             catch(EBadRequest & e)
             {
-                Logger.Warn << "Corrupt state: " << e.what() << std::endl;
+                FREEDM_LOG_WARN(Logger) << "Corrupt state: " << e.what() << std::endl;
                 packet << "BadRequest\r\n" << e.what() << "\r\n\r\n";
             }
         }
         else if( header == "PoliteDisconnect" )
         {
-            Logger.Info << "Polite Disconnect Accepted" << std::endl;
+            FREEDM_LOG_INFO(Logger) << "Polite Disconnect Accepted" << std::endl;
             packet << "PoliteDisconnect\r\nAccepted\r\n\r\n";
             m_countdown->cancel();
             {
@@ -341,15 +341,15 @@ void CPnpAdapter::HandleRead(const boost::system::error_code & e)
         {
             std::string msg = "Unknown header: " + header;
             packet << "BadRequest\r\n" << msg << "\r\n\r\n";
-            Logger.Warn << msg << std::endl;
+            FREEDM_LOG_WARN(Logger) << msg << std::endl;
         }
         StartWrite();
     }
     catch(std::exception & e)
     {
-        Logger.Info << m_identifier << " communication failed."
+        FREEDM_LOG_INFO(Logger) << m_identifier << " communication failed."
                 << std::endl;
-        Logger.Debug << "Reason: " << e.what() << std::endl;
+        FREEDM_LOG_DEBUG(Logger) << "Reason: " << e.what() << std::endl;
     }
 }
 
@@ -365,7 +365,7 @@ void CPnpAdapter::HandleRead(const boost::system::error_code & e)
 ////////////////////////////////////////////////////////////////////////////////
 void CPnpAdapter::AfterWrite(const boost::system::error_code & e)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     boost::lock_guard<boost::mutex> lock(m_stoppingMutex);
     if( !m_stopping && !e )
@@ -375,7 +375,7 @@ void CPnpAdapter::AfterWrite(const boost::system::error_code & e)
     }
     else
     {
-        Logger.Debug << "AfterWrite giving up: "
+        FREEDM_LOG_DEBUG(Logger) << "AfterWrite giving up: "
                 << (m_stopping ? "stop received" : e.message()) << std::endl;
     }
 }
@@ -393,7 +393,7 @@ void CPnpAdapter::AfterWrite(const boost::system::error_code & e)
 ////////////////////////////////////////////////////////////////////////////////
 void CPnpAdapter::ReadStatePacket(const std::string packet)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     std::map<std::size_t, SignalValue> temp;
     std::map<std::size_t, SignalValue>::iterator it, end;
@@ -404,7 +404,7 @@ void CPnpAdapter::ReadStatePacket(const std::string packet)
     std::size_t index;
     SignalValue value;
 
-    Logger.Debug << "Processing packet: " << packet;
+    FREEDM_LOG_DEBUG(Logger) << "Processing packet: " << packet;
 
     out << packet;
 
@@ -413,7 +413,7 @@ void CPnpAdapter::ReadStatePacket(const std::string packet)
         name = m_identifier + ":" + name;
         boost::replace_all(name, ".", ":");
 
-        Logger.Debug << "Parsing: " << name << " " << signal << std::endl;
+        FREEDM_LOG_DEBUG(Logger) << "Parsing: " << name << " " << signal << std::endl;
 
         DeviceSignal devsig(name, signal);
         std::string devsigstr = name + " " + signal;
@@ -459,7 +459,7 @@ void CPnpAdapter::ReadStatePacket(const std::string packet)
 ////////////////////////////////////////////////////////////////////////////////
 std::string CPnpAdapter::GetCommandPacket()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     std::map<const DeviceSignal, const std::size_t>::iterator it, end;
     std::stringstream packet;
@@ -485,7 +485,7 @@ std::string CPnpAdapter::GetCommandPacket()
 
         packet << devname << " " << signal << " " << value << "\r\n";
     }
-    Logger.Debug << "Sending packet:\n" << packet.str() << std::endl;
+    FREEDM_LOG_DEBUG(Logger) << "Sending packet:\n" << packet.str() << std::endl;
     packet << "\r\n";
     return packet.str();
 }
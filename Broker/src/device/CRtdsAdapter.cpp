@@ -85,7 +85,7 @@ CLocalLogger Logger(__FILE__);
 IAdapter::Pointer CRtdsAdapter::Create(boost::asio::io_service & service,
         const boost::property_tree::ptree & ptree)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     return CRtdsAdapter::Pointer(new CRtdsAdapter(service, ptree));
 }
 
@@ -109,7 +109,7 @@ CRtdsAdapter::CRtdsAdapter(boost::asio::io_service & io_service,
     , m_host(ptree.get<std::string>("host"))
     , m_port(ptree.get<std::string>("port"))
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -122,12 +122,12 @@ CRtdsAdapter::CRtdsAdapter(boost::asio::io_service & io_service,
 ////////////////////////////////////////////////////////////////////////////////
 void CRtdsAdapter::Start()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     IBufferAdapter::Start();
     Connect();
     m_runTimer.expires_from_now(
-            boost::posix_time::milliseconds(CTimings::Get("DEV_RTDS_DELAY")));
+            CTimings::GetDuration(CTimings::DEV_RTDS_DELAY));
     m_runTimer.async_wait(boost::bind(&CRtdsAdapter::Run, shared_from_this(),
             boost::asio::placeholders::error));
 }
@@ -157,7 +157,7 @@ void CRtdsAdapter::Start()
 ////////////////////////////////////////////////////////////////////////////////
 void CRtdsAdapter::Run(const boost::system::error_code & e)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if( e )
     {
@@ -167,7 +167,7 @@ void CRtdsAdapter::Run(const boost::system::error_code & e)
         }
         else
         {
-            Logger.Fatal << "Run called with error: " << e.message()
+            FREEDM_LOG_FATAL(Logger) << "Run called with error: " << e.message()
                     << std::endl;
             throw boost::system::system_error(e);
         }
@@ -177,25 +177,25 @@ void CRtdsAdapter::Run(const boost::system::error_code & e)
     if( !m_txBuffer.empty() )
     {
         boost::unique_lock<boost::shared_mutex> writeLock(m_txMutex);
-        Logger.Debug << "Obtained the txBuffer mutex." << std::endl;
+        FREEDM_LOG_DEBUG(Logger) << "Obtained the txBuffer mutex." << std::endl;
 
         EndianSwapIfNeeded(m_txBuffer);
         try
         {
-            Logger.Debug << "Blocking for a socket write call." << std::endl;
+            FREEDM_LOG_DEBUG(Logger) << "Blocking for a socket write call." << std::endl;
             TimedWrite(m_socket, boost::asio::buffer(m_txBuffer,
                     m_txBuffer.size() * sizeof(SignalValue)),
-                    CTimings::Get("DEV_SOCKET_TIMEOUT"));
+                    CTimings::Get(CTimings::DEV_SOCKET_TIMEOUT));
 
         }
         catch(boost::system::system_error & e)
         {
-            Logger.Fatal << "Send to FPGA failed: " << e.what();
+            FREEDM_LOG_FATAL(Logger) << "Send to FPGA failed: " << e.what();
             throw;
         }
         EndianSwapIfNeeded(m_txBuffer);
 
-        Logger.Debug << "Releasing the txBuffer mutex." << std::endl;
+        FREEDM_LOG_DEBUG(Logger) << "Releasing the txBuffer mutex." << std::endl;
     }
 
     // Receive data from FPGA next
@@ -203,18 +203,18 @@ void CRtdsAdapter::Run(const boost::system::error_code & e)
     {
         // must be a unique_lock for endian swaps
         boost::unique_lock<boost::shared_mutex> writeLock(m_rxMutex);
-        Logger.Debug << "Obtained the rxBuffer mutex." << std::endl;
+        FREEDM_LOG_DEBUG(Logger) << "Obtained the rxBuffer mutex." << std::endl;
 
         try
         {
-            Logger.Debug << "Blocking for a socket read call." << std::endl;
+            FREEDM_LOG_DEBUG(Logger) << "Blocking for a socket read call." << std::endl;
             TimedRead(m_socket, boost::asio::buffer(m_rxBuffer,
                     m_rxBuffer.size() * sizeof(SignalValue)),
-                    CTimings::Get("DEV_SOCKET_TIMEOUT"));
+                    CTimings::Get(CTimings::DEV_SOCKET_TIMEOUT));
         }
         catch (boost::system::system_error & e)
         {
-            Logger.Fatal << "Receive from FPGA failed: " << e.what();
+            FREEDM_LOG_FATAL(Logger) << "Receive from FPGA failed: " << e.what();
             throw;
         }
         EndianSwapIfNeeded(m_rxBuffer);
@@ -232,18 +232,18 @@ void CRtdsAdapter::Run(const boost::system::error_code & e)
             }
             if( m_buffer_initialized )
             {
-                Logger.Status << "Clientdata : " <<m_rxBuffer[0]<< std::endl;
+                FREEDM_LOG_STATUS(Logger) << "Clientdata : " <<m_rxBuffer[0]<< std::endl;
 
                 RevealDevices();
             }
         }
 
-        Logger.Debug << "Releasing the rxBuffer mutex." << std::endl;
+        FREEDM_LOG_DEBUG(Logger) << "Releasing the rxBuffer mutex." << std::endl;
     }
 
     // Start the timer; on timeout, this function is called again
     m_runTimer.expires_from_now(
-    boost::posix_time::milliseconds(CTimings::Get("DEV_RTDS_DELAY")));
+    CTimings::GetDuration(CTimings::DEV_RTDS_DELAY));
     m_runTimer.async_wait(boost::bind(&CRtdsAdapter::Run, shared_from_this(),
             boost::asio::placeholders::error));
 }
@@ -258,7 +258,7 @@ void CRtdsAdapter::Run(const boost::system::error_code & e)
 ////////////////////////////////////////////////////////////////////////////
 void CRtdsAdapter::Stop()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     try
     {
@@ -266,7 +266,7 @@ void CRtdsAdapter::Stop()
     }
     catch( boost::system::system_error& e)
     {
-        Logger.Error << "Error cancelling timer: " << e.what() << std::endl;
+        FREEDM_LOG_ERROR(Logger) << "Error cancelling timer: " << e.what() << std::endl;
     }
 
     if( m_socket.is_open() )
@@ -285,7 +285,7 @@ void CRtdsAdapter::Stop()
 ////////////////////////////////////////////////////////////////////////////
 CRtdsAdapter::~CRtdsAdapter()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -300,7 +300,7 @@ CRtdsAdapter::~CRtdsAdapter()
 ////////////////////////////////////////////////////////////////////////////////
 void CRtdsAdapter::ReverseBytes( char * buffer, const int numBytes )
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     for( std::size_t i = 0, j = numBytes-1; i < j; i++, j-- )
     {
@@ -324,7 +324,7 @@ void CRtdsAdapter::ReverseBytes( char * buffer, const int numBytes )
 ///////////////////////////////////////////////////////////////////////////////
 void CRtdsAdapter::EndianSwapIfNeeded(std::vector<SignalValue> & v)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
 // check endianess at compile time.  Middle-Endian not allowed
 // The parameters __BYTE_ORDER, __LITTLE_ENDIAN, __BIG_ENDIAN should
@@ -337,7 +337,7 @@ void CRtdsAdapter::EndianSwapIfNeeded(std::vector<SignalValue> & v)
     }
 
 #elif __BYTE_ORDER == __BIG_ENDIAN
-    Logger.Debug << "Endian swap skipped: host is big-endian." << std::endl;
+    FREEDM_LOG_DEBUG(Logger) << "Endian swap skipped: host is big-endian." << std::endl;
 #else
 #error "unsupported endianness or __BYTE_ORDER not defined"
 #endif
@@ -354,7 +354,7 @@ void CRtdsAdapter::EndianSwapIfNeeded(std::vector<SignalValue> & v)
 ////////////////////////////////////////////////////////////////////////////////
 void CRtdsAdapter::Connect()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     boost::asio::ip::tcp::resolver resolver(m_socket.get_io_service());
     boost::asio::ip::tcp::resolver::query query(m_host, m_port);
@@ -378,7 +378,7 @@ void CRtdsAdapter::Connect()
                 + std::string(boost::system::system_error(error).what()));
     }
 
-    Logger.Status << "Opened a TCP socket connection to host " << m_host
+    FREEDM_LOG_STATUS(Logger) << "Opened a TCP socket connection to host " << m_host
             << ":" << m_port << "." << std::endl;
 }
 
@@ -67,7 +67,7 @@ CTcpServer::CTcpServer(boost::asio::io_service & ios, unsigned short port,
     : m_acceptor(ios)
     , m_port(port)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     using boost::asio::ip::tcp;
 
@@ -83,7 +83,7 @@ CTcpServer::CTcpServer(boost::asio::io_service & ios, unsigned short port,
     m_acceptor.bind(endpoint);
     m_acceptor.listen();
 
-    Logger.Status << "Opened TCP server: " << endpoint << "." << std::endl;
+    FREEDM_LOG_STATUS(Logger) << "Opened TCP server: " << endpoint << "." << std::endl;
 
     StartAccept();
 }
@@ -98,7 +98,7 @@ CTcpServer::CTcpServer(boost::asio::io_service & ios, unsigned short port,
 ////////////////////////////////////////////////////////////////////////////////
 CTcpServer::~CTcpServer()
 {
-    Logger.Trace << hdr() << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << hdr() << __PRETTY_FUNCTION__ << std::endl;
     Stop();
 }
 
@@ -117,7 +117,7 @@ CTcpServer::~CTcpServer()
 CTcpServer::Pointer CTcpServer::Create(boost::asio::io_service & ios,
         unsigned short port, const std::string address)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     return Pointer(new CTcpServer(ios, port, address));
 }
 
@@ -132,15 +132,15 @@ CTcpServer::Pointer CTcpServer::Create(boost::asio::io_service & ios,
 ////////////////////////////////////////////////////////////////////////////////
 void CTcpServer::Stop()
 {
-    Logger.Trace << hdr() << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << hdr() << __PRETTY_FUNCTION__ << std::endl;
 
     if( m_acceptor.is_open() )
     {
-        Logger.Info << hdr() << "Closed TCP server acceptor." << std::endl;
+        FREEDM_LOG_INFO(Logger) << hdr() << "Closed TCP server acceptor." << std::endl;
         m_acceptor.close();
     }
 
-    Logger.Status << "Closed TCP server on port " << m_port << "." << std::endl;
+    FREEDM_LOG_STATUS(Logger) << "Closed TCP server on port " << m_port << "." << std::endl;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -156,7 +156,7 @@ void CTcpServer::Stop()
 ////////////////////////////////////////////////////////////////////////////////
 void CTcpServer::RegisterHandler(ConnectionHandler h)
 {
-    Logger.Trace << hdr() << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << hdr() << __PRETTY_FUNCTION__ << std::endl;
 
     if( !m_handler.empty() )
     {
@@ -170,7 +170,7 @@ void CTcpServer::RegisterHandler(ConnectionHandler h)
 
     m_handler = h;
 
-    Logger.Notice << hdr() << "Set client connection handler." << std::endl;
+    FREEDM_LOG_NOTICE(Logger) << hdr() << "Set client connection handler." << std::endl;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -183,7 +183,7 @@ void CTcpServer::RegisterHandler(ConnectionHandler h)
 ////////////////////////////////////////////////////////////////////////////////
 void CTcpServer::StartAccept()
 {
-    Logger.Trace << hdr() << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << hdr() << __PRETTY_FUNCTION__ << std::endl;
 
     if( m_acceptor.is_open() )
     {
@@ -191,7 +191,7 @@ void CTcpServer::StartAccept()
         m_acceptor.async_accept(*m_client, boost::bind(&CTcpServer::HandleAccept,
                 this, boost::asio::placeholders::error));
 
-        Logger.Info << hdr() << "Waiting for next connection." << std::endl;
+        FREEDM_LOG_INFO(Logger) << hdr() << "Waiting for next connection." << std::endl;
     }
 }
 
@@ -211,11 +211,11 @@ void CTcpServer::StartAccept()
 ////////////////////////////////////////////////////////////////////////////////
 void CTcpServer::HandleAccept(const boost::system::error_code & error)
 {
-    Logger.Trace << hdr() << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << hdr() << __PRETTY_FUNCTION__ << std::endl;
 
     if( !error )
     {
-        Logger.Info << hdr() << "Accepted new client connection." << std::endl;
+        FREEDM_LOG_INFO(Logger) << hdr() << "Accepted new client connection." << std::endl;
 
         if( m_handler.empty() )
         {
@@ -225,7 +225,7 @@ void CTcpServer::HandleAccept(const boost::system::error_code & error)
     }
     else if( error != boost::asio::error::operation_aborted )
     {
-        Logger.Warn << hdr() << "Failed to accept a client." << std::endl;
+        FREEDM_LOG_WARN(Logger) << hdr() << "Failed to accept a client." << std::endl;
     }
 }
 
@@ -46,7 +46,7 @@ CLocalLogger Logger(__FILE__);
 ////////////////////////////////////////////////////////////////////////////////
 IAdapter::IAdapter()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -59,7 +59,7 @@ IAdapter::IAdapter()
 ////////////////////////////////////////////////////////////////////////////////
 IAdapter::~IAdapter()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -73,7 +73,7 @@ IAdapter::~IAdapter()
 ////////////////////////////////////////////////////////////////////////////////
 void IAdapter::RegisterDevice(const std::string devid)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     m_devices.insert(devid);
 }
 
@@ -88,7 +88,7 @@ void IAdapter::RegisterDevice(const std::string devid)
 ////////////////////////////////////////////////////////////////////////////////
 std::set<std::string> IAdapter::GetDevices() const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     return m_devices;
 }
 
@@ -102,7 +102,7 @@ std::set<std::string> IAdapter::GetDevices() const
 ////////////////////////////////////////////////////////////////////////////////
 void IAdapter::RevealDevices()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     BOOST_FOREACH(std::string devid, m_devices)
     {
@@ -69,7 +69,7 @@ IBufferAdapter::IBufferAdapter() { }
 ///////////////////////////////////////////////////////////////////////////////
 void IBufferAdapter::Start()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     std::size_t stateSize;
     std::size_t commandSize;
@@ -148,7 +148,7 @@ void IBufferAdapter::Start()
 void IBufferAdapter::SetCommand(const std::string device, const std::string signal,
         const SignalValue value)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     const DeviceSignal devsig(device, signal);
     boost::unique_lock<boost::shared_mutex> writeLock(m_txMutex);
@@ -181,7 +181,7 @@ void IBufferAdapter::SetCommand(const std::string device, const std::string sign
 SignalValue IBufferAdapter::GetState(const std::string device,
         const std::string signal) const
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     const DeviceSignal devsig(device, signal);
     boost::shared_lock<boost::shared_mutex> readLock(m_rxMutex);
@@ -194,7 +194,7 @@ SignalValue IBufferAdapter::GetState(const std::string device,
 
     SignalValue value = m_rxBuffer.at(m_stateInfo.find(devsig)->second);
 
-    Logger.Debug << device << " " << signal << ": " << value << std::endl;
+    FREEDM_LOG_DEBUG(Logger) << device << " " << signal << ": " << value << std::endl;
 
     return value;
 }
@@ -217,7 +217,7 @@ SignalValue IBufferAdapter::GetState(const std::string device,
 void IBufferAdapter::RegisterStateInfo(const std::string device,
         const std::string signal, const std::size_t index )
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     DeviceSignal devsig(device, signal);
 
     if( device.empty() || signal.empty() )
@@ -247,7 +247,7 @@ void IBufferAdapter::RegisterStateInfo(const std::string device,
 
     // Buffer indices start at zero, but XML indices start at one...
     m_stateInfo.insert(std::pair<DeviceSignal, std::size_t>(devsig, index-1));
-    Logger.Info << "Registered the device signal (" << device << "," << signal
+    FREEDM_LOG_INFO(Logger) << "Registered the device signal (" << device << "," << signal
             << ") as adapter state information." << std::endl;
 }
 
@@ -269,7 +269,7 @@ void IBufferAdapter::RegisterStateInfo(const std::string device,
 void IBufferAdapter::RegisterCommandInfo(const std::string device,
         const std::string signal, const std::size_t index )
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     DeviceSignal devsig(device, signal);
 
     if( device.empty() || signal.empty() )
@@ -299,7 +299,7 @@ void IBufferAdapter::RegisterCommandInfo(const std::string device,
 
     // Buffer indices start at zero, but XML indices start at one...
     m_commandInfo.insert(std::pair<DeviceSignal, std::size_t>(devsig, index-1));
-    Logger.Info << "Registered the device (" << device << "," << signal
+    FREEDM_LOG_INFO(Logger) << "Registered the device (" << device << "," << signal
             << ") as adapter command information." << std::endl;
 }
 
@@ -313,7 +313,7 @@ void IBufferAdapter::RegisterCommandInfo(const std::string device,
 ////////////////////////////////////////////////////////////////////////////////
 IBufferAdapter::~IBufferAdapter()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 }
 
 } // namespace device
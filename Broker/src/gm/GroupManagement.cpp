@@ -26,7 +26,9 @@
 #include "CBroker.hpp"
 #include "CConnection.hpp"
 #include "CConnectionManager.hpp"
+#include "CEventLog.hpp"
 #include "CGlobalPeerList.hpp"
+#include "CListener.hpp"
 #include "CLogger.hpp"
 #include "SRemoteHost.hpp"
 #include "CDeviceManager.hpp"
@@ -78,12 +80,9 @@ CLocalLogger Logger(__FILE__);
 GMAgent::GMAgent()
     : CHECK_TIMEOUT(boost::posix_time::not_a_date_time),
       TIMEOUT_TIMEOUT(boost::posix_time::not_a_date_time),
-      FID_TIMEOUT(boost::posix_time::not_a_date_time),
-      AYC_RESPONSE_TIMEOUT(boost::posix_time::milliseconds(CTimings::Get("GM_AYC_RESPONSE_TIMEOUT"))),
-      AYT_RESPONSE_TIMEOUT(boost::posix_time::milliseconds(CTimings::Get("GM_AYT_RESPONSE_TIMEOUT"))),
-      INVITE_RESPONSE_TIMEOUT(boost::posix_time::milliseconds(CTimings::Get("GM_INVITE_RESPONSE_TIMEOUT")))
+      FID_TIMEOUT(boost::posix_time::not_a_date_time)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     AddPeer(GetMe());
     m_groupsformed = 0;
     m_groupsbroken = 0;
@@ -104,7 +103,7 @@ GMAgent::GMAgent()
 ///////////////////////////////////////////////////////////////////////////////
 GMAgent::~GMAgent()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     m_UpNodes.clear();
     m_Coordinators.clear();
     m_AYCResponse.clear();
@@ -120,7 +119,7 @@ GMAgent::~GMAgent()
 ///////////////////////////////////////////////////////////////////////////////
 void GMAgent::HandleIncomingMessage(boost::shared_ptr<const ModuleMessage> msg, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if(msg->has_group_management_message())
     {
@@ -159,12 +158,12 @@ void GMAgent::HandleIncomingMessage(boost::shared_ptr<const ModuleMessage> msg,
         }
         else
         {
-            Logger.Warn << "Dropped gm message of unexpected type:\n" << msg->DebugString();
+            FREEDM_LOG_WARN(Logger) << "Dropped gm message of unexpected type:\n" << msg->DebugString();
         }
     }
     else
     {
-        Logger.Warn << "Dropped message of unexpected type:\n" << msg->DebugString();
+        FREEDM_LOG_WARN(Logger) << "Dropped message of unexpected type:\n" << msg->DebugString();
     }
 }
 
@@ -176,15 +175,16 @@ void GMAgent::HandleIncomingMessage(boost::shared_ptr<const ModuleMessage> msg,
 /// @return A GroupManagementMessage with the contents of an Are You Coordinator Message.
 /// @limitations: Can only author messages from this node.
 ///////////////////////////////////////////////////////////////////////////////
-ModuleMessage GMAgent::AreYouCoordinator()
+const ModuleMessage& GMAgent::AreYouCoordinator()
 {
     static google::protobuf::uint32 id = 0;
-    GroupManagementMessage gmm;
-    AreYouCoordinatorMessage* aycm = gmm.mutable_are_you_coordinator_message();
+    ModuleMessage& mm = NewMessage("gm");
+    GroupManagementMessage* gmm = mm.mutable_group_management_message();
+    AreYouCoordinatorMessage* aycm = gmm->mutable_are_you_coordinator_message();
     aycm->set_sequence_no(id);
-    Logger.Debug<<"Generated AYC : "<<id<<std::endl;
+    FREEDM_LOG_DEBUG(Logger)<<"Generated AYC : "<<id<<std::endl;
     id++;
-    return PrepareForSending(gmm);
+    return mm;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -195,16 +195,17 @@ ModuleMessage GMAgent::AreYouCoordinator()
 /// @post No change
 /// @return A GroupManagementMessage with the contents of a Invitation message.
 ///////////////////////////////////////////////////////////////////////////////
-ModuleMessage GMAgent::Invitation()
+const ModuleMessage& GMAgent::Invitation()
 {
-    GroupManagementMessage gmm;
-    InviteMessage* im = gmm.mutable_invite_message();
+    ModuleMessage& mm = NewMessage("gm");
+    GroupManagementMessage* gmm = mm.mutable_group_management_message();
+    InviteMessage* im = gmm->mutable_invite_message();
     im->set_group_id(m_GroupID);
     im->set_group_leader_uuid(m_GroupLeader);
     CPeerNode p = GetPeer(m_GroupLeader);
     im->set_group_leader_host(p.GetHostname());
     im->set_group_leader_port(p.GetPort());
-    return PrepareForSending(gmm);
+    return mm;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -216,10 +217,11 @@ ModuleMessage GMAgent::Invitation()
 /// @param seq sequence number? (?)
 /// @return A GroupManagementMessage with the contents of a Response message
 ///////////////////////////////////////////////////////////////////////////////
-ModuleMessage GMAgent::AreYouCoordinatorResponse(std::string payload,int seq)
+const ModuleMessage& GMAgent::AreYouCoordinatorResponse(std::string payload,int seq)
 {
-    GroupManagementMessage gmm;
-    AreYouCoordinatorResponseMessage* aycrm = gmm.mutable_are_you_coordinator_response_message();
+    ModuleMessage& mm = NewMessage("gm");
+    GroupManagementMessage* gmm = mm.mutable_group_management_message();
+    AreYouCoordinatorResponseMessage* aycrm = gmm->mutable_are_you_coordinator_response_message();
     aycrm->set_payload(payload);
     aycrm->set_leader_uuid(Coordinator());
     aycrm->set_leader_host(GetPeer(Coordinator()).GetHostname());
@@ -232,7 +234,7 @@ ModuleMessage GMAgent::AreYouCoordinatorResponse(std::string payload,int seq)
         fsm->set_deviceid(ptr->GetID());
         fsm->set_state((bool) ptr->GetState("state"));
     }
-    return PrepareForSending(gmm);
+    return mm;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -244,16 +246,17 @@ ModuleMessage GMAgent::AreYouCoordinatorResponse(std::string payload,int seq)
 /// @param seq sequence number? (?)
 /// @return A GroupManagementMessage with the contents of a Response message
 ///////////////////////////////////////////////////////////////////////////////
-ModuleMessage GMAgent::AreYouThereResponse(std::string payload,int seq)
+const ModuleMessage& GMAgent::AreYouThereResponse(std::string payload,int seq)
 {
-    GroupManagementMessage gmm;
-    AreYouThereResponseMessage* aytrm = gmm.mutable_are_you_there_response_message();
+    ModuleMessage& mm = NewMessage("gm");
+    GroupManagementMessage* gmm = mm.mutable_group_management_message();
+    AreYouThereResponseMessage* aytrm = gmm->mutable_are_you_there_response_message();
     aytrm->set_payload(payload);
     aytrm->set_leader_uuid(Coordinator());
     aytrm->set_leader_host(GetPeer(Coordinator()).GetHostname());
     aytrm->set_leader_port(GetPeer(Coordinator()).GetPort());
     aytrm->set_sequence_no(seq);
-    return PrepareForSending(gmm);
+    return mm;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -263,12 +266,13 @@ ModuleMessage GMAgent::AreYouThereResponse(std::string payload,int seq)
 /// @post No change.
 /// @return A GroupManagementMessage with the contents of an Accept message
 ///////////////////////////////////////////////////////////////////////////////
-ModuleMessage GMAgent::Accept()
+const ModuleMessage& GMAgent::Accept()
 {
-    GroupManagementMessage gmm;
-    AcceptMessage* am = gmm.mutable_accept_message();
+    ModuleMessage& mm = NewMessage("gm");
+    GroupManagementMessage* gmm = mm.mutable_group_management_message();
+    AcceptMessage* am = gmm->mutable_accept_message();
     am->set_group_id(m_GroupID);
-    return PrepareForSending(gmm);
+    return mm;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -278,16 +282,17 @@ ModuleMessage GMAgent::Accept()
 /// @post No Change.
 /// @return A GroupManagementMessage with the contents of an AreYouThere message
 ///////////////////////////////////////////////////////////////////////////////
-ModuleMessage GMAgent::AreYouThere()
+const ModuleMessage& GMAgent::AreYouThere()
 {
     static int id = 100000;
-    GroupManagementMessage gmm;
-    AreYouThereMessage* aytm = gmm.mutable_are_you_there_message();
+    ModuleMessage& mm = NewMessage("gm");
+    GroupManagementMessage* gmm = mm.mutable_group_management_message();
+    AreYouThereMessage* aytm = gmm->mutable_are_you_there_message();
     aytm->set_group_id(m_GroupID);
     aytm->set_sequence_no(id);
-    Logger.Debug<<"Generated AYT : "<<id<<std::endl;
+    FREEDM_LOG_DEBUG(Logger)<<"Generated AYT : "<<id<<std::endl;
     id++;
-    return PrepareForSending(gmm);
+    return mm;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -297,10 +302,11 @@ ModuleMessage GMAgent::AreYouThere()
 /// @post No Change.
 /// @return A GroupManagementMessage with the contents of group membership
 ///////////////////////////////////////////////////////////////////////////////
-ModuleMessage GMAgent::PeerList(std::string requester)
+const ModuleMessage& GMAgent::PeerList(std::string requester)
 {
-    GroupManagementMessage gmm;
-    PeerListMessage* plm = gmm.mutable_peer_list_message();
+    ModuleMessage& mm = NewMessage(requester);
+    GroupManagementMessage* gmm = mm.mutable_group_management_message();
+    PeerListMessage* plm = gmm->mutable_peer_list_message();
     BOOST_FOREACH(CPeerNode peer, m_UpNodes | boost::adaptors::map_values)
     {
         ConnectedPeerMessage* cpm = plm->add_connected_peer_message();
@@ -312,7 +318,7 @@ ModuleMessage GMAgent::PeerList(std::string requester)
     cpm->set_uuid(GetUUID());
     cpm->set_host(GetMe().GetHostname());
     cpm->set_port(GetMe().GetPort());
-    return PrepareForSending(gmm, requester);
+    return mm;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -351,7 +357,8 @@ void GMAgent::SystemState()
     {
         groupfield = 1;
     }
-    BOOST_FOREACH(CPeerNode& peer, CGlobalPeerList::instance().PeerList() | boost::adaptors::map_values)
+    boost::shared_ptr<const CGlobalPeerList::PeerSet> peers = CGlobalPeerList::instance().PeerList();
+    BOOST_FOREACH(CPeerNode peer, *peers | boost::adaptors::map_values)
     {
         nodestatus<<"Node: "<<peer.GetUUID()<<" State: ";
         if(peer.GetUUID() == GetUUID())
@@ -381,15 +388,15 @@ void GMAgent::SystemState()
 
     float* groupfloat = (float *) &groupfield;
 
-    Logger.Status<<"Group Bitfield : ";
+    FREEDM_LOG_STATUS(Logger)<<"Group Bitfield : ";
     bit = 1;
     for(int i=0; i < 32; i++)
     {
-        Logger.Status<< ((groupfield & bit)?1:0);
+        FREEDM_LOG_STATUS(Logger)<< ((groupfield & bit)?1:0);
         bit = bit << 1;
     }
-    Logger.Status<<std::endl;
-    Logger.Status<<"Group Float : "<< *groupfloat << std::endl;
+    FREEDM_LOG_STATUS(Logger)<<std::endl;
+    FREEDM_LOG_STATUS(Logger)<<"Group Float : "<< *groupfloat << std::endl;
 
     std::set<device::CDevice::Pointer> devset;
     devset = device::CDeviceManager::Instance().GetDevicesOfType("Logger");
@@ -402,7 +409,7 @@ void GMAgent::SystemState()
             GetNetValue("Fid", "state");
     nodestatus<<std::endl<<"Current Skew: "<<CGlobalConfiguration::Instance().GetClockSkew();
     nodestatus<<std::endl<<"Time left in phase: "<<CBroker::Instance().TimeRemaining()<<std::endl;
-    Logger.Status<<nodestatus.str()<<std::endl;
+    FREEDM_LOG_STATUS(Logger)<<nodestatus.str()<<std::endl;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -415,14 +422,14 @@ void GMAgent::SystemState()
 ///////////////////////////////////////////////////////////////////////////////
 void GMAgent::PushPeerList()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    ModuleMessage m_ = PeerList();
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    boost::shared_ptr<const ModuleMessage> m_ = ShareMessage(PeerList());
     BOOST_FOREACH( CPeerNode peer, m_UpNodes | boost::adaptors::map_values)
     {
         peer.Send(m_);
     }
     GetMe().Send(m_);
-    Logger.Trace << __PRETTY_FUNCTION__ << "FINISH" <<    std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << "FINISH" <<    std::endl;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -436,28 +443,29 @@ void GMAgent::PushPeerList()
 ///////////////////////////////////////////////////////////////////////////////
 void GMAgent::Recovery()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     SetStatus(GMAgent::ELECTION);
-    Logger.Notice << "+ State Change ELECTION : "<<__LINE__<<std::endl;
+    FREEDM_LOG_NOTICE(Logger) << "+ State Change ELECTION : "<<__LINE__<<std::endl;
     m_GrpCounter++;
     m_GroupID = m_GrpCounter;
     m_GroupLeader = GetUUID();
-    BOOST_FOREACH(CPeerNode& peer, CGlobalPeerList::instance().PeerList() | boost::adaptors::map_values)
+    boost::shared_ptr<const CGlobalPeerList::PeerSet> peers = CGlobalPeerList::instance().PeerList();
+    BOOST_FOREACH(CPeerNode peer, *peers | boost::adaptors::map_values)
     {
         if( peer.GetUUID() == GetUUID())
             continue;
     }
-    Logger.Notice << "Changed group: "<< m_GroupID<<" ("<< m_GroupLeader <<")"<<std::endl;
+    FREEDM_LOG_NOTICE(Logger) << "Changed group: "<< m_GroupID<<" ("<< m_GroupLeader <<")"<<std::endl;
     // Empties the UpList
     m_UpNodes.clear();
     SetStatus(GMAgent::REORGANIZATION);
-    Logger.Notice << "+ State Change REORGANIZATION : "<<__LINE__<<std::endl;
+    FREEDM_LOG_NOTICE(Logger) << "+ State Change REORGANIZATION : "<<__LINE__<<std::endl;
     // Perform work assignments, etc here.
     SetStatus(GMAgent::NORMAL);
-    Logger.Notice << "+ State Change NORMAL : "<<__LINE__<<std::endl;
+    FREEDM_LOG_NOTICE(Logger) << "+ State Change NORMAL : "<<__LINE__<<std::endl;
     PushPeerList();
     // Go to work
-    Logger.Info << "TIMER: Setting CheckTimer (Check): " << __LINE__ << std::endl;
+    FREEDM_LOG_INFO(Logger) << "TIMER: Setting CheckTimer (Check): " << __LINE__ << std::endl;
     CBroker::Instance().Schedule(m_timer, CHECK_TIMEOUT,
         boost::bind(&GMAgent::Check, this, boost::asio::placeholders::error));
     // On recovery, we will reset the clock skew to 0 and start trying to synch again
@@ -475,8 +483,8 @@ void GMAgent::Recovery()
 ///////////////////////////////////////////////////////////////////////////////
 void GMAgent::Recovery( const boost::system::error_code& err )
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    Logger.Info << "RECOVERY CALL" << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_INFO(Logger) << "RECOVERY CALL" << std::endl;
     if(!err)
     {
         m_groupsbroken++;
@@ -486,7 +494,7 @@ void GMAgent::Recovery( const boost::system::error_code& err )
     {
         if(!IsCoordinator())
         {
-            Logger.Info << "TIMER: Setting TimeoutTimer (Timeout):" << __LINE__ << std::endl;
+            FREEDM_LOG_INFO(Logger) << "TIMER: Setting TimeoutTimer (Timeout):" << __LINE__ << std::endl;
             // We are not the Coordinator, we must run Timeout()
             CBroker::Instance().Schedule(m_timer, TIMEOUT_TIMEOUT,
                 boost::bind(&GMAgent::Timeout, this, boost::asio::placeholders::error));
@@ -495,7 +503,7 @@ void GMAgent::Recovery( const boost::system::error_code& err )
     else
     {
         /* An error occurred or timer was canceled */
-        Logger.Error << err << std::endl;
+        FREEDM_LOG_ERROR(Logger) << err << std::endl;
         throw boost::system::system_error(err);
     }
 }
@@ -512,7 +520,7 @@ void GMAgent::Recovery( const boost::system::error_code& err )
 ///////////////////////////////////////////////////////////////////////////////
 void GMAgent::Check( const boost::system::error_code& err )
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     if( !err )
     {
         SystemState();
@@ -522,20 +530,25 @@ void GMAgent::Check( const boost::system::error_code& err )
             // Reset and find all group leaders
             m_Coordinators.clear();
             m_AYCResponse.clear();
-            ModuleMessage m_ = AreYouCoordinator();
-            Logger.Info <<"SEND: Sending out AYC"<<std::endl;
-            BOOST_FOREACH(CPeerNode& peer, CGlobalPeerList::instance().PeerList() | boost::adaptors::map_values)
+            const ModuleMessage& m_ = AreYouCoordinator();
+            FREEDM_LOG_INFO(Logger) <<"SEND: Sending out AYC"<<std::endl;
+            // An AYC is repeated every check, so a lost multicast is harmless.
+            bool multicast = CListener::Instance().Broadcast(m_);
+            boost::shared_ptr<const CGlobalPeerList::PeerSet> peers = CGlobalPeerList::instance().PeerList();
+            BOOST_FOREACH(CPeerNode peer, *peers | boost::adaptors::map_values)
             {
                 if( peer.GetUUID() == GetUUID())
                     continue;
-                peer.Send(m_);
+                if(!multicast)
+                    peer.Send(m_);
                 InsertInTimedPeerSet(m_AYCResponse, peer, boost::posix_time::microsec_clock::universal_time());
             }
             // The AlivePeers set is no longer good, we should clear it and make them
             // Send us new messages
             // Wait for responses
-            Logger.Info << "TIMER: Setting GlobalTimer (Premerge): " << __LINE__ << std::endl;
-            CBroker::Instance().Schedule(m_timer, AYC_RESPONSE_TIMEOUT,
+            FREEDM_LOG_INFO(Logger) << "TIMER: Setting GlobalTimer (Premerge): " << __LINE__ << std::endl;
+            CBroker::Instance().Schedule(m_timer,
+                CTimings::GetDuration(CTimings::GM_AYC_RESPONSE_TIMEOUT),
                 boost::bind(&GMAgent::Premerge, this, boost::asio::placeholders::error));
         } // End if
     }
@@ -546,7 +559,7 @@ void GMAgent::Check( const boost::system::error_code& err )
     else
     {
         /* An error occurred or timer was canceled */
-        Logger.Error << err << std::endl;
+        FREEDM_LOG_ERROR(Logger) << err << std::endl;
         throw boost::system::system_error(err);
     }
 }
@@ -562,7 +575,7 @@ void GMAgent::Check( const boost::system::error_code& err )
 ///////////////////////////////////////////////////////////////////////////////
 void GMAgent::Premerge( const boost::system::error_code &err )
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     if(!IsCoordinator())
         return;
     if( !err || (boost::asio::error::operation_aborted == err ))
@@ -581,7 +594,7 @@ void GMAgent::Premerge( const boost::system::error_code &err )
             {
                 list_change = true;
                 EraseInPeerSet(m_UpNodes,peer);
-                Logger.Info << "No response from peer: "<<peer.GetUUID()<<std::endl;
+                FREEDM_LOG_INFO(Logger) << "No response from peer: "<<peer.GetUUID()<<std::endl;
             }
         }
         if(CPhysicalTopology::Instance().IsAvailable())
@@ -589,26 +602,26 @@ void GMAgent::Premerge( const boost::system::error_code &err )
             // Add my state of m_fidstate:
             std::set<device::CDevice::Pointer> attachedFIDs = 
                 device::CDeviceManager::Instance().GetDevicesOfType("Fid");
-            Logger.Notice<<"There are "<<attachedFIDs.size()<<" Attached Fids"<<std::endl;
+            FREEDM_LOG_NOTICE(Logger)<<"There are "<<attachedFIDs.size()<<" Attached Fids"<<std::endl;
             BOOST_FOREACH(device::CDevice::Pointer ptr, attachedFIDs)
             {
                 m_fidstate[ptr->GetID()] = ptr->GetState("state");
             }
             // Print out a table to debug
-            Logger.Info<<"FID Table:"<<std::endl;
+            FREEDM_LOG_INFO(Logger)<<"FID Table:"<<std::endl;
             typedef std::pair< std::string , bool > FIDPair;
             BOOST_FOREACH( const FIDPair& fid, m_fidstate )
             {
-                Logger.Info<<"(FID) "<<fid.first<<" : ";
+                FREEDM_LOG_INFO(Logger)<<"(FID) "<<fid.first<<" : ";
                 if(fid.second)
-                    Logger.Info<<"Closed"<<std::endl;
+                    FREEDM_LOG_INFO(Logger)<<"Closed"<<std::endl;
                 else
-                    Logger.Info<<"Open"<<std::endl;
+                    FREEDM_LOG_INFO(Logger)<<"Open"<<std::endl;
             }
             // Run BFS on the collected Data to make sure your group is still reachable.
             std::set<std::string> reachables = CPhysicalTopology::Instance().ReachablePeers(GetUUID(),  m_fidstate);
             std::stringstream table2;
-            Logger.Warn<<"There are "<<reachables.size()<<" reachable peers"<<std::endl;
+            FREEDM_LOG_WARN(Logger)<<"There are "<<reachables.size()<<" reachable peers"<<std::endl;
             
             std::set<std::string> unreachables;
             // Of the nodes in the m_UpNodes set, which are not in the physically reachable set?
@@ -631,12 +644,12 @@ void GMAgent::Premerge( const boost::system::error_code &err )
                 list_change = true;
                 m_UpNodes.erase(uuid);
                 m_Coordinators.erase(uuid);
-                Logger.Info << "FID state indicates "<<uuid<<" is unreachable"<<std::endl;
+                FREEDM_LOG_INFO(Logger) << "FID state indicates "<<uuid<<" is unreachable"<<std::endl;
             }
         }
         else
         {
-            Logger.Warn<<"Physical Topology not available. Groups will form using cyber topology only."<<std::endl;
+            FREEDM_LOG_WARN(Logger)<<"Physical Topology not available. Groups will form using cyber topology only."<<std::endl;
         }
         if(list_change)
         {
@@ -664,9 +677,9 @@ void GMAgent::Premerge( const boost::system::error_code &err )
                 }
             }
             float wait_val_;
-            int maxWait = CTimings::Get("GM_PREMERGE_MAX_TIMEOUT"); /* The longest a node would have to wait to Merge */
-            int minWait = CTimings::Get("GM_PREMERGE_MIN_TIMEOUT");
-            int granularity = CTimings::Get("GM_PREMERGE_GRANULARITY"); /* How finely it can slip in */
+            int maxWait = CTimings::Get(CTimings::GM_PREMERGE_MAX_TIMEOUT); /* The longest a node would have to wait to Merge */
+            int minWait = CTimings::Get(CTimings::GM_PREMERGE_MIN_TIMEOUT);
+            int granularity = CTimings::Get(CTimings::GM_PREMERGE_GRANULARITY); /* How finely it can slip in */
             int delta = ((maxWait-minWait)*1.0)/(granularity*1.0);
             if( myPriority < maxPeer_ )
                 wait_val_ = (((maxPeer_ - myPriority)%(granularity+1))*1.0)*delta+minWait;
@@ -674,13 +687,13 @@ void GMAgent::Premerge( const boost::system::error_code &err )
                 wait_val_ = 0;
             boost::posix_time::milliseconds proportional_Timeout( wait_val_ );
             /* Set deadline timer to call Merge() */
-            Logger.Notice << "TIMER: Waiting for Merge(): " << wait_val_ << " ms." << std::endl;
+            FREEDM_LOG_NOTICE(Logger) << "TIMER: Waiting for Merge(): " << wait_val_ << " ms." << std::endl;
             CBroker::Instance().Schedule(m_timer, proportional_Timeout,
                 boost::bind(&GMAgent::Merge, this, boost::asio::placeholders::error));
         }
         else
         {    // We didn't find any other Coordinators, go back to work
-            Logger.Info << "TIMER: Setting CheckTimer (Check): " << __LINE__ << std::endl;
+            FREEDM_LOG_INFO(Logger) << "TIMER: Setting CheckTimer (Check): " << __LINE__ << std::endl;
             CBroker::Instance().Schedule(m_timer, CHECK_TIMEOUT,
                 boost::bind(&GMAgent::Check, this, boost::asio::placeholders::error));
         }
@@ -688,7 +701,7 @@ void GMAgent::Premerge( const boost::system::error_code &err )
     else
     {
         // Unexpected error
-        Logger.Error << err << std::endl;
+        FREEDM_LOG_ERROR(Logger) << err << std::endl;
         throw boost::system::system_error(err);
     }
 }
@@ -709,33 +722,33 @@ void GMAgent::Premerge( const boost::system::error_code &err )
 ///////////////////////////////////////////////////////////////////////////////
 void GMAgent::Merge( const boost::system::error_code& err )
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     if(!IsCoordinator())
     {
         // Premerge made me wait. If in the waiting period I accepted someone
         // else's invitation, I am no longer a Coordinator and don't need to worry
         // about performing this anymore.
-        Logger.Notice << "Skipping Merge(): No longer a Coordinator." << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "Skipping Merge(): No longer a Coordinator." << std::endl;
         return;
     }
     if( !err )
     {
         // This proc forms a new group by inviting Coordinators in CoordinatorSet
         SetStatus(GMAgent::ELECTION);
-        Logger.Notice << "+ State Change ELECTION : "<<__LINE__<<std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "+ State Change ELECTION : "<<__LINE__<<std::endl;
         // Update GroupID
         m_GrpCounter++;
         m_GroupID = m_GrpCounter;
         m_GroupLeader = GetUUID();
         // Clear the FID state, this gives us a more accurate BFS
         m_fidstate.clear();
-        Logger.Notice << "Changed group: " << m_GroupID << " (" << m_GroupLeader << ")" << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "Changed group: " << m_GroupID << " (" << m_GroupLeader << ")" << std::endl;
         // m_UpNodes are the members of my group.
         PeerSet tempSet_ = m_UpNodes;
         m_UpNodes.clear();
         // Create new invitation and send it to all Coordinators
-        ModuleMessage m_ = Invitation();
-        Logger.Info <<"SEND: Sending out Invites (Invite Coordinators)"<<std::endl;
+        const ModuleMessage& m_ = Invitation();
+        FREEDM_LOG_INFO(Logger) <<"SEND: Sending out Invites (Invite Coordinators)"<<std::endl;
         BOOST_FOREACH( CPeerNode& peer, m_Coordinators | boost::adaptors::map_values)
         {
             if( peer.GetUUID() == GetUUID())
@@ -754,7 +767,7 @@ void GMAgent::Merge( const boost::system::error_code& err )
     }
     else
     {
-        Logger.Error << err << std::endl;
+        FREEDM_LOG_ERROR(Logger) << err << std::endl;
         throw boost::system::system_error(err);
     }
     //m_CheckTimer.expires_from_now( boost::posix_time::seconds(CHECK_TIMEOUT) );
@@ -774,14 +787,14 @@ void GMAgent::Merge( const boost::system::error_code& err )
 ///////////////////////////////////////////////////////////////////////////////
 void GMAgent::InviteGroupNodes( const boost::system::error_code& err, PeerSet p_tempSet )
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     if( !err || err == boost::asio::error::operation_aborted )
     {
         /* If the timer expired, err should be false, if canceled,
          * second condition is true.    Timer should only be canceled if
          * we are no longer waiting on more replies  */
-        ModuleMessage m_ = Invitation();
-        Logger.Info <<"SEND: Sending out Invites (Invite Group Nodes):"<<std::endl;
+        const ModuleMessage& m_ = Invitation();
+        FREEDM_LOG_INFO(Logger) <<"SEND: Sending out Invites (Invite Group Nodes):"<<std::endl;
         BOOST_FOREACH( CPeerNode& peer, p_tempSet | boost::adaptors::map_values)
         {
             if( peer.GetUUID() == GetUUID())
@@ -790,14 +803,15 @@ void GMAgent::InviteGroupNodes( const boost::system::error_code& err, PeerSet p_
         }
         if(IsCoordinator())
         {     // We only call Reorganize if we are the new leader
-            Logger.Info << "TIMER: Setting GlobalTimer (Reorganize) : " << __LINE__ << std::endl;
-            CBroker::Instance().Schedule(m_timer, INVITE_RESPONSE_TIMEOUT,
+            FREEDM_LOG_INFO(Logger) << "TIMER: Setting GlobalTimer (Reorganize) : " << __LINE__ << std::endl;
+            CBroker::Instance().Schedule(m_timer,
+                CTimings::GetDuration(CTimings::GM_INVITE_RESPONSE_TIMEOUT),
                 boost::bind(&GMAgent::Reorganize, this, boost::asio::placeholders::error));
         }
     }
     else
     {
-        Logger.Error << err << std::endl;
+        FREEDM_LOG_ERROR(Logger) << err << std::endl;
         throw boost::system::system_error(err);
     }
     return;
@@ -814,11 +828,11 @@ void GMAgent::InviteGroupNodes( const boost::system::error_code& err, PeerSet p_
 ///////////////////////////////////////////////////////////////////////////////
 void GMAgent::Reorganize( const boost::system::error_code& err )
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     if( !err )
     {
         SetStatus(GMAgent::REORGANIZATION);
-        Logger.Notice << "+ State change: REORGANIZATION: " << __LINE__    << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "+ State change: REORGANIZATION: " << __LINE__    << std::endl;
         // Send new membership list to group members
         // PeerList is the new READY
         PushPeerList();
@@ -826,16 +840,16 @@ void GMAgent::Reorganize( const boost::system::error_code& err )
         m_membershipchecks++;
         // sufficiently_long_Timeout; maybe Reorganize if something blows up
         SetStatus(GMAgent::NORMAL);
-        Logger.Notice << "+ State change: NORMAL: " << __LINE__ << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "+ State change: NORMAL: " << __LINE__ << std::endl;
         m_groupsformed++;
         // Back to work
-        Logger.Info << "TIMER: Setting CheckTimer (Check): " << __LINE__ << std::endl;
+        FREEDM_LOG_INFO(Logger) << "TIMER: Setting CheckTimer (Check): " << __LINE__ << std::endl;
         CBroker::Instance().Schedule(m_timer, CHECK_TIMEOUT,
             boost::bind(&GMAgent::Check, this, boost::asio::placeholders::error));
     }
     else
     {
-        Logger.Error << err << std::endl;
+        FREEDM_LOG_ERROR(Logger) << err << std::endl;
         throw boost::system::system_error(err);
     }
 }
@@ -850,26 +864,27 @@ void GMAgent::Reorganize( const boost::system::error_code& err )
 ///////////////////////////////////////////////////////////////////////////////
 void GMAgent::Timeout( const boost::system::error_code& err )
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     CPeerNode peer;
     if( !err )
     {
         SystemState();
         /* If we are the group leader, we don't need to run this */
-        ModuleMessage m_ = AreYouThere();
+        const ModuleMessage& m_ = AreYouThere();
         peer = GetPeer(Coordinator());
         m_AYTResponse.clear();
         if(!IsCoordinator())
         {
-            Logger.Info << "SEND: Sending AreYouThere messages." << std::endl;
+            FREEDM_LOG_INFO(Logger) << "SEND: Sending AreYouThere messages." << std::endl;
             if(peer.GetUUID() != GetUUID())
             {
                 peer.Send(m_);
-                Logger.Info << "Expecting response from "<<peer.GetUUID()<<std::endl;
+                FREEDM_LOG_INFO(Logger) << "Expecting response from "<<peer.GetUUID()<<std::endl;
                 InsertInTimedPeerSet(m_AYTResponse, peer, boost::posix_time::microsec_clock::universal_time());
             }
-            Logger.Info << "TIMER: Setting TimeoutTimer (Recovery):" << __LINE__ << std::endl;
-            CBroker::Instance().Schedule(m_timer, AYT_RESPONSE_TIMEOUT,
+            FREEDM_LOG_INFO(Logger) << "TIMER: Setting TimeoutTimer (Recovery):" << __LINE__ << std::endl;
+            CBroker::Instance().Schedule(m_timer,
+                CTimings::GetDuration(CTimings::GM_AYT_RESPONSE_TIMEOUT),
                 boost::bind(&GMAgent::Recovery, this, boost::asio::placeholders::error));
         }
     }
@@ -880,7 +895,7 @@ void GMAgent::Timeout( const boost::system::error_code& err )
     else
     {
         /* An error occurred */
-        Logger.Error << err << std::endl;
+        FREEDM_LOG_ERROR(Logger) << err << std::endl;
         throw boost::system::system_error(err);
     }
 }
@@ -896,10 +911,10 @@ PeerSet GMAgent::ProcessPeerList(const PeerListMessage& msg)
 {
     // Note: The group leader inserts himself into the peer list.
     PeerSet tmp;
-    //Logger.Debug<<"Looping Peer List"<<std::endl;
+    //FREEDM_LOG_DEBUG(Logger)<<"Looping Peer List"<<std::endl;
     BOOST_FOREACH(const ConnectedPeerMessage &cpm, msg.connected_peer_message())
     {
-        //Logger.Debug<<"Peer Item"<<std::endl;
+        //FREEDM_LOG_DEBUG(Logger)<<"Peer Item"<<std::endl;
         std::string nuuid = cpm.uuid();
         std::string nhost = cpm.host();
         std::string nport = cpm.port();
@@ -908,7 +923,7 @@ PeerSet GMAgent::ProcessPeerList(const PeerListMessage& msg)
             throw std::runtime_error(
                 "GMAgent::ProcessPeerList: invalid port: " + msg.DebugString());
         }
-        //Logger.Debug<<"Got Peer ("<<nuuid<<","<<nhost<<","<<nport<<")"<<std::endl;
+        //FREEDM_LOG_DEBUG(Logger)<<"Got Peer ("<<nuuid<<","<<nhost<<","<<nport<<")"<<std::endl;
         CPeerNode p;
         try
         {
@@ -916,7 +931,7 @@ PeerSet GMAgent::ProcessPeerList(const PeerListMessage& msg)
         }
         catch(EDgiNoSuchPeerError &e)
         {    
-            Logger.Warn<<"Adding previously unknown peer: "<<nuuid<<std::endl;
+            FREEDM_LOG_WARN(Logger)<<"Adding previously unknown peer: "<<nuuid<<std::endl;
             //If you don't already know about the peer, make sure it is in the connection manager
             CConnectionManager::Instance().PutHost(nuuid, nhost, nport);
             p = CGlobalPeerList::instance().Create(nuuid);
@@ -937,25 +952,25 @@ PeerSet GMAgent::ProcessPeerList(const PeerListMessage& msg)
 ///////////////////////////////////////////////////////////////////////////////
 void GMAgent::HandlePeerList(const PeerListMessage& msg, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     if(peer.GetUUID() == m_GroupLeader && GetStatus() == GMAgent::REORGANIZATION)
     {
         SetStatus(GMAgent::NORMAL);
-        Logger.Notice << "+ State change: NORMAL: " << __LINE__ << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "+ State change: NORMAL: " << __LINE__ << std::endl;
         m_groupsjoined++;
         // We are no longer the Coordinator, we must run Timeout()
-        Logger.Info << "TIMER: Canceling TimeoutTimer : " << __LINE__ << std::endl;
+        FREEDM_LOG_INFO(Logger) << "TIMER: Canceling TimeoutTimer : " << __LINE__ << std::endl;
         // We used to set a timeout timer here but cancelling the
         // timer should accomplish the same thing.
         CBroker::Instance().Schedule(m_timer, TIMEOUT_TIMEOUT,
             boost::bind(&GMAgent::Timeout, this, boost::asio::placeholders::error));
-        Logger.Info << "RECV: PeerList (Ready) message from " <<peer.GetUUID() << std::endl;
+        FREEDM_LOG_INFO(Logger) << "RECV: PeerList (Ready) message from " <<peer.GetUUID() << std::endl;
         m_UpNodes.clear();
         m_UpNodes = ProcessPeerList(msg);
         m_membership += m_UpNodes.size();
         m_membershipchecks++;
         m_UpNodes.erase(GetUUID());
-        Logger.Notice<<"Updated Peer Set."<<std::endl;
+        FREEDM_LOG_NOTICE(Logger)<<"Updated Peer Set."<<std::endl;
     }
     else if(peer.GetUUID() == m_GroupLeader && GetStatus() == GMAgent::NORMAL)
     {
@@ -964,7 +979,7 @@ void GMAgent::HandlePeerList(const PeerListMessage& msg, CPeerNode peer)
         m_membership = m_UpNodes.size()+1;
         m_membershipchecks++;
         m_UpNodes.erase(GetUUID());
-        Logger.Notice<<"Updated peer set (UPDATE)"<<std::endl;
+        FREEDM_LOG_NOTICE(Logger)<<"Updated peer set (UPDATE)"<<std::endl;
     }
 }
 
@@ -981,9 +996,9 @@ void GMAgent::HandlePeerList(const PeerListMessage& msg, CPeerNode peer)
 ///////////////////////////////////////////////////////////////////////////////
 void GMAgent::HandleAccept(const AcceptMessage& msg, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     unsigned int msg_group = msg.group_id();
-    Logger.Info << "RECV: Accept Message from " << peer.GetUUID() << std::endl;
+    FREEDM_LOG_INFO(Logger) << "RECV: Accept Message from " << peer.GetUUID() << std::endl;
     if(GetStatus() == GMAgent::ELECTION && msg_group == m_GroupID && IsCoordinator())
     {
         // We are holding an election, the remote peer wants to join
@@ -994,7 +1009,7 @@ void GMAgent::HandleAccept(const AcceptMessage& msg, CPeerNode peer)
     }
     else
     {
-        Logger.Warn << "Unexpected Accept message" << std::endl;
+        FREEDM_LOG_WARN(Logger) << "Unexpected Accept message" << std::endl;
     }
 }
 
@@ -1008,21 +1023,21 @@ void GMAgent::HandleAccept(const AcceptMessage& msg, CPeerNode peer)
 ///////////////////////////////////////////////////////////////////////////////
 void GMAgent::HandleAreYouCoordinator(const AreYouCoordinatorMessage& msg, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     int seq = msg.sequence_no();
-    Logger.Info << "RECV: AreYouCoordinator message from "<< peer.GetUUID() <<" seq: "<<seq<<std::endl;
+    FREEDM_LOG_INFO(Logger) << "RECV: AreYouCoordinator message from "<< peer.GetUUID() <<" seq: "<<seq<<std::endl;
     if(GetStatus() == GMAgent::NORMAL && IsCoordinator())
     {
         // We are the group Coordinator AND we are at normal operation
-        Logger.Info << "SEND: AYC Response (YES) to "<<peer.GetUUID()<<std::endl;
-        ModuleMessage m_ = AreYouCoordinatorResponse("yes",seq);
+        FREEDM_LOG_INFO(Logger) << "SEND: AYC Response (YES) to "<<peer.GetUUID()<<std::endl;
+        const ModuleMessage& m_ = AreYouCoordinatorResponse("yes",seq);
         peer.Send(m_);
     }
     else
     {
         // We are not the Coordinator OR we are not at normal operation
-        Logger.Info << "SEND: AYC Response (NO) to "<<peer.GetUUID()<<std::endl;
-        ModuleMessage m_ = AreYouCoordinatorResponse("no",seq);
+        FREEDM_LOG_INFO(Logger) << "SEND: AYC Response (NO) to "<<peer.GetUUID()<<std::endl;
+        const ModuleMessage& m_ = AreYouCoordinatorResponse("no",seq);
         peer.Send(m_);
     }
 }
@@ -1037,23 +1052,23 @@ void GMAgent::HandleAreYouCoordinator(const AreYouCoordinatorMessage& msg, CPeer
 ///////////////////////////////////////////////////////////////////////////////
 void GMAgent::HandleAreYouThere(const AreYouThereMessage& msg, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     int seq = msg.sequence_no();
-    Logger.Info << "RECV: AreYouThere message from " << peer.GetUUID()  <<" seq: "<<seq<< std::endl;
+    FREEDM_LOG_INFO(Logger) << "RECV: AreYouThere message from " << peer.GetUUID()  <<" seq: "<<seq<< std::endl;
     unsigned int msg_group = msg.group_id();
     bool ingroup = CountInPeerSet(m_UpNodes,peer);
     if(IsCoordinator() && msg_group == m_GroupID && ingroup)
     {
-        Logger.Info << "SEND: AYT Response (YES) to "<<peer.GetUUID()<<std::endl;
+        FREEDM_LOG_INFO(Logger) << "SEND: AYT Response (YES) to "<<peer.GetUUID()<<std::endl;
         // We are Coordinator, peer is in our group, and peer is up
-        ModuleMessage m_ = AreYouThereResponse("yes",seq);
+        const ModuleMessage& m_ = AreYouThereResponse("yes",seq);
         peer.Send(m_);
     }
     else
     {
-        Logger.Info << "SEND: AYT Response (NO) to "<<peer.GetUUID()<<std::endl;
+        FREEDM_LOG_INFO(Logger) << "SEND: AYT Response (NO) to "<<peer.GetUUID()<<std::endl;
         // We are not Coordinator OR peer is not in our groups OR peer is down
-        ModuleMessage m_ = AreYouThereResponse("no",seq);
+        const ModuleMessage& m_ = AreYouThereResponse("no",seq);
         peer.Send(m_);
     }
 }
@@ -1071,26 +1086,26 @@ void GMAgent::HandleAreYouThere(const AreYouThereMessage& msg, CPeerNode peer)
 ///////////////////////////////////////////////////////////////////////////////
 void GMAgent::HandleInvite(const InviteMessage& msg, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     PeerSet tempSet_;
     std::string coord_;
-    Logger.Info << "RECV: Invite message from " <<peer.GetUUID() << std::endl;
+    FREEDM_LOG_INFO(Logger) << "RECV: Invite message from " <<peer.GetUUID() << std::endl;
     if(GetStatus() == GMAgent::NORMAL)
     {
         // STOP ALL JOBS.
         coord_ = Coordinator();
         tempSet_ = m_UpNodes;
         SetStatus(GMAgent::ELECTION);
-        Logger.Notice << "+ State Change ELECTION : "<<__LINE__<<std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "+ State Change ELECTION : "<<__LINE__<<std::endl;
 
         m_GroupID = msg.group_id();
         m_GroupLeader = msg.group_leader_uuid();
-        Logger.Notice << "Changed group: " << m_GroupID << " (" << m_GroupLeader << ") " << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "Changed group: " << m_GroupID << " (" << m_GroupLeader << ") " << std::endl;
         if(coord_ == GetUUID())
         {
-            Logger.Info << "SEND: Sending invitations to former group members" << std::endl;
+            FREEDM_LOG_INFO(Logger) << "SEND: Sending invitations to former group members" << std::endl;
             // Forward invitation to all members of my group
-            ModuleMessage m_ = Invitation();
+            const ModuleMessage& m_ = Invitation();
             BOOST_FOREACH(CPeerNode peer, tempSet_ | boost::adaptors::map_values)
             {
                 if( peer.GetUUID() == GetUUID())
@@ -1098,8 +1113,8 @@ void GMAgent::HandleInvite(const InviteMessage& msg, CPeerNode peer)
                 peer.Send(m_);
             }
         }
-        ModuleMessage m_ = Accept();
-        Logger.Info << "SEND: Invitation accept to "<<peer.GetUUID()<< std::endl;
+        const ModuleMessage& m_ = Accept();
+        FREEDM_LOG_INFO(Logger) << "SEND: Invitation accept to "<<peer.GetUUID()<< std::endl;
         //Send Accept
         //If this is a forwarded invite, the source may not be where I want
         //send my accept to. Instead, we will generate it based on the groupleader
@@ -1117,15 +1132,15 @@ void GMAgent::HandleInvite(const InviteMessage& msg, CPeerNode peer)
                 throw std::runtime_error(
                     "GMAgent::HandleInvite: invalid port: " + msg.DebugString());
             }
-            Logger.Warn<<"Got invite from unknonwn peer: "<<m_GroupLeader<<". Added."<<std::endl;
+            FREEDM_LOG_WARN(Logger)<<"Got invite from unknonwn peer: "<<m_GroupLeader<<". Added."<<std::endl;
             //If you don't already know about the peer, make sure it is in the connection manager
             CConnectionManager::Instance().PutHost(m_GroupLeader, nhost, nport);
             p = CGlobalPeerList::instance().Create(m_GroupLeader);
         }
         p.Send(m_);
         SetStatus(GMAgent::REORGANIZATION);
-        Logger.Notice << "+ State Change REORGANIZATION : "<<__LINE__<<std::endl;
-        Logger.Info << "TIMER: Setting TimeoutTimer (Recovery) : " << __LINE__ << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "+ State Change REORGANIZATION : "<<__LINE__<<std::endl;
+        FREEDM_LOG_INFO(Logger) << "TIMER: Setting TimeoutTimer (Recovery) : " << __LINE__ << std::endl;
         CBroker::Instance().Schedule(m_timer, TIMEOUT_TIMEOUT,
             boost::bind(&GMAgent::Recovery, this, boost::asio::placeholders::error));
     }
@@ -1148,15 +1163,15 @@ void GMAgent::HandleInvite(const InviteMessage& msg, CPeerNode peer)
 ///////////////////////////////////////////////////////////////////////////////
 void GMAgent::HandleResponseAYC(const AreYouCoordinatorResponseMessage& msg, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     std::string answer = msg.payload();
     int seq = msg.sequence_no();
-    Logger.Info << "RECV: Response (AYC) ("<<answer<<") from " <<peer.GetUUID() << " seq "<<seq<< std::endl;
+    FREEDM_LOG_INFO(Logger) << "RECV: Response (AYC) ("<<answer<<") from " <<peer.GetUUID() << " seq "<<seq<< std::endl;
     bool expected = CountInTimedPeerSet(m_AYCResponse,peer);
     if(expected)
     {
         boost::posix_time::time_duration interval = boost::posix_time::microsec_clock::universal_time() - GetTimeFromPeerSet(m_AYCResponse, peer);
-        Logger.Info << "AYC response received " << interval << " after query sent" << std::endl;
+        FREEDM_LOG_INFO(Logger) << "AYC response received " << interval << " after query sent" << std::endl;
         //Update the states of the available FIDs
         BOOST_FOREACH(const FidStateMessage &fsm, msg.fid_state())
         {
@@ -1171,7 +1186,7 @@ void GMAgent::HandleResponseAYC(const AreYouCoordinatorResponseMessage& msg, CPe
         InsertInPeerSet(m_Coordinators,peer);
         if(m_AYCResponse.size() == 0)
         {
-            Logger.Info << "TIMER: Canceling GlobalTimer : " << __LINE__ << std::endl;
+            FREEDM_LOG_INFO(Logger) << "TIMER: Canceling GlobalTimer : " << __LINE__ << std::endl;
             //Before, we just cleared this timer. Now I'm going to set it to start another check cycle
             CBroker::Instance().Schedule(m_timer, TIMEOUT_TIMEOUT,
                 boost::bind(&GMAgent::Check, this, boost::asio::placeholders::error));
@@ -1193,7 +1208,7 @@ void GMAgent::HandleResponseAYC(const AreYouCoordinatorResponseMessage& msg, CPe
     }
     else
     {
-        Logger.Warn<< "Unsolicited AreYouCoordinator response from "<<peer.GetUUID()<< std::endl;
+        FREEDM_LOG_WARN(Logger)<< "Unsolicited AreYouCoordinator response from "<<peer.GetUUID()<< std::endl;
     }
 }
 
@@ -1209,21 +1224,21 @@ void GMAgent::HandleResponseAYC(const AreYouCoordinatorResponseMessage& msg, CPe
 ///////////////////////////////////////////////////////////////////////////////
 void GMAgent::HandleResponseAYT(const AreYouThereResponseMessage& msg, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     std::string answer = msg.payload();
     int seq = msg.sequence_no();
-    Logger.Info << "RECV: Response (AYT) ("<<answer<<") from " <<peer.GetUUID() << " seq " <<seq<<std::endl;
+    FREEDM_LOG_INFO(Logger) << "RECV: Response (AYT) ("<<answer<<") from " <<peer.GetUUID() << " seq " <<seq<<std::endl;
     bool expected = CountInTimedPeerSet(m_AYTResponse,peer);
     if(expected)
     {
         boost::posix_time::time_duration interval = boost::posix_time::microsec_clock::universal_time() - GetTimeFromPeerSet(m_AYTResponse, peer);
-        Logger.Info << "AYT response received " << interval << " after query sent" << std::endl;
+        FREEDM_LOG_INFO(Logger) << "AYT response received " << interval << " after query sent" << std::endl;
     }
 
     EraseInTimedPeerSet(m_AYTResponse,peer);
     if(expected == true && answer == "yes")
     {
-        Logger.Info << "TIMER: Setting TimeoutTimer (Timeout): " << __LINE__ << std::endl;
+        FREEDM_LOG_INFO(Logger) << "TIMER: Setting TimeoutTimer (Timeout): " << __LINE__ << std::endl;
         CBroker::Instance().Schedule(m_timer, TIMEOUT_TIMEOUT,
             boost::bind(&GMAgent::Timeout, this, boost::asio::placeholders::error));
     }
@@ -1236,7 +1251,7 @@ void GMAgent::HandleResponseAYT(const AreYouThereResponseMessage& msg, CPeerNode
     }
     else
     {
-        Logger.Warn<< "Unsolicited AreYouThere response from "<<peer.GetUUID()<<std::endl;
+        FREEDM_LOG_WARN(Logger)<< "Unsolicited AreYouThere response from "<<peer.GetUUID()<<std::endl;
     }
 }
 
@@ -1264,7 +1279,7 @@ void GMAgent::HandlePeerListQuery(const PeerListQueryMessage& msg, CPeerNode pee
 ///////////////////////////////////////////////////////////////////////////////
 CPeerNode GMAgent::AddPeer(std::string uuid)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     return CGlobalPeerList::instance().Create(uuid);
 }
 
@@ -1303,7 +1318,7 @@ CPeerNode GMAgent::GetPeer(const std::string& uuid)
 /////////////////////////////////////////////////////////
 int GMAgent::Run()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     std::map<std::string, SRemoteHost>::iterator mapIt_;
 
@@ -1311,13 +1326,14 @@ int GMAgent::Run()
         mapIt_ != CConnectionManager::Instance().GetHostsEnd(); ++mapIt_ )
     {
         std::string host_ = mapIt_->first;
-        Logger.Notice<<"Registering peer "<<mapIt_->first<<std::endl;
+        FREEDM_LOG_NOTICE(Logger)<<"Registering peer "<<mapIt_->first<<std::endl;
         AddPeer(const_cast<std::string&>(mapIt_->first));
     }
-    Logger.Notice<<"All peers added "<<CGlobalPeerList::instance().PeerList().size()<<std::endl;
-    BOOST_FOREACH(CPeerNode p_, CGlobalPeerList::instance().PeerList() | boost::adaptors::map_values)
+    boost::shared_ptr<const CGlobalPeerList::PeerSet> peers = CGlobalPeerList::instance().PeerList();
+    FREEDM_LOG_NOTICE(Logger)<<"All peers added "<<peers->size()<<std::endl;
+    BOOST_FOREACH(CPeerNode p_, *peers | boost::adaptors::map_values)
     {
-        Logger.Notice << "! " <<p_.GetUUID() << " added to peer set" <<std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "! " <<p_.GetUUID() << " added to peer set" <<std::endl;
     }
     Recovery();
     return 0;
@@ -1342,11 +1358,17 @@ int GMAgent::GetStatus() const
 ///   on establishing the status code numbers.
 /// @param status The status code to set
 /// @pre None
-/// @post The modules status code has been set to "status"
+/// @post The modules status code has been set to "status", and a change
+///   is recorded in the event log with the leader and group size.
 ////////////////////////////////////////////////////////////
 void GMAgent::SetStatus(int status)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    if(status != m_status)
+    {
+        CEventLog::Instance().StateChange(ModuleMessage::GM_MODULE, status,
+            m_status, m_GroupLeader, m_UpNodes.size());
+    }
     m_status = status;
 }
 
@@ -1363,10 +1385,10 @@ void GMAgent::SetStatus(int status)
 ModuleMessage GMAgent::PrepareForSending(
     const GroupManagementMessage& message, std::string recipient)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     ModuleMessage mm;
     mm.mutable_group_management_message()->CopyFrom(message);
-    mm.set_recipient_module(recipient);
+    SetRecipient(mm, recipient);
     return mm;
 }
 
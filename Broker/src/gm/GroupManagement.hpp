@@ -99,19 +99,19 @@ class GMAgent
 
     // Messages
     /// Creates AYC Message.
-    ModuleMessage AreYouCoordinator();
+    const ModuleMessage& AreYouCoordinator();
     /// Creates Group Invitation Message
-    ModuleMessage Invitation();
+    const ModuleMessage& Invitation();
     /// Creates A Response message
-    ModuleMessage AreYouCoordinatorResponse(std::string payload, int seq);
+    const ModuleMessage& AreYouCoordinatorResponse(std::string payload, int seq);
     /// Creates A Response message
-    ModuleMessage AreYouThereResponse(std::string payload,int seq);
+    const ModuleMessage& AreYouThereResponse(std::string payload,int seq);
     /// Creates an Accept Message
-    ModuleMessage Accept();
+    const ModuleMessage& Accept();
     /// Creates a AYT, used for Timeout
-    ModuleMessage AreYouThere();
+    const ModuleMessage& AreYouThere();
     /// Generates a peer list
-    ModuleMessage PeerList(std::string requester="all");
+    const ModuleMessage& PeerList(std::string requester="all");
     /// Generates a CMessage that can be used to query for the group
     static ModuleMessage PeerListQuery(std::string requester);
 
@@ -174,12 +174,6 @@ class GMAgent
     boost::posix_time::time_duration TIMEOUT_TIMEOUT;
     /// How long to wait before checking attached FIDs
     boost::posix_time::time_duration FID_TIMEOUT;
-    /// How long to wait for responses from other nodes.
-    boost::posix_time::time_duration AYC_RESPONSE_TIMEOUT;
-    /// How long to wait for responses from other nodes.
-    boost::posix_time::time_duration AYT_RESPONSE_TIMEOUT;
-    /// How long to wait for responses from other nodes.
-    boost::posix_time::time_duration INVITE_RESPONSE_TIMEOUT;
 
     /// Number of groups formed
     int m_groupsformed ;
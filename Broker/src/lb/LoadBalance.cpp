@@ -38,7 +38,6 @@
 ///                 LBAgent::HandlePeerList
 ///                 LBAgent::SetPStar
 ///                 LBAgent::SetDesd
-///                 LBAgent::PrepareForSending
 ///                 LBAgent::Synchronize
 ///                 LBAgent::CheckInvariant
 ///
@@ -58,12 +57,14 @@
 
 #include "LoadBalance.hpp"
 
+#include "CEventLog.hpp"
 #include "CLogger.hpp"
 #include "CTimings.hpp"
 #include "CDeviceManager.hpp"
 #include "CGlobalPeerList.hpp"
 #include "gm/GroupManagement.hpp"
 #include "CGlobalConfiguration.hpp"
+#include "Messages.hpp"
 
 #include <boost/range/adaptor/map.hpp>
 
@@ -85,10 +86,8 @@ CLocalLogger Logger(__FILE__);
 /// @limitations: None
 ///////////////////////////////////////////////////////////////////////////////
 LBAgent::LBAgent()
-    : ROUND_TIME(boost::posix_time::milliseconds(CTimings::Get("LB_ROUND_TIME")))
-    , REQUEST_TIMEOUT(boost::posix_time::milliseconds(CTimings::Get("LB_REQUEST_TIMEOUT")))
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     m_RoundTimer = CBroker::Instance().AllocateTimer("lb");
     m_WaitTimer = CBroker::Instance().AllocateTimer("lb");
@@ -117,10 +116,10 @@ LBAgent::LBAgent()
 /////////////////////////////////////////////////////////
 int LBAgent::Run()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     CBroker::Instance().Schedule(m_RoundTimer, boost::posix_time::not_a_date_time,
         boost::bind(&LBAgent::FirstRound, this, boost::asio::placeholders::error));
-    Logger.Info << "LoadManage scheduled for the next phase." << std::endl;
+    FREEDM_LOG_INFO(Logger) << "LoadManage scheduled for the next phase." << std::endl;
     return 0;
 }
 
@@ -136,7 +135,7 @@ int LBAgent::Run()
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::HandleIncomingMessage(boost::shared_ptr<const ModuleMessage> m, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if(m->has_group_management_message())
     {
@@ -148,7 +147,7 @@ void LBAgent::HandleIncomingMessage(boost::shared_ptr<const ModuleMessage> m, CP
         }
         else
         {
-            Logger.Warn << "Dropped unexpected group management message:\n" << m->DebugString();
+            FREEDM_LOG_WARN(Logger) << "Dropped unexpected group management message:\n" << m->DebugString();
         }
     }
     else if(m->has_state_collection_message())
@@ -157,12 +156,12 @@ void LBAgent::HandleIncomingMessage(boost::shared_ptr<const ModuleMessage> m, CP
     
         if(scm.has_collected_state_message())
         {
-            Logger.Debug << "Collected State: " << m->DebugString();
+            FREEDM_LOG_DEBUG(Logger) << "Collected State: " << m->DebugString();
             HandleCollectedState(scm.collected_state_message());
         }
         else
         {
-            Logger.Warn << "Dropped unexpected group management message:\n" << m->DebugString();
+            FREEDM_LOG_WARN(Logger) << "Dropped unexpected group management message:\n" << m->DebugString();
         }
     }
     else if(m->has_load_balancing_message())
@@ -199,12 +198,12 @@ void LBAgent::HandleIncomingMessage(boost::shared_ptr<const ModuleMessage> m, CP
         }
         else
         {
-            Logger.Warn << "Dropped unexpected load balance message:\n" << m->DebugString();
+            FREEDM_LOG_WARN(Logger) << "Dropped unexpected load balance message:\n" << m->DebugString();
         }
     }
     else
     {
-        Logger.Warn << "Dropped message of unexpected type:\n" << m->DebugString();
+        FREEDM_LOG_WARN(Logger) << "Dropped message of unexpected type:\n" << m->DebugString();
     }
 }
 
@@ -219,7 +218,7 @@ void LBAgent::HandleIncomingMessage(boost::shared_ptr<const ModuleMessage> m, CP
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::MoveToPeerSet(PeerSet & ps, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     EraseInPeerSet(m_InSupply, peer);
     EraseInPeerSet(m_InDemand, peer);
     EraseInPeerSet(m_InNormal, peer);
@@ -237,18 +236,20 @@ void LBAgent::MoveToPeerSet(PeerSet & ps, CPeerNode peer)
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::SendToPeerSet(const PeerSet & ps, const ModuleMessage & m)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    Logger.Info << "Sending " << m.DebugString() << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_INFO(Logger) << "Sending " << m.DebugString() << std::endl;
 
+    // Every peer gets the same message rather than its own copy.
+    boost::shared_ptr<const ModuleMessage> shared = ShareMessage(m);
     BOOST_FOREACH(CPeerNode peer, ps | boost::adaptors::map_values)
     {
         try
         {
-            peer.Send(m);
+            peer.Send(shared);
         }
         catch(boost::system::system_error & error)
         {
-            Logger.Warn << "Couldn't send message to peer";
+            FREEDM_LOG_WARN(Logger) << "Couldn't send message to peer";
         }
     }
 }
@@ -264,7 +265,7 @@ void LBAgent::SendToPeerSet(const PeerSet & ps, const ModuleMessage & m)
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::FirstRound(const boost::system::error_code & error)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if(!error)
     {
@@ -275,11 +276,11 @@ void LBAgent::FirstRound(const boost::system::error_code & error)
     }
     else if(error == boost::asio::error::operation_aborted)
     {
-        Logger.Notice << "Load Manage Aborted" << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "Load Manage Aborted" << std::endl;
     }
     else
     {
-        Logger.Error << error << std::endl;
+        FREEDM_LOG_ERROR(Logger) << error << std::endl;
         throw boost::system::system_error(error);
     }
 }
@@ -298,7 +299,7 @@ void LBAgent::FirstRound(const boost::system::error_code & error)
 /////////////////////////////////////////////////////////
 void LBAgent::LoadManage(const boost::system::error_code & error)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if(!error)
     {
@@ -316,7 +317,7 @@ void LBAgent::LoadManage(const boost::system::error_code & error)
             if(m_State == LBAgent::DEMAND)
             {
                 SendToPeerSet(m_AllPeers, MessageStateChange("demand"));
-                Logger.Notice << "Sending state change, DEMAND" << std::endl;
+                FREEDM_LOG_NOTICE(Logger) << "Sending state change, DEMAND" << std::endl;
             }
 
             if(m_Synchronized)
@@ -325,7 +326,7 @@ void LBAgent::LoadManage(const boost::system::error_code & error)
             }
             else
             {
-                Logger.Notice << "Draft Request Cancelled: state too old" << std::endl;
+                FREEDM_LOG_NOTICE(Logger) << "Draft Request Cancelled: state too old" << std::endl;
             }
         }
         else
@@ -338,11 +339,11 @@ void LBAgent::LoadManage(const boost::system::error_code & error)
     }
     else if(error == boost::asio::error::operation_aborted)
     {
-        Logger.Notice << "Load Manage Aborted" << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "Load Manage Aborted" << std::endl;
     }
     else
     {
-        Logger.Error << error << std::endl;
+        FREEDM_LOG_ERROR(Logger) << error << std::endl;
         throw boost::system::system_error(error);
     }
 }
@@ -357,19 +358,23 @@ void LBAgent::LoadManage(const boost::system::error_code & error)
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::ScheduleNextRound()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
-    if(CBroker::Instance().TimeRemaining() > ROUND_TIME + ROUND_TIME)
+    // Read each round, so a reloaded timings config takes effect.
+    boost::posix_time::time_duration round =
+        CTimings::GetDuration(CTimings::LB_ROUND_TIME);
+
+    if(CBroker::Instance().TimeRemaining() > round + round)
     {
-        CBroker::Instance().Schedule(m_RoundTimer, ROUND_TIME,
+        CBroker::Instance().Schedule(m_RoundTimer, round,
             boost::bind(&LBAgent::LoadManage, this, boost::asio::placeholders::error));
-        Logger.Info << "LoadManage scheduled in " << ROUND_TIME << " ms." << std::endl;
+        FREEDM_LOG_INFO(Logger) << "LoadManage scheduled in " << round << " ms." << std::endl;
     }
     else
     {
         CBroker::Instance().Schedule(m_RoundTimer, boost::posix_time::not_a_date_time,
             boost::bind(&LBAgent::FirstRound, this, boost::asio::placeholders::error));
-        Logger.Info << "LoadManage scheduled for the next phase." << std::endl;
+        FREEDM_LOG_INFO(Logger) << "LoadManage scheduled for the next phase." << std::endl;
     }
 }
 
@@ -381,7 +386,7 @@ void LBAgent::ScheduleNextRound()
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::ReadDevices()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     float generation = device::CDeviceManager::Instance().GetNetValue("DRER", "AOUT/Grid_Freq");//these are placeholders, it should be generation
     float storage = device::CDeviceManager::Instance().GetNetValue("DESD", "AOUT/Grid_Freq");   //these are placeholders, it should be storage
@@ -390,7 +395,7 @@ void LBAgent::ReadDevices()
     m_Gateway = device::CDeviceManager::Instance().GetNetValue("SST", "AOUT/Reactive_Pwr");     //these are placeholders, it should be gateway
     m_NetGeneration = generation + storage - load;
 
-   // Logger.Status << "NET dedsd VALUES: " << storage << " SST values" <<m_Gateway<< std::endl;
+   // FREEDM_LOG_STATUS(Logger) << "NET dedsd VALUES: " << storage << " SST values" <<m_Gateway<< std::endl;
 
     // Keeping the above changes in merge and disabling below
     // float generation = device::CDeviceManager::Instance().GetNetValue("Drer", "generation");
@@ -407,21 +412,23 @@ void LBAgent::ReadDevices()
 ///     Demand, Normal.
 /// @pre The values used such as the gateway and migration step are valid and
 ///     up to date.
-/// @post This node may change state.
+/// @post This node may change state, which is recorded in the event log.
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::UpdateState()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+
+    State previous = m_State;
 
     int sstCount = device::CDeviceManager::Instance().GetDevicesOfType("SST").size();
-    Logger.Status << "Recognize " << sstCount << " attached SST devices." << std::endl;
+    FREEDM_LOG_STATUS(Logger) << "Recognize " << sstCount << " attached SST devices." << std::endl;
 
     if(sstCount > 0 && m_NetGeneration >= m_Gateway + m_MigrationStep)
     {
         if(m_State != LBAgent::SUPPLY)
         {
             m_State = LBAgent::SUPPLY;
-            Logger.Info << "Changed to SUPPLY state." << std::endl;
+            FREEDM_LOG_INFO(Logger) << "Changed to SUPPLY state." << std::endl;
         }
     }
     else if(sstCount > 0 && m_NetGeneration <= m_Gateway - m_MigrationStep)
@@ -429,7 +436,7 @@ void LBAgent::UpdateState()
         if(m_State != LBAgent::DEMAND)
         {
             m_State = LBAgent::DEMAND;
-            Logger.Info << "Changed to DEMAND state." << std::endl;
+            FREEDM_LOG_INFO(Logger) << "Changed to DEMAND state." << std::endl;
         }
     }
     else
@@ -437,9 +444,15 @@ void LBAgent::UpdateState()
         if(m_State != LBAgent::NORMAL)
         {
             m_State = LBAgent::NORMAL;
-            Logger.Info << "Changed to NORMAL state." << std::endl;
+            FREEDM_LOG_INFO(Logger) << "Changed to NORMAL state." << std::endl;
         }
     }
+
+    if(m_State != previous)
+    {
+        CEventLog::Instance().StateChange(ModuleMessage::LB_MODULE, m_State,
+            previous, "", m_Gateway);
+    }
 }
 
 ////////////////////////////////////////////////////////////
@@ -453,7 +466,7 @@ void LBAgent::UpdateState()
 /////////////////////////////////////////////////////////
 void LBAgent::LoadTable()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     int drer_count = device::CDeviceManager::Instance().GetDevicesOfType("DRER").size();
     int desd_count = device::CDeviceManager::Instance().GetDevicesOfType("DESD").size();
@@ -472,7 +485,7 @@ void LBAgent::LoadTable()
     if (desd_count > 0) { //pub
         device::CDevice::Pointer dev1 = device::CDeviceManager::Instance().GetDevice("DESD");
         dev1->SetCommand("AIN/Active_Pwr", 8888);
-        Logger.Status << "Set command on " << dev1->GetID() << std::endl;
+        FREEDM_LOG_STATUS(Logger) << "Set command on " << dev1->GetID() << std::endl;
     }
     std::stringstream loadtable;
     loadtable << std::setprecision(2) << std::fixed;
@@ -488,7 +501,7 @@ void LBAgent::LoadTable()
     loadtable << "\tNet Generation: " << m_NetGeneration << std::endl;
     loadtable << "\tPredicted K:    " << m_PowerDifferential << std::endl;
     loadtable << "\t---------------------------------------------" << std::endl;
-    Logger.Status << "NET dedsd VALUES: " << storage << " SST values" <<m_Gateway<< std::endl;
+    FREEDM_LOG_STATUS(Logger) << "NET dedsd VALUES: " << storage << " SST values" <<m_Gateway<< std::endl;
 
     if(m_State == LBAgent::DEMAND)
     {
@@ -523,7 +536,7 @@ void LBAgent::LoadTable()
     }
 
     loadtable << "\t---------------------------------------------";
-    Logger.Status << loadtable.str() << std::endl;
+    FREEDM_LOG_STATUS(Logger) << loadtable.str() << std::endl;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -533,13 +546,14 @@ void LBAgent::LoadTable()
 /// @post Returns the new message.
 /// @param state is a string describing the new state of Load Balancing
 ///////////////////////////////////////////////////////////////////////////////
-ModuleMessage LBAgent::MessageStateChange(std::string state)
+const ModuleMessage& LBAgent::MessageStateChange(std::string state)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    LoadBalancingMessage msg;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    ModuleMessage& mm = NewMessage("lb");
+    LoadBalancingMessage& msg = *mm.mutable_load_balancing_message();
     StateChangeMessage * submsg = msg.mutable_state_change_message();
     submsg->set_state(state);
-    return PrepareForSending(msg);
+    return mm;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -556,16 +570,16 @@ ModuleMessage LBAgent::MessageStateChange(std::string state)
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::HandleStateChange(const StateChangeMessage & m, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if(CountInPeerSet(m_AllPeers, peer) == 0)
     {
-        Logger.Warn << "State from unknown peer: " << peer.GetUUID() << std::endl;
+        FREEDM_LOG_WARN(Logger) << "State from unknown peer: " << peer.GetUUID() << std::endl;
     }
     else
     {
         std::string state = m.state();
-        Logger.Info << "Received " << state << " state from " << peer.GetUUID() << std::endl;
+        FREEDM_LOG_INFO(Logger) << "Received " << state << " state from " << peer.GetUUID() << std::endl;
 
         if(state == "supply")
         {
@@ -581,7 +595,7 @@ void LBAgent::HandleStateChange(const StateChangeMessage & m, CPeerNode peer)
         }
         else
         {
-            Logger.Warn << "Bad state from peer: " << peer.GetUUID() << std::endl;
+            FREEDM_LOG_WARN(Logger) << "Bad state from peer: " << peer.GetUUID() << std::endl;
         }
     }
 }
@@ -592,12 +606,13 @@ void LBAgent::HandleStateChange(const StateChangeMessage & m, CPeerNode peer)
 /// @post A new message is generated
 /// @description Creates a new DraftRequest message.
 ///////////////////////////////////////////////////////////////////////////////
-ModuleMessage LBAgent::MessageDraftRequest()
+const ModuleMessage& LBAgent::MessageDraftRequest()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    LoadBalancingMessage msg;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    ModuleMessage& mm = NewMessage("lb");
+    LoadBalancingMessage& msg = *mm.mutable_load_balancing_message();
     msg.mutable_draft_request_message();
-    return PrepareForSending(msg);
+    return mm;
 }
 
 ////////////////////////////////////////////////////////////
@@ -608,27 +623,28 @@ ModuleMessage LBAgent::MessageDraftRequest()
 /////////////////////////////////////////////////////////
 void LBAgent::SendDraftRequest()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if(m_State != LBAgent::SUPPLY)
     {
-        Logger.Notice << "Draft Request Cancelled: not in SUPPLY" << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "Draft Request Cancelled: not in SUPPLY" << std::endl;
     }
     else if(m_InDemand.empty())
     {
-        Logger.Notice << "Draft Request Cancelled: no DEMAND" << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "Draft Request Cancelled: no DEMAND" << std::endl;
     }
     else if(!InvariantCheck())
     {
-        Logger.Notice << "Draft Request Cancelled: invariant false" << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "Draft Request Cancelled: invariant false" << std::endl;
     }
     else
     {
         SendToPeerSet(m_InDemand, MessageDraftRequest());
-        CBroker::Instance().Schedule(m_WaitTimer, REQUEST_TIMEOUT,
+        CBroker::Instance().Schedule(m_WaitTimer,
+            CTimings::GetDuration(CTimings::LB_REQUEST_TIMEOUT),
             boost::bind(&LBAgent::DraftStandard, this, boost::asio::placeholders::error));
         m_DraftAge.clear();
-        Logger.Info << "Sent Draft Request" << std::endl;
+        FREEDM_LOG_INFO(Logger) << "Sent Draft Request" << std::endl;
     }
 }
 
@@ -648,12 +664,12 @@ void LBAgent::SendDraftRequest()
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::HandleDraftRequest(const DraftRequestMessage & /*m*/, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    Logger.Info << "Draft Request from " << peer.GetUUID() << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_INFO(Logger) << "Draft Request from " << peer.GetUUID() << std::endl;
 
     if(CountInPeerSet(m_AllPeers, peer) == 0)
     {
-        Logger.Notice << "Rejected Draft Request: unknown peer" << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "Rejected Draft Request: unknown peer" << std::endl;
     }
     else
     {
@@ -668,13 +684,14 @@ void LBAgent::HandleDraftRequest(const DraftRequestMessage & /*m*/, CPeerNode pe
 /// @post A new message is generated
 /// @description Creates a new DraftAge message.
 ///////////////////////////////////////////////////////////////////////////////
-ModuleMessage LBAgent::MessageDraftAge(float age)
+const ModuleMessage& LBAgent::MessageDraftAge(float age)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    LoadBalancingMessage msg;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    ModuleMessage& mm = NewMessage("lb");
+    LoadBalancingMessage& msg = *mm.mutable_load_balancing_message();
     DraftAgeMessage * submsg = msg.mutable_draft_age_message();
     submsg->set_draft_age(age);
-    return PrepareForSending(msg);
+    return mm;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -687,23 +704,23 @@ ModuleMessage LBAgent::MessageDraftAge(float age)
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::SendDraftAge(CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     float age = 0;
     if(m_State == LBAgent::DEMAND)
     {
         age = m_Gateway - m_NetGeneration;
     }
-    Logger.Info << "Calculated Draft Age: " << age << std::endl;
+    FREEDM_LOG_INFO(Logger) << "Calculated Draft Age: " << age << std::endl;
 
     try
     {
-        peer.Send(MessageDraftAge(age));
-        Logger.Notice << "Sent Draft Age to " << peer.GetUUID() << std::endl;
+        peer.Send(ShareMessage(MessageDraftAge(age)));
+        FREEDM_LOG_NOTICE(Logger) << "Sent Draft Age to " << peer.GetUUID() << std::endl;
     }
     catch(boost::system::system_error & e)
     {
-        Logger.Warn << "Couldn't connect to peer" << std::endl;
+        FREEDM_LOG_WARN(Logger) << "Couldn't connect to peer" << std::endl;
     }
 }
 
@@ -725,16 +742,16 @@ void LBAgent::SendDraftAge(CPeerNode peer)
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::HandleDraftAge(const DraftAgeMessage & m, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if(CountInPeerSet(m_AllPeers, peer) == 0)
     {
-        Logger.Notice << "Rejected Draft Age: unknown peer" << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "Rejected Draft Age: unknown peer" << std::endl;
     }
     else
     {
         m_DraftAge[peer.GetUUID()] = m.draft_age();
-        Logger.Info << "Received draft age from " << peer.GetUUID() << std::endl;
+        FREEDM_LOG_INFO(Logger) << "Received draft age from " << peer.GetUUID() << std::endl;
     }
 }
 
@@ -748,7 +765,7 @@ void LBAgent::HandleDraftAge(const DraftAgeMessage & m, CPeerNode peer)
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::DraftStandard(const boost::system::error_code & error)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if(!error)
     {
@@ -762,7 +779,7 @@ void LBAgent::DraftStandard(const boost::system::error_code & error)
 
             if(psit == m_AllPeers.end())
             {
-                Logger.Info << "Skipped unknown peer: " << it->first << std::endl;
+                FREEDM_LOG_INFO(Logger) << "Skipped unknown peer: " << it->first << std::endl;
                 continue;
             }
 
@@ -787,11 +804,11 @@ void LBAgent::DraftStandard(const boost::system::error_code & error)
     }
     else if(error == boost::asio::error::operation_aborted)
     {
-        Logger.Notice << "Draft Standard Aborted" << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "Draft Standard Aborted" << std::endl;
     }
     else
     {
-        Logger.Error << error << std::endl;
+        FREEDM_LOG_ERROR(Logger) << error << std::endl;
         throw boost::system::system_error(error);
     }
 }
@@ -802,13 +819,14 @@ void LBAgent::DraftStandard(const boost::system::error_code & error)
 /// @pre None
 /// @post a new message is generated.
 ///////////////////////////////////////////////////////////////////////////////
-ModuleMessage LBAgent::MessageDraftSelect(float amount)
+const ModuleMessage& LBAgent::MessageDraftSelect(float amount)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    LoadBalancingMessage msg;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    ModuleMessage& mm = NewMessage("lb");
+    LoadBalancingMessage& msg = *mm.mutable_load_balancing_message();
     DraftSelectMessage * submsg = msg.mutable_draft_select_message();
     submsg->set_migrate_step(amount);
-    return PrepareForSending(msg);
+    return mm;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -819,17 +837,17 @@ ModuleMessage LBAgent::MessageDraftSelect(float amount)
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::SendDraftSelect(CPeerNode peer, float step)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     try
     {
-        peer.Send(MessageDraftSelect(step));
+        peer.Send(ShareMessage(MessageDraftSelect(step)));
         SetPStar(m_PredictedGateway + step);
         m_PowerDifferential += step;
     }
     catch(boost::system::system_error & e)
     {
-        Logger.Warn << "Couldn't connect to peer" << std::endl;
+        FREEDM_LOG_WARN(Logger) << "Couldn't connect to peer" << std::endl;
     }
 }
 
@@ -853,15 +871,15 @@ void LBAgent::SendDraftSelect(CPeerNode peer, float step)
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::HandleDraftSelect(const DraftSelectMessage & m, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if(CountInPeerSet(m_AllPeers, peer) == 0)
     {
-        Logger.Notice << "Rejected Draft Select: peer node in group" << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "Rejected Draft Select: peer node in group" << std::endl;
     }
     else if(CGlobalConfiguration::Instance().GetMaliciousFlag())
     {
-        Logger.Notice << "(MALICIOUS) Dropped draft select message." << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "(MALICIOUS) Dropped draft select message." << std::endl;
     }
     else
     {
@@ -871,17 +889,17 @@ void LBAgent::HandleDraftSelect(const DraftSelectMessage & m, CPeerNode peer)
         {
             if(m_NetGeneration <= m_PredictedGateway - amount)
             {
-                peer.Send(MessageDraftAccept(amount));
+                peer.Send(ShareMessage(MessageDraftAccept(amount)));
                 SetPStar(m_PredictedGateway - amount);
             }
             else
             {
-                peer.Send(MessageTooLate(amount));
+                peer.Send(ShareMessage(MessageTooLate(amount)));
             }
         }
         catch(boost::system::system_error & error)
         {
-            Logger.Warn << "Couldn't connect to peer" << std::endl;
+            FREEDM_LOG_WARN(Logger) << "Couldn't connect to peer" << std::endl;
         }
     }
 }
@@ -892,13 +910,14 @@ void LBAgent::HandleDraftSelect(const DraftSelectMessage & m, CPeerNode peer)
 /// @pre None
 /// @post an Accept message is generated.
 /////////////////////////////////////////////////////////////////////////////// 
-ModuleMessage LBAgent::MessageDraftAccept(float amount)
+const ModuleMessage& LBAgent::MessageDraftAccept(float amount)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    LoadBalancingMessage msg;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    ModuleMessage& mm = NewMessage("lb");
+    LoadBalancingMessage& msg = *mm.mutable_load_balancing_message();
     DraftAcceptMessage * submsg = msg.mutable_draft_accept_message();
     submsg->set_migrate_step(amount);
-    return PrepareForSending(msg);
+    return mm;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -907,13 +926,14 @@ ModuleMessage LBAgent::MessageDraftAccept(float amount)
 /// @pre None
 /// @post A too late message is generated.
 ///////////////////////////////////////////////////////////////////////////////
-ModuleMessage LBAgent::MessageTooLate(float amount)
+const ModuleMessage& LBAgent::MessageTooLate(float amount)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    LoadBalancingMessage msg;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    ModuleMessage& mm = NewMessage("lb");
+    LoadBalancingMessage& msg = *mm.mutable_load_balancing_message();
     TooLateMessage * submsg = msg.mutable_too_late_message();
     submsg->set_migrate_step(amount);
-    return PrepareForSending(msg);
+    return mm;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -931,7 +951,7 @@ ModuleMessage LBAgent::MessageTooLate(float amount)
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::HandleDraftAccept(const DraftAcceptMessage & m, CPeerNode /* peer */)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     m_PowerDifferential -= m.migrate_step();
 }
 
@@ -950,7 +970,7 @@ void LBAgent::HandleDraftAccept(const DraftAcceptMessage & m, CPeerNode /* peer
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::HandleTooLate(const TooLateMessage & m)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     SetPStar(m_PredictedGateway - m.migrate_step());
     m_PowerDifferential -= m.migrate_step();
 }
@@ -968,8 +988,8 @@ void LBAgent::HandleTooLate(const TooLateMessage & m)
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::HandlePeerList(const gm::PeerListMessage & m, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    Logger.Notice << "Updated peer list received from: " << peer.GetUUID() << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_NOTICE(Logger) << "Updated peer list received from: " << peer.GetUUID() << std::endl;
 
     m_AllPeers.clear();
     m_InSupply.clear();
@@ -981,7 +1001,7 @@ void LBAgent::HandlePeerList(const gm::PeerListMessage & m, CPeerNode peer)
     {
         if(CountInPeerSet(m_AllPeers, p) == 0 && p.GetUUID() != GetUUID())
         {
-            Logger.Debug << "Recognize new peer: " << p.GetUUID() << std::endl;
+            FREEDM_LOG_DEBUG(Logger) << "Recognize new peer: " << p.GetUUID() << std::endl;
             InsertInPeerSet(m_AllPeers, p);
             InsertInPeerSet(m_InNormal, p);
         }
@@ -999,7 +1019,7 @@ void LBAgent::HandlePeerList(const gm::PeerListMessage & m, CPeerNode peer)
 /////////////////////////////////////////////////////////
 void LBAgent::SetPStar(float pstar)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     //std::set<device::CDevice::Pointer> sstContainer;
     //sstContainer = device::CDeviceManager::Instance().GetDevicesOfType("Sst");
@@ -1014,16 +1034,16 @@ void LBAgent::SetPStar(float pstar)
     {
         if(sstContainer.size() > 1)
         {
-            Logger.Warn << "Multiple attached SST devices" << std::endl;
+            FREEDM_LOG_WARN(Logger) << "Multiple attached SST devices" << std::endl;
         }
 
         (*sstContainer.begin())->SetCommand("gateway", pstar);
         m_PredictedGateway = pstar;
-        Logger.Notice << "P* = " << pstar << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "P* = " << pstar << std::endl;
     }
     else
     {
-        Logger.Warn << "Failed to set P*: no attached SST device" << std::endl;
+        FREEDM_LOG_WARN(Logger) << "Failed to set P*: no attached SST device" << std::endl;
     }*/
 }
 
@@ -1037,7 +1057,7 @@ void LBAgent::SetPStar(float pstar)
 /////////////////////////////////////////////////////////
 void LBAgent::SetDESD(float desdv)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     std::set<device::CDevice::Pointer> desd;
     desd = device::CDeviceManager::Instance().GetDevicesOfType("DESD");
@@ -1061,41 +1081,22 @@ void LBAgent::SetDESD(float desdv)
             }
             output += "\t" + command + "\n";
         }
-        Logger.Status << output << std::endl;
+        FREEDM_LOG_STATUS(Logger) << output << std::endl;
 
         //HARD CODED BIT
 
         if(!cmd.empty())
         {
             dev->SetCommand(cmd, desdv);
-            Logger.Notice << "Desd* = " << desdv << std::endl;
+            FREEDM_LOG_NOTICE(Logger) << "Desd* = " << desdv << std::endl;
         }
     }
     else
     {
-        Logger.Warn << "Failed to set Desd: no attached Desd device" << std::endl;
+        FREEDM_LOG_WARN(Logger) << "Failed to set Desd: no attached Desd device" << std::endl;
     }
 }
 
-///////////////////////////////////////////////////////////////////////////////
-/// Wraps a LoadBalancingMessage in a ModuleMessage.
-///
-/// @param m the message to prepare. If any required field is unset,
-///                the DGI will abort.
-/// @param recipient the module (sc/lb/gm/clk etc.) the message should be
-///                delivered to
-///
-/// @return a ModuleMessage containing a copy of the LoadBalancingMessage
-///////////////////////////////////////////////////////////////////////////////
-ModuleMessage LBAgent::PrepareForSending(const LoadBalancingMessage & m, std::string recipient)
-{
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    ModuleMessage mm;
-    mm.mutable_load_balancing_message()->CopyFrom(m);
-    mm.set_recipient_module(recipient);
-    return mm;
-}
-
 ///////////////////////////////////////////////////////////////////////////////
 /// MessageStateCollection
 /// @description Returns a message which is sent to state collection requesting
@@ -1103,21 +1104,19 @@ ModuleMessage LBAgent::PrepareForSending(const LoadBalancingMessage & m, std::st
 /// @pre None
 /// @post A CollectState message is created.
 ///////////////////////////////////////////////////////////////////////////////
-ModuleMessage LBAgent::MessageStateCollection()
+const ModuleMessage& LBAgent::MessageStateCollection()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
-    sc::StateCollectionMessage msg;
-    sc::RequestMessage * submsg = msg.mutable_request_message();
+    ModuleMessage& mm = NewMessage("sc");
+    sc::RequestMessage * submsg =
+        mm.mutable_state_collection_message()->mutable_request_message();
     sc::DeviceSignalRequestMessage * subsubmsg = submsg->add_device_signal_request_message();
     submsg->set_module("lb");
     subsubmsg->set_type("SST");
     subsubmsg->set_signal("gateway");
 
-    ModuleMessage m;
-    m.mutable_state_collection_message()->CopyFrom(msg);
-    m.set_recipient_module("sc");
-    return m;
+    return mm;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1129,18 +1128,18 @@ ModuleMessage LBAgent::MessageStateCollection()
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::ScheduleStateCollection()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if(m_Leader == GetUUID())
     {
         try
         {
             CPeerNode self = CGlobalPeerList::instance().GetPeer(GetUUID());
-            self.Send(MessageStateCollection());
+            self.Send(ShareMessage(MessageStateCollection()));
         }
         catch(boost::system::system_error & error)
         {
-            Logger.Info << "Couldn't send message to peer" << std::endl;
+            FREEDM_LOG_INFO(Logger) << "Couldn't send message to peer" << std::endl;
         }
     }
 }
@@ -1159,7 +1158,7 @@ void LBAgent::ScheduleStateCollection()
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::HandleCollectedState(const sc::CollectedStateMessage & m)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     float net_power = 0;
     BOOST_FOREACH(float v, m.gateway())
@@ -1179,13 +1178,14 @@ void LBAgent::HandleCollectedState(const sc::CollectedStateMessage & m)
 /// @post returns a new message
 /// @param state the normal value to send out.
 ///////////////////////////////////////////////////////////////////////////////
-ModuleMessage LBAgent::MessageCollectedState(float state)
+const ModuleMessage& LBAgent::MessageCollectedState(float state)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    LoadBalancingMessage msg;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    ModuleMessage& mm = NewMessage("lb");
+    LoadBalancingMessage& msg = *mm.mutable_load_balancing_message();
     CollectedStateMessage * submsg = msg.mutable_collected_state_message();
     submsg->set_gross_power_flow(state);
-    return PrepareForSending(msg);
+    return mm;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1202,7 +1202,7 @@ ModuleMessage LBAgent::MessageCollectedState(float state)
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::HandleCollectedState(const CollectedStateMessage & m)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     Synchronize(m.gross_power_flow());
 }
 
@@ -1216,15 +1216,15 @@ void LBAgent::HandleCollectedState(const CollectedStateMessage & m)
 ///////////////////////////////////////////////////////////////////////////////
 void LBAgent::Synchronize(float k)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     
     ReadDevices();
     m_PowerDifferential = k;
     m_PredictedGateway = m_Gateway;
     m_Synchronized = true;
 
-    Logger.Info << "Reset Gross Power Flow: " << k << std::endl;
-    Logger.Info << "Reset Predicted Gateway: " << m_Gateway << std::endl;
+    FREEDM_LOG_INFO(Logger) << "Reset Gross Power Flow: " << k << std::endl;
+    FREEDM_LOG_INFO(Logger) << "Reset Predicted Gateway: " << m_Gateway << std::endl;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1236,7 +1236,7 @@ void LBAgent::Synchronize(float k)
 ///////////////////////////////////////////////////////////////////////////////
 bool LBAgent::InvariantCheck()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     const float OMEGA_STEADY_STATE = 376.8;
     const int SCALING_FACTOR = 1000;
@@ -1249,14 +1249,14 @@ bool LBAgent::InvariantCheck()
     {
         if(container.size() > 1)
         {
-            Logger.Warn << "Multiple attached frequency devices." << std::endl;
+            FREEDM_LOG_WARN(Logger) << "Multiple attached frequency devices." << std::endl;
         }
         float w  = (*container.begin())->GetState("frequency");
         float P  = SCALING_FACTOR * m_PowerDifferential;
         float dK = SCALING_FACTOR * (m_PowerDifferential + m_MigrationStep);
         float freq_diff = w - OMEGA_STEADY_STATE;
 
-        Logger.Info << "Invariant Variables:"
+        FREEDM_LOG_INFO(Logger) << "Invariant Variables:"
             << "\n\tw  = " << w
             << "\n\tP  = " << P
             << "\n\tdK = " << dK << std::endl;
@@ -1265,7 +1265,7 @@ bool LBAgent::InvariantCheck()
 
         if(!result)
         {
-            Logger.Info << "The physical invariant is false." << std::endl;
+            FREEDM_LOG_INFO(Logger) << "The physical invariant is false." << std::endl;
         }
     }
 
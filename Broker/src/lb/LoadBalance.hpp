@@ -51,24 +51,22 @@ private:
     enum State { SUPPLY, DEMAND, NORMAL };
     //     
     /// Generates the message announcing current node state
-    ModuleMessage MessageStateChange(std::string state);
+    const ModuleMessage& MessageStateChange(std::string state);
     /// Generates message supply nodes send to demand nodes
-    ModuleMessage MessageDraftRequest();
+    const ModuleMessage& MessageDraftRequest();
     /// Generates message demand nodes send in response to DraftRequest
-    ModuleMessage MessageDraftAge(float age);
+    const ModuleMessage& MessageDraftAge(float age);
     /// Generates the message that the supply node uses to select a demand node.
-    ModuleMessage MessageDraftSelect(float amount);
+    const ModuleMessage& MessageDraftSelect(float amount);
     /// Generates the message that the demand node uses to confirm the migration
-    ModuleMessage MessageDraftAccept(float amount);
+    const ModuleMessage& MessageDraftAccept(float amount);
     /// Generates the message sent by the demand node to refuse migration.
-    ModuleMessage MessageTooLate(float amount);
+    const ModuleMessage& MessageTooLate(float amount);
     /// Generates the message used to request a state collection.
-    ModuleMessage MessageStateCollection();
+    const ModuleMessage& MessageStateCollection();
     //// Generates the message used to announce the collected normal.
-    ModuleMessage MessageCollectedState(float state);
-    
-    /// Boilerplate for preparing a message.
-    ModuleMessage PrepareForSending(const LoadBalancingMessage & m, std::string recipient = "lb");
+    const ModuleMessage& MessageCollectedState(float state);
+
     /// Sends a message to all peers in a peerset.
     void SendToPeerSet(const PeerSet & ps, const ModuleMessage & m);
 
@@ -132,11 +130,6 @@ private:
     /// Check the invariant prior to starting a new migration.
     bool InvariantCheck();
 
-    /// The amount of time it takes to do an LB round
-    const boost::posix_time::time_duration ROUND_TIME;
-    /// The time it takes to get a draftrequest response
-    const boost::posix_time::time_duration REQUEST_TIMEOUT;
-
     /// Timer handle for the round timer
     CBroker::TimerHandle m_RoundTimer;
     /// Timer handle for the request timer
@@ -110,7 +110,7 @@ SCAgent::SCAgent():
         m_NotifyToSave(false),
         m_curversion("default", 0)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     AddPeer(GetMe());
 }
 
@@ -123,7 +123,7 @@ SCAgent::SCAgent():
 ///////////////////////////////////////////////////////////////////////////////
 void SCAgent::HandleIncomingMessage(boost::shared_ptr<const ModuleMessage> msg, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if (msg->has_group_management_message())
     {
@@ -135,7 +135,7 @@ void SCAgent::HandleIncomingMessage(boost::shared_ptr<const ModuleMessage> msg,
         }
         else
         {
-            Logger.Warn << "Dropped group management message of unexpected type:\n"
+            FREEDM_LOG_WARN(Logger) << "Dropped group management message of unexpected type:\n"
                         << msg->DebugString();
         }
     }
@@ -170,12 +170,12 @@ void SCAgent::HandleIncomingMessage(boost::shared_ptr<const ModuleMessage> msg,
         }
         else
         {
-            Logger.Warn << "Dropped sc message of unexpected type:\n" << msg->DebugString();
+            FREEDM_LOG_WARN(Logger) << "Dropped sc message of unexpected type:\n" << msg->DebugString();
         }
     }
     else
     {
-        Logger.Warn << "Dropped message of unexpected type:\n" << msg->DebugString();
+        FREEDM_LOG_WARN(Logger) << "Dropped message of unexpected type:\n" << msg->DebugString();
     }
 }
 
@@ -192,7 +192,7 @@ void SCAgent::HandleIncomingMessage(boost::shared_ptr<const ModuleMessage> msg,
 //////////////////////////////////////////////////////////////////
 void SCAgent::Initiate()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     //clear map of the collected states previously
     collectstate.clear();
     //count the number of states recorded
@@ -205,14 +205,14 @@ void SCAgent::Initiate()
     //count marker
     m_countmarker = 1;
     //current peers in a group
-    Logger.Debug << " ------------ INITIAL, current peerList : -------------- "<<std::endl;
+    FREEDM_LOG_DEBUG(Logger) << " ------------ INITIAL, current peerList : -------------- "<<std::endl;
     BOOST_FOREACH(CPeerNode peer, m_AllPeers | boost::adaptors::map_values)
     {
-        Logger.Trace << peer.GetUUID() <<std::endl;
+        FREEDM_LOG_TRACE(Logger) << peer.GetUUID() <<std::endl;
     }
-    Logger.Debug << " --------------------------------------------- "<<std::endl;
+    FREEDM_LOG_DEBUG(Logger) << " --------------------------------------------- "<<std::endl;
     //collect states of local devices
-    Logger.Info << "TakeSnapshot: collect states of " << GetUUID() << std::endl;
+    FREEDM_LOG_INFO(Logger) << "TakeSnapshot: collect states of " << GetUUID() << std::endl;
     //TakeSnapshot(m_deviceType, m_valueType);
     TakeSnapshot(m_device);
     //save state into the multimap "collectstate"
@@ -226,9 +226,10 @@ void SCAgent::Initiate()
     }
 
     //prepare marker tagged with UUID + Int
-    Logger.Info << "Marker is ready from " << GetUUID() << std::endl;
+    FREEDM_LOG_INFO(Logger) << "Marker is ready from " << GetUUID() << std::endl;
 
-    StateCollectionMessage scm;
+    ModuleMessage& modmsg = NewMessage("sc");
+    StateCollectionMessage& scm = *modmsg.mutable_state_collection_message();
     MarkerMessage* mm = scm.mutable_marker_message();
     mm->set_source(GetUUID());
     mm->set_id(m_curversion.second);
@@ -239,12 +240,13 @@ void SCAgent::Initiate()
         mm->add_device(device);
     }
     //send tagged marker to all other peers
+    boost::shared_ptr<const ModuleMessage> marker = ShareMessage(modmsg);
     BOOST_FOREACH(CPeerNode peer, m_AllPeers | boost::adaptors::map_values)
     {
         if (peer.GetUUID()!= GetUUID())
         {
-            Logger.Info << "Sending marker to " << peer.GetUUID() << std::endl;
-            peer.Send(PrepareForSending(scm));
+            FREEDM_LOG_INFO(Logger) << "Sending marker to " << peer.GetUUID() << std::endl;
+            peer.Send(marker);
         }
     }//end foreach
 }
@@ -262,15 +264,16 @@ void SCAgent::Initiate()
 
 void SCAgent::StateResponse()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if (m_countmarker == m_AllPeers.size() && m_NotifyToSave == false)
     {
-        Logger.Status << "****************CollectedStates***************************" << std::endl;
+        FREEDM_LOG_STATUS(Logger) << "****************CollectedStates***************************" << std::endl;
         //prepare collect states
-        Logger.Info << "Sending requested state back to " << m_module << " module" << std::endl;
+        FREEDM_LOG_INFO(Logger) << "Sending requested state back to " << m_module << " module" << std::endl;
 
-        StateCollectionMessage scm;
+        ModuleMessage& modmsg = NewMessage(m_module);
+        StateCollectionMessage& scm = *modmsg.mutable_state_collection_message();
         CollectedStateMessage* csm = scm.mutable_collected_state_message();
         csm->set_num_intransit_accepts(0);
 
@@ -281,7 +284,7 @@ void SCAgent::StateResponse()
                 BOOST_FOREACH(
                     const DeviceSignalStateMessage& dssm, it->second.device_signal_state_message())
                 {
-                    Logger.Status << (*it).first.first << "+++" << (*it).first.second << "    "
+                    FREEDM_LOG_STATUS(Logger) << (*it).first.first << "+++" << (*it).first.second << "    "
                                   << dssm.type() << " : "
                                   << dssm.signal() << " : "
                                   << dssm.value() << std::endl;
@@ -349,7 +352,7 @@ void SCAgent::StateResponse()
         }//end for
 
         //send collected states to the request module
-        GetMe().Send(PrepareForSending(scm, m_module));
+        GetMe().Send(ShareMessage(modmsg));
 
         //clear collectstate
         collectstate.clear();
@@ -358,15 +361,15 @@ void SCAgent::StateResponse()
     }
     else
     {
-        Logger.Notice << "(Initiator) Not receiving all states back. PeerList size is " << m_AllPeers.size()<< std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "(Initiator) Not receiving all states back. PeerList size is " << m_AllPeers.size()<< std::endl;
 
         if (m_NotifyToSave == true)
         {
-            Logger.Status << m_countmarker << " + " << "TRUE" << std::endl;
+            FREEDM_LOG_STATUS(Logger) << m_countmarker << " + " << "TRUE" << std::endl;
         }
         else
         {
-            Logger.Status << m_countmarker << " + " << "FALSE" << std::endl;
+            FREEDM_LOG_STATUS(Logger) << m_countmarker << " + " << "FALSE" << std::endl;
         }
 
         m_countmarker = 0;
@@ -388,7 +391,7 @@ void SCAgent::TakeSnapshot(const std::vector<std::string>& devicelist)
 {
     //For multidevices state collection
 
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     device::SignalValue PowerValue;
 
     m_curstate.Clear();
@@ -408,7 +411,7 @@ void SCAgent::TakeSnapshot(const std::vector<std::string>& devicelist)
         std::string signal(device.begin() + colon + 1, device.end());
 
         PowerValue = device::CDeviceManager::Instance().GetNetValue(type, signal);
-        Logger.Status << "Device:   "<< type << "  Signal:  "<< signal << " Value:  " << PowerValue << std::endl;
+        FREEDM_LOG_STATUS(Logger) << "Device:   "<< type << "  Signal:  "<< signal << " Value:  " << PowerValue << std::endl;
         count = device::CDeviceManager::Instance().GetDevicesOfType(type).size();
 
 	//save device state
@@ -430,12 +433,13 @@ void SCAgent::TakeSnapshot(const std::vector<std::string>& devicelist)
 //////////////////////////////////////////////////////////////////
 void SCAgent::SendStateBack()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     //Peer send collected states to initiator
     //for each in collectstate, extract ptree as a message then send to initiator
-    Logger.Status << "(Peer)The number of collected states is " << int(collectstate.size()) << std::endl;
+    FREEDM_LOG_STATUS(Logger) << "(Peer)The number of collected states is " << int(collectstate.size()) << std::endl;
 
-    StateCollectionMessage scm;
+    ModuleMessage& modmsg = NewMessage("sc");
+    StateCollectionMessage& scm = *modmsg.mutable_state_collection_message();
     StateMessage* sm = scm.mutable_state_message();
     sm->set_source(GetUUID());
     sm->set_marker_uuid(m_curversion.first);
@@ -449,7 +453,7 @@ void SCAgent::SendStateBack()
             BOOST_FOREACH(
                 const DeviceSignalStateMessage& stored, it->second.device_signal_state_message())
             {
-                Logger.Status << "item:     " << stored.type() << "   "
+                FREEDM_LOG_STATUS(Logger) << "item:     " << stored.type() << "   "
                               << stored.signal() << "    "
                               <<  stored.value() << std::endl;
 
@@ -461,11 +465,11 @@ void SCAgent::SendStateBack()
 
     try
     {
-        GetPeer(m_curversion.first).Send(PrepareForSending(scm));
+        GetPeer(m_curversion.first).Send(ShareMessage(modmsg));
     }
     catch(EDgiNoSuchPeerError)
     {
-        Logger.Info << "Peer '"<<m_curversion.first<<"' doesn't exist" << std::endl;
+        FREEDM_LOG_INFO(Logger) << "Peer '"<<m_curversion.first<<"' doesn't exist" << std::endl;
     }
 }
 
@@ -480,15 +484,15 @@ void SCAgent::SendStateBack()
 //////////////////////////////////////////////////////////////////
 void SCAgent::SaveForward(StateVersion latest, const MarkerMessage& msg)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     collectstate.clear();
     //assign latest marker version to current version
     m_curversion = latest;
     //count unique marker
     m_countmarker = 1;
-    Logger.Info << "Marker is " << m_curversion.first << " " << m_curversion.second << std::endl;
+    FREEDM_LOG_INFO(Logger) << "Marker is " << m_curversion.first << " " << m_curversion.second << std::endl;
     //physical device information
-    Logger.Debug << "SC module identified "<< device::CDeviceManager::Instance().DeviceCount()
+    FREEDM_LOG_DEBUG(Logger) << "SC module identified "<< device::CDeviceManager::Instance().DeviceCount()
     << " physical devices on this node" << std::endl;
     //collect local state
     TakeSnapshot(m_device);
@@ -496,14 +500,16 @@ void SCAgent::SaveForward(StateVersion latest, const MarkerMessage& msg)
     collectstate.insert(std::make_pair(m_curversion, m_curstate));
     m_countstate++;
 
-    StateCollectionMessage scm;
+    ModuleMessage& modmsg = NewMessage("sc");
+    StateCollectionMessage& scm = *modmsg.mutable_state_collection_message();
     MarkerMessage* mm = scm.mutable_marker_message();
     mm->CopyFrom(msg);
+    boost::shared_ptr<const ModuleMessage> marker = ShareMessage(modmsg);
 
     if (m_AllPeers.size()==2)
     //only two nodes, peer finish collecting states: send marker then state back
     {
-        GetPeer(m_curversion.first).Send(PrepareForSending(scm));
+        GetPeer(m_curversion.first).Send(marker);
         //send collected states to initiator
         SendStateBack();
         m_curversion.first = "default";
@@ -519,8 +525,8 @@ void SCAgent::SaveForward(StateVersion latest, const MarkerMessage& msg)
         {
             if (peer.GetUUID()!= GetUUID())
             {
-                Logger.Info << "Forward marker to " << peer.GetUUID() << std::endl;
-                peer.Send(PrepareForSending(scm));
+                FREEDM_LOG_INFO(Logger) << "Forward marker to " << peer.GetUUID() << std::endl;
+                peer.Send(marker);
             }
         }//end foreach
         //set flag to start to record messages in channel
@@ -542,7 +548,7 @@ void SCAgent::HandleAccept(CPeerNode peer)
         return;
     if (m_NotifyToSave == true)
     {
-        Logger.Warn << "Received intransit accept message" << std::endl;
+        FREEDM_LOG_WARN(Logger) << "Received intransit accept message" << std::endl;
 
         // FIXME yes, the accept message is a device! you bet!
         m_curstate.Clear();
@@ -569,10 +575,10 @@ void SCAgent::HandleAccept(CPeerNode peer)
 //////////////////////////////////////////////////////////////////
 void SCAgent::HandlePeerList(const gm::PeerListMessage& msg, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     std::string line_ = peer.GetUUID();
     m_scleader = peer.GetUUID();
-    Logger.Info << "Peer List received from Group Leader: " << peer.GetUUID() <<std::endl;
+    FREEDM_LOG_INFO(Logger) << "Peer List received from Group Leader: " << peer.GetUUID() <<std::endl;
     // Process the peer list.
     m_AllPeers = gm::GMAgent::ProcessPeerList(msg);
 
@@ -585,7 +591,7 @@ void SCAgent::HandlePeerList(const gm::PeerListMessage& msg, CPeerNode peer)
     if (line_ == GetUUID() && line_  == m_curversion.first)
         //initiator doesn't change
     {
-        Logger.Info << "Keep going!" << std::endl;
+        FREEDM_LOG_INFO(Logger) << "Keep going!" << std::endl;
     }
     else if (line_ == GetUUID() && line_ != m_curversion.first)
         //group leader is changed to a new one
@@ -621,7 +627,7 @@ void SCAgent::HandlePeerList(const gm::PeerListMessage& msg, CPeerNode peer)
 //////////////////////////////////////////////////////////////////
 void SCAgent::HandleRequest(const RequestMessage& msg, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     //For multidevices state collection
     //clear m_device
@@ -642,11 +648,11 @@ void SCAgent::HandleRequest(const RequestMessage& msg, CPeerNode peer)
         std::string valueType = dsrm.signal();
         std::string combine = deviceType + ":" + valueType;
         m_device.push_back(combine);
-        Logger.Status<<"Device Item:  .." << combine << std::endl;
+        FREEDM_LOG_STATUS(Logger)<<"Device Item:  .." << combine << std::endl;
     }
 
     //call initiate to start state collection
-    Logger.Notice << "Receiving state collect request from " << m_module << " ( "
+    FREEDM_LOG_NOTICE(Logger) << "Receiving state collect request from " << m_module << " ( "
                   << peer.GetUUID() << " )" << std::endl;
 
     //Put the initiate call into the back of queue
@@ -667,12 +673,12 @@ void SCAgent::HandleRequest(const RequestMessage& msg, CPeerNode peer)
 //////////////////////////////////////////////////////////////////
 void SCAgent::HandleMarker(const MarkerMessage& msg, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     if(CountInPeerSet(m_AllPeers,peer) == 0)
         return;
     StateVersion incomingVer_;
     // marker value is present
-    Logger.Info << "Received message is a marker!" << std::endl;
+    FREEDM_LOG_INFO(Logger) << "Received message is a marker!" << std::endl;
     // read the incoming version from marker
     incomingVer_.first = msg.source();
     incomingVer_.second = msg.id();
@@ -683,19 +689,19 @@ void SCAgent::HandleMarker(const MarkerMessage& msg, CPeerNode peer)
 	{
         //save power level for each node into a vector
         m_device.push_back(device);
-	    Logger.Notice << "Needed device: " << device << std::endl;
+	    FREEDM_LOG_NOTICE(Logger) << "Needed device: " << device << std::endl;
 	}
 
     if (m_curversion.first == "default")
         //peer receives first marker
     {
-        Logger.Status << "------------------------first maker with default state ----------------" << std::endl;
+        FREEDM_LOG_STATUS(Logger) << "------------------------first maker with default state ----------------" << std::endl;
         SaveForward(incomingVer_, msg);
     }//first receive marker
     else if (m_curversion == incomingVer_ && m_curversion.first == GetUUID())
         //initiator receives his marker before
     {
-        Logger.Status << "------------------------Initiator receives his marker------------------" << std::endl;
+        FREEDM_LOG_STATUS(Logger) << "------------------------Initiator receives his marker------------------" << std::endl;
         //number of marker is increased by 1
         m_countmarker++;
 
@@ -708,7 +714,7 @@ void SCAgent::HandleMarker(const MarkerMessage& msg, CPeerNode peer)
     else if (m_curversion == incomingVer_ && m_curversion.first != GetUUID())
         //peer receives this marker before
     {
-        Logger.Status << "------------------------Peer receives marker before--------------------" << std::endl;
+        FREEDM_LOG_STATUS(Logger) << "------------------------Peer receives marker before--------------------" << std::endl;
         //number of marker is increased by 1
         m_countmarker++;
 
@@ -727,31 +733,31 @@ void SCAgent::HandleMarker(const MarkerMessage& msg, CPeerNode peer)
     else if (incomingVer_ != m_curversion && m_curversion.first != "default")
         //receive a new marker from other peer
     {
-        //Logger.Status << "===================================================" << std::endl;
-        Logger.Status << "-----Receive a new marker different from current one.-------" << std::endl;
-        Logger.Status << "Current version is " << m_curversion.first << " + " << m_curversion.second << std::endl;
-        Logger.Status << "Incoming version is " << incomingVer_.first << " + " << incomingVer_.second << std::endl;
+        //FREEDM_LOG_STATUS(Logger) << "===================================================" << std::endl;
+        FREEDM_LOG_STATUS(Logger) << "-----Receive a new marker different from current one.-------" << std::endl;
+        FREEDM_LOG_STATUS(Logger) << "Current version is " << m_curversion.first << " + " << m_curversion.second << std::endl;
+        FREEDM_LOG_STATUS(Logger) << "Incoming version is " << incomingVer_.first << " + " << incomingVer_.second << std::endl;
 
         //assign incoming version to current version if the incoming is newer
         if (m_curversion.first == incomingVer_.first && incomingVer_.second > m_curversion.second)
         {
-            Logger.Status << "Incoming marker is newer from same node, follow the newer" << std::endl;
+            FREEDM_LOG_STATUS(Logger) << "Incoming marker is newer from same node, follow the newer" << std::endl;
             SaveForward(incomingVer_, msg);
         }
         //assign incoming version to current version if the incoming is from leader
         else if (GetUUID() != m_scleader && incomingVer_.first == m_scleader && incomingVer_.second >  m_curversion.second)
         {
-            Logger.Status << "Incoming marker is from leader and newer, follow the newer" << std::endl;
+            FREEDM_LOG_STATUS(Logger) << "Incoming marker is from leader and newer, follow the newer" << std::endl;
             SaveForward(incomingVer_, msg);
         }
         else if (incomingVer_.first == m_scleader && m_curversion.first != incomingVer_.first)
         {
-            Logger.Status << "Incoming marker is from leader, follow the leader" << std::endl;
+            FREEDM_LOG_STATUS(Logger) << "Incoming marker is from leader, follow the leader" << std::endl;
             SaveForward(incomingVer_, msg);
         }
         else
         {
-            Logger.Status << "Incoming marker is from another peer, or index is smaller, ignore" << std::endl;
+            FREEDM_LOG_STATUS(Logger) << "Incoming marker is from another peer, or index is smaller, ignore" << std::endl;
         }
     }
  }
@@ -769,14 +775,14 @@ void SCAgent::HandleMarker(const MarkerMessage& msg, CPeerNode peer)
 //////////////////////////////////////////////////////////////////
 void SCAgent::HandleState(const StateMessage& msg, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     if(CountInPeerSet(m_AllPeers,peer) == 0)
         return;
 
     if (m_curversion.first==msg.marker_uuid() && m_curversion.second==msg.marker_int())
     {
         m_countdone++;
-        Logger.Notice << "Receive collected state from peer " << msg.source() << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "Receive collected state from peer " << msg.source() << std::endl;
         m_curstate.CopyFrom(msg);
 
         //save state into the map "collectstate"
@@ -805,7 +811,7 @@ void SCAgent::HandleState(const StateMessage& msg, CPeerNode peer)
 /////////////////////////////////////////////////////////
 CPeerNode SCAgent::AddPeer(CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     InsertInPeerSet(m_AllPeers,peer);
     return peer;
 }
@@ -821,7 +827,7 @@ CPeerNode SCAgent::AddPeer(CPeerNode peer)
 /////////////////////////////////////////////////////////
 CPeerNode SCAgent::GetPeer(std::string uuid)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     PeerSet::iterator it = m_AllPeers.find(uuid);
 
     if (it != m_AllPeers.end())
@@ -834,26 +840,6 @@ CPeerNode SCAgent::GetPeer(std::string uuid)
     }
 }
 
-///////////////////////////////////////////////////////////////////////////////
-/// Wraps a StateCollectionMessage in a ModuleMessage.
-///
-/// @param message the message to prepare. If any required field is unset,
-///                the DGI will abort.
-/// @param recipient the module (sc/lb/gm/clk etc.) the message should be
-///                  delivered to
-///
-/// @return a ModuleMessage containing a copy of the StateCollectionMessage
-///////////////////////////////////////////////////////////////////////////////
-ModuleMessage SCAgent::PrepareForSending(
-    const StateCollectionMessage& message, std::string recipient)
-{
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    ModuleMessage mm;
-    mm.mutable_state_collection_message()->CopyFrom(message);
-    mm.set_recipient_module(recipient);
-    return mm;
-}
-
 } // namespace sc
 
 } // namespace broker
@@ -96,10 +96,6 @@ class SCAgent
         ///Get a pointer to a peer from UUID
         CPeerNode GetPeer(std::string uuid);
 
-        /// Wraps a StateCollectionMessage in a ModuleMessage
-        static ModuleMessage PrepareForSending(
-            const StateCollectionMessage& message, std::string recipient = "sc");
-
         ///collect states container and its iterator
         std::multimap<StateVersion, StateMessage> collectstate;
         std::multimap<StateVersion, StateMessage>::iterator it;
@@ -44,11 +44,9 @@ CLocalLogger Logger(__FILE__);
 /// @limitations: None
 ///////////////////////////////////////////////////////////////////////////////
 VVCAgent::VVCAgent()
-    : ROUND_TIME(boost::posix_time::milliseconds(CTimings::Get("LB_ROUND_TIME")))
-    , REQUEST_TIMEOUT(boost::posix_time::milliseconds(CTimings::Get("LB_REQUEST_TIMEOUT")))
 {
 
-  Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+  FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
   m_RoundTimer = CBroker::Instance().AllocateTimer("vvc");
   m_WaitTimer = CBroker::Instance().AllocateTimer("vvc");
@@ -70,7 +68,7 @@ int VVCAgent::Run()
   std::cout<< " --------------------VVC ---------------------------------" << std::endl; 
   CBroker::Instance().Schedule("vvc",
       boost::bind(&VVCAgent::FirstRound, this, boost::system::error_code()));
-  Logger.Info << "VVC is scheduled for the next phase." << std::endl;
+  FREEDM_LOG_INFO(Logger) << "VVC is scheduled for the next phase." << std::endl;
   return 0;
 }
 
@@ -104,7 +102,7 @@ void VVCAgent::HandleIncomingMessage(boost::shared_ptr<const ModuleMessage> m, C
         }
         else
         {
-            Logger.Warn << "Dropped unexpected volt var message: \n" << m->DebugString();
+            FREEDM_LOG_WARN(Logger) << "Dropped unexpected volt var message: \n" << m->DebugString();
         }
     }
     else if(m->has_group_management_message())
@@ -116,34 +114,34 @@ void VVCAgent::HandleIncomingMessage(boost::shared_ptr<const ModuleMessage> m, C
         }
         else
         {
-            Logger.Warn << "Dropped unexpected group management message:\n" << m->DebugString();
+            FREEDM_LOG_WARN(Logger) << "Dropped unexpected group management message:\n" << m->DebugString();
         }
     }
     else
     {
-        Logger.Warn<<"Dropped message of unexpected type:\n" << m->DebugString();
+        FREEDM_LOG_WARN(Logger)<<"Dropped message of unexpected type:\n" << m->DebugString();
     }
 }
 
 void VVCAgent::HandleVoltageDelta(const VoltageDeltaMessage & m, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    Logger.Notice << "Got VoltageDelta from: " << peer.GetUUID() << std::endl;
-    Logger.Notice << "CF "<<m.control_factor()<<" Phase "<<m.phase_measurement()<<std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_NOTICE(Logger) << "Got VoltageDelta from: " << peer.GetUUID() << std::endl;
+    FREEDM_LOG_NOTICE(Logger) << "CF "<<m.control_factor()<<" Phase "<<m.phase_measurement()<<std::endl;
 }
 
 void VVCAgent::HandleLineReadings(const LineReadingsMessage & m, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    Logger.Notice << "Got Line Readings from "<< peer.GetUUID() << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_NOTICE(Logger) << "Got Line Readings from "<< peer.GetUUID() << std::endl;
 }
 
 void VVCAgent::HandleGradient(const GradientMessage & m, CPeerNode peer)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-    Logger.Notice << "Got Gradients from "<< peer.GetUUID() << std::endl;
-    Logger.Notice << "size of vector "<< m.gradient_value_size() << std::endl;
-    Logger.Notice << "the 1st element = " << m.gradient_value(0) <<std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_NOTICE(Logger) << "Got Gradients from "<< peer.GetUUID() << std::endl;
+    FREEDM_LOG_NOTICE(Logger) << "size of vector "<< m.gradient_value_size() << std::endl;
+    FREEDM_LOG_NOTICE(Logger) << "the 1st element = " << m.gradient_value(0) <<std::endl;
     
 }
 
@@ -151,8 +149,8 @@ void VVCAgent::HandleGradient(const GradientMessage & m, CPeerNode peer)
 // HandlePeerlist Implementation
 void VVCAgent::HandlePeerList(const gm::PeerListMessage & m, CPeerNode peer)
 {
-	Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
-	Logger.Notice << "Updated Peer List Received from: " << peer.GetUUID() << std::endl;
+	FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
+	FREEDM_LOG_NOTICE(Logger) << "Updated Peer List Received from: " << peer.GetUUID() << std::endl;
 	
 	m_peers.clear();
 	
@@ -200,10 +198,10 @@ ModuleMessage VVCAgent::Gradient(arma::mat grad)
 
 ModuleMessage VVCAgent::PrepareForSending(const VoltVarMessage& message, std::string recipient)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
     ModuleMessage mm;
     mm.mutable_volt_var_message()->CopyFrom(message);
-    mm.set_recipient_module(recipient);
+    SetRecipient(mm, recipient);
     return mm;
 }
 // End of Preparing Messages
@@ -218,7 +216,7 @@ ModuleMessage VVCAgent::PrepareForSending(const VoltVarMessage& message, std::st
 ///////////////////////////////////////////////////////////////////////////////
 void VVCAgent::FirstRound(const boost::system::error_code& err)
 {
-  Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+  FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
   
   if(!err)
   {
@@ -227,11 +225,11 @@ void VVCAgent::FirstRound(const boost::system::error_code& err)
   }
   else if(err == boost::asio::error::operation_aborted)
   {
-    Logger.Notice << "VVCManage Aborted" << std::endl;
+    FREEDM_LOG_NOTICE(Logger) << "VVCManage Aborted" << std::endl;
   }
   else
   {
-    Logger.Error << err << std::endl;
+    FREEDM_LOG_ERROR(Logger) << err << std::endl;
     throw boost::system::system_error(err);
   }
 			
@@ -248,7 +246,7 @@ void VVCAgent::FirstRound(const boost::system::error_code& err)
 /////////////////////////////////////////////////////////
 void VVCAgent::VVCManage(const boost::system::error_code& err)
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     if(!err)
     {
@@ -261,11 +259,11 @@ void VVCAgent::VVCManage(const boost::system::error_code& err)
         
     else if(err == boost::asio::error::operation_aborted)
     {
-        Logger.Notice << "VVCManage Aborted" << std::endl;
+        FREEDM_LOG_NOTICE(Logger) << "VVCManage Aborted" << std::endl;
     }
     else
     {
-        Logger.Error << err << std::endl;
+        FREEDM_LOG_ERROR(Logger) << err << std::endl;
         throw boost::system::system_error(err);
     }
 }
@@ -280,19 +278,23 @@ void VVCAgent::VVCManage(const boost::system::error_code& err)
 ///////////////////////////////////////////////////////////////////////////////
 void VVCAgent::ScheduleNextRound()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
-    if(CBroker::Instance().TimeRemaining() > ROUND_TIME + ROUND_TIME)
+    // Read each round, so a reloaded timings config takes effect.
+    boost::posix_time::time_duration round =
+        CTimings::GetDuration(CTimings::LB_ROUND_TIME);
+
+    if(CBroker::Instance().TimeRemaining() > round + round)
     {
-        CBroker::Instance().Schedule(m_RoundTimer, ROUND_TIME,
+        CBroker::Instance().Schedule(m_RoundTimer, round,
             boost::bind(&VVCAgent::VVCManage, this, boost::asio::placeholders::error));
-        Logger.Info << "VVCManage scheduled in " << ROUND_TIME << " ms." << std::endl;
+        FREEDM_LOG_INFO(Logger) << "VVCManage scheduled in " << round << " ms." << std::endl;
     }
     else
     {
         CBroker::Instance().Schedule(m_RoundTimer, boost::posix_time::not_a_date_time,
             boost::bind(&VVCAgent::FirstRound, this, boost::asio::placeholders::error));
-        Logger.Info << "VVCManage scheduled for the next phase." << std::endl;
+        FREEDM_LOG_INFO(Logger) << "VVCManage scheduled for the next phase." << std::endl;
     }
 }
 
@@ -305,7 +307,7 @@ void VVCAgent::ScheduleNextRound()
 ///////////////////////////////////////////////////////////////////////////////
 void VVCAgent::ReadDevices()
 {
-    Logger.Trace << __PRETTY_FUNCTION__ << std::endl;
+    FREEDM_LOG_TRACE(Logger) << __PRETTY_FUNCTION__ << std::endl;
 
     float generation = device::CDeviceManager::Instance().GetNetValue("Drer", "generation");
     float storage = device::CDeviceManager::Instance().GetNetValue("Desd", "storage");
@@ -82,10 +82,6 @@ private:
     void vvc_main();
     
     ////////////////////////////////////////////////////
-    /// The amount of time it takes to do an VVC round
-    const boost::posix_time::time_duration ROUND_TIME;
-    /// The time it takes to get a draftrequest response
-    const boost::posix_time::time_duration REQUEST_TIMEOUT;
 
     /// Timer handle for the round timer
     CBroker::TimerHandle m_RoundTimer;